@@ -26,6 +26,10 @@ AppBase::AppBase(HINSTANCE hInstance)
     // Only one AppBase can be constructed.
     assert(mApp == nullptr);
     mApp = this;
+
+    mPacer.SetTargetFrameRate(120.0);
+    mPacer.SetFixedTimestep(1.0 / 60.0);
+    mPacer.SetMaxCatchUpSteps(5);
 }
 
 AppBase::~AppBase()
@@ -69,8 +73,13 @@ void AppBase::Set4xMsaaState(bool value)
 int AppBase::Run()
 {
 	MSG msg = {0};
- 
+
+	// Ask for 1 ms scheduler granularity so the pacer's sleeps are accurate.
+	timeBeginPeriod(1);
+
 	mTimer.Reset();
+	mTimer.Stats().SetHitchThresholdMs(mHitchThresholdMs);
+	mPacer.Reset();
 
 	while(msg.message != WM_QUIT)
 	{
@@ -83,20 +92,40 @@ int AppBase::Run()
 		// Otherwise, do animation/game stuff.
 		else
         {	
+			if( !mAppPaused )
+				mPacer.WaitForNextFrame();
+
 			mTimer.Tick();
 
 			if( !mAppPaused )
 			{
-				Update(mTimer);
-                Draw(mTimer);
+				CalculateFrameStats();
+				{
+					PROFILE_SCOPE("FixedUpdate");
+					int steps = mPacer.AdvanceSimulation(mTimer.DeltaTime());
+					for(int i = 0; i < steps; ++i)
+						FixedUpdate(mPacer.GetFixedTimestep());
+				}
+				{
+					PROFILE_SCOPE("Update");
+					Update(mTimer);
+				}
+				{
+					PROFILE_SCOPE("Draw");
+					Draw(mTimer);
+				}
+				PROFILE_END_FRAME();
 			}
 			else
 			{
 				Sleep(100);
+				mPacer.Reset();
 			}
         }
     }
 
+	timeEndPeriod(1);
+
 	return (int)msg.wParam;
 }
 
@@ -136,6 +165,8 @@ void AppBase::CreateRtvAndDsvDescriptorHeaps()
 
 void AppBase::OnResize()
 {
+    PROFILE_SCOPE("OnResize");
+
     assert(md3dDevice);
     assert(mSwapChain);
     assert(mDirectCmdListAlloc);
@@ -365,6 +396,10 @@ LRESULT AppBase::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         }
         else if((int)wParam == VK_F2)
             Set4xMsaaState(!m4xMsaaState);
+#if PROFILER_ENABLED
+        else if((int)wParam == VK_F3)
+            ToggleProfilerCapture();
+#endif
 
         return 0;
 	}
@@ -469,6 +504,7 @@ bool AppBase::InitDirect3D()
 	
 #ifdef _DEBUG
     LogAdapters();
+    LogClockOverhead();
 #endif
 
 	CreateCommandObjects();
@@ -533,6 +569,8 @@ void AppBase::CreateSwapChain()
 
 void AppBase::FlushCommandQueue()
 {
+	PROFILE_SCOPE("FlushCommandQueue");
+
 	// Advance the fence value to mark commands up to this fence point.
 	mCurrentFence++;
 
@@ -555,6 +593,55 @@ void AppBase::FlushCommandQueue()
 	}
 }
 
+void AppBase::ToggleProfilerCapture()
+{
+	// F3 starts a capture; the next F3 writes it to the working directory.
+	Profiler& profiler = Profiler::Get();
+	if(!profiler.IsCapturing())
+	{
+		profiler.BeginCapture();
+		return;
+	}
+
+	profiler.EndCapture();
+
+	std::ofstream json("profile_trace.json");
+	profiler.WriteChromeTrace(json);
+
+	std::ofstream binary("profile_trace.bin", std::ios::binary);
+	profiler.WriteBinary(binary);
+
+	std::string message = "Profiler capture written to profile_trace.json / profile_trace.bin";
+	if(profiler.GetCaptureDroppedEventCount() > 0)
+		message += ", " + std::to_string(profiler.GetCaptureDroppedEventCount()) + " events past the capture limit dropped";
+	OutputDebugStringA((message + "\n").c_str());
+}
+
+void AppBase::CalculateFrameStats()
+{
+	// Refresh the window caption about once per second.  Percentiles are taken over
+	// the timer's frame window, so stutter shows up even when the average is fine.
+	if( (mTimer.TotalTime() - mStatsLastUpdateTime) < 1.0f )
+		return;
+
+	mStatsLastUpdateTime = mTimer.TotalTime();
+
+	FrameStats::Summary stats = mTimer.Stats().ComputeSummary();
+	if(stats.SampleCount == 0)
+		return;
+
+	float fps = static_cast<float>(1000.0 / stats.MeanMs);
+
+	std::wstring windowText = mMainWndCaption +
+		L"    fps: " + std::to_wstring(fps) +
+		L"   avg: " + std::to_wstring(stats.MeanMs) + L" ms" +
+		L"   p99: " + std::to_wstring(stats.P99Ms) + L" ms" +
+		L"   max: " + std::to_wstring(stats.MaxMs) + L" ms" +
+		L"   hitches: " + std::to_wstring(stats.HitchCount);
+
+	SetWindowText(mhMainWnd, windowText.c_str());
+}
+
 ID3D12Resource* AppBase::CurrentBackBuffer()const
 {
 	return mSwapChainBuffer[mCurrBackBuffer].Get();
@@ -573,6 +660,20 @@ D3D12_CPU_DESCRIPTOR_HANDLE AppBase::DepthStencilView()const
 	return mDsvHeap->GetCPUDescriptorHandleForHeapStart();
 }
 
+void AppBase::LogClockOverhead()
+{
+    const IClock* clocks[] = { &mTimer.GetClock(), &Clock::Fastest() };
+
+    for(const IClock* clock : clocks)
+    {
+        std::string text = "***Clock: " + std::string(clock->Name()) +
+            " resolution = " + std::to_string(clock->SecondsPerCount() * 1e9) + " ns" +
+            " read cost = " + std::to_string(Clock::MeasureOverheadNs(*clock)) + " ns\n";
+
+        OutputDebugStringA(text.c_str());
+    }
+}
+
 void AppBase::LogAdapters()
 {
     UINT i = 0;
@@ -8,11 +8,14 @@
 
 #include "../graphics/Dx12Utils.h"
 #include "../core/FrameTimer.h"
+#include "../core/FramePacer.h"
+#include "../core/Profiler.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
 #pragma comment(lib, "D3D12.lib")
 #pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "winmm.lib")
 
 class AppBase
 {
@@ -45,6 +48,11 @@ protected:
 	virtual void Update(const FrameTimer& gt)=0;
     virtual void Draw(const FrameTimer& gt)=0;
 
+	// Called zero or more times per frame with a constant dt (mPacer's fixed
+	// timestep) before Update.  Use mPacer.GetInterpolationAlpha() in Update/Draw to
+	// blend between the last two simulation states.
+	virtual void FixedUpdate(double dt) { (void)dt; }
+
 	// Convenience overrides for handling mouse input.
 	virtual void OnMouseDown(WPARAM btnState, int x, int y) { (void)btnState; (void)x; (void)y; }
 	virtual void OnMouseUp(WPARAM btnState, int x, int y)   { (void)btnState; (void)x; (void)y; }
@@ -59,10 +67,14 @@ protected:
 
 	void FlushCommandQueue();
 
+	void CalculateFrameStats();
+	void ToggleProfilerCapture();
+
 	ID3D12Resource* CurrentBackBuffer()const;
 	D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView()const;
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
+    void LogClockOverhead();
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
     void LogOutputDisplayModes(IDXGIOutput* output, DXGI_FORMAT format);
@@ -85,6 +97,14 @@ protected:
 
 	// Used to keep track of the �delta-time� and game time (�4.4).
 	FrameTimer mTimer;
+
+	// Frame rate limiter and fixed-step simulation clock.  Derived classes may change
+	// the target rate and timestep in their constructor.
+	FramePacer mPacer{ mTimer.GetClock() };
+
+	// Frames slower than this are counted as hitches in the frame statistics.
+	double mHitchThresholdMs = 50.0;
+	float mStatsLastUpdateTime = 0.0f;
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
@@ -5,6 +5,8 @@
 #include "../graphics/GpuUploadBuffer.h"
 #include "../resources/ObjLoader.h"
 
+const int gNumFrameResources = 3;
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 				   PSTR cmdLine, int showCmd)
 {
@@ -35,10 +37,16 @@ CubeApp::CubeApp(HINSTANCE hInstance)
 : AppBase(hInstance)
 {
 	mMainWndCaption = L"cool sponza )";
+
+	UpdateOrbitCamera();
 }
 
 CubeApp::~CubeApp()
 {
+    // Frame resources are destroyed before ~AppBase flushes, so make sure the GPU
+    // is no longer using them.
+    if(md3dDevice != nullptr)
+        FlushCommandQueue();
 }
 
 bool CubeApp::Initialize()
@@ -49,7 +57,14 @@ bool CubeApp::Initialize()
     // Reset the command list to prep for initialization commands.
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
  
+    // Meshes and textures bigger than the ring get a one-off upload buffer for the
+    // initial copy instead of failing with E_OUTOFMEMORY.
+    mUploadRing = std::make_unique<UploadRing>(md3dDevice.Get(), 64ull * 1024 * 1024);
+    mUploadRing->SetOversizeFallback(true);
+    mGpuHeap = std::make_unique<GpuHeap>(md3dDevice.Get());
+
     BuildDescriptorHeaps();
+    BuildFrameResources();
 	BuildConstantBuffers();
     BuildRootSignature();
     BuildShadersAndInputLayout();
@@ -64,6 +79,8 @@ bool CubeApp::Initialize()
     // Wait until initialization is complete.
     FlushCommandQueue();
 
+    mFrameFence = std::make_unique<Dx12Fence>(mFence.Get());
+
 	return true;
 }
 
@@ -72,59 +89,65 @@ void CubeApp::OnResize()
 	AppBase::OnResize();
 
     // The window resized, so update the aspect ratio and recompute the projection matrix.
-    XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f*MathUtils::Pi, AspectRatio(), 1.0f, 1000.0f);
-    XMStoreFloat4x4(&mProj, P);
+    mCamera.SetLens(0.25f*MathUtils::Pi, AspectRatio(), 1.0f, 1000.0f);
 }
 
 void CubeApp::Update(const FrameTimer& gt)
 {
 	(void)gt;
-	// Convert Spherical to Cartesian coordinates.
-	float x = mRadius * sinf(mPhi) * cosf(mTheta);
-	float z = mRadius * sinf(mPhi) * sinf(mTheta);
-	float y = mRadius * cosf(mPhi);
 
-	XMVECTOR pos    = XMVectorSet(x, y, z, 1.0f);
-	XMVECTOR target = XMVectorZero();
-	XMVECTOR up     = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	// Cycle through the circular frame resource array.  This only blocks when the
+	// GPU is still executing the frame that last used this resource.
+	mCurrFrameResource = mFrameResources[mFrameRing.BeginFrame(*mFrameFence)].get();
+
+	mUploadRing->Reclaim(mFrameFence->GetCompletedValue());
+	mCbvHeap->Reclaim(mFrameFence->GetCompletedValue());
 
-	XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
-	XMStoreFloat4x4(&mView, view);
+	mCamera.UpdateViewMatrix();
 
-	XMMATRIX world = XMLoadFloat4x4(&mWorld);
-	XMMATRIX proj  = XMLoadFloat4x4(&mProj);
-	XMMATRIX wvp   = world * view * proj;
+	if(mCamera.GetGeneration() != mUploadedCameraGeneration)
+	{
+		XMMATRIX world = XMLoadFloat4x4(&mWorld);
+		XMMATRIX wvp   = world * mCamera.GetViewProj();
+
+		ObjectConstants obj;
 
-	ObjectConstants obj{};
+		// Матрицы: в HLSL мы умножаем row-vector * matrix (mul(v, M)),
+		// поэтому передаём транспонированные.
+		XMStoreFloat4x4(&obj.World, XMMatrixTranspose(world));
+		XMStoreFloat4x4(&obj.WorldInvTranspose, XMMatrixTranspose(MathUtils::InverseTranspose(world)));
+		XMStoreFloat4x4(&obj.WorldViewProj, XMMatrixTranspose(wvp));
 
-	// Матрицы: в HLSL мы умножаем row-vector * matrix (mul(v, M)),
-	// поэтому передаём транспонированные.
-	XMStoreFloat4x4(&obj.World, XMMatrixTranspose(world));
-	XMStoreFloat4x4(&obj.WorldInvTranspose, XMMatrixTranspose(MathUtils::InverseTranspose(world)));
-	XMStoreFloat4x4(&obj.WorldViewProj, XMMatrixTranspose(wvp));
+		// Камера
+		obj.EyePosW = mCamera.GetPosition3f();
 
-	// Камера
-	obj.EyePosW = XMFLOAT3(x, y, z);
+		// Свет/материал (можешь крутить как хочешь)
+		obj.LightDirW   = XMFLOAT3(0.577f, -0.577f, 0.577f);
+		obj.LightColor  = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		obj.AmbientK    = 0.15f;
+		obj.SpecPower   = 64.0f;
 
-	// Свет/материал (можешь крутить как хочешь)
-	obj.LightDirW   = XMFLOAT3(0.577f, -0.577f, 0.577f);
-	obj.LightColor  = XMFLOAT3(1.0f, 1.0f, 1.0f);
-	obj.AmbientK    = 0.15f;
-	obj.SpecPower   = 64.0f;
+		mObjectPool.Set(mBoxObjCBIndex, obj);
+		mUploadedCameraGeneration = mCamera.GetGeneration();
+	}
 
-	mObjectCB->CopyData(0, obj);
+	// Copy only the slots that changed since this frame resource was last written.
+	mObjectPool.Flush(mCurrFrameResource->ObjectCB->MappedData());
 }
 
 void CubeApp::Draw(const FrameTimer& gt)
 {
 	(void)gt;
+    auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
+
     // Reuse the memory associated with command recording.
-    // We can only reset when the associated command lists have finished execution on the GPU.
-    ThrowIfFailed(mDirectCmdListAlloc->Reset());
+    // We can only reset when the associated command lists have finished execution on the GPU,
+    // which FrameRing::BeginFrame in Update made sure of.
+    ThrowIfFailed(cmdListAlloc->Reset());
 
     // A command list can be reset after it has been added to the command queue via ExecuteCommandList.
     // Reusing the command list reuses memory.
-    ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), mPSO.Get()));
+    ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSO.Get()));
 
     mCommandList->RSSetViewports(1, &mScreenViewport);
     mCommandList->RSSetScissorRects(1, &mScissorRect);
@@ -151,7 +174,7 @@ void CubeApp::Draw(const FrameTimer& gt)
     const auto dsv = DepthStencilView();
     mCommandList->OMSetRenderTargets(1, &rtv, TRUE, &dsv);
 
-    ID3D12DescriptorHeap* descriptorHeaps[] = { mCbvHeap.Get() };
+    ID3D12DescriptorHeap* descriptorHeaps[] = { mCbvHeap->Heap() };
     mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
     mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
@@ -165,7 +188,9 @@ void CubeApp::Draw(const FrameTimer& gt)
 
     mCommandList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-    mCommandList->SetGraphicsRootDescriptorTable(0, mCbvHeap->GetGPUDescriptorHandleForHeapStart());
+    // Each frame resource has its own CBV, stored at the frame index in the heap.
+    CD3DX12_GPU_DESCRIPTOR_HANDLE cbvHandle = mCbvHeap->GpuHandle(mObjectCbvs.Range.Offset + mFrameRing.GetCurrentIndex());
+    mCommandList->SetGraphicsRootDescriptorTable(0, cbvHandle);
 
     // Определяем имя submesh (может быть "box", "sponge" или "sponza")
     std::string submeshName = "box";
@@ -202,8 +227,10 @@ void CubeApp::Draw(const FrameTimer& gt)
     ThrowIfFailed(mSwapChain->Present(0, 0));
     mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
-    // Wait until frame commands are complete.
-    FlushCommandQueue();
+    // Mark the commands up to this point with a fence value and move on without
+    // waiting; the frame resource is only reused once the GPU reaches this fence.
+    mFrameRing.EndFrame(++mCurrentFence);
+    ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
 }
 
 void CubeApp::OnMouseDown(WPARAM btnState, int x, int y)
@@ -251,39 +278,63 @@ void CubeApp::OnMouseMove(WPARAM btnState, int x, int y)
         mRadius = MathUtils::Clamp(mRadius, 3.0f, 15.0f);
     }
 
+    if((btnState & (MK_LBUTTON | MK_RBUTTON)) != 0)
+        UpdateOrbitCamera();
+
     mLastMousePos.x = x;
     mLastMousePos.y = y;
 }
 
+void CubeApp::UpdateOrbitCamera()
+{
+	// Convert Spherical to Cartesian coordinates.
+	XMVECTOR pos    = MathUtils::SphericalToCartesian(mRadius, mTheta, mPhi);
+	XMVECTOR target = XMVectorZero();
+	XMVECTOR up     = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+	mCamera.LookAt(pos, target, up);
+}
+
 void CubeApp::BuildDescriptorHeaps()
 {
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = 1;
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	cbvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&cbvHeapDesc,
-        IID_PPV_ARGS(&mCbvHeap)));
+    mCbvHeap = std::make_unique<DescriptorHeap>(md3dDevice.Get(),
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+        256,    // persistent
+        1024,   // transient, shared by the frames in flight
+        true);
+
+    mObjectCbvs = mCbvHeap->AllocatePersistent(gNumFrameResources);
 }
 
-void CubeApp::BuildConstantBuffers()
+void CubeApp::BuildFrameResources()
 {
-	mObjectCB = std::make_unique<GpuUploadBuffer<ObjectConstants>>(md3dDevice.Get(), 1, true);
+    for(int i = 0; i < gNumFrameResources; ++i)
+    {
+        mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(), MaxObjects));
+    }
+
+    mBoxObjCBIndex = mObjectPool.Allocate();
+}
 
+void CubeApp::BuildConstantBuffers()
+{
 	UINT objCBByteSize = Dx12Utils::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 
-	D3D12_GPU_VIRTUAL_ADDRESS cbAddress = mObjectCB->Resource()->GetGPUVirtualAddress();
-    // Offset to the ith object constant buffer in the buffer.
-    int boxCBufIndex = 0;
-	cbAddress += boxCBufIndex*objCBByteSize;
+	for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex)
+	{
+		D3D12_GPU_VIRTUAL_ADDRESS cbAddress = mFrameResources[frameIndex]->ObjectCB->Resource()->GetGPUVirtualAddress();
+		// Offset to the ith object constant buffer in the buffer.
+		cbAddress += mBoxObjCBIndex*objCBByteSize;
+
+		// Offset to the frame's CBV in the descriptor heap.
+		CD3DX12_CPU_DESCRIPTOR_HANDLE handle = mCbvHeap->CpuHandle(mObjectCbvs.Range.Offset + frameIndex);
 
-	D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
-	cbvDesc.BufferLocation = cbAddress;
-	cbvDesc.SizeInBytes = Dx12Utils::CalcConstantBufferByteSize(sizeof(ObjectConstants));
+		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
+		cbvDesc.BufferLocation = cbAddress;
+		cbvDesc.SizeInBytes = objCBByteSize;
 
-	md3dDevice->CreateConstantBufferView(
-		&cbvDesc,
-		mCbvHeap->GetCPUDescriptorHandleForHeapStart());
+		md3dDevice->CreateConstantBufferView(&cbvDesc, handle);
+	}
 }
 
 void CubeApp::BuildRootSignature()
@@ -425,13 +476,13 @@ void CubeApp::BuildBoxGeometry()
     mBoxGeo->VertexBufferGPU = Dx12Utils::CreateDefaultBuffer(
         md3dDevice.Get(), mCommandList.Get(),
         vertices.data(), vbByteSize,
-        mBoxGeo->VertexBufferUploader
+        *mUploadRing, mCurrentFence + 1, mGpuHeap.get()
     );
 
     mBoxGeo->IndexBufferGPU = Dx12Utils::CreateDefaultBuffer(
         md3dDevice.Get(), mCommandList.Get(),
         indices.data(), ibByteSize,
-        mBoxGeo->IndexBufferUploader
+        *mUploadRing, mCurrentFence + 1, mGpuHeap.get()
     );
 
     mBoxGeo->VertexByteStride = sizeof(Vertex);
@@ -548,7 +599,7 @@ void CubeApp::LoadSpongeModel()
     mBoxGeo->VertexBufferGPU = Dx12Utils::CreateDefaultBuffer(
         md3dDevice.Get(), mCommandList.Get(),
         vertices.data(), vbByteSize,
-        mBoxGeo->VertexBufferUploader
+        *mUploadRing, mCurrentFence + 1, mGpuHeap.get()
     );
 
     if (use16Bit)
@@ -556,7 +607,7 @@ void CubeApp::LoadSpongeModel()
         mBoxGeo->IndexBufferGPU = Dx12Utils::CreateDefaultBuffer(
             md3dDevice.Get(), mCommandList.Get(),
             indices.data(), ibByteSize,
-            mBoxGeo->IndexBufferUploader
+            *mUploadRing, mCurrentFence + 1, mGpuHeap.get()
         );
         mBoxGeo->IndexFormat = DXGI_FORMAT_R16_UINT;
     }
@@ -565,7 +616,7 @@ void CubeApp::LoadSpongeModel()
         mBoxGeo->IndexBufferGPU = Dx12Utils::CreateDefaultBuffer(
             md3dDevice.Get(), mCommandList.Get(),
             objIndices.data(), ibByteSize,
-            mBoxGeo->IndexBufferUploader
+            *mUploadRing, mCurrentFence + 1, mGpuHeap.get()
         );
         mBoxGeo->IndexFormat = DXGI_FORMAT_R32_UINT;
     }
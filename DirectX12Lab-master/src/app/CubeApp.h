@@ -2,38 +2,25 @@
 
 #include "../math/MathUtils.h"
 #include "../graphics/GpuUploadBuffer.h"
+#include "../graphics/Dx12Fence.h"
+#include "../graphics/UploadRing.h"
+#include "../graphics/ObjectConstantPool.h"
+#include "../graphics/DescriptorHeap.h"
+#include "../graphics/GpuHeap.h"
+#include "../scene/CameraComponent.h"
+#include "FrameResource.h"
 #include "AppBase.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
-struct Vertex
-{
-	XMFLOAT3 Pos;
-	XMFLOAT3 Normal;
-	XMFLOAT4 Color; // albedo
-};
-
-struct ObjectConstants
-{
-	XMFLOAT4X4 World             = MathUtils::Identity4x4();
-	XMFLOAT4X4 WorldInvTranspose = MathUtils::Identity4x4();
-	XMFLOAT4X4 WorldViewProj     = MathUtils::Identity4x4();
-
-	XMFLOAT3   EyePosW   = {0.0f, 0.0f, 0.0f};
-	float      SpecPower = 32.0f;
-
-	XMFLOAT3   LightDirW = {0.577f, -0.577f, 0.577f}; // диагональный directional light
-	float      AmbientK  = 0.15f;
-
-	XMFLOAT3   LightColor = {1.0f, 1.0f, 1.0f};
-	float      _pad0      = 0.0f;
-};
-
 class CubeApp : public AppBase
 {
 public:
+    // Capacity of the object constant pool and of each frame's ObjectCB.
+    static const UINT MaxObjects = 1024;
+
 	CubeApp(HINSTANCE hInstance);
     CubeApp(const CubeApp& rhs) = delete;
     CubeApp& operator=(const CubeApp& rhs) = delete;
@@ -51,6 +38,7 @@ private:
     virtual void OnMouseMove(WPARAM btnState, int x, int y)override;
 
     void BuildDescriptorHeaps();
+    void BuildFrameResources();
 	void BuildConstantBuffers();
     void BuildRootSignature();
     void BuildShadersAndInputLayout();
@@ -58,12 +46,28 @@ private:
     void LoadSpongeModel();
     void BuildPSO();
 
+    void UpdateOrbitCamera();
+
 private:
     
     ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
-    ComPtr<ID3D12DescriptorHeap> mCbvHeap = nullptr;
+    // Shader-visible CBV/SRV/UAV heap.  Only persistent ranges are used: one CBV
+    // per frame resource, allocated once in BuildDescriptorHeaps().
+    std::unique_ptr<DescriptorHeap> mCbvHeap;
+    DescriptorHeap::Allocation mObjectCbvs; // one object CBV per frame resource
+
+    std::vector<std::unique_ptr<FrameResource>> mFrameResources;
+    FrameResource* mCurrFrameResource = nullptr;
+
+    // Fence bookkeeping for the frame resources; replaces the per-frame flush.
+    FrameRing mFrameRing{ gNumFrameResources };
+    std::unique_ptr<Dx12Fence> mFrameFence;
+
+    // Shared staging memory for static geometry uploads; reclaimed by fence value.
+    std::unique_ptr<UploadRing> mUploadRing;
 
-    std::unique_ptr<GpuUploadBuffer<ObjectConstants>> mObjectCB = nullptr;
+    // Default-heap pages the static geometry is placed in.
+    std::unique_ptr<GpuHeap> mGpuHeap;
 
 	std::unique_ptr<MeshGeometry> mBoxGeo = nullptr;
 
@@ -75,8 +79,18 @@ private:
     ComPtr<ID3D12PipelineState> mPSO = nullptr;
 
     XMFLOAT4X4 mWorld = MathUtils::Identity4x4();
-    XMFLOAT4X4 mView = MathUtils::Identity4x4();
-    XMFLOAT4X4 mProj = MathUtils::Identity4x4();
+
+    CameraComponent mCamera;
+
+    // Camera generation the object constants were last built for.  The world
+    // matrix and lighting are static, so nothing needs uploading until it changes.
+    std::uint64_t mUploadedCameraGeneration = ~0ull;
+
+    // Per-object constants; the pool writes each changed slot once into every
+    // frame resource's ObjectCB as the frames come around.
+    ObjectConstantPool<ObjectConstants> mObjectPool{
+        MaxObjects, Dx12Utils::CalcConstantBufferByteSize(sizeof(ObjectConstants)), gNumFrameResources };
+    std::uint32_t mBoxObjCBIndex = ObjectConstantPool<ObjectConstants>::InvalidSlot;
 
     float mTheta = 1.5f*XM_PI;
     float mPhi = XM_PIDIV4;
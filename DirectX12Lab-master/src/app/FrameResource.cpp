@@ -0,0 +1,14 @@
+#include "FrameResource.h"
+
+FrameResource::FrameResource(ID3D12Device* device, UINT objectCount)
+{
+    ThrowIfFailed(device->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+
+    ObjectCB = std::make_unique<GpuUploadBuffer<ObjectConstants>>(device, objectCount, true);
+}
+
+FrameResource::~FrameResource()
+{
+}
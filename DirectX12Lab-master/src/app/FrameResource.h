@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../math/MathUtils.h"
+#include "../graphics/GpuUploadBuffer.h"
+
+struct Vertex
+{
+	DirectX::XMFLOAT3 Pos;
+	DirectX::XMFLOAT3 Normal;
+	DirectX::XMFLOAT4 Color; // albedo
+};
+
+struct ObjectConstants
+{
+	DirectX::XMFLOAT4X4 World             = MathUtils::Identity4x4();
+	DirectX::XMFLOAT4X4 WorldInvTranspose = MathUtils::Identity4x4();
+	DirectX::XMFLOAT4X4 WorldViewProj     = MathUtils::Identity4x4();
+
+	DirectX::XMFLOAT3   EyePosW   = {0.0f, 0.0f, 0.0f};
+	float               SpecPower = 32.0f;
+
+	DirectX::XMFLOAT3   LightDirW = {0.577f, -0.577f, 0.577f}; // диагональный directional light
+	float               AmbientK  = 0.15f;
+
+	DirectX::XMFLOAT3   LightColor = {1.0f, 1.0f, 1.0f};
+	float               _pad0      = 0.0f;
+};
+
+// Stores the resources needed for the CPU to build the command lists for a frame.
+// There are gNumFrameResources of these so the CPU can record frame N+1 while the
+// GPU still executes frame N; FrameRing tracks when each one may be reused.
+struct FrameResource
+{
+public:
+    FrameResource(ID3D12Device* device, UINT objectCount);
+    FrameResource(const FrameResource& rhs) = delete;
+    FrameResource& operator=(const FrameResource& rhs) = delete;
+    ~FrameResource();
+
+    // We cannot reset the allocator until the GPU is done processing the commands.
+    // So each frame needs its own allocator.
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+
+    // We cannot update a cbuffer until the GPU is done processing the commands
+    // that reference it.  So each frame needs its own cbuffers.
+    std::unique_ptr<GpuUploadBuffer<ObjectConstants>> ObjectCB = nullptr;
+};
@@ -0,0 +1,201 @@
+#include "Clock.h"
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if CLOCK_HAS_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#endif
+
+//--------------------------------------------------------------------------------------
+// IClock
+//--------------------------------------------------------------------------------------
+void IClock::SleepFor(double seconds)const
+{
+	if(seconds > 0.0)
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+
+void IClock::SpinUntil(std::int64_t tick)const
+{
+	while(Now() < tick)
+	{
+	}
+}
+
+//--------------------------------------------------------------------------------------
+// SteadyClock
+//--------------------------------------------------------------------------------------
+SteadyClock::SteadyClock()
+{
+	using Period = std::chrono::steady_clock::period;
+	mSecondsPerCount = (double)Period::num / (double)Period::den;
+}
+
+std::int64_t SteadyClock::Now()const
+{
+	return (std::int64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+double SteadyClock::SecondsPerCount()const
+{
+	return mSecondsPerCount;
+}
+
+const char* SteadyClock::Name()const
+{
+	return "steady_clock";
+}
+
+//--------------------------------------------------------------------------------------
+// NativeClock
+//--------------------------------------------------------------------------------------
+NativeClock::NativeClock()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER countsPerSec;
+	QueryPerformanceFrequency(&countsPerSec);
+	mSecondsPerCount = 1.0 / (double)countsPerSec.QuadPart;
+#else
+	// Now() returns nanoseconds.
+	mSecondsPerCount = 1e-9;
+#endif
+}
+
+std::int64_t NativeClock::Now()const
+{
+#if defined(_WIN32)
+	LARGE_INTEGER currTime;
+	QueryPerformanceCounter(&currTime);
+	return currTime.QuadPart;
+#elif defined(CLOCK_MONOTONIC_RAW)
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (std::int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (std::int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+double NativeClock::SecondsPerCount()const
+{
+	return mSecondsPerCount;
+}
+
+const char* NativeClock::Name()const
+{
+#if defined(_WIN32)
+	return "QueryPerformanceCounter";
+#else
+	return "CLOCK_MONOTONIC_RAW";
+#endif
+}
+
+//--------------------------------------------------------------------------------------
+// TscClock
+//--------------------------------------------------------------------------------------
+#if CLOCK_HAS_TSC
+TscClock::TscClock(double calibrationSeconds)
+{
+	// Count TSC ticks across a busy-waited interval of the reference clock.  Spinning
+	// instead of sleeping keeps the core out of low power states during the window.
+	const IClock& reference = Clock::Default();
+	const std::int64_t refTicks = (std::int64_t)(calibrationSeconds / reference.SecondsPerCount());
+
+	std::int64_t refStart = reference.Now();
+	std::uint64_t tscStart = __rdtsc();
+
+	std::int64_t refEnd = refStart;
+	while(refEnd - refStart < refTicks)
+		refEnd = reference.Now();
+
+	std::uint64_t tscEnd = __rdtsc();
+
+	double elapsedSeconds = (double)(refEnd - refStart) * reference.SecondsPerCount();
+	mSecondsPerCount = elapsedSeconds / (double)(tscEnd - tscStart);
+}
+
+std::int64_t TscClock::Now()const
+{
+	return (std::int64_t)__rdtsc();
+}
+
+double TscClock::SecondsPerCount()const
+{
+	return mSecondsPerCount;
+}
+
+const char* TscClock::Name()const
+{
+	return "rdtsc";
+}
+
+bool TscClock::IsInvariant()
+{
+	// CPUID.80000007H:EDX[8] = invariant TSC.
+	unsigned int regs[4] = {};
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0x80000000);
+	if((unsigned int)info[0] < 0x80000007u)
+		return false;
+	__cpuid(info, 0x80000007);
+	regs[3] = (unsigned int)info[3];
+#else
+	if(__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+		return false;
+	__get_cpuid(0x80000007u, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+	return (regs[3] & (1u << 8)) != 0;
+}
+#endif
+
+//--------------------------------------------------------------------------------------
+// Clock
+//--------------------------------------------------------------------------------------
+const IClock& Clock::Default()
+{
+	static const NativeClock clock;
+	return clock;
+}
+
+const IClock& Clock::Fastest()
+{
+#if CLOCK_HAS_TSC
+	static const bool invariant = TscClock::IsInvariant();
+	if(!invariant)
+		return Default();
+
+	static const TscClock clock;
+	return clock;
+#else
+	return Default();
+#endif
+}
+
+double Clock::MeasureOverheadNs(const IClock& clock, int sampleCount)
+{
+	// Accumulate the results so the calls cannot be optimized away.
+	volatile std::int64_t sink = 0;
+
+	const IClock& reference = Clock::Default();
+	std::int64_t start = reference.Now();
+	for(int i = 0; i < sampleCount; ++i)
+		sink = sink + clock.Now();
+	std::int64_t end = reference.Now();
+
+	(void)sink;
+	return (double)(end - start) * reference.SecondsPerCount() * 1e9 / (double)sampleCount;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CLOCK_HAS_TSC 1
+#else
+#define CLOCK_HAS_TSC 0
+#endif
+
+// Source of monotonically increasing ticks.  FrameTimer and the other timing
+// code only see this interface, so they run on any platform and can be driven
+// by a fake clock.
+class IClock
+{
+public:
+	virtual ~IClock() = default;
+
+	// Current tick count.  Only differences between two calls are meaningful.
+	virtual std::int64_t Now()const = 0;
+
+	virtual double SecondsPerCount()const = 0;
+
+	virtual const char* Name()const = 0;
+
+	// Blocks the calling thread for roughly the given time.  The OS may oversleep by
+	// up to a scheduler quantum; fake clocks simply advance their tick count.
+	virtual void SleepFor(double seconds)const;
+
+	// Busy-waits until Now() reaches tick, for deadlines closer than a sleep can
+	// hit.  Fake clocks override this like SleepFor and jump to tick.
+	virtual void SpinUntil(std::int64_t tick)const;
+};
+
+// std::chrono::steady_clock.  Portable fallback, available everywhere.
+class SteadyClock : public IClock
+{
+public:
+	SteadyClock();
+
+	std::int64_t Now()const override;
+	double SecondsPerCount()const override;
+	const char* Name()const override;
+
+private:
+	double mSecondsPerCount;
+};
+
+// The platform's native high resolution monotonic counter:
+// QueryPerformanceCounter on Windows, clock_gettime(CLOCK_MONOTONIC_RAW) elsewhere.
+// CLOCK_MONOTONIC_RAW is not slewed by NTP, so intervals match the hardware rate.
+class NativeClock : public IClock
+{
+public:
+	NativeClock();
+
+	std::int64_t Now()const override;
+	double SecondsPerCount()const override;
+	const char* Name()const override;
+
+private:
+	double mSecondsPerCount;
+};
+
+#if CLOCK_HAS_TSC
+// Raw time stamp counter (rdtsc).  Cheapest to read, but the frequency is not
+// reported by the CPU, so it is calibrated against NativeClock on construction.
+// Only trustworthy on CPUs with an invariant TSC; see IsInvariant().
+class TscClock : public IClock
+{
+public:
+	explicit TscClock(double calibrationSeconds = 0.05);
+
+	std::int64_t Now()const override;
+	double SecondsPerCount()const override;
+	const char* Name()const override;
+
+	// True when CPUID reports a constant-rate TSC that keeps ticking in deep
+	// C-states and is synchronized between cores.
+	static bool IsInvariant();
+
+private:
+	double mSecondsPerCount;
+};
+#endif
+
+class Clock
+{
+public:
+	// Process-wide default clock: NativeClock.
+	static const IClock& Default();
+
+	// Returns the TSC clock when the CPU has an invariant TSC, otherwise Default().
+	static const IClock& Fastest();
+
+	// Average cost of one Now() call in nanoseconds, measured over sampleCount calls.
+	static double MeasureOverheadNs(const IClock& clock, int sampleCount = 100000);
+};
@@ -0,0 +1,110 @@
+#include "FramePacer.h"
+#include <cmath>
+
+FramePacer::FramePacer(const IClock& clock)
+: mClock(clock)
+{
+}
+
+void FramePacer::SetTargetFrameRate(double framesPerSecond)
+{
+	mTargetFrameRate = framesPerSecond > 0.0 ? framesPerSecond : 0.0;
+	mScheduled = false;
+}
+
+double FramePacer::GetTargetFrameRate()const
+{
+	return mTargetFrameRate;
+}
+
+void FramePacer::SetSpinThreshold(double seconds)
+{
+	mSpinThreshold = seconds > 0.0 ? seconds : 0.0;
+}
+
+void FramePacer::SetFixedTimestep(double seconds)
+{
+	if(seconds > 0.0)
+		mFixedTimestep = seconds;
+}
+
+double FramePacer::GetFixedTimestep()const
+{
+	return mFixedTimestep;
+}
+
+void FramePacer::SetMaxCatchUpSteps(int steps)
+{
+	mMaxCatchUpSteps = steps > 1 ? steps : 1;
+}
+
+void FramePacer::Reset()
+{
+	mScheduled = false;
+	mAccumulator = 0.0;
+	mDroppedSteps = 0;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	if(mTargetFrameRate <= 0.0)
+		return;
+
+	const double secondsPerCount = mClock.SecondsPerCount();
+	const std::int64_t period = (std::int64_t)std::llround(1.0 / (mTargetFrameRate * secondsPerCount));
+	const std::int64_t spin = (std::int64_t)std::llround(mSpinThreshold / secondsPerCount);
+
+	std::int64_t now = mClock.Now();
+
+	if(!mScheduled)
+	{
+		// First frame after Reset(): run immediately and schedule from here.
+		mNextFrameTime = now + period;
+		mScheduled = true;
+		return;
+	}
+
+	// Sleep through most of the remaining time, then spin to hit the deadline.
+	std::int64_t remaining = mNextFrameTime - now;
+	if(remaining > spin)
+		mClock.SleepFor((double)(remaining - spin) * secondsPerCount);
+
+	mClock.SpinUntil(mNextFrameTime);
+	now = mClock.Now();
+
+	// Frames are scheduled on a fixed grid so small oversleeps do not accumulate
+	// into drift.  If we fell more than a whole period behind, resynchronize
+	// instead of rushing out a burst of frames.
+	mNextFrameTime += period;
+	if(now - mNextFrameTime > period)
+		mNextFrameTime = now + period;
+}
+
+int FramePacer::AdvanceSimulation(double frameSeconds)
+{
+	if(frameSeconds > 0.0)
+		mAccumulator += frameSeconds;
+
+	int steps = (int)std::floor(mAccumulator / mFixedTimestep);
+	if(steps > mMaxCatchUpSteps)
+	{
+		// Drop the backlog beyond the limit rather than carrying it forward, which
+		// would only make the next frame slower still.
+		mDroppedSteps += (std::uint64_t)(steps - mMaxCatchUpSteps);
+		mAccumulator -= (double)(steps - mMaxCatchUpSteps) * mFixedTimestep;
+		steps = mMaxCatchUpSteps;
+	}
+
+	mAccumulator -= (double)steps * mFixedTimestep;
+	return steps;
+}
+
+double FramePacer::GetInterpolationAlpha()const
+{
+	return mAccumulator > 0.0 ? mAccumulator / mFixedTimestep : 0.0;
+}
+
+std::uint64_t FramePacer::GetDroppedStepCount()const
+{
+	return mDroppedSteps;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Clock.h"
+
+// Frame rate limiter and fixed-timestep accumulator.
+//
+// WaitForNextFrame() holds the caller until the next frame slot of the target
+// rate.  Most of the wait is spent in IClock::SleepFor(); the last SpinThreshold
+// seconds go to IClock::SpinUntil() because OS sleeps overshoot by up to a
+// scheduler tick.
+//
+// AdvanceSimulation() turns variable frame times into a whole number of fixed
+// simulation steps.  The remainder carries over to the next frame and is exposed
+// as GetInterpolationAlpha() for blending between the last two simulation states.
+// After a long stall at most MaxCatchUpSteps are run and the rest of the backlog
+// is dropped, so a slow frame can not snowball into ever slower frames.
+//
+// Every wait goes through the IClock passed in, so tests can drive it with a fake.
+class FramePacer
+{
+public:
+	explicit FramePacer(const IClock& clock);
+
+	// 0 disables the limiter.
+	void SetTargetFrameRate(double framesPerSecond);
+	double GetTargetFrameRate()const;
+
+	void SetSpinThreshold(double seconds);
+
+	void SetFixedTimestep(double seconds);
+	double GetFixedTimestep()const;
+	void SetMaxCatchUpSteps(int steps);
+
+	// Restarts frame scheduling from now and clears the accumulator.  Call after a
+	// pause so the pacer does not try to make up for the paused time.
+	void Reset();
+
+	void WaitForNextFrame();
+
+	// Adds frameSeconds to the accumulator and returns how many fixed steps to run.
+	int AdvanceSimulation(double frameSeconds);
+
+	// Fraction of a fixed step left in the accumulator, in [0, 1).
+	double GetInterpolationAlpha()const;
+
+	// Steps dropped because of the catch-up limit since Reset().
+	std::uint64_t GetDroppedStepCount()const;
+
+private:
+	const IClock& mClock;
+
+	double mTargetFrameRate = 0.0;
+	double mSpinThreshold = 0.002;
+
+	std::int64_t mNextFrameTime = 0;
+	bool mScheduled = false;
+
+	double mFixedTimestep = 1.0 / 60.0;
+	int mMaxCatchUpSteps = 5;
+	double mAccumulator = 0.0;
+	std::uint64_t mDroppedSteps = 0;
+};
@@ -0,0 +1,172 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+FrameStats::FrameStats(std::uint32_t capacity)
+: mCapacity(capacity > 0 ? capacity : 1), mSamplesMs(new std::atomic<float>[mCapacity])
+{
+	Reset();
+}
+
+void FrameStats::SetHitchThresholdMs(double thresholdMs)
+{
+	mHitchThresholdMs.store(thresholdMs, std::memory_order_relaxed);
+}
+
+double FrameStats::GetHitchThresholdMs()const
+{
+	return mHitchThresholdMs.load(std::memory_order_relaxed);
+}
+
+void FrameStats::Reset()
+{
+	for(std::uint32_t i = 0; i < mCapacity; ++i)
+		mSamplesMs[i].store(0.0f, std::memory_order_relaxed);
+
+	mHitchCount.store(0, std::memory_order_relaxed);
+	mFrameCount.store(0, std::memory_order_release);
+}
+
+bool FrameStats::Record(double frameSeconds)
+{
+	const double ms = frameSeconds * 1000.0;
+
+	// Single writer: a plain load/store pair is enough, the release publishes the sample.
+	const std::uint64_t frame = mFrameCount.load(std::memory_order_relaxed);
+	mSamplesMs[frame % mCapacity].store((float)ms, std::memory_order_relaxed);
+	mFrameCount.store(frame + 1, std::memory_order_release);
+
+	const double threshold = mHitchThresholdMs.load(std::memory_order_relaxed);
+	if(threshold > 0.0 && ms > threshold)
+	{
+		mHitchCount.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+std::uint32_t FrameStats::GetCapacity()const
+{
+	return mCapacity;
+}
+
+std::uint64_t FrameStats::GetFrameCount()const
+{
+	return mFrameCount.load(std::memory_order_acquire);
+}
+
+std::uint64_t FrameStats::GetHitchCount()const
+{
+	return mHitchCount.load(std::memory_order_relaxed);
+}
+
+void FrameStats::CopySamples(std::vector<float>& outMs)const
+{
+	const std::uint64_t frameCount = mFrameCount.load(std::memory_order_acquire);
+	const std::uint32_t count = (std::uint32_t)std::min<std::uint64_t>(frameCount, mCapacity);
+	const std::uint64_t first = frameCount - count;
+
+	outMs.resize(count);
+	for(std::uint32_t i = 0; i < count; ++i)
+		outMs[i] = mSamplesMs[(first + i) % mCapacity].load(std::memory_order_relaxed);
+}
+
+double FrameStats::BucketLowerMs(int bucket)
+{
+	return 0.25 * std::pow(2.0, bucket / 4.0);
+}
+
+int FrameStats::BucketForMs(double ms)
+{
+	if(ms <= 0.25)
+		return 0;
+
+	int bucket = (int)std::floor(4.0 * std::log2(ms / 0.25));
+	return std::min(bucket, HistogramBucketCount - 1);
+}
+
+FrameStats::Summary FrameStats::ComputeSummary()const
+{
+	Summary s;
+	s.FrameCount = GetFrameCount();
+	s.HitchCount = GetHitchCount();
+
+	std::vector<float> samples;
+	CopySamples(samples);
+	s.SampleCount = (std::uint32_t)samples.size();
+	if(samples.empty())
+		return s;
+
+	double sum = 0.0;
+	for(float ms : samples)
+	{
+		sum += ms;
+		++s.Histogram[BucketForMs(ms)];
+	}
+	s.MeanMs = sum / (double)samples.size();
+
+	// Nearest-rank percentiles on a sorted copy.
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](double p)
+	{
+		std::size_t rank = (std::size_t)std::ceil(p * (double)samples.size());
+		return (double)samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+	};
+
+	s.MinMs = samples.front();
+	s.P50Ms = percentile(0.50);
+	s.P95Ms = percentile(0.95);
+	s.P99Ms = percentile(0.99);
+	s.MaxMs = samples.back();
+
+	return s;
+}
+
+void FrameStats::WriteCsv(std::ostream& out)const
+{
+	std::vector<float> samples;
+	CopySamples(samples);
+
+	const double threshold = GetHitchThresholdMs();
+	const std::uint64_t firstFrame = GetFrameCount() - samples.size();
+
+	out << "frame,ms,hitch\n";
+	for(std::size_t i = 0; i < samples.size(); ++i)
+	{
+		bool hitch = threshold > 0.0 && samples[i] > threshold;
+		out << (firstFrame + i) << ',' << samples[i] << ',' << (hitch ? 1 : 0) << '\n';
+	}
+}
+
+void FrameStats::WriteJson(std::ostream& out)const
+{
+	Summary s = ComputeSummary();
+
+	std::vector<float> samples;
+	CopySamples(samples);
+
+	out << "{\n";
+	out << "  \"frameCount\": " << s.FrameCount << ",\n";
+	out << "  \"hitchCount\": " << s.HitchCount << ",\n";
+	out << "  \"hitchThresholdMs\": " << GetHitchThresholdMs() << ",\n";
+	out << "  \"meanMs\": " << s.MeanMs << ",\n";
+	out << "  \"minMs\": " << s.MinMs << ",\n";
+	out << "  \"p50Ms\": " << s.P50Ms << ",\n";
+	out << "  \"p95Ms\": " << s.P95Ms << ",\n";
+	out << "  \"p99Ms\": " << s.P99Ms << ",\n";
+	out << "  \"maxMs\": " << s.MaxMs << ",\n";
+
+	out << "  \"histogram\": [";
+	for(int i = 0; i < HistogramBucketCount; ++i)
+	{
+		out << (i ? ", " : "") << "{\"lowerMs\": " << BucketLowerMs(i) << ", \"count\": " << s.Histogram[i] << "}";
+	}
+	out << "],\n";
+
+	out << "  \"samplesMs\": [";
+	for(std::size_t i = 0; i < samples.size(); ++i)
+		out << (i ? ", " : "") << samples[i];
+	out << "]\n";
+	out << "}\n";
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Rolling frame time statistics.
+//
+// Frame times go into a fixed-size ring.  One thread (the one ticking the timer)
+// records, any other thread may take a snapshot at the same time: the ring and the
+// counters are atomics, so neither side ever takes a lock.  A snapshot racing with
+// the writer can see a sample from the next lap in place of the oldest one, which
+// is harmless for statistics.
+class FrameStats
+{
+public:
+	static const int HistogramBucketCount = 32;
+
+	struct Summary
+	{
+		std::uint64_t FrameCount = 0;  // frames recorded since Reset()
+		std::uint64_t HitchCount = 0;  // frames above the hitch threshold since Reset()
+		std::uint32_t SampleCount = 0; // frames in the window below
+
+		// Over the window, in milliseconds.
+		double MeanMs = 0.0;
+		double MinMs = 0.0;
+		double P50Ms = 0.0;
+		double P95Ms = 0.0;
+		double P99Ms = 0.0;
+		double MaxMs = 0.0;
+
+		// Log-scale histogram: bucket i counts frames in [BucketLowerMs(i), BucketLowerMs(i+1)).
+		std::uint32_t Histogram[HistogramBucketCount] = {};
+	};
+
+	explicit FrameStats(std::uint32_t capacity = 1024);
+	FrameStats(const FrameStats& rhs) = delete;
+	FrameStats& operator=(const FrameStats& rhs) = delete;
+
+	// Frames longer than this count as hitches.  0 disables detection.
+	void SetHitchThresholdMs(double thresholdMs);
+	double GetHitchThresholdMs()const;
+
+	// Must not run concurrently with Record().
+	void Reset();
+
+	// Returns true when the frame was a hitch.
+	bool Record(double frameSeconds);
+
+	std::uint32_t GetCapacity()const;
+	std::uint64_t GetFrameCount()const;
+	std::uint64_t GetHitchCount()const;
+
+	// Copies the recorded window, oldest first, in milliseconds.
+	void CopySamples(std::vector<float>& outMs)const;
+
+	Summary ComputeSummary()const;
+
+	// CSV holds one row per frame in the window; JSON holds the summary, the
+	// histogram and the samples in one object.
+	void WriteCsv(std::ostream& out)const;
+	void WriteJson(std::ostream& out)const;
+
+	// Histogram buckets are quarter octaves starting at 0.25 ms; the last bucket
+	// also holds everything longer.
+	static double BucketLowerMs(int bucket);
+	static int BucketForMs(double ms);
+
+private:
+	std::uint32_t mCapacity;
+	std::unique_ptr<std::atomic<float>[]> mSamplesMs;
+
+	std::atomic<std::uint64_t> mFrameCount{ 0 };
+	std::atomic<std::uint64_t> mHitchCount{ 0 };
+	std::atomic<double> mHitchThresholdMs{ 0.0 };
+};
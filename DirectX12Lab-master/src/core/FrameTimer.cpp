@@ -1,14 +1,16 @@
 
-#include <windows.h>
 #include "FrameTimer.h"
 
-FrameTimer::FrameTimer()
-: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
-  mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+FrameTimer::FrameTimer(const IClock* clock)
+: mClock(clock ? clock : &Clock::Default()), mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0),
+  mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+	mSecondsPerCount = mClock->SecondsPerCount();
+}
+
+const IClock& FrameTimer::GetClock()const
+{
+	return *mClock;
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -50,10 +52,19 @@ float FrameTimer::DeltaTime()const
 	return (float)mDeltaTime;
 }
 
+FrameStats& FrameTimer::Stats()
+{
+	return mStats;
+}
+
+const FrameStats& FrameTimer::Stats()const
+{
+	return mStats;
+}
+
 void FrameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = mClock->Now();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
@@ -63,8 +74,7 @@ void FrameTimer::Reset()
 
 void FrameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	std::int64_t startTime = mClock->Now();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -87,8 +97,7 @@ void FrameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+		std::int64_t currTime = mClock->Now();
 
 		mStopTime = currTime;
 		mStopped  = true;
@@ -103,8 +112,7 @@ void FrameTimer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = mClock->Now();
 	mCurrTime = currTime;
 
 	// Time difference between this frame and the previous.
@@ -120,5 +128,7 @@ void FrameTimer::Tick()
 	{
 		mDeltaTime = 0.0;
 	}
+
+	mStats.Record(mDeltaTime);
 }
 
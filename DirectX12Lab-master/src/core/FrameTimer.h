@@ -2,30 +2,45 @@
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <cstdint>
+#include "Clock.h"
+#include "FrameStats.h"
+
 class FrameTimer
 {
 public:
-	FrameTimer();
+	// Uses Clock::Default() when no clock is given.  The clock must outlive the timer.
+	explicit FrameTimer(const IClock* clock = nullptr);
+
+	const IClock& GetClock()const;
 
 	float TotalTime()const; // in seconds
 	float DeltaTime()const; // in seconds
 
+	// Every non-paused Tick() is recorded here.
+	FrameStats& Stats();
+	const FrameStats& Stats()const;
+
 	void Reset(); // Call before message loop.
 	void Start(); // Call when unpaused.
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
 private:
+	const IClock* mClock;
+
 	double mSecondsPerCount;
 	double mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	std::int64_t mBaseTime;
+	std::int64_t mPausedTime;
+	std::int64_t mStopTime;
+	std::int64_t mPrevTime;
+	std::int64_t mCurrTime;
 
 	bool mStopped;
+
+	FrameStats mStats;
 };
 
 #endif // GAMETIMER_H
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <string>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+	if(this != &rhs)
+	{
+		Close();
+
+		std::swap(mData, rhs.mData);
+		std::swap(mSize, rhs.mSize);
+		std::swap(mError, rhs.mError);
+#if defined(_WIN32)
+		std::swap(mFile, rhs.mFile);
+		std::swap(mMapping, rhs.mMapping);
+#else
+		std::swap(mFd, rhs.mFd);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const wchar_t* fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		mError = (int)GetLastError();
+		return false;
+	}
+
+	mFile = file;
+	return MapOpenedFile();
+}
+
+bool MappedFile::Open(const char* fileName)
+{
+	int length = MultiByteToWideChar(CP_UTF8, 0, fileName, -1, nullptr, 0);
+	if(length <= 0)
+	{
+		mError = (int)GetLastError();
+		return false;
+	}
+
+	std::wstring wideName(length, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, fileName, -1, &wideName[0], length);
+	return Open(wideName.c_str());
+}
+
+bool MappedFile::MapOpenedFile()
+{
+	LARGE_INTEGER fileSize = {};
+	if(!GetFileSizeEx((HANDLE)mFile, &fileSize))
+	{
+		mError = (int)GetLastError();
+		Close();
+		return false;
+	}
+
+	// Zero-length files can not be mapped.
+	if(fileSize.QuadPart == 0 || (std::uint64_t)fileSize.QuadPart > (std::uint64_t)SIZE_MAX)
+	{
+		mError = fileSize.QuadPart == 0 ? ERROR_HANDLE_EOF : ERROR_FILE_TOO_LARGE;
+		Close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingW((HANDLE)mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mMapping)
+	{
+		mError = (int)GetLastError();
+		Close();
+		return false;
+	}
+
+	mData = (const std::uint8_t*)MapViewOfFile((HANDLE)mMapping, FILE_MAP_READ, 0, 0, 0);
+	if(!mData)
+	{
+		mError = (int)GetLastError();
+		Close();
+		return false;
+	}
+
+	mSize = (std::uint64_t)fileSize.QuadPart;
+	mError = 0;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(mData)
+		UnmapViewOfFile(mData);
+	if(mMapping)
+		CloseHandle((HANDLE)mMapping);
+	if(mFile)
+		CloseHandle((HANDLE)mFile);
+
+	mData = nullptr;
+	mMapping = nullptr;
+	mFile = nullptr;
+	mSize = 0;
+}
+
+void MappedFile::Prefetch(std::uint64_t offset, std::uint64_t size)const
+{
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+	if(!mData || offset >= mSize)
+		return;
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = (PVOID)(mData + offset);
+	range.NumberOfBytes = (SIZE_T)(size < mSize - offset ? size : mSize - offset);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	(void)offset;
+	(void)size;
+#endif
+}
+
+#else
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	mFd = open(fileName, O_RDONLY | O_CLOEXEC);
+	if(mFd < 0)
+	{
+		mError = errno;
+		return false;
+	}
+
+	return MapOpenedFile();
+}
+
+bool MappedFile::MapOpenedFile()
+{
+	struct stat info;
+	if(fstat(mFd, &info) != 0)
+	{
+		mError = errno;
+		Close();
+		return false;
+	}
+
+	if(info.st_size <= 0 || (std::uint64_t)info.st_size > (std::uint64_t)SIZE_MAX)
+	{
+		mError = info.st_size <= 0 ? EINVAL : EFBIG;
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, mFd, 0);
+	if(data == MAP_FAILED)
+	{
+		mError = errno;
+		Close();
+		return false;
+	}
+
+	madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+	mData = (const std::uint8_t*)data;
+	mSize = (std::uint64_t)info.st_size;
+	mError = 0;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(mData)
+		munmap((void*)mData, (size_t)mSize);
+	if(mFd >= 0)
+		close(mFd);
+
+	mData = nullptr;
+	mFd = -1;
+	mSize = 0;
+}
+
+void MappedFile::Prefetch(std::uint64_t offset, std::uint64_t size)const
+{
+	if(!mData || offset >= mSize)
+		return;
+
+	// madvise wants a page-aligned start.
+	const std::uint64_t pageSize = (std::uint64_t)sysconf(_SC_PAGESIZE);
+	const std::uint64_t start = offset & ~(pageSize - 1);
+	const std::uint64_t end = (size < mSize - offset) ? offset + size : mSize;
+	madvise((void*)(mData + start), (size_t)(end - start), MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file.
+//
+// The pages are faulted in from the OS file cache on first touch, so readers can
+// copy straight out of the mapping instead of reading the file into a heap buffer
+// first.  Sizes are 64-bit; on a 32-bit build files that do not fit the address
+// space fail to open.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+	MappedFile(MappedFile&& rhs) noexcept;
+	MappedFile& operator=(MappedFile&& rhs) noexcept;
+	~MappedFile();
+
+	// On failure returns false and GetError() holds the GetLastError()/errno value.
+#if defined(_WIN32)
+	bool Open(const wchar_t* fileName);
+#endif
+	bool Open(const char* fileName); // UTF-8
+
+	void Close();
+
+	bool IsOpen()const { return mData != nullptr; }
+	const std::uint8_t* Data()const { return mData; }
+	std::uint64_t Size()const { return mSize; }
+	int GetError()const { return mError; }
+
+	// Hints the OS to start reading [offset, offset + size) in the background.
+	void Prefetch(std::uint64_t offset, std::uint64_t size)const;
+
+private:
+	bool MapOpenedFile();
+
+private:
+	const std::uint8_t* mData = nullptr;
+	std::uint64_t mSize = 0;
+	int mError = 0;
+
+#if defined(_WIN32)
+	void* mFile = nullptr;      // HANDLE
+	void* mMapping = nullptr;   // HANDLE
+#else
+	int mFd = -1;
+#endif
+};
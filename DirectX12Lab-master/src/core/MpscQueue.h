@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+
+// Node of an MpscQueue; derive the queued type from it.
+struct MpscNode
+{
+	std::atomic<MpscNode*> Next{ nullptr };
+};
+
+// Unbounded lock-free queue for many producer threads and one consumer thread
+// (D. Vyukov's intrusive MPSC queue).
+//
+// Push() is a single atomic exchange, so workers never block each other or the
+// consumer.  Nodes are owned by the caller while queued; the queue allocates
+// nothing.  Pop() can briefly return nullptr while a Push() is half done even
+// though the queue is not empty; the element shows up on the next call.
+template<typename T>
+class MpscQueue
+{
+public:
+	MpscQueue()
+	: mHead(&mStub), mTail(&mStub)
+	{
+	}
+
+	MpscQueue(const MpscQueue& rhs) = delete;
+	MpscQueue& operator=(const MpscQueue& rhs) = delete;
+
+	// Any thread.
+	void Push(T* item)
+	{
+		PushNode(static_cast<MpscNode*>(item));
+	}
+
+	// Consumer thread only.
+	T* Pop()
+	{
+		MpscNode* tail = mTail;
+		MpscNode* next = tail->Next.load(std::memory_order_acquire);
+
+		// Skip the stub when it is at the front.
+		if(tail == &mStub)
+		{
+			if(next == nullptr)
+				return nullptr;
+
+			mTail = next;
+			tail = next;
+			next = next->Next.load(std::memory_order_acquire);
+		}
+
+		if(next != nullptr)
+		{
+			mTail = next;
+			return static_cast<T*>(tail);
+		}
+
+		// tail is the last linked node.  If a producer has already swapped the head
+		// but not linked its node yet, wait for it to finish.
+		if(tail != mHead.load(std::memory_order_acquire))
+			return nullptr;
+
+		// Re-insert the stub behind tail so tail can be handed out.
+		PushNode(&mStub);
+
+		next = tail->Next.load(std::memory_order_acquire);
+		if(next != nullptr)
+		{
+			mTail = next;
+			return static_cast<T*>(tail);
+		}
+
+		return nullptr;
+	}
+
+private:
+	void PushNode(MpscNode* node)
+	{
+		node->Next.store(nullptr, std::memory_order_relaxed);
+		MpscNode* prev = mHead.exchange(node, std::memory_order_acq_rel);
+		prev->Next.store(node, std::memory_order_release);
+	}
+
+private:
+	std::atomic<MpscNode*> mHead; // producers
+	MpscNode* mTail;              // consumer
+	MpscNode mStub;
+};
@@ -0,0 +1,152 @@
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct ParallelJob
+	{
+		ParallelForCallback Callback = nullptr;
+		const void* Context = nullptr;
+		size_t Count = 0;
+		std::atomic<size_t> Next{ 0 };
+
+		// Guarded by the pool mutex.
+		unsigned HelpersWanted = 0; // workers that may still join
+		unsigned HelpersActive = 0; // workers running items
+	};
+
+	void RunItems(ParallelJob& job)
+	{
+		for(size_t i = job.Next.fetch_add(1); i < job.Count; i = job.Next.fetch_add(1))
+			job.Callback(job.Context, i);
+	}
+
+	// hardware_concurrency() - 1 threads sleeping on a queue of jobs.  A job stays
+	// queued until enough workers picked it up or its caller ran out of items.
+	class WorkerPool
+	{
+	public:
+		WorkerPool()
+		{
+			const unsigned workerCount = GetHardwareThreadCount() - 1;
+			mThreads.reserve(workerCount);
+			for(unsigned i = 0; i < workerCount; ++i)
+				mThreads.emplace_back(&WorkerPool::WorkerMain, this);
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStop = true;
+			}
+			mWake.notify_all();
+
+			for(auto& t : mThreads)
+				t.join();
+		}
+
+		unsigned GetWorkerCount()const
+		{
+			return (unsigned)mThreads.size();
+		}
+
+		void Run(ParallelJob& job, unsigned helperCount)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				job.HelpersWanted = helperCount;
+				mJobs.push_back(&job);
+			}
+			if(helperCount == 1)
+				mWake.notify_one();
+			else
+				mWake.notify_all();
+
+			RunItems(job);
+
+			// Every item is taken.  Make sure no more workers join, then wait for the
+			// ones running the last items; job lives on the caller's stack.
+			std::unique_lock<std::mutex> lock(mMutex);
+			if(job.HelpersWanted > 0)
+				mJobs.erase(std::find(mJobs.begin(), mJobs.end(), &job));
+			mDone.wait(lock, [&job] { return job.HelpersActive == 0; });
+		}
+
+	private:
+		void WorkerMain()
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			for(;;)
+			{
+				mWake.wait(lock, [this] { return mStop || !mJobs.empty(); });
+				if(mStop)
+					return;
+
+				ParallelJob* job = mJobs.front();
+				if(--job->HelpersWanted == 0)
+					mJobs.pop_front();
+				++job->HelpersActive;
+
+				lock.unlock();
+				RunItems(*job);
+				lock.lock();
+
+				if(--job->HelpersActive == 0)
+					mDone.notify_all();
+			}
+		}
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+		std::deque<ParallelJob*> mJobs;
+		std::vector<std::thread> mThreads;
+		bool mStop = false;
+	};
+
+	WorkerPool& GetPool()
+	{
+		static WorkerPool pool;
+		return pool;
+	}
+}
+
+void ParallelFor(size_t count, unsigned threadCount, ParallelForCallback callback, const void* context)
+{
+	if(threadCount == 0)
+		threadCount = GetHardwareThreadCount();
+
+	if(count <= 1 || threadCount <= 1)
+	{
+		for(size_t i = 0; i < count; ++i)
+			callback(context, i);
+		return;
+	}
+
+	WorkerPool& pool = GetPool();
+	const unsigned helperCount = (unsigned)std::min<size_t>({ (size_t)threadCount - 1, count - 1, (size_t)pool.GetWorkerCount() });
+	if(helperCount == 0)
+	{
+		for(size_t i = 0; i < count; ++i)
+			callback(context, i);
+		return;
+	}
+
+	ParallelJob job;
+	job.Callback = callback;
+	job.Context = context;
+	job.Count = count;
+	pool.Run(job, helperCount);
+}
+
+unsigned GetHardwareThreadCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Runs function(i) for every i in [0, count) on up to threadCount threads: the
+// caller plus the workers of one process-wide pool, created on first use and
+// kept until exit, so per-frame and per-surface callers never create threads.
+// Items are handed out one at a time, so uneven items balance themselves; make
+// each item a band of work rather than a single pixel.
+//
+// threadCount 0 means every hardware thread.  threadCount 1, or count 1, runs
+// everything on the caller.  Calls may nest and may come from several threads
+// at once: the caller always works on its own items, so it never waits for a
+// worker that is busy elsewhere.
+typedef void (*ParallelForCallback)(const void* context, size_t index);
+
+void ParallelFor(size_t count, unsigned threadCount, ParallelForCallback callback, const void* context);
+
+template<typename Function>
+void ParallelFor(size_t count, unsigned threadCount, const Function& function)
+{
+	ParallelFor(count, threadCount,
+		[](const void* context, size_t index) { (*static_cast<const Function*>(context))(index); },
+		&function);
+}
+
+// std::thread::hardware_concurrency(), at least 1.
+unsigned GetHardwareThreadCount();
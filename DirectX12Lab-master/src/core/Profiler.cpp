@@ -0,0 +1,313 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <string>
+
+#if CLOCK_HAS_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace
+{
+void WriteJsonString(std::ostream& out, const char* s)
+{
+	out << '"';
+	for(; *s; ++s)
+	{
+		if(*s == '"' || *s == '\\')
+			out << '\\';
+		out << *s;
+	}
+	out << '"';
+}
+}
+
+thread_local Profiler::ThreadBuffer* Profiler::sLocalBuffer = nullptr;
+
+Profiler::Profiler()
+: mClock(Clock::Fastest())
+{
+#if CLOCK_HAS_TSC
+	// Zones read the counter inline rather than through the virtual call.
+	mUseTsc = dynamic_cast<const TscClock*>(&mClock) != nullptr;
+#endif
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+const IClock& Profiler::GetClock()const
+{
+	return mClock;
+}
+
+std::int64_t Profiler::Now()
+{
+	return Now(LocalBuffer());
+}
+
+std::int64_t Profiler::Now(const ThreadBuffer& buffer)
+{
+#if CLOCK_HAS_TSC
+	if(buffer.UseTsc)
+		return (std::int64_t)__rdtsc();
+#endif
+	return buffer.Clock->Now();
+}
+
+Profiler::ThreadBuffer& Profiler::LocalBuffer()
+{
+	if(sLocalBuffer == nullptr)
+		sLocalBuffer = Get().RegisterThread();
+
+	return *sLocalBuffer;
+}
+
+Profiler::ThreadBuffer* Profiler::RegisterThread()
+{
+	std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+	// Buffers live as long as the process so a thread that exits mid-frame still
+	// has its last events drained.
+	mOwnedBuffers.push_back(std::make_unique<ThreadBuffer>());
+	ThreadBuffer* buffer = mOwnedBuffers.back().get();
+	buffer->Clock = &mClock;
+	buffer->UseTsc = mUseTsc;
+	buffer->ThreadIndex = (std::uint32_t)mThreads.size();
+
+	mThreads.push_back(buffer);
+
+	return buffer;
+}
+
+Profiler::ThreadBuffer& Profiler::BeginZone()
+{
+	ThreadBuffer& buffer = LocalBuffer();
+	++buffer.Depth;
+	return buffer;
+}
+
+void Profiler::EndZone(ThreadBuffer& buffer, const char* name, std::int64_t start)
+{
+	std::int64_t end = Now(buffer);
+
+	--buffer.Depth;
+
+	const std::uint64_t n = buffer.WriteCount.load(std::memory_order_relaxed);
+	Event& e = buffer.Events[n % ThreadBufferCapacity];
+	e.Name = name;
+	e.Start = start;
+	e.End = end;
+	e.ThreadIndex = buffer.ThreadIndex;
+	e.Depth = buffer.Depth;
+
+	buffer.WriteCount.store(n + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+	mLastFrameZones.clear();
+	mZoneLookup.clear();
+
+	std::vector<ThreadBuffer*> threads;
+	{
+		std::lock_guard<std::mutex> lock(mThreadsMutex);
+		threads = mThreads;
+	}
+
+	for(ThreadBuffer* buffer : threads)
+	{
+		DrainThread(*buffer);
+
+		AggregateThread(mFrameEvents.data(), mFrameEvents.size());
+
+		if(mCapturing)
+		{
+			const std::size_t room = mMaxCapturedEvents - std::min(mMaxCapturedEvents, mCapturedEvents.size());
+			const std::size_t kept = std::min(room, mFrameEvents.size());
+			mCapturedEvents.insert(mCapturedEvents.end(), mFrameEvents.begin(), mFrameEvents.begin() + kept);
+			mCaptureDroppedEvents += mFrameEvents.size() - kept;
+		}
+	}
+
+	++mFrameIndex;
+}
+
+void Profiler::DrainThread(ThreadBuffer& buffer)
+{
+	mFrameEvents.clear();
+
+	// Anything more than a buffer behind has been overwritten already.
+	const std::uint64_t written = buffer.WriteCount.load(std::memory_order_acquire);
+	const std::uint64_t first = std::max(buffer.ReadCount,
+		written > ThreadBufferCapacity ? written - ThreadBufferCapacity : 0);
+
+	for(std::uint64_t i = first; i < written; ++i)
+		mFrameEvents.push_back(buffer.Events[i % ThreadBufferCapacity]);
+
+	// The owner keeps writing while we copy.  Once it has published event n it may
+	// be filling slot n + 1, which held event n + 1 - capacity, so every event
+	// older than that could have been torn mid-copy.  Seqlock style: the fence
+	// orders the copy before the second read of the count.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const std::uint64_t after = buffer.WriteCount.load(std::memory_order_relaxed);
+	const std::uint64_t firstIntact = after + 1 > ThreadBufferCapacity ? after + 1 - ThreadBufferCapacity : 0;
+	if(firstIntact > first)
+	{
+		const std::size_t torn = (std::size_t)std::min<std::uint64_t>(firstIntact - first, mFrameEvents.size());
+		mFrameEvents.erase(mFrameEvents.begin(), mFrameEvents.begin() + torn);
+	}
+
+	mDroppedEvents += (written - buffer.ReadCount) - mFrameEvents.size();
+	buffer.ReadCount = written;
+}
+
+void Profiler::AggregateThread(const Event* events, std::size_t count)
+{
+	const double msPerCount = mClock.SecondsPerCount() * 1000.0;
+
+	// Zones are written when they close, so children always precede their parent.
+	// mChildMs[d] accumulates the time of closed zones at depth d until their
+	// parent at depth d-1 closes and claims it.
+	std::fill(mChildMs.begin(), mChildMs.end(), 0.0);
+
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		const Event& e = events[i];
+		if(mChildMs.size() < e.Depth + 2)
+			mChildMs.resize(e.Depth + 2, 0.0);
+
+		const double totalMs = (double)(e.End - e.Start) * msPerCount;
+		const double selfMs = totalMs - mChildMs[e.Depth + 1];
+		mChildMs[e.Depth + 1] = 0.0;
+		mChildMs[e.Depth] += totalMs;
+
+		const ZoneKey key = { e.Name, e.ThreadIndex, e.Depth };
+		auto it = mZoneLookup.find(key);
+		if(it == mZoneLookup.end())
+		{
+			mZoneLookup.emplace(key, mLastFrameZones.size());
+			mLastFrameZones.push_back(ZoneStats{ e.Name, e.ThreadIndex, e.Depth, 1, totalMs, selfMs });
+		}
+		else
+		{
+			ZoneStats& z = mLastFrameZones[it->second];
+			++z.Calls;
+			z.TotalMs += totalMs;
+			z.SelfMs += selfMs;
+		}
+	}
+}
+
+const std::vector<Profiler::ZoneStats>& Profiler::GetLastFrameZones()const
+{
+	return mLastFrameZones;
+}
+
+std::uint64_t Profiler::GetFrameIndex()const
+{
+	return mFrameIndex;
+}
+
+std::uint64_t Profiler::GetDroppedEventCount()const
+{
+	return mDroppedEvents;
+}
+
+void Profiler::BeginCapture(std::size_t maxEvents)
+{
+	mCapturedEvents.clear();
+	mMaxCapturedEvents = maxEvents;
+	mCaptureDroppedEvents = 0;
+	mCapturing = true;
+}
+
+void Profiler::EndCapture()
+{
+	mCapturing = false;
+}
+
+bool Profiler::IsCapturing()const
+{
+	return mCapturing;
+}
+
+const std::vector<Profiler::Event>& Profiler::GetCapturedEvents()const
+{
+	return mCapturedEvents;
+}
+
+std::uint64_t Profiler::GetCaptureDroppedEventCount()const
+{
+	return mCaptureDroppedEvents;
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out)const
+{
+	const double usPerCount = mClock.SecondsPerCount() * 1e6;
+
+	std::int64_t origin = 0;
+	if(!mCapturedEvents.empty())
+	{
+		origin = std::min_element(mCapturedEvents.begin(), mCapturedEvents.end(),
+			[](const Event& a, const Event& b) { return a.Start < b.Start; })->Start;
+	}
+
+	out << "{\"traceEvents\":[\n";
+	for(std::size_t i = 0; i < mCapturedEvents.size(); ++i)
+	{
+		const Event& e = mCapturedEvents[i];
+
+		out << (i ? ",\n" : "") << "{\"name\":";
+		WriteJsonString(out, e.Name);
+		out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.ThreadIndex
+			<< ",\"ts\":" << (double)(e.Start - origin) * usPerCount
+			<< ",\"dur\":" << (double)(e.End - e.Start) * usPerCount << "}";
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::WriteBinary(std::ostream& out)const
+{
+	auto writeU32 = [&out](std::uint32_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+	auto writeI64 = [&out](std::int64_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+
+	// Zone names are interned; events refer to them by index.
+	std::unordered_map<const char*, std::uint32_t> nameIndices;
+	std::vector<const char*> names;
+	for(const Event& e : mCapturedEvents)
+	{
+		if(nameIndices.emplace(e.Name, (std::uint32_t)names.size()).second)
+			names.push_back(e.Name);
+	}
+
+	out.write("HPRF", 4);
+	writeU32(1);
+
+	double secondsPerCount = mClock.SecondsPerCount();
+	out.write(reinterpret_cast<const char*>(&secondsPerCount), sizeof(secondsPerCount));
+
+	writeU32((std::uint32_t)names.size());
+	for(const char* name : names)
+	{
+		std::uint32_t length = (std::uint32_t)std::char_traits<char>::length(name);
+		writeU32(length);
+		out.write(name, length);
+	}
+
+	writeU32((std::uint32_t)mCapturedEvents.size());
+	for(const Event& e : mCapturedEvents)
+	{
+		writeU32(nameIndices[e.Name]);
+		writeU32(e.ThreadIndex);
+		writeU32(e.Depth);
+		writeI64(e.Start);
+		writeI64(e.End);
+	}
+}
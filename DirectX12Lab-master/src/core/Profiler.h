@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include "Clock.h"
+
+// Hierarchical CPU scope profiler.
+//
+// PROFILE_SCOPE("Name") records a zone from the point of declaration to the end of
+// the enclosing scope.  Each thread writes its zones into its own ring buffer with
+// no locks or atomics other than the publishing store, so a zone costs two clock
+// reads and one small store.  Once per frame, Profiler::EndFrame() drains every
+// thread's buffer, aggregates the zones into per-frame totals (with self time) and,
+// while a capture is running, keeps the raw events for Chrome trace / binary export.
+// Events a thread overwrote while they were being drained are dropped, never
+// reported torn.
+//
+// Every thread that records a zone gets a buffer for the rest of the process
+// lifetime, so keep zones on long-lived threads.
+//
+// The clock (and its TSC calibration) is set up by the first Get() or zone, not at
+// static initialization.  Build with PROFILER_ENABLED=0 to compile every macro out.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+class Profiler
+{
+public:
+	// One completed zone.  Name must be a string literal (or otherwise outlive
+	// the profiler); only the pointer is stored.
+	struct Event
+	{
+		const char* Name;
+		std::int64_t Start;
+		std::int64_t End;
+		std::uint32_t ThreadIndex;
+		std::uint32_t Depth;
+	};
+
+	// Aggregate of all zones with the same name, depth and thread in one frame.
+	struct ZoneStats
+	{
+		const char* Name;
+		std::uint32_t ThreadIndex;
+		std::uint32_t Depth;
+		std::uint32_t Calls;
+		double TotalMs;
+		double SelfMs; // TotalMs minus time spent in child zones
+	};
+
+	static Profiler& Get();
+
+	const IClock& GetClock()const;
+
+	// Drains all thread buffers and rebuilds the per-frame zone statistics.
+	// Call once per frame from the main thread.
+	void EndFrame();
+
+	const std::vector<ZoneStats>& GetLastFrameZones()const;
+	std::uint64_t GetFrameIndex()const;
+
+	// Events lost because a thread produced more than a buffer's worth between
+	// two EndFrame() calls.
+	std::uint64_t GetDroppedEventCount()const;
+
+	// While capturing, drained events are kept for export, up to maxEvents (32
+	// bytes each); later events are counted in GetCaptureDroppedEventCount().
+	static const std::size_t DefaultMaxCapturedEvents = 1 << 21;
+
+	void BeginCapture(std::size_t maxEvents = DefaultMaxCapturedEvents);
+	void EndCapture();
+	bool IsCapturing()const;
+	const std::vector<Event>& GetCapturedEvents()const;
+	std::uint64_t GetCaptureDroppedEventCount()const;
+
+	// Chrome about://tracing / Perfetto "trace_event" JSON.
+	void WriteChromeTrace(std::ostream& out)const;
+
+	// Compact binary dump:
+	//   char[4] "HPRF", u32 version, f64 secondsPerCount,
+	//   u32 nameCount, { u32 length, char[length] } * nameCount,
+	//   u32 eventCount, { u32 nameIndex, u32 threadIndex, u32 depth, i64 start, i64 end } * eventCount
+	void WriteBinary(std::ostream& out)const;
+
+	// Current tick of GetClock().
+	static std::int64_t Now();
+
+private:
+	friend class ProfileScope;
+
+	Profiler();
+	Profiler(const Profiler& rhs) = delete;
+	Profiler& operator=(const Profiler& rhs) = delete;
+
+	static const std::uint32_t ThreadBufferCapacity = 1 << 14;
+
+	struct ThreadBuffer
+	{
+		const IClock* Clock = nullptr;
+		bool UseTsc = false;        // read the TSC directly instead of calling Clock
+		std::uint32_t ThreadIndex = 0;
+		std::uint32_t Depth = 0;
+		std::atomic<std::uint64_t> WriteCount{ 0 }; // written by the owning thread only
+		std::uint64_t ReadCount = 0;                // touched by EndFrame() only
+		Event Events[ThreadBufferCapacity];
+	};
+
+	// Hot path, used by ProfileScope.
+	static ThreadBuffer& BeginZone();
+	static void EndZone(ThreadBuffer& buffer, const char* name, std::int64_t start);
+	static std::int64_t Now(const ThreadBuffer& buffer);
+
+	static ThreadBuffer& LocalBuffer();
+	ThreadBuffer* RegisterThread();
+
+	void DrainThread(ThreadBuffer& buffer);
+	void AggregateThread(const Event* events, std::size_t count);
+
+	struct ZoneKey
+	{
+		const char* Name;
+		std::uint32_t ThreadIndex;
+		std::uint32_t Depth;
+
+		bool operator==(const ZoneKey& rhs)const
+		{
+			return Name == rhs.Name && ThreadIndex == rhs.ThreadIndex && Depth == rhs.Depth;
+		}
+	};
+
+	struct ZoneKeyHash
+	{
+		std::size_t operator()(const ZoneKey& key)const
+		{
+			return std::hash<const char*>()(key.Name) ^
+				(((std::size_t)key.ThreadIndex << 16 | key.Depth) * 0x9E3779B97F4A7C15ull);
+		}
+	};
+
+	static thread_local ThreadBuffer* sLocalBuffer;
+
+	const IClock& mClock;
+	bool mUseTsc = false;
+
+	std::mutex mThreadsMutex;
+	std::vector<ThreadBuffer*> mThreads;
+	std::vector<std::unique_ptr<ThreadBuffer>> mOwnedBuffers;
+
+	std::vector<Event> mFrameEvents;
+	std::vector<ZoneStats> mLastFrameZones;
+	std::unordered_map<ZoneKey, std::size_t, ZoneKeyHash> mZoneLookup; // into mLastFrameZones
+	std::vector<double> mChildMs;
+	std::uint64_t mFrameIndex = 0;
+	std::uint64_t mDroppedEvents = 0;
+
+	bool mCapturing = false;
+	std::size_t mMaxCapturedEvents = DefaultMaxCapturedEvents;
+	std::uint64_t mCaptureDroppedEvents = 0;
+	std::vector<Event> mCapturedEvents;
+};
+
+// RAII zone marker.
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+	: mBuffer(Profiler::BeginZone()), mName(name)
+	{
+		mStart = Profiler::Now(mBuffer);
+	}
+
+	~ProfileScope()
+	{
+		Profiler::EndZone(mBuffer, mName, mStart);
+	}
+
+	ProfileScope(const ProfileScope& rhs) = delete;
+	ProfileScope& operator=(const ProfileScope& rhs) = delete;
+
+private:
+	Profiler::ThreadBuffer& mBuffer;
+	const char* mName;
+	std::int64_t mStart;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_END_FRAME() Profiler::Get().EndFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,151 @@
+#include "DescriptorAllocator.h"
+
+#include <cassert>
+
+DescriptorAllocator::DescriptorAllocator(std::uint32_t persistentCount, std::uint32_t transientCount)
+: mPersistentCount(persistentCount), mTransientCount(transientCount),
+  mTransient(transientCount > 0 ? transientCount : 1)
+{
+	if(persistentCount > 0)
+		InsertFreeBlock(0, persistentCount);
+}
+
+std::uint32_t DescriptorAllocator::GetTotalCount()const
+{
+	return mPersistentCount + mTransientCount;
+}
+
+std::uint32_t DescriptorAllocator::GetPersistentCount()const
+{
+	return mPersistentCount;
+}
+
+std::uint32_t DescriptorAllocator::GetTransientCount()const
+{
+	return mTransientCount;
+}
+
+DescriptorAllocator::Range DescriptorAllocator::AllocatePersistent(std::uint32_t count)
+{
+	Range range;
+	if(count == 0)
+		return range;
+
+	// Smallest free block that fits.
+	auto bySize = mFreeBySize.lower_bound(count);
+	if(bySize == mFreeBySize.end())
+		return range;
+
+	const std::uint32_t blockOffset = bySize->second;
+	const std::uint32_t blockCount = bySize->first;
+
+	EraseFreeBlock(mFreeByOffset.find(blockOffset));
+
+	// Keep the remainder at the end of the block free.
+	if(blockCount > count)
+		InsertFreeBlock(blockOffset + count, blockCount - count);
+
+	range.Offset = blockOffset;
+	range.Count = count;
+	return range;
+}
+
+void DescriptorAllocator::FreePersistent(const Range& range)
+{
+	if(!range.IsValid() || range.Count == 0)
+		return;
+
+	assert(range.Offset + range.Count <= mPersistentCount);
+
+	std::uint32_t offset = range.Offset;
+	std::uint32_t count = range.Count;
+
+	// Merge with the free block that follows...
+	auto next = mFreeByOffset.lower_bound(offset);
+	assert(next == mFreeByOffset.end() || next->first >= offset + count); // double free
+	if(next != mFreeByOffset.end() && next->first == offset + count)
+	{
+		count += next->second;
+		EraseFreeBlock(next);
+	}
+
+	// ...and the one that precedes it.
+	auto prev = mFreeByOffset.lower_bound(offset);
+	if(prev != mFreeByOffset.begin())
+	{
+		--prev;
+		assert(prev->first + prev->second <= offset); // double free
+		if(prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			count += prev->second;
+			EraseFreeBlock(prev);
+		}
+	}
+
+	InsertFreeBlock(offset, count);
+}
+
+DescriptorAllocator::Range DescriptorAllocator::AllocateTransient(std::uint32_t count, std::uint64_t fenceValue)
+{
+	Range range;
+	if(count == 0 || mTransientCount == 0)
+		return range;
+
+	// A descriptor table must be contiguous, so the ring never splits a range.
+	const std::uint64_t offset = mTransient.Allocate(count, 1, fenceValue);
+	if(offset == RingAllocator::InvalidOffset)
+		return range;
+
+	range.Offset = mPersistentCount + static_cast<std::uint32_t>(offset);
+	range.Count = count;
+	return range;
+}
+
+void DescriptorAllocator::Reclaim(std::uint64_t completedFenceValue)
+{
+	mTransient.Reclaim(completedFenceValue);
+}
+
+std::uint32_t DescriptorAllocator::GetPersistentFreeCount()const
+{
+	return mPersistentFree;
+}
+
+std::uint32_t DescriptorAllocator::GetLargestPersistentFreeBlock()const
+{
+	return mFreeBySize.empty() ? 0 : mFreeBySize.rbegin()->first;
+}
+
+std::uint32_t DescriptorAllocator::GetPersistentFreeBlockCount()const
+{
+	return static_cast<std::uint32_t>(mFreeByOffset.size());
+}
+
+std::uint32_t DescriptorAllocator::GetTransientUsedCount()const
+{
+	return mTransientCount > 0 ? static_cast<std::uint32_t>(mTransient.GetUsedBytes()) : 0;
+}
+
+void DescriptorAllocator::InsertFreeBlock(std::uint32_t offset, std::uint32_t count)
+{
+	mFreeByOffset.emplace(offset, count);
+	mFreeBySize.emplace(count, offset);
+	mPersistentFree += count;
+}
+
+void DescriptorAllocator::EraseFreeBlock(std::map<std::uint32_t, std::uint32_t>::iterator it)
+{
+	auto range = mFreeBySize.equal_range(it->second);
+	for(auto bySize = range.first; bySize != range.second; ++bySize)
+	{
+		if(bySize->second == it->first)
+		{
+			mFreeBySize.erase(bySize);
+			break;
+		}
+	}
+
+	mPersistentFree -= it->second;
+	mFreeByOffset.erase(it);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include "RingAllocator.h"
+
+// Index allocator for one descriptor heap; knows nothing about D3D handles.
+//
+// The heap is split in two regions:
+//  - [0, persistentCount) holds long-lived descriptors (CBVs for frame resources,
+//    texture SRVs, ...).  Ranges come from a best-fit free list and adjacent free
+//    ranges are merged again on Free, so the region does not fragment over time.
+//  - [persistentCount, persistentCount + transientCount) is a ring for descriptor
+//    tables built each frame.  Transient ranges are tagged with the frame's fence
+//    value and recycled once the GPU has passed it; they are never freed one by one.
+class DescriptorAllocator
+{
+public:
+	static const std::uint32_t InvalidIndex = ~0u;
+
+	struct Range
+	{
+		std::uint32_t Offset = InvalidIndex;
+		std::uint32_t Count = 0;
+
+		bool IsValid()const { return Offset != InvalidIndex; }
+	};
+
+	DescriptorAllocator(std::uint32_t persistentCount, std::uint32_t transientCount);
+	DescriptorAllocator(const DescriptorAllocator& rhs) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator& rhs) = delete;
+
+	std::uint32_t GetTotalCount()const;
+	std::uint32_t GetPersistentCount()const;
+	std::uint32_t GetTransientCount()const;
+
+	// Returns an invalid range when no free block of count descriptors exists.
+	Range AllocatePersistent(std::uint32_t count);
+	void FreePersistent(const Range& range);
+
+	// fenceValue is the value signaled after the commands that use the range.
+	Range AllocateTransient(std::uint32_t count, std::uint64_t fenceValue);
+	void Reclaim(std::uint64_t completedFenceValue);
+
+	std::uint32_t GetPersistentFreeCount()const;
+	std::uint32_t GetLargestPersistentFreeBlock()const;
+	std::uint32_t GetPersistentFreeBlockCount()const;
+	std::uint32_t GetTransientUsedCount()const;
+
+private:
+	void InsertFreeBlock(std::uint32_t offset, std::uint32_t count);
+	void EraseFreeBlock(std::map<std::uint32_t, std::uint32_t>::iterator it);
+
+private:
+	std::uint32_t mPersistentCount = 0;
+	std::uint32_t mTransientCount = 0;
+
+	// Free persistent blocks keyed by offset (for merging) and by size (for best fit).
+	std::map<std::uint32_t, std::uint32_t> mFreeByOffset;
+	std::multimap<std::uint32_t, std::uint32_t> mFreeBySize;
+	std::uint32_t mPersistentFree = 0;
+
+	RingAllocator mTransient;
+};
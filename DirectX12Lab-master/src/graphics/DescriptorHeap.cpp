@@ -0,0 +1,115 @@
+#include "DescriptorHeap.h"
+
+DescriptorHeap::DescriptorHeap(
+    ID3D12Device* device,
+    D3D12_DESCRIPTOR_HEAP_TYPE type,
+    UINT persistentCount,
+    UINT transientCount,
+    bool shaderVisible)
+: mDevice(device), mType(type), mShaderVisible(shaderVisible),
+  mAllocator(persistentCount, transientCount)
+{
+    // Only CBV/SRV/UAV and sampler heaps can be bound to the pipeline.
+    assert(!shaderVisible ||
+        type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ||
+        type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+    heapDesc.NumDescriptors = persistentCount + transientCount;
+    heapDesc.Type = type;
+    heapDesc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    heapDesc.NodeMask = 0;
+    ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+
+    mDescriptorSize = device->GetDescriptorHandleIncrementSize(type);
+
+    mCpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
+    if(shaderVisible)
+        mGpuStart = mHeap->GetGPUDescriptorHandleForHeapStart();
+}
+
+DescriptorHeap::~DescriptorHeap()
+{
+}
+
+DescriptorHeap::Allocation DescriptorHeap::AllocatePersistent(UINT count)
+{
+    DescriptorAllocator::Range range = mAllocator.AllocatePersistent(count);
+    if(!range.IsValid())
+        ThrowIfFailed(E_OUTOFMEMORY);
+
+    return MakeAllocation(range);
+}
+
+DescriptorHeap::Allocation DescriptorHeap::AllocateTransient(UINT count, UINT64 fenceValue)
+{
+    DescriptorAllocator::Range range = mAllocator.AllocateTransient(count, fenceValue);
+    if(!range.IsValid())
+        ThrowIfFailed(E_OUTOFMEMORY);
+
+    return MakeAllocation(range);
+}
+
+void DescriptorHeap::FreePersistent(const Allocation& allocation)
+{
+    mAllocator.FreePersistent(allocation.Range);
+}
+
+void DescriptorHeap::Reclaim(UINT64 completedFenceValue)
+{
+    mAllocator.Reclaim(completedFenceValue);
+}
+
+DescriptorHeap::Allocation DescriptorHeap::StageTable(
+    const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count, UINT64 fenceValue)
+{
+    Allocation table = AllocateTransient(count, fenceValue);
+
+    // One destination range, count single-descriptor source ranges.
+    mSrcRangeSizes.assign(count, 1);
+
+    UINT destRangeSize = count;
+    D3D12_CPU_DESCRIPTOR_HANDLE destStart = table.CpuHandle;
+    mDevice->CopyDescriptors(
+        1, &destStart, &destRangeSize,
+        count, srcHandles, mSrcRangeSizes.data(),
+        mType);
+
+    return table;
+}
+
+CD3DX12_CPU_DESCRIPTOR_HANDLE DescriptorHeap::CpuHandle(UINT index)const
+{
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, static_cast<INT>(index), mDescriptorSize);
+}
+
+CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorHeap::GpuHandle(UINT index)const
+{
+    assert(mShaderVisible);
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, static_cast<INT>(index), mDescriptorSize);
+}
+
+ID3D12DescriptorHeap* DescriptorHeap::Heap()const
+{
+    return mHeap.Get();
+}
+
+UINT DescriptorHeap::DescriptorSize()const
+{
+    return mDescriptorSize;
+}
+
+const DescriptorAllocator& DescriptorHeap::Allocator()const
+{
+    return mAllocator;
+}
+
+DescriptorHeap::Allocation DescriptorHeap::MakeAllocation(const DescriptorAllocator::Range& range)const
+{
+    Allocation allocation;
+    allocation.Range = range;
+    allocation.CpuHandle = CpuHandle(range.Offset);
+    if(mShaderVisible)
+        allocation.GpuHandle = GpuHandle(range.Offset);
+    return allocation;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "Dx12Utils.h"
+#include "DescriptorAllocator.h"
+
+// ID3D12DescriptorHeap managed by a DescriptorAllocator.
+//
+// Shader-visible heaps are where descriptor tables live; CPU-only heaps are used as
+// staging.  Descriptors created in a staging heap can be gathered into a transient
+// range of the shader-visible heap with StageTable(), which is how tables are built
+// from descriptors that are not already contiguous.
+class DescriptorHeap
+{
+public:
+    struct Allocation
+    {
+        DescriptorAllocator::Range Range;
+        CD3DX12_CPU_DESCRIPTOR_HANDLE CpuHandle{ D3D12_DEFAULT };
+        CD3DX12_GPU_DESCRIPTOR_HANDLE GpuHandle{ D3D12_DEFAULT }; // zero for CPU-only heaps
+
+        bool IsValid()const { return Range.IsValid(); }
+    };
+
+    DescriptorHeap(
+        ID3D12Device* device,
+        D3D12_DESCRIPTOR_HEAP_TYPE type,
+        UINT persistentCount,
+        UINT transientCount,
+        bool shaderVisible);
+    DescriptorHeap(const DescriptorHeap& rhs) = delete;
+    DescriptorHeap& operator=(const DescriptorHeap& rhs) = delete;
+    ~DescriptorHeap();
+
+    // Throw E_OUTOFMEMORY when the heap is exhausted.
+    Allocation AllocatePersistent(UINT count);
+    Allocation AllocateTransient(UINT count, UINT64 fenceValue);
+
+    void FreePersistent(const Allocation& allocation);
+    void Reclaim(UINT64 completedFenceValue);
+
+    // Copies count descriptors from arbitrary CPU handles (normally in a staging heap)
+    // into a contiguous transient range and returns it.
+    Allocation StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count, UINT64 fenceValue);
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE CpuHandle(UINT index)const;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GpuHandle(UINT index)const;
+
+    ID3D12DescriptorHeap* Heap()const;
+    UINT DescriptorSize()const;
+    const DescriptorAllocator& Allocator()const;
+
+private:
+    Allocation MakeAllocation(const DescriptorAllocator::Range& range)const;
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+    D3D12_DESCRIPTOR_HEAP_TYPE mType;
+    UINT mDescriptorSize = 0;
+    bool mShaderVisible = false;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart = {};
+    D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart = {};
+
+    DescriptorAllocator mAllocator;
+
+    // Reused by StageTable so building a table does not allocate.
+    std::vector<UINT> mSrcRangeSizes;
+};
@@ -0,0 +1,33 @@
+#include "Dx12Fence.h"
+
+Dx12Fence::Dx12Fence(ID3D12Fence* fence)
+: mFence(fence)
+{
+    assert(mFence);
+
+    mEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+    if(!mEvent)
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+Dx12Fence::~Dx12Fence()
+{
+    if(mEvent)
+        CloseHandle(mEvent);
+}
+
+std::uint64_t Dx12Fence::GetCompletedValue()const
+{
+    return mFence->GetCompletedValue();
+}
+
+void Dx12Fence::WaitForValue(std::uint64_t value)
+{
+    if(mFence->GetCompletedValue() >= value)
+        return;
+
+    ThrowIfFailed(mFence->SetEventOnCompletion(value, mEvent));
+    WaitForSingleObject(mEvent, INFINITE);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Dx12Utils.h"
+#include "FrameRing.h"
+
+// IGpuFence over an ID3D12Fence.  Keeps one reusable wait event instead of creating
+// an event per wait.
+class Dx12Fence : public IGpuFence
+{
+public:
+    explicit Dx12Fence(ID3D12Fence* fence);
+    Dx12Fence(const Dx12Fence& rhs) = delete;
+    Dx12Fence& operator=(const Dx12Fence& rhs) = delete;
+    ~Dx12Fence();
+
+    std::uint64_t GetCompletedValue()const override;
+    void WaitForValue(std::uint64_t value) override;
+
+private:
+    ID3D12Fence* mFence = nullptr;
+    HANDLE mEvent = nullptr;
+};
@@ -1,5 +1,7 @@
 
 #include "Dx12Utils.h"
+#include "UploadRing.h"
+#include "GpuHeap.h"
 #include <comdef.h>
 #include <fstream>
 
@@ -97,6 +99,58 @@ Microsoft::WRL::ComPtr<ID3D12Resource> Dx12Utils::CreateDefaultBuffer(
     return defaultBuffer;
 }
 
+Microsoft::WRL::ComPtr<ID3D12Resource> Dx12Utils::CreateDefaultBuffer(
+    ID3D12Device* device,
+    ID3D12GraphicsCommandList* cmdList,
+    const void* initData,
+    UINT64 byteSize,
+    UploadRing& uploadRing,
+    UINT64 fenceValue,
+    GpuHeap* gpuHeap)
+{
+    // Stage the data in the shared upload ring.  Buffer copies only need 4-byte
+    // aligned source offsets, but keep a cache line to avoid false sharing with
+    // whatever the CPU writes next.
+    UploadRing::Allocation staging;
+    if(!uploadRing.Allocate(byteSize, 64, fenceValue, staging))
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    memcpy(staging.CpuAddress, initData, (size_t)byteSize);
+
+    ComPtr<ID3D12Resource> defaultBuffer;
+
+    // Buffers may be created in the COPY_DEST state directly.
+    if(gpuHeap != nullptr)
+    {
+        ThrowIfFailed(gpuHeap->CreateBuffer(byteSize, D3D12_RESOURCE_STATE_COPY_DEST, defaultBuffer));
+    }
+    else
+    {
+        CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+        CD3DX12_RESOURCE_DESC defaultDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+
+        ThrowIfFailed(device->CreateCommittedResource(
+            &defaultHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &defaultDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
+    }
+
+    cmdList->CopyBufferRegion(defaultBuffer.Get(), 0, staging.Resource, staging.Offset, byteSize);
+
+    auto toGenericRead = CD3DX12_RESOURCE_BARRIER::Transition(
+        defaultBuffer.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_GENERIC_READ);
+    cmdList->ResourceBarrier(1, &toGenericRead);
+
+    return defaultBuffer;
+}
+
 ComPtr<ID3DBlob> Dx12Utils::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
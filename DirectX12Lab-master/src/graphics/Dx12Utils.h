@@ -21,11 +21,15 @@
 #include <sstream>
 #include <cassert>
 #include "Dx12Core.h"
+#include "Light.h"
 #include "../resources/TextureLoaderDDS.h"
 #include "../math/MathUtils.h"
 
 extern const int gNumFrameResources;
 
+class UploadRing;
+class GpuHeap;
+
 inline void d3dSetDebugName(IDXGIObject* obj, const char* name)
 {
     if(obj)
@@ -88,6 +92,19 @@ public:
         UINT64 byteSize,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
 
+    // Same as above, but stages the data in uploadRing instead of a new upload heap.
+    // fenceValue must be the value signaled after cmdList executes; the staging
+    // space is reclaimed once the GPU reaches it.  When gpuHeap is given the
+    // buffer is placed in it instead of getting its own committed heap.
+    static Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
+        ID3D12Device* device,
+        ID3D12GraphicsCommandList* cmdList,
+        const void* initData,
+        UINT64 byteSize,
+        UploadRing& uploadRing,
+        UINT64 fenceValue,
+        GpuHeap* gpuHeap = nullptr);
+
 	static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
 		const std::wstring& filename,
 		const D3D_SHADER_MACRO* defines,
@@ -179,18 +196,6 @@ struct MeshGeometry
 	}
 };
 
-struct Light
-{
-    DirectX::XMFLOAT3 Strength = { 0.5f, 0.5f, 0.5f };
-    float FalloffStart = 1.0f;                          // point/spot light only
-    DirectX::XMFLOAT3 Direction = { 0.0f, -1.0f, 0.0f };// directional/spot light only
-    float FalloffEnd = 10.0f;                           // point/spot light only
-    DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };  // point/spot light only
-    float SpotPower = 64.0f;                            // spot light only
-};
-
-#define MaxLights 16
-
 struct MaterialConstants
 {
 	DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
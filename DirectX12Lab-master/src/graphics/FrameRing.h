@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Fence the CPU can poll and block on.  Implemented over ID3D12Fence by Dx12Fence;
+// tests can implement it with a plain counter.
+class IGpuFence
+{
+public:
+	virtual ~IGpuFence() = default;
+
+	virtual std::uint64_t GetCompletedValue()const = 0;
+
+	// Blocks until GetCompletedValue() >= value.
+	virtual void WaitForValue(std::uint64_t value) = 0;
+};
+
+// Bookkeeping for N frames in flight.
+//
+// Each slot remembers the fence value signaled after the GPU work recorded with
+// that slot's resources.  BeginFrame() moves to the next slot and only blocks if
+// the GPU has not yet finished the frame that last used it, i.e. when the CPU is
+// more than N-1 frames ahead.
+class FrameRing
+{
+public:
+	explicit FrameRing(int frameCount)
+	: mFenceValues((std::size_t)frameCount, 0)
+	{
+		assert(frameCount > 0);
+	}
+
+	int GetFrameCount()const
+	{
+		return (int)mFenceValues.size();
+	}
+
+	int GetCurrentIndex()const
+	{
+		return mCurrentIndex;
+	}
+
+	std::uint64_t GetFenceValue(int index)const
+	{
+		return mFenceValues[(std::size_t)index];
+	}
+
+	// Number of BeginFrame() calls that had to wait on the GPU.
+	std::uint64_t GetStallCount()const
+	{
+		return mStallCount;
+	}
+
+	// Advances to the next slot and waits until its previous frame has completed.
+	// Returns the new slot index.
+	int BeginFrame(IGpuFence& fence)
+	{
+		mCurrentIndex = (mCurrentIndex + 1) % GetFrameCount();
+
+		const std::uint64_t pending = mFenceValues[(std::size_t)mCurrentIndex];
+		if(pending != 0 && fence.GetCompletedValue() < pending)
+		{
+			++mStallCount;
+			fence.WaitForValue(pending);
+		}
+
+		return mCurrentIndex;
+	}
+
+	// Records the fence value signaled after this frame's command lists.
+	void EndFrame(std::uint64_t fenceValue)
+	{
+		mFenceValues[(std::size_t)mCurrentIndex] = fenceValue;
+	}
+
+	// Largest fence value any slot is waiting for; waiting on it idles every slot.
+	std::uint64_t GetLastFenceValue()const
+	{
+		std::uint64_t last = 0;
+		for(std::uint64_t v : mFenceValues)
+			last = v > last ? v : last;
+		return last;
+	}
+
+private:
+	std::vector<std::uint64_t> mFenceValues;
+	int mCurrentIndex = -1;
+	std::uint64_t mStallCount = 0;
+};
@@ -0,0 +1,250 @@
+#include "GpuHeap.h"
+
+#include <algorithm>
+
+using Microsoft::WRL::ComPtr;
+
+GpuHeap::GpuHeap(ID3D12Device* device, UINT64 pageSize)
+: mDevice(device), mPageSize(pageSize)
+{
+    // Pages must be able to hold at least one MSAA placement.
+    assert(pageSize >= D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+}
+
+GpuHeap::~GpuHeap()
+{
+    // Placed resources hold a reference to their ID3D12Heap, so pages stay alive
+    // for resources that are destroyed after the GpuHeap.
+}
+
+void GpuHeap::SetBudget(UINT64 bytes)
+{
+    mBudget = bytes;
+}
+
+GpuHeap::HeapClass GpuHeap::Classify(const D3D12_RESOURCE_DESC& desc)
+{
+    if(desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        return HeapClass_Buffer;
+
+    if(desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+        return HeapClass_RenderTarget;
+
+    return HeapClass_Texture;
+}
+
+HRESULT GpuHeap::CreateResource(
+    const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* clearValue,
+    ComPtr<ID3D12Resource>& resource,
+    GpuHeapAllocation* allocation)
+{
+    resource = nullptr;
+    if(allocation != nullptr)
+        *allocation = GpuHeapAllocation();
+
+    D3D12_RESOURCE_DESC placedDesc = desc;
+
+    // Try the 4 KB alignment for small textures first; the runtime rejects it
+    // (returns a different alignment) when the texture does not qualify.
+    const HeapClass heapClass = Classify(desc);
+    if(heapClass == HeapClass_Texture && placedDesc.Alignment == 0 && placedDesc.SampleDesc.Count <= 1)
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &placedDesc);
+    if(info.Alignment != placedDesc.Alignment && placedDesc.Alignment != desc.Alignment)
+    {
+        placedDesc.Alignment = desc.Alignment;
+        info = mDevice->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+
+    if(info.SizeInBytes == UINT64_MAX)
+        return E_INVALIDARG;
+
+    auto& pages = mPages[heapClass];
+
+    // Newest pages are most likely to have room.
+    Page* page = nullptr;
+    size_t pageIndex = 0;
+    TlsfAllocator<UINT64>::Allocation block;
+    for(size_t i = pages.size(); i > 0; --i)
+    {
+        block = pages[i - 1]->Allocator.Allocate(info.SizeInBytes, info.Alignment);
+        if(block.IsValid())
+        {
+            page = pages[i - 1].get();
+            pageIndex = i - 1;
+            break;
+        }
+    }
+
+    if(page == nullptr)
+    {
+        HRESULT hr = CreatePage(heapClass, info.SizeInBytes + info.Alignment, page);
+        if(FAILED(hr))
+            return hr;
+
+        pageIndex = pages.size() - 1;
+        block = page->Allocator.Allocate(info.SizeInBytes, info.Alignment);
+
+        // A fresh page has room for size + alignment; anything else is a bug in the
+        // allocator, but fail the call rather than place over live memory.
+        assert(block.IsValid());
+        if(!block.IsValid())
+            return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = mDevice->CreatePlacedResource(
+        page->Heap.Get(),
+        block.Offset,
+        &placedDesc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(resource.GetAddressOf()));
+
+    if(FAILED(hr))
+    {
+        page->Allocator.Free(block);
+        resource = nullptr;
+        return hr;
+    }
+
+    GpuHeapAllocation placement;
+    placement.HeapClass = heapClass;
+    placement.PageIndex = (UINT)pageIndex;
+    placement.Block = block;
+
+    mPlacements[PlacementKey(placement.HeapClass, placement.PageIndex, block.Node)] = resource.Get();
+    if(allocation != nullptr)
+        *allocation = placement;
+
+    return S_OK;
+}
+
+HRESULT GpuHeap::CreateBuffer(
+    UINT64 byteSize,
+    D3D12_RESOURCE_STATES initialState,
+    ComPtr<ID3D12Resource>& resource,
+    GpuHeapAllocation* allocation)
+{
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+    return CreateResource(desc, initialState, nullptr, resource, allocation);
+}
+
+void GpuHeap::Release(const GpuHeapAllocation& allocation)
+{
+    if(!allocation.IsValid())
+        return;
+
+    auto it = mPlacements.find(PlacementKey(allocation.HeapClass, allocation.PageIndex, allocation.Block.Node));
+    if(it == mPlacements.end())
+        return;
+
+    mPages[allocation.HeapClass][allocation.PageIndex]->Allocator.Free(allocation.Block);
+    mPlacements.erase(it);
+}
+
+GpuHeap::Stats GpuHeap::GetStats()const
+{
+    Stats stats;
+    stats.BudgetBytes = mBudget;
+
+    for(int c = 0; c < HeapClass_Count; ++c)
+    {
+        ClassStats& classStats = stats.Classes[c];
+        for(const auto& page : mPages[c])
+        {
+            const TlsfAllocator<UINT64>& allocator = page->Allocator;
+            classStats.ReservedBytes += allocator.GetSize();
+            classStats.UsedBytes += allocator.GetUsedSize();
+            classStats.AllocationCount += allocator.GetAllocationCount();
+            classStats.FreeBlockCount += allocator.GetFreeBlockCount();
+
+            UINT64 largest = allocator.GetLargestFreeBlock();
+            classStats.LargestFreeBlock = largest > classStats.LargestFreeBlock ? largest : classStats.LargestFreeBlock;
+        }
+        classStats.PageCount = (UINT)mPages[c].size();
+
+        stats.ReservedBytes += classStats.ReservedBytes;
+        stats.UsedBytes += classStats.UsedBytes;
+    }
+
+    return stats;
+}
+
+void GpuHeap::GetDefragCandidates(std::vector<DefragCandidate>& out, size_t maxCount)const
+{
+    out.clear();
+    if(maxCount == 0)
+        return;
+
+    std::vector<TlsfAllocator<UINT64>::Allocation> blocks;
+    for(int c = 0; c < HeapClass_Count; ++c)
+    {
+        for(size_t p = 0; p < mPages[c].size(); ++p)
+        {
+            mPages[c][p]->Allocator.GetDefragCandidates(blocks, maxCount);
+            for(const auto& block : blocks)
+            {
+                auto it = mPlacements.find(PlacementKey((UINT)c, (UINT)p, block.Node));
+                if(it == mPlacements.end())
+                    continue;
+
+                DefragCandidate candidate;
+                candidate.Resource = it->second;
+                candidate.Allocation.HeapClass = (UINT)c;
+                candidate.Allocation.PageIndex = (UINT)p;
+                candidate.Allocation.Block = block;
+                candidate.Class = (HeapClass)c;
+                candidate.Offset = block.Offset;
+                candidate.Size = block.Size;
+                out.push_back(candidate);
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end(),
+        [](const DefragCandidate& a, const DefragCandidate& b) { return a.Size < b.Size; });
+    if(out.size() > maxCount)
+        out.resize(maxCount);
+}
+
+HRESULT GpuHeap::CreatePage(HeapClass heapClass, UINT64 minSize, Page*& page)
+{
+    page = nullptr;
+
+    UINT64 size = mPageSize;
+    while(size < minSize)
+        size *= 2;
+
+    if(mBudget != 0 && mReserved + size > mBudget)
+        return E_OUTOFMEMORY;
+
+    static const D3D12_HEAP_FLAGS classFlags[HeapClass_Count] =
+    {
+        D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+    };
+
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = size;
+    heapDesc.Properties = heapProps;
+    heapDesc.Alignment = heapClass == HeapClass_RenderTarget
+        ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+        : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heapDesc.Flags = classFlags[heapClass];
+
+    auto newPage = std::make_unique<Page>(size);
+    HRESULT hr = mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(newPage->Heap.GetAddressOf()));
+    if(FAILED(hr))
+        return hr;
+
+    mReserved += size;
+    mPages[heapClass].push_back(std::move(newPage));
+    page = mPages[heapClass].back().get();
+    return S_OK;
+}
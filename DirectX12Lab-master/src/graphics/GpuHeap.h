@@ -0,0 +1,134 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Dx12Utils.h"
+#include "TlsfAllocator.h"
+
+// Suballocates placed resources out of large ID3D12Heap pages instead of giving
+// every buffer and texture its own implicit heap through CreateCommittedResource.
+//
+// Resources are sorted into heap classes because resource heap tier 1 hardware
+// can not mix buffers, textures and render targets in one heap, and because they
+// use different placement alignments (64 KB normally, 4 MB for MSAA, 4 KB for
+// small textures).  Each class grows by whole pages; a page is a TlsfAllocator.
+//
+// Every placement is identified by the GpuHeapAllocation handed out with the
+// resource, not by the resource pointer, which the runtime may reuse for a new
+// object once the old one is destroyed.  Release() returns the memory
+// immediately, so only call it once the GPU is done with the resource.
+//
+// Failures (budget exceeded, heap or resource creation failing) come back as an
+// HRESULT with a null resource; nothing is thrown.
+struct GpuHeapAllocation
+{
+    UINT HeapClass = 0;
+    UINT PageIndex = 0;
+    TlsfAllocator<UINT64>::Allocation Block;
+
+    bool IsValid()const { return Block.IsValid(); }
+};
+
+class GpuHeap
+{
+public:
+    enum HeapClass
+    {
+        HeapClass_Buffer = 0,
+        HeapClass_Texture,
+        HeapClass_RenderTarget, // render targets and depth-stencil
+        HeapClass_Count
+    };
+
+    struct ClassStats
+    {
+        UINT64 ReservedBytes = 0;   // sum of the page sizes
+        UINT64 UsedBytes = 0;       // sum of the allocation sizes
+        UINT AllocationCount = 0;
+        UINT PageCount = 0;
+        UINT FreeBlockCount = 0;
+        UINT64 LargestFreeBlock = 0;
+    };
+
+    struct Stats
+    {
+        ClassStats Classes[HeapClass_Count];
+        UINT64 ReservedBytes = 0;
+        UINT64 UsedBytes = 0;
+        UINT64 BudgetBytes = 0;     // 0 = unlimited
+    };
+
+    struct DefragCandidate
+    {
+        ID3D12Resource* Resource = nullptr;
+        GpuHeapAllocation Allocation;
+        HeapClass Class = HeapClass_Buffer;
+        UINT64 Offset = 0;
+        UINT64 Size = 0;
+    };
+
+    explicit GpuHeap(ID3D12Device* device, UINT64 pageSize = 64ull * 1024 * 1024);
+    GpuHeap(const GpuHeap& rhs) = delete;
+    GpuHeap& operator=(const GpuHeap& rhs) = delete;
+    ~GpuHeap();
+
+    // Caps the bytes reserved in heap pages.  A page that would exceed the budget
+    // is not created and the allocation fails with E_OUTOFMEMORY.
+    void SetBudget(UINT64 bytes);
+
+    // Places a resource, failing like CreateCommittedResource would.  allocation,
+    // when given, receives the handle to Release() it with; resources that live as
+    // long as the heap may skip it.
+    HRESULT CreateResource(
+        const D3D12_RESOURCE_DESC& desc,
+        D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue,
+        Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+        GpuHeapAllocation* allocation = nullptr);
+
+    HRESULT CreateBuffer(
+        UINT64 byteSize,
+        D3D12_RESOURCE_STATES initialState,
+        Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+        GpuHeapAllocation* allocation = nullptr);
+
+    // Frees the memory behind allocation.  The heap keeps no reference to the
+    // resource, so the caller's ComPtr still owns the (now dangling) object.
+    void Release(const GpuHeapAllocation& allocation);
+
+    Stats GetStats()const;
+
+    // Live resources whose neighbours on both sides are free, smallest first.
+    // Recreating them elsewhere and copying the contents merges the free space.
+    void GetDefragCandidates(std::vector<DefragCandidate>& out, size_t maxCount)const;
+
+    static HeapClass Classify(const D3D12_RESOURCE_DESC& desc);
+
+private:
+    struct Page
+    {
+        Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+        TlsfAllocator<UINT64> Allocator;
+
+        Page(UINT64 size) : Allocator(size, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {}
+    };
+
+    // Allocator nodes are only unique per page, so placements are keyed by all three.
+    static UINT64 PlacementKey(UINT heapClass, UINT pageIndex, std::uint32_t node)
+    {
+        return ((UINT64)heapClass << 56) | ((UINT64)pageIndex << 32) | node;
+    }
+
+    HRESULT CreatePage(HeapClass heapClass, UINT64 minSize, Page*& page);
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    UINT64 mPageSize = 0;
+    UINT64 mBudget = 0;
+    UINT64 mReserved = 0;
+
+    std::vector<std::unique_ptr<Page>> mPages[HeapClass_Count];
+    // Live placements, for GetDefragCandidates(); the resources are not owned.
+    std::unordered_map<UINT64, ID3D12Resource*> mPlacements;
+};
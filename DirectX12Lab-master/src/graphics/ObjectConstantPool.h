@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// CPU-side store for per-object constants that are mirrored into one upload buffer
+// per frame resource.
+//
+// Every slot carries a NumFramesDirty counter like Material::NumFramesDirty: a Set()
+// marks the slot dirty for all frame resources, and each Flush() into the current
+// frame's buffer copies the slot once and decrements the counter.  Only dirty slots
+// are touched, and runs of adjacent dirty slots go out as a single memcpy.  The
+// shadow copy uses the same element stride as the GPU buffer (256 bytes for
+// constant buffers) so a run is contiguous on both sides.
+template<typename T>
+class ObjectConstantPool
+{
+public:
+	static const std::uint32_t InvalidSlot = ~0u;
+
+	struct FlushStats
+	{
+		std::uint64_t BytesCopied = 0;
+		std::uint32_t SlotsCopied = 0;
+		std::uint32_t CopyCalls = 0;
+	};
+
+	ObjectConstantPool(std::uint32_t capacity, std::uint32_t elementByteSize, int numFrameResources)
+	: mCapacity(capacity), mStride(elementByteSize), mNumFrameResources(numFrameResources)
+	{
+		assert(elementByteSize >= sizeof(T));
+		assert(numFrameResources > 0);
+
+		mShadow.resize(static_cast<size_t>(capacity) * mStride);
+		mNumFramesDirty.resize(capacity, 0);
+		mFreeSlots.reserve(capacity);
+
+		// Hand out low slots first so live objects stay packed at the front.
+		for(std::uint32_t i = capacity; i > 0; --i)
+			mFreeSlots.push_back(i - 1);
+	}
+
+	ObjectConstantPool(const ObjectConstantPool& rhs) = delete;
+	ObjectConstantPool& operator=(const ObjectConstantPool& rhs) = delete;
+
+	std::uint32_t GetCapacity()const { return mCapacity; }
+	std::uint32_t GetElementByteSize()const { return mStride; }
+	std::uint32_t GetLiveCount()const { return mCapacity - static_cast<std::uint32_t>(mFreeSlots.size()); }
+
+	// Returns InvalidSlot when the pool is full.
+	std::uint32_t Allocate(const T& initial = T())
+	{
+		if(mFreeSlots.empty())
+			return InvalidSlot;
+
+		std::uint32_t slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+
+		Set(slot, initial);
+		return slot;
+	}
+
+	// The slot's data stays in the per-frame buffers until it is reused; nothing
+	// draws with a freed slot, so there is no need to clear it.
+	void Free(std::uint32_t slot)
+	{
+		assert(slot < mCapacity);
+		mNumFramesDirty[slot] = 0;
+		mFreeSlots.push_back(slot);
+	}
+
+	const T& Get(std::uint32_t slot)const
+	{
+		assert(slot < mCapacity);
+		return *reinterpret_cast<const T*>(&mShadow[static_cast<size_t>(slot) * mStride]);
+	}
+
+	void Set(std::uint32_t slot, const T& data)
+	{
+		assert(slot < mCapacity);
+		memcpy(&mShadow[static_cast<size_t>(slot) * mStride], &data, sizeof(T));
+		MarkDirty(slot);
+	}
+
+	void MarkDirty(std::uint32_t slot)
+	{
+		assert(slot < mCapacity);
+		if(mNumFramesDirty[slot] == 0)
+			mDirtySlots.push_back(slot);
+
+		mNumFramesDirty[slot] = mNumFrameResources;
+	}
+
+	bool IsDirty()const { return !mDirtySlots.empty(); }
+
+	// Copies every dirty slot into dest, the mapped buffer of the frame resource
+	// being recorded, which must hold GetCapacity() elements of GetElementByteSize().
+	FlushStats Flush(std::uint8_t* dest)
+	{
+		FlushStats stats;
+		if(mDirtySlots.empty())
+		{
+			mLastFlush = stats;
+			return stats;
+		}
+
+		// A slot freed and reallocated between flushes is listed twice.
+		std::sort(mDirtySlots.begin(), mDirtySlots.end());
+		mDirtySlots.erase(std::unique(mDirtySlots.begin(), mDirtySlots.end()), mDirtySlots.end());
+
+		// Slots freed while dirty are still listed; they have a zero counter.
+		size_t kept = 0;
+		size_t i = 0;
+		while(i < mDirtySlots.size())
+		{
+			const std::uint32_t first = mDirtySlots[i];
+			if(mNumFramesDirty[first] == 0)
+			{
+				++i;
+				continue;
+			}
+
+			// Extend the run while the next listed slot is adjacent and still dirty.
+			std::uint32_t last = first;
+			size_t j = i + 1;
+			while(j < mDirtySlots.size() && mDirtySlots[j] == last + 1 && mNumFramesDirty[mDirtySlots[j]] > 0)
+			{
+				last = mDirtySlots[j];
+				++j;
+			}
+
+			const size_t offset = static_cast<size_t>(first) * mStride;
+			const size_t count = last - first + 1;
+
+			// The last element only needs sizeof(T); the rest of its stride is padding.
+			const size_t bytes = (count - 1) * mStride + sizeof(T);
+			memcpy(dest + offset, &mShadow[offset], bytes);
+
+			stats.BytesCopied += bytes;
+			stats.SlotsCopied += static_cast<std::uint32_t>(count);
+			++stats.CopyCalls;
+
+			for(std::uint32_t slot = first; slot <= last; ++slot)
+			{
+				if(--mNumFramesDirty[slot] > 0)
+					mDirtySlots[kept++] = slot;
+			}
+
+			i = j;
+		}
+
+		mDirtySlots.resize(kept);
+
+		mLastFlush = stats;
+		mTotalBytesCopied += stats.BytesCopied;
+		return stats;
+	}
+
+	const FlushStats& GetLastFlushStats()const { return mLastFlush; }
+	std::uint64_t GetTotalBytesCopied()const { return mTotalBytesCopied; }
+
+private:
+	std::uint32_t mCapacity = 0;
+	std::uint32_t mStride = 0;
+	int mNumFrameResources = 0;
+
+	std::vector<std::uint8_t> mShadow;
+	std::vector<int> mNumFramesDirty;
+
+	// Slots with a non-zero counter (plus possibly freed ones), unsorted between flushes.
+	std::vector<std::uint32_t> mDirtySlots;
+	std::vector<std::uint32_t> mFreeSlots;
+
+	FlushStats mLastFlush;
+	std::uint64_t mTotalBytesCopied = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+// Offset allocator for a circular buffer whose allocations are retired in order.
+//
+// Each allocation is tagged with the fence value the GPU will signal once it is
+// done with the memory.  Reclaim(completed) releases everything tagged with a value
+// up to the completed one, in allocation order.  The allocator only hands out
+// offsets, so it can manage a mapped upload heap as well as a plain memory block.
+class RingAllocator
+{
+public:
+	static const std::uint64_t InvalidOffset = ~0ull;
+
+	explicit RingAllocator(std::uint64_t capacity)
+	: mCapacity(capacity)
+	{
+		assert(capacity > 0);
+	}
+
+	std::uint64_t GetCapacity()const { return mCapacity; }
+	std::uint64_t GetUsedBytes()const { return mUsed; }
+
+	// Returns the offset of size bytes aligned to alignment (a power of two), or
+	// InvalidOffset when there is not enough free space until more is reclaimed.
+	// A size above GetCapacity() fails every time; callers must not retry it.
+	std::uint64_t Allocate(std::uint64_t size, std::uint64_t alignment, std::uint64_t fenceValue)
+	{
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		if(size == 0 || size > mCapacity)
+			return InvalidOffset;
+
+		// An empty ring can restart at 0, which avoids needless wrapping.
+		if(mUsed == 0)
+			mHead = 0;
+
+		std::uint64_t offset = (mHead + alignment - 1) & ~(alignment - 1);
+		if(offset + size > mCapacity)
+		{
+			// Not enough room before the end: skip the tail and start over at 0.
+			// The skipped bytes are charged to this allocation and freed with it.
+			offset = 0;
+		}
+
+		const std::uint64_t consumed = (offset >= mHead ? offset - mHead : mCapacity - mHead) + size;
+		if(mUsed + consumed > mCapacity)
+			return InvalidOffset;
+
+		mUsed += consumed;
+		mHead = offset + size;
+
+		if(!mPending.empty() && mPending.back().FenceValue == fenceValue)
+			mPending.back().Size += consumed;
+		else
+			mPending.push_back(PendingRegion{ fenceValue, consumed });
+
+		return offset;
+	}
+
+	// Releases every allocation tagged with a fence value <= completedFenceValue.
+	void Reclaim(std::uint64_t completedFenceValue)
+	{
+		while(!mPending.empty() && mPending.front().FenceValue <= completedFenceValue)
+		{
+			mUsed -= mPending.front().Size;
+			mPending.pop_front();
+		}
+	}
+
+private:
+	// Consecutive allocations with the same fence value share one region.
+	struct PendingRegion
+	{
+		std::uint64_t FenceValue;
+		std::uint64_t Size;
+	};
+
+	std::uint64_t mCapacity;
+	std::uint64_t mHead = 0;
+	std::uint64_t mUsed = 0;
+
+	std::deque<PendingRegion> mPending;
+};
@@ -0,0 +1,464 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Two-level segregated fit allocator over an abstract offset space [0, size).
+//
+// Free blocks are kept in size classes: the first level is the power of two of the
+// size, the second level splits each power of two into SlCount linear steps.  Two
+// bitmaps record which classes are non-empty, so Allocate() and Free() are O(1):
+// a couple of bit scans plus constant list and neighbour updates.  Freed blocks
+// are merged with free physical neighbours immediately.
+//
+// The allocator never touches the memory it manages, so it works for GPU heaps,
+// file regions or anything else addressed by offset.  Every offset and size is a
+// multiple of the granularity passed to the constructor.
+template<typename OffsetT = std::uint64_t>
+class TlsfAllocator
+{
+public:
+	static const std::uint32_t InvalidNode = ~0u;
+
+	struct Allocation
+	{
+		OffsetT Offset = 0;
+		OffsetT Size = 0;
+		std::uint32_t Node = InvalidNode;
+
+		bool IsValid()const { return Node != InvalidNode; }
+	};
+
+	explicit TlsfAllocator(OffsetT size, OffsetT granularity = 256)
+	: mSize(size), mGranularity(granularity)
+	{
+		assert(granularity > 0 && (granularity & (granularity - 1)) == 0);
+		assert(size >= granularity);
+
+		mGranularityLog2 = Log2(static_cast<std::uint64_t>(granularity));
+
+		for(std::uint32_t fl = 0; fl < FlCount; ++fl)
+		{
+			mSlBitmap[fl] = 0;
+			for(std::uint32_t sl = 0; sl < SlCount; ++sl)
+				mFreeHeads[fl][sl] = InvalidNode;
+		}
+
+		// Any tail smaller than the granularity is simply not managed.
+		std::uint32_t node = NewNode();
+		mNodes[node].Offset = 0;
+		mNodes[node].Size = size & ~(granularity - 1);
+		InsertFree(node);
+	}
+
+	TlsfAllocator(const TlsfAllocator& rhs) = delete;
+	TlsfAllocator& operator=(const TlsfAllocator& rhs) = delete;
+	TlsfAllocator(TlsfAllocator&& rhs) = default;
+	TlsfAllocator& operator=(TlsfAllocator&& rhs) = default;
+
+	OffsetT GetSize()const { return mSize; }
+	OffsetT GetGranularity()const { return mGranularity; }
+	OffsetT GetUsedSize()const { return mUsed; }
+	OffsetT GetFreeSize()const { return (mSize & ~(mGranularity - 1)) - mUsed; }
+	std::uint32_t GetAllocationCount()const { return mAllocationCount; }
+	std::uint32_t GetFreeBlockCount()const { return mFreeBlockCount; }
+
+	// alignment must be a power of two; anything below the granularity is implied.
+	Allocation Allocate(OffsetT size, OffsetT alignment = 1)
+	{
+		Allocation result;
+		if(size == 0)
+			return result;
+
+		assert((alignment & (alignment - 1)) == 0);
+		if(alignment < mGranularity)
+			alignment = mGranularity;
+
+		size = RoundUp(size, mGranularity);
+
+		// Searching for size + alignment - granularity guarantees that any block
+		// found can hold an aligned allocation of size.
+		const OffsetT search = size + (alignment - mGranularity);
+		if(search < size)
+			return result; // overflow
+
+		std::uint32_t node = FindFree(search);
+		if(node == InvalidNode)
+			return result;
+
+		RemoveFree(node);
+
+		// Give the padding in front of the aligned offset back as its own block.
+		const OffsetT aligned = RoundUp(mNodes[node].Offset, alignment);
+		const OffsetT padding = aligned - mNodes[node].Offset;
+		if(padding > 0)
+		{
+			std::uint32_t front = SplitFront(node, padding);
+			InsertFree(front);
+		}
+
+		// Give the tail back.
+		if(mNodes[node].Size > size)
+		{
+			std::uint32_t tail = SplitBack(node, size);
+			InsertFree(tail);
+		}
+
+		mNodes[node].Free = false;
+		mUsed += mNodes[node].Size;
+		++mAllocationCount;
+
+		result.Offset = mNodes[node].Offset;
+		result.Size = mNodes[node].Size;
+		result.Node = node;
+		return result;
+	}
+
+	void Free(const Allocation& allocation)
+	{
+		if(!allocation.IsValid())
+			return;
+
+		std::uint32_t node = allocation.Node;
+		assert(node < mNodes.size() && !mNodes[node].Free && mNodes[node].Offset == allocation.Offset);
+
+		mUsed -= mNodes[node].Size;
+		--mAllocationCount;
+		mNodes[node].Free = true;
+
+		// Merge with free physical neighbours.
+		std::uint32_t next = mNodes[node].NextPhys;
+		if(next != InvalidNode && mNodes[next].Free)
+		{
+			RemoveFree(next);
+			mNodes[node].Size += mNodes[next].Size;
+			UnlinkPhys(next);
+			ReleaseNode(next);
+		}
+
+		std::uint32_t prev = mNodes[node].PrevPhys;
+		if(prev != InvalidNode && mNodes[prev].Free)
+		{
+			RemoveFree(prev);
+			mNodes[prev].Size += mNodes[node].Size;
+			UnlinkPhys(node);
+			ReleaseNode(node);
+			node = prev;
+		}
+
+		InsertFree(node);
+	}
+
+	// Size of the largest free block, i.e. the largest unaligned allocation that
+	// can currently succeed.
+	OffsetT GetLargestFreeBlock()const
+	{
+		if(mFlBitmap == 0)
+			return 0;
+
+		// Blocks within the top class differ in size; walk its list for the maximum.
+		const std::uint32_t fl = Log2(mFlBitmap);
+		const std::uint32_t sl = Log2(mSlBitmap[fl]);
+
+		OffsetT largest = 0;
+		for(std::uint32_t n = mFreeHeads[fl][sl]; n != InvalidNode; n = mNodes[n].NextFree)
+			largest = mNodes[n].Size > largest ? mNodes[n].Size : largest;
+		return largest;
+	}
+
+	// Live allocations that sit between free blocks, smallest first.  Moving one
+	// of them merges its two free neighbours, which is the cheapest way to turn
+	// fragmented free space back into large blocks.
+	void GetDefragCandidates(std::vector<Allocation>& out, std::size_t maxCount)const
+	{
+		out.clear();
+		if(maxCount == 0)
+			return;
+
+		for(std::uint32_t n = mFirstPhys; n != InvalidNode; n = mNodes[n].NextPhys)
+		{
+			const Node& block = mNodes[n];
+			if(block.Free)
+				continue;
+
+			const bool prevFree = block.PrevPhys != InvalidNode && mNodes[block.PrevPhys].Free;
+			const bool nextFree = block.NextPhys != InvalidNode && mNodes[block.NextPhys].Free;
+			if(!prevFree || !nextFree)
+				continue;
+
+			Allocation candidate;
+			candidate.Offset = block.Offset;
+			candidate.Size = block.Size;
+			candidate.Node = n;
+
+			// Keep the smallest maxCount candidates, sorted by size.
+			std::size_t pos = out.size();
+			while(pos > 0 && out[pos - 1].Size > candidate.Size)
+				--pos;
+
+			if(pos >= maxCount)
+				continue;
+
+			out.insert(out.begin() + pos, candidate);
+			if(out.size() > maxCount)
+				out.pop_back();
+		}
+	}
+
+	// Free space outside the largest free block, as a fraction of all free space.
+	float GetFragmentation()const
+	{
+		const OffsetT freeSize = GetFreeSize();
+		if(freeSize == 0)
+			return 0.0f;
+
+		return 1.0f - static_cast<float>(GetLargestFreeBlock()) / static_cast<float>(freeSize);
+	}
+
+private:
+	static const std::uint32_t SlLog2 = 4;
+	static const std::uint32_t SlCount = 1u << SlLog2;
+	static const std::uint32_t FlCount = 64;
+
+	struct Node
+	{
+		OffsetT Offset = 0;
+		OffsetT Size = 0;
+		std::uint32_t PrevPhys = InvalidNode;
+		std::uint32_t NextPhys = InvalidNode;
+		std::uint32_t PrevFree = InvalidNode;
+		std::uint32_t NextFree = InvalidNode;
+		bool Free = false;
+	};
+
+	static std::uint32_t Log2(std::uint64_t v)
+	{
+		assert(v != 0);
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, v);
+		return index;
+#else
+		return 63u - static_cast<std::uint32_t>(__builtin_clzll(v));
+#endif
+	}
+
+	static std::uint32_t LowestBit(std::uint64_t v)
+	{
+		assert(v != 0);
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, v);
+		return index;
+#else
+		return static_cast<std::uint32_t>(__builtin_ctzll(v));
+#endif
+	}
+
+	static OffsetT RoundUp(OffsetT v, OffsetT alignment)
+	{
+		return (v + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Size class that contains size.
+	void Mapping(OffsetT size, std::uint32_t& fl, std::uint32_t& sl)const
+	{
+		const std::uint64_t units = static_cast<std::uint64_t>(size) >> mGranularityLog2;
+		if(units < SlCount)
+		{
+			fl = 0;
+			sl = static_cast<std::uint32_t>(units);
+			return;
+		}
+
+		const std::uint32_t log2 = Log2(units);
+		fl = log2 - SlLog2 + 1;
+		sl = static_cast<std::uint32_t>(units >> (log2 - SlLog2)) - SlCount;
+	}
+
+	// First non-empty class whose blocks are all >= size.
+	std::uint32_t FindFree(OffsetT size)const
+	{
+		std::uint64_t units = static_cast<std::uint64_t>(size) >> mGranularityLog2;
+		if(units >= SlCount)
+		{
+			// Round up to the next class boundary so every block in it fits.
+			const std::uint32_t log2 = Log2(units);
+			const std::uint64_t step = (1ull << (log2 - SlLog2)) - 1;
+			if(units + step < units)
+				return InvalidNode;
+			units += step;
+		}
+
+		std::uint32_t fl, sl;
+		Mapping(static_cast<OffsetT>(units << mGranularityLog2), fl, sl);
+		if(fl >= FlCount)
+			return InvalidNode;
+
+		std::uint64_t slMap = mSlBitmap[fl] & (~0ull << sl);
+		if(slMap == 0)
+		{
+			if(fl + 1 >= FlCount)
+				return InvalidNode;
+
+			const std::uint64_t flMap = mFlBitmap & (~0ull << (fl + 1));
+			if(flMap == 0)
+				return InvalidNode;
+
+			fl = LowestBit(flMap);
+			slMap = mSlBitmap[fl];
+		}
+
+		sl = LowestBit(slMap);
+		return mFreeHeads[fl][sl];
+	}
+
+	void InsertFree(std::uint32_t node)
+	{
+		std::uint32_t fl, sl;
+		Mapping(mNodes[node].Size, fl, sl);
+
+		Node& block = mNodes[node];
+		block.Free = true;
+		block.PrevFree = InvalidNode;
+		block.NextFree = mFreeHeads[fl][sl];
+		if(block.NextFree != InvalidNode)
+			mNodes[block.NextFree].PrevFree = node;
+
+		mFreeHeads[fl][sl] = node;
+		mFlBitmap |= 1ull << fl;
+		mSlBitmap[fl] |= 1ull << sl;
+		++mFreeBlockCount;
+	}
+
+	void RemoveFree(std::uint32_t node)
+	{
+		std::uint32_t fl, sl;
+		Mapping(mNodes[node].Size, fl, sl);
+
+		Node& block = mNodes[node];
+		if(block.PrevFree != InvalidNode)
+			mNodes[block.PrevFree].NextFree = block.NextFree;
+		else
+			mFreeHeads[fl][sl] = block.NextFree;
+
+		if(block.NextFree != InvalidNode)
+			mNodes[block.NextFree].PrevFree = block.PrevFree;
+
+		if(mFreeHeads[fl][sl] == InvalidNode)
+		{
+			mSlBitmap[fl] &= ~(1ull << sl);
+			if(mSlBitmap[fl] == 0)
+				mFlBitmap &= ~(1ull << fl);
+		}
+
+		block.PrevFree = InvalidNode;
+		block.NextFree = InvalidNode;
+		block.Free = false;
+		--mFreeBlockCount;
+	}
+
+	// Cuts the first size bytes of node off into a new node placed before it.
+	std::uint32_t SplitFront(std::uint32_t node, OffsetT size)
+	{
+		std::uint32_t front = NewNode();
+		Node& block = mNodes[node];
+		Node& head = mNodes[front];
+
+		head.Offset = block.Offset;
+		head.Size = size;
+		block.Offset += size;
+		block.Size -= size;
+
+		head.PrevPhys = block.PrevPhys;
+		head.NextPhys = node;
+		if(block.PrevPhys != InvalidNode)
+			mNodes[block.PrevPhys].NextPhys = front;
+		else
+			mFirstPhys = front;
+		block.PrevPhys = front;
+
+		return front;
+	}
+
+	// Keeps the first size bytes in node and returns a new node for the rest.
+	std::uint32_t SplitBack(std::uint32_t node, OffsetT size)
+	{
+		std::uint32_t back = NewNode();
+		Node& block = mNodes[node];
+		Node& tail = mNodes[back];
+
+		tail.Offset = block.Offset + size;
+		tail.Size = block.Size - size;
+		block.Size = size;
+
+		tail.PrevPhys = node;
+		tail.NextPhys = block.NextPhys;
+		if(block.NextPhys != InvalidNode)
+			mNodes[block.NextPhys].PrevPhys = back;
+		block.NextPhys = back;
+
+		return back;
+	}
+
+	void UnlinkPhys(std::uint32_t node)
+	{
+		Node& block = mNodes[node];
+		if(block.PrevPhys != InvalidNode)
+			mNodes[block.PrevPhys].NextPhys = block.NextPhys;
+		else
+			mFirstPhys = block.NextPhys;
+
+		if(block.NextPhys != InvalidNode)
+			mNodes[block.NextPhys].PrevPhys = block.PrevPhys;
+	}
+
+	// Node records are recycled through a free index list so the vector stops
+	// growing once the allocator reaches its steady state.
+	std::uint32_t NewNode()
+	{
+		std::uint32_t node;
+		if(mUnusedNodes.empty())
+		{
+			node = static_cast<std::uint32_t>(mNodes.size());
+			mNodes.emplace_back();
+		}
+		else
+		{
+			node = mUnusedNodes.back();
+			mUnusedNodes.pop_back();
+			mNodes[node] = Node();
+		}
+
+		if(mFirstPhys == InvalidNode)
+			mFirstPhys = node;
+		return node;
+	}
+
+	void ReleaseNode(std::uint32_t node)
+	{
+		mUnusedNodes.push_back(node);
+	}
+
+private:
+	OffsetT mSize = 0;
+	OffsetT mGranularity = 0;
+	std::uint32_t mGranularityLog2 = 0;
+
+	std::vector<Node> mNodes;
+	std::vector<std::uint32_t> mUnusedNodes;
+	std::uint32_t mFirstPhys = InvalidNode;
+
+	std::uint64_t mFlBitmap = 0;
+	std::uint64_t mSlBitmap[FlCount];
+	std::uint32_t mFreeHeads[FlCount][SlCount];
+
+	OffsetT mUsed = 0;
+	std::uint32_t mAllocationCount = 0;
+	std::uint32_t mFreeBlockCount = 0;
+};
@@ -0,0 +1,125 @@
+#include "UploadRing.h"
+
+UploadRing::UploadRing(ID3D12Device* device, UINT64 capacity)
+: mDevice(device), mAllocator(capacity)
+{
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+
+    ThrowIfFailed(device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&mUploadBuffer)));
+
+    // Upload heaps may stay mapped for their whole lifetime.
+    ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+}
+
+UploadRing::~UploadRing()
+{
+    if(mUploadBuffer != nullptr)
+        mUploadBuffer->Unmap(0, nullptr);
+
+    mMappedData = nullptr;
+}
+
+void UploadRing::SetOversizeFallback(bool enable)
+{
+    mOversizeFallback = enable;
+}
+
+bool UploadRing::Allocate(UINT64 size, UINT64 alignment, UINT64 fenceValue, Allocation& out)
+{
+    if(size > mAllocator.GetCapacity())
+        return mOversizeFallback && AllocateOversize(size, fenceValue, out);
+
+    UINT64 offset = mAllocator.Allocate(size, alignment, fenceValue);
+    if(offset == RingAllocator::InvalidOffset)
+        return false;
+
+    out.CpuAddress = mMappedData + offset;
+    out.GpuAddress = mUploadBuffer->GetGPUVirtualAddress() + offset;
+    out.Resource = mUploadBuffer.Get();
+    out.Offset = offset;
+    out.Size = size;
+
+    return true;
+}
+
+bool UploadRing::AllocateOversize(UINT64 size, UINT64 fenceValue, Allocation& out)
+{
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    OversizeBuffer buffer;
+    if(FAILED(mDevice->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&buffer.Resource))))
+    {
+        return false;
+    }
+
+    // Stays mapped until the buffer is released, like the ring itself.
+    BYTE* mapped = nullptr;
+    if(FAILED(buffer.Resource->Map(0, nullptr, reinterpret_cast<void**>(&mapped))))
+        return false;
+
+    out.CpuAddress = mapped;
+    out.GpuAddress = buffer.Resource->GetGPUVirtualAddress();
+    out.Resource = buffer.Resource.Get();
+    out.Offset = 0;
+    out.Size = size;
+
+    buffer.Size = size;
+    buffer.FenceValue = fenceValue;
+    mOversizeBuffers.push_back(std::move(buffer));
+    mOversizeBytes += size;
+
+    return true;
+}
+
+void UploadRing::Reclaim(UINT64 completedFenceValue)
+{
+    mAllocator.Reclaim(completedFenceValue);
+
+    for(size_t i = 0; i < mOversizeBuffers.size();)
+    {
+        if(mOversizeBuffers[i].FenceValue <= completedFenceValue)
+        {
+            mOversizeBytes -= mOversizeBuffers[i].Size;
+            mOversizeBuffers[i] = std::move(mOversizeBuffers.back());
+            mOversizeBuffers.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+ID3D12Resource* UploadRing::Resource()const
+{
+    return mUploadBuffer.Get();
+}
+
+UINT64 UploadRing::GetCapacity()const
+{
+    return mAllocator.GetCapacity();
+}
+
+UINT64 UploadRing::GetUsedBytes()const
+{
+    return mAllocator.GetUsedBytes();
+}
+
+UINT64 UploadRing::GetOversizeBytes()const
+{
+    return mOversizeBytes;
+}
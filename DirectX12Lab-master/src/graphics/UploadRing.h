@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Dx12Utils.h"
+#include "RingAllocator.h"
+
+// One persistently mapped upload heap shared by all transient CPU->GPU copies.
+//
+// Allocations are carved out of the heap by RingAllocator and tagged with the fence
+// value that will be signaled after the commands reading them.  Once the GPU passes
+// that fence, Reclaim() makes the space available again.  This replaces creating a
+// committed upload resource per buffer and keeping it alive in an *Uploader member.
+//
+// A request larger than the whole ring can never fit.  With the oversize fallback
+// enabled it gets a one-off committed upload buffer instead, released by Reclaim()
+// under the same fence rule; otherwise Allocate() fails for it right away.
+class UploadRing
+{
+public:
+    struct Allocation
+    {
+        BYTE* CpuAddress = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+        ID3D12Resource* Resource = nullptr;
+        UINT64 Offset = 0; // from the start of Resource
+        UINT64 Size = 0;
+    };
+
+    UploadRing(ID3D12Device* device, UINT64 capacity);
+    UploadRing(const UploadRing& rhs) = delete;
+    UploadRing& operator=(const UploadRing& rhs) = delete;
+    ~UploadRing();
+
+    // Off by default, so streaming code sized around the ring fails oversize
+    // requests instead of creating heaps behind its back.
+    void SetOversizeFallback(bool enable);
+
+    // Returns false when the ring is full; reclaim (or wait on the fence) and retry.
+    // Also false, permanently, for size > GetCapacity() without the fallback.
+    bool Allocate(UINT64 size, UINT64 alignment, UINT64 fenceValue, Allocation& out);
+
+    void Reclaim(UINT64 completedFenceValue);
+
+    ID3D12Resource* Resource()const;
+    UINT64 GetCapacity()const;
+    UINT64 GetUsedBytes()const;
+
+    // Bytes held by one-off oversize buffers the GPU may still read.
+    UINT64 GetOversizeBytes()const;
+
+private:
+    bool AllocateOversize(UINT64 size, UINT64 fenceValue, Allocation& out);
+
+    struct OversizeBuffer
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+        UINT64 Size = 0;
+        UINT64 FenceValue = 0;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+    BYTE* mMappedData = nullptr;
+
+    RingAllocator mAllocator;
+
+    bool mOversizeFallback = false;
+    std::vector<OversizeBuffer> mOversizeBuffers;
+    UINT64 mOversizeBytes = 0;
+};
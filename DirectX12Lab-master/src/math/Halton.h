@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Returns the index-th element of the Halton low-discrepancy sequence for the
+// given prime base, in [0, 1).  Index 0 yields 0, so callers usually start at 1.
+inline float Halton(std::uint32_t index, std::uint32_t base)
+{
+	// Radical inverse: mirror the base-b digits of index around the radix point.
+	float result = 0.0f;
+	float f = 1.0f;
+	const float invBase = 1.0f / (float)base;
+
+	while(index > 0)
+	{
+		f *= invBase;
+		result += f * (float)(index % base);
+		index /= base;
+	}
+
+	return result;
+}
@@ -0,0 +1,166 @@
+#include "AsyncTextureLoader.h"
+
+AsyncTextureLoader::AsyncTextureLoader(unsigned workerCount)
+{
+	if(workerCount == 0)
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	mWorkers.reserve(workerCount);
+	for(unsigned i = 0; i < workerCount; ++i)
+		mWorkers.emplace_back(&AsyncTextureLoader::WorkerMain, this);
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mJobMutex);
+		mStopping = true;
+	}
+	mJobReady.notify_all();
+
+	for(std::thread& worker : mWorkers)
+		worker.join();
+
+	// Workers are gone, so nothing is half pushed any more.
+	while(LoadedTexture* texture = mCompleted.Pop())
+		delete texture;
+}
+
+std::uint64_t AsyncTextureLoader::Request(const std::string& path, void* userData)
+{
+	auto texture = std::make_unique<LoadedTexture>();
+	texture->RequestId = mNextRequestId.fetch_add(1, std::memory_order_relaxed);
+	texture->Path = path;
+	texture->UserData = userData;
+
+	const std::uint64_t id = texture->RequestId;
+	{
+		std::lock_guard<std::mutex> lock(mJobMutex);
+		mJobs.push_back(std::move(texture));
+		++mInFlight;
+		++mRequested;
+	}
+	mJobReady.notify_one();
+
+	return id;
+}
+
+std::uint32_t AsyncTextureLoader::ProcessCompletions(ITextureUploadTarget& target, std::uint64_t maxBytes)
+{
+	std::uint32_t uploaded = 0;
+	std::uint64_t bytes = 0;
+
+	while(uploaded == 0 || bytes < maxBytes)
+	{
+		std::unique_ptr<LoadedTexture> texture = std::move(mDeferred);
+		if(texture == nullptr)
+			texture.reset(mCompleted.Pop());
+		if(texture == nullptr)
+			break;
+
+		if(!texture->IsOk())
+		{
+			target.OnLoadFailed(*texture);
+			mFailed.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		const TextureUploadResult result = target.Upload(*texture);
+		if(result == TextureUpload_Busy)
+		{
+			mDeferred = std::move(texture);
+			break;
+		}
+		if(result == TextureUpload_Failed)
+		{
+			// Retrying would only stall everything behind it.
+			target.OnLoadFailed(*texture);
+			mFailed.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		bytes += texture->Image.GetBitSize();
+		++uploaded;
+		mUploaded.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return uploaded;
+}
+
+void AsyncTextureLoader::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(mJobMutex);
+	mIdle.wait(lock, [this]() { return mInFlight == 0; });
+}
+
+AsyncTextureLoader::Stats AsyncTextureLoader::GetStats()const
+{
+	Stats stats;
+	{
+		std::lock_guard<std::mutex> lock(mJobMutex);
+		stats.Requested = mRequested;
+		stats.InFlight = mInFlight;
+	}
+	stats.Loaded = mLoaded.load(std::memory_order_relaxed);
+	stats.Uploaded = mUploaded.load(std::memory_order_relaxed);
+	stats.Failed = mFailed.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void AsyncTextureLoader::WorkerMain()
+{
+	for(;;)
+	{
+		std::unique_ptr<LoadedTexture> texture;
+		{
+			std::unique_lock<std::mutex> lock(mJobMutex);
+			mJobReady.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+			if(mStopping)
+				return;
+
+			texture = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+
+		Load(*texture);
+		mLoaded.fetch_add(1, std::memory_order_relaxed);
+		mCompleted.Push(texture.release());
+
+		bool idle;
+		{
+			std::lock_guard<std::mutex> lock(mJobMutex);
+			idle = --mInFlight == 0;
+		}
+		if(idle)
+			mIdle.notify_all();
+	}
+}
+
+void AsyncTextureLoader::Load(LoadedTexture& texture)
+{
+	if(!texture.File.Open(texture.Path.c_str()))
+	{
+		texture.FileError = texture.File.GetError() != 0 ? texture.File.GetError() : -1;
+		texture.Result = DdsImage::Result_BadFile;
+		return;
+	}
+
+	texture.File.Prefetch(0, texture.File.Size());
+
+	texture.Result = texture.Image.Parse(texture.File.Data(), (size_t)texture.File.Size());
+	if(texture.Result != DdsImage::Result_Ok)
+		return;
+
+	// Fault the pixel data in here, not during the copy on the render thread.
+	const std::uint8_t* data = texture.Image.GetBitData();
+	const size_t size = texture.Image.GetBitSize();
+	std::uint8_t touched = 0;
+	for(size_t offset = 0; offset < size; offset += 4096)
+		touched ^= static_cast<const volatile std::uint8_t*>(data)[offset];
+	if(size > 0)
+		touched ^= static_cast<const volatile std::uint8_t*>(data)[size - 1];
+	(void)touched;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../core/MappedFile.h"
+#include "../core/MpscQueue.h"
+#include "DdsImage.h"
+
+// A DDS file opened and parsed by a loader worker.
+struct LoadedTexture : public MpscNode
+{
+	std::uint64_t RequestId = 0;
+	std::string Path;
+	void* UserData = nullptr;
+
+	DdsImage::Result Result = DdsImage::Result_Ok;
+	int FileError = 0; // GetLastError()/errno when the file could not be opened
+
+	MappedFile File;
+	DdsImage Image;    // points into File
+
+	bool IsOk()const { return FileError == 0 && Result == DdsImage::Result_Ok; }
+};
+
+enum TextureUploadResult
+{
+	TextureUpload_Done,
+	TextureUpload_Busy,   // out of staging space; offered again next ProcessCompletions()
+	TextureUpload_Failed, // can never be uploaded, e.g. larger than all the staging space
+};
+
+// Where parsed textures go on the render thread; a D3D12 implementation records
+// the copies, tests use a mock.
+class ITextureUploadTarget
+{
+public:
+	virtual ~ITextureUploadTarget() = default;
+
+	// Copy what is needed out of texture; it is unmapped after the call.  A busy
+	// target is offered the same texture again on the next ProcessCompletions(),
+	// a failed one gets OnLoadFailed() for it instead.
+	virtual TextureUploadResult Upload(const LoadedTexture& texture) = 0;
+
+	// The file could not be opened, is not a usable DDS or could not be uploaded.
+	virtual void OnLoadFailed(const LoadedTexture& texture) { (void)texture; }
+};
+
+// Loads DDS files on worker threads so the render thread never waits for disk.
+//
+// Request() queues a file.  A worker maps it, parses and validates it with
+// DdsImage and touches every page of the pixel data so it is in memory before the
+// render thread sees it.  Finished files go through a lock-free MpscQueue; the
+// render thread drains it with ProcessCompletions(), which only hands the data to
+// the upload target (recording copy commands), limited to a byte budget per call
+// to keep frame times flat while a level streams in.
+class AsyncTextureLoader
+{
+public:
+	struct Stats
+	{
+		std::uint64_t Requested = 0;
+		std::uint64_t Loaded = 0;     // parsed by workers (including failures)
+		std::uint64_t Uploaded = 0;
+		std::uint64_t Failed = 0;
+		std::uint32_t InFlight = 0;   // requested, not yet parsed
+	};
+
+	// workerCount 0 = one less than the hardware threads, at least one.
+	explicit AsyncTextureLoader(unsigned workerCount = 0);
+	AsyncTextureLoader(const AsyncTextureLoader& rhs) = delete;
+	AsyncTextureLoader& operator=(const AsyncTextureLoader& rhs) = delete;
+
+	// Stops the workers; files not yet uploaded are dropped.
+	~AsyncTextureLoader();
+
+	// Any thread.  path is UTF-8.  Returns the RequestId of the LoadedTexture.
+	std::uint64_t Request(const std::string& path, void* userData = nullptr);
+
+	// Render thread.  Offers parsed textures to target until maxBytes of pixel data
+	// were uploaded (at least one texture per call) or target refuses one.
+	// Returns the number uploaded.
+	std::uint32_t ProcessCompletions(ITextureUploadTarget& target, std::uint64_t maxBytes = ~0ull);
+
+	// Blocks until every request so far has been parsed, e.g. behind a loading screen.
+	void WaitIdle();
+
+	Stats GetStats()const;
+
+	unsigned GetWorkerCount()const { return (unsigned)mWorkers.size(); }
+
+private:
+	void WorkerMain();
+	static void Load(LoadedTexture& texture);
+
+private:
+	std::vector<std::thread> mWorkers;
+
+	mutable std::mutex mJobMutex;
+	std::condition_variable mJobReady;
+	std::condition_variable mIdle;
+	std::deque<std::unique_ptr<LoadedTexture>> mJobs;
+	std::uint32_t mInFlight = 0;
+	bool mStopping = false;
+
+	MpscQueue<LoadedTexture> mCompleted;
+
+	// Refused by the upload target last time; render thread only.
+	std::unique_ptr<LoadedTexture> mDeferred;
+
+	std::atomic<std::uint64_t> mNextRequestId{ 1 };
+	std::atomic<std::uint64_t> mLoaded{ 0 };
+	std::uint64_t mRequested = 0; // under mJobMutex
+	std::atomic<std::uint64_t> mUploaded{ 0 }; // written by the render thread only
+	std::atomic<std::uint64_t> mFailed{ 0 };
+};
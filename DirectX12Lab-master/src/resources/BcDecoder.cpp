@@ -0,0 +1,606 @@
+#include "BcDecoder.h"
+#include "BcTables.h"
+#include "../core/ParallelFor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BC_DECODER_SSE2 1
+#include <emmintrin.h>
+#else
+#define BC_DECODER_SSE2 0
+#endif
+
+namespace
+{
+	typedef void (*BlockDecoder)(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+
+	// Blocks per ParallelFor item; below this a surface is decoded on the calling thread only.
+	const size_t MinBlocksPerBand = 4096;
+
+	inline std::uint64_t Load64(const std::uint8_t* p)
+	{
+		std::uint64_t v;
+		memcpy(&v, p, sizeof(v)); // DDS data is little-endian, like every D3D target
+		return v;
+	}
+
+	//----------------------------------------------------------------------------
+	// Palettes
+	//----------------------------------------------------------------------------
+
+	// The 16 3-bit indices of a BC4 block, one byte each in pixel order.
+	void UnpackChannelIndices(const std::uint8_t* block, std::uint8_t indices[16])
+	{
+		const std::uint64_t bits = Load64(block) >> 16;
+		for(int i = 0; i < 16; ++i)
+			indices[i] = (std::uint8_t)((bits >> (3 * i)) & 7);
+	}
+
+	//----------------------------------------------------------------------------
+	// Scalar reference path
+	//----------------------------------------------------------------------------
+
+	void WriteColorsScalar(const std::uint32_t palette[4], const std::uint8_t* indexBytes,
+		std::uint8_t* dest, size_t destRowPitch)
+	{
+		for(int row = 0; row < 4; ++row)
+		{
+			std::uint8_t* out = dest + row * destRowPitch;
+			const std::uint32_t bits = indexBytes[row];
+			for(int col = 0; col < 4; ++col)
+				memcpy(out + col * 4, &palette[(bits >> (2 * col)) & 3], 4);
+		}
+	}
+
+	// channel: byte offset within each output pixel of pixelSize bytes.
+	void WriteChannelScalar(const std::uint8_t* channelBlock, std::uint8_t* dest, size_t destRowPitch,
+		size_t pixelSize, size_t channel)
+	{
+		std::uint8_t palette[8];
+		std::uint8_t indices[16];
+		BcBuildChannelPalette(channelBlock, palette);
+		UnpackChannelIndices(channelBlock, indices);
+
+		for(int i = 0; i < 16; ++i)
+			dest[(i >> 2) * destRowPitch + (i & 3) * pixelSize + channel] = palette[indices[i]];
+	}
+
+	void DecodeBC1Scalar(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block, true, palette);
+		WriteColorsScalar(palette, block + 4, dest, destRowPitch);
+	}
+
+	void DecodeBC2Scalar(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block + 8, false, palette);
+		WriteColorsScalar(palette, block + 12, dest, destRowPitch);
+
+		const std::uint64_t alpha = Load64(block);
+		for(int i = 0; i < 16; ++i)
+			dest[(i >> 2) * destRowPitch + (i & 3) * 4 + 3] = (std::uint8_t)(((alpha >> (4 * i)) & 15) * 17);
+	}
+
+	void DecodeBC3Scalar(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block + 8, false, palette);
+		WriteColorsScalar(palette, block + 12, dest, destRowPitch);
+		WriteChannelScalar(block, dest, destRowPitch, 4, 3);
+	}
+
+	void DecodeBC4Scalar(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		WriteChannelScalar(block, dest, destRowPitch, 1, 0);
+	}
+
+	void DecodeBC5Scalar(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		WriteChannelScalar(block, dest, destRowPitch, 2, 0);
+		WriteChannelScalar(block + 8, dest, destRowPitch, 2, 1);
+	}
+
+	//----------------------------------------------------------------------------
+	// SSE2 path
+	//----------------------------------------------------------------------------
+#if BC_DECODER_SSE2
+
+	// Four rows of four RGBA pixels.  Each lane isolates its pixel's 2-bit index
+	// in place (row byte & (3 << 2 * col)) and compares it with every possible
+	// index shifted the same way.
+	void BuildColorRowsSse2(const std::uint32_t palette[4], const std::uint8_t* indexBytes, __m128i rows[4])
+	{
+		const __m128i laneMask = _mm_setr_epi32(3, 3 << 2, 3 << 4, 3 << 6);
+		const __m128i index1 = _mm_setr_epi32(1, 1 << 2, 1 << 4, 1 << 6);
+		const __m128i index2 = _mm_setr_epi32(2, 2 << 2, 2 << 4, 2 << 6);
+
+		const __m128i color0 = _mm_set1_epi32((int)palette[0]);
+		const __m128i color1 = _mm_set1_epi32((int)palette[1]);
+		const __m128i color2 = _mm_set1_epi32((int)palette[2]);
+		const __m128i color3 = _mm_set1_epi32((int)palette[3]);
+
+		for(int row = 0; row < 4; ++row)
+		{
+			const __m128i idx = _mm_and_si128(_mm_set1_epi32(indexBytes[row]), laneMask);
+
+			__m128i out = _mm_and_si128(_mm_cmpeq_epi32(idx, _mm_setzero_si128()), color0);
+			out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi32(idx, index1), color1));
+			out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi32(idx, index2), color2));
+			out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi32(idx, laneMask), color3));
+			rows[row] = out;
+		}
+	}
+
+	// The 16 decoded values of a BC4 block, in pixel order.
+	__m128i DecodeChannelSse2(const std::uint8_t* channelBlock)
+	{
+		alignas(16) std::uint8_t indices[16];
+		std::uint8_t palette[8];
+		BcBuildChannelPalette(channelBlock, palette);
+		UnpackChannelIndices(channelBlock, indices);
+
+		const __m128i idx = _mm_load_si128(reinterpret_cast<const __m128i*>(indices));
+
+		__m128i out = _mm_setzero_si128();
+		for(int k = 0; k < 8; ++k)
+		{
+			const __m128i match = _mm_cmpeq_epi8(idx, _mm_set1_epi8((char)k));
+			out = _mm_or_si128(out, _mm_and_si128(match, _mm_set1_epi8((char)palette[k])));
+		}
+		return out;
+	}
+
+	// Replaces the alpha byte of the RGBA rows with the 16 bytes in alpha.
+	void MergeAlphaSse2(__m128i rows[4], __m128i alpha)
+	{
+		const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i zero = _mm_setzero_si128();
+
+		const __m128i lo = _mm_unpacklo_epi8(zero, alpha); // pixels 0-7, alpha in the high byte
+		const __m128i hi = _mm_unpackhi_epi8(zero, alpha); // pixels 8-15
+
+		rows[0] = _mm_or_si128(_mm_and_si128(rows[0], rgbMask), _mm_unpacklo_epi16(zero, lo));
+		rows[1] = _mm_or_si128(_mm_and_si128(rows[1], rgbMask), _mm_unpackhi_epi16(zero, lo));
+		rows[2] = _mm_or_si128(_mm_and_si128(rows[2], rgbMask), _mm_unpacklo_epi16(zero, hi));
+		rows[3] = _mm_or_si128(_mm_and_si128(rows[3], rgbMask), _mm_unpackhi_epi16(zero, hi));
+	}
+
+	void StoreRowsSse2(const __m128i rows[4], std::uint8_t* dest, size_t destRowPitch)
+	{
+		for(int row = 0; row < 4; ++row)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + row * destRowPitch), rows[row]);
+	}
+
+	void DecodeBC1Sse2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block, true, palette);
+
+		__m128i rows[4];
+		BuildColorRowsSse2(palette, block + 4, rows);
+		StoreRowsSse2(rows, dest, destRowPitch);
+	}
+
+	void DecodeBC2Sse2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block + 8, false, palette);
+
+		__m128i rows[4];
+		BuildColorRowsSse2(palette, block + 12, rows);
+
+		// Split the nibbles into bytes and scale 0..15 to 0..255 (x * 17).
+		const __m128i nibbles = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+		const __m128i lowMask = _mm_set1_epi8(0x0F);
+		const __m128i low = _mm_and_si128(nibbles, lowMask);
+		const __m128i high = _mm_and_si128(_mm_srli_epi16(nibbles, 4), lowMask);
+		const __m128i alpha4 = _mm_unpacklo_epi8(low, high);
+		const __m128i alpha = _mm_or_si128(alpha4, _mm_slli_epi16(alpha4, 4)); // no carries between bytes
+
+		MergeAlphaSse2(rows, alpha);
+		StoreRowsSse2(rows, dest, destRowPitch);
+	}
+
+	void DecodeBC3Sse2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		std::uint32_t palette[4];
+		BcBuildColorPalette(block + 8, false, palette);
+
+		__m128i rows[4];
+		BuildColorRowsSse2(palette, block + 12, rows);
+		MergeAlphaSse2(rows, DecodeChannelSse2(block));
+		StoreRowsSse2(rows, dest, destRowPitch);
+	}
+
+	void DecodeBC4Sse2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		alignas(16) std::uint8_t values[16];
+		_mm_store_si128(reinterpret_cast<__m128i*>(values), DecodeChannelSse2(block));
+
+		for(int row = 0; row < 4; ++row)
+			memcpy(dest + row * destRowPitch, values + row * 4, 4);
+	}
+
+	void DecodeBC5Sse2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		const __m128i red = DecodeChannelSse2(block);
+		const __m128i green = DecodeChannelSse2(block + 8);
+
+		const __m128i rg01 = _mm_unpacklo_epi8(red, green); // rows 0 and 1
+		const __m128i rg23 = _mm_unpackhi_epi8(red, green); // rows 2 and 3
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest), rg01);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + destRowPitch), _mm_srli_si128(rg01, 8));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 2 * destRowPitch), rg23);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 3 * destRowPitch), _mm_srli_si128(rg23, 8));
+	}
+
+#endif // BC_DECODER_SSE2
+
+	//----------------------------------------------------------------------------
+	// BC7
+	//----------------------------------------------------------------------------
+
+	// LSB-first reader over the 128 bits of a block.
+	class Bc7BitReader
+	{
+	public:
+		explicit Bc7BitReader(const std::uint8_t* block)
+		: mLow(Load64(block)), mHigh(Load64(block + 8))
+		{
+		}
+
+		std::uint32_t Read(unsigned count)
+		{
+			if(count == 0)
+				return 0;
+
+			std::uint64_t value;
+			if(mPos >= 64)
+			{
+				value = mHigh >> (mPos - 64);
+			}
+			else
+			{
+				value = mLow >> mPos;
+				if(mPos + count > 64)
+					value |= mHigh << (64 - mPos);
+			}
+
+			mPos += count;
+			return (std::uint32_t)(value & ((1u << count) - 1));
+		}
+
+		void Skip(unsigned count) { mPos += count; }
+
+	private:
+		std::uint64_t mLow;
+		std::uint64_t mHigh;
+		unsigned mPos = 0;
+	};
+
+	void DecodeBC7Block(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+	{
+		unsigned modeIndex = 0;
+		while(modeIndex < 8 && (block[0] & (1u << modeIndex)) == 0)
+			++modeIndex;
+
+		// Reserved mode: transparent black, as D3D decodes it.
+		if(modeIndex == 8)
+		{
+			for(int row = 0; row < 4; ++row)
+				memset(dest + row * destRowPitch, 0, 16);
+			return;
+		}
+
+		const Bc7Mode& mode = Bc7Modes[modeIndex];
+		Bc7BitReader bits(block);
+		bits.Skip(modeIndex + 1);
+
+		const unsigned partition = bits.Read(mode.PartitionBits);
+		const unsigned rotation = bits.Read(mode.RotationBits);
+		const unsigned indexSelection = bits.Read(mode.IndexSelectionBits);
+
+		const unsigned numEndpoints = mode.NumSubsets * 2u;
+		std::uint32_t endpoints[6][4];
+
+		for(unsigned channel = 0; channel < 3; ++channel)
+		{
+			for(unsigned e = 0; e < numEndpoints; ++e)
+				endpoints[e][channel] = bits.Read(mode.ColorBits);
+		}
+
+		for(unsigned e = 0; e < numEndpoints; ++e)
+			endpoints[e][3] = mode.AlphaBits > 0 ? bits.Read(mode.AlphaBits) : 255;
+
+		unsigned colorBits = mode.ColorBits;
+		unsigned alphaBits = mode.AlphaBits;
+		if(mode.EndpointPBits != 0 || mode.SharedPBits != 0)
+		{
+			std::uint32_t pbits[6];
+			if(mode.EndpointPBits != 0)
+			{
+				for(unsigned e = 0; e < numEndpoints; ++e)
+					pbits[e] = bits.Read(1);
+			}
+			else
+			{
+				for(unsigned s = 0; s < mode.NumSubsets; ++s)
+					pbits[2 * s] = pbits[2 * s + 1] = bits.Read(1);
+			}
+
+			for(unsigned e = 0; e < numEndpoints; ++e)
+			{
+				for(unsigned channel = 0; channel < 3; ++channel)
+					endpoints[e][channel] = (endpoints[e][channel] << 1) | pbits[e];
+				if(mode.AlphaBits > 0)
+					endpoints[e][3] = (endpoints[e][3] << 1) | pbits[e];
+			}
+
+			++colorBits;
+			if(alphaBits > 0)
+				++alphaBits;
+		}
+
+		for(unsigned e = 0; e < numEndpoints; ++e)
+		{
+			for(unsigned channel = 0; channel < 3; ++channel)
+				endpoints[e][channel] = Bc7Expand(endpoints[e][channel], colorBits);
+			if(alphaBits > 0)
+				endpoints[e][3] = Bc7Expand(endpoints[e][3], alphaBits);
+		}
+
+		std::uint8_t subsets[16];
+		std::uint8_t indices[16];
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			subsets[i] = (std::uint8_t)Bc7GetSubset(mode.NumSubsets, partition, i);
+			indices[i] = (std::uint8_t)bits.Read(Bc7IsAnchor(mode.NumSubsets, partition, i) ? mode.IndexBits - 1u : mode.IndexBits);
+		}
+
+		std::uint8_t indices2[16];
+		if(mode.IndexBits2 > 0)
+		{
+			for(unsigned i = 0; i < 16; ++i)
+				indices2[i] = (std::uint8_t)bits.Read(i == 0 ? mode.IndexBits2 - 1u : mode.IndexBits2);
+		}
+
+		// Mode 4's selection bit swaps which index set drives colour and alpha.
+		const std::uint8_t* colorIndices = indices;
+		const std::uint8_t* alphaIndices = mode.IndexBits2 > 0 ? indices2 : indices;
+		unsigned colorIndexBits = mode.IndexBits;
+		unsigned alphaIndexBits = mode.IndexBits2 > 0 ? mode.IndexBits2 : mode.IndexBits;
+		if(indexSelection != 0)
+		{
+			std::swap(colorIndices, alphaIndices);
+			std::swap(colorIndexBits, alphaIndexBits);
+		}
+
+		const std::uint8_t* colorWeights = Bc7WeightTable(colorIndexBits);
+		const std::uint8_t* alphaWeights = Bc7WeightTable(alphaIndexBits);
+
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			const std::uint32_t* e0 = endpoints[2 * subsets[i]];
+			const std::uint32_t* e1 = endpoints[2 * subsets[i] + 1];
+			const std::uint32_t cw = colorWeights[colorIndices[i]];
+			const std::uint32_t aw = alphaWeights[alphaIndices[i]];
+
+			std::uint8_t rgba[4];
+			rgba[0] = (std::uint8_t)Bc7Interpolate(e0[0], e1[0], cw);
+			rgba[1] = (std::uint8_t)Bc7Interpolate(e0[1], e1[1], cw);
+			rgba[2] = (std::uint8_t)Bc7Interpolate(e0[2], e1[2], cw);
+			rgba[3] = (std::uint8_t)Bc7Interpolate(e0[3], e1[3], aw);
+
+			if(rotation != 0)
+				std::swap(rgba[3], rgba[rotation - 1]);
+
+			memcpy(dest + (i >> 2) * destRowPitch + (i & 3) * 4, rgba, 4);
+		}
+	}
+
+	//----------------------------------------------------------------------------
+
+	BlockDecoder GetBlockDecoder(DXGI_FORMAT format, bool useSimd)
+	{
+#if BC_DECODER_SSE2
+		const bool simd = useSimd;
+#else
+		const bool simd = false;
+		(void)useSimd;
+#endif
+
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+#if BC_DECODER_SSE2
+			if(simd) return DecodeBC1Sse2;
+#endif
+			return DecodeBC1Scalar;
+
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+#if BC_DECODER_SSE2
+			if(simd) return DecodeBC2Sse2;
+#endif
+			return DecodeBC2Scalar;
+
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+#if BC_DECODER_SSE2
+			if(simd) return DecodeBC3Sse2;
+#endif
+			return DecodeBC3Scalar;
+
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+#if BC_DECODER_SSE2
+			if(simd) return DecodeBC4Sse2;
+#endif
+			return DecodeBC4Scalar;
+
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+#if BC_DECODER_SSE2
+			if(simd) return DecodeBC5Sse2;
+#endif
+			return DecodeBC5Scalar;
+
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return DecodeBC7Block;
+
+		default:
+			return nullptr;
+		}
+	}
+
+	void DecodeBlockRows(BlockDecoder decoder, size_t blockSize, size_t pixelSize,
+		const std::uint8_t* src, size_t srcRowPitch,
+		size_t width, size_t height,
+		std::uint8_t* dest, size_t destRowPitch,
+		size_t firstBlockRow, size_t endBlockRow)
+	{
+		const size_t blocksWide = (width + 3) / 4;
+
+		for(size_t by = firstBlockRow; by < endBlockRow; ++by)
+		{
+			const std::uint8_t* srcBlock = src + by * srcRowPitch;
+			const size_t rows = std::min<size_t>(4, height - by * 4);
+			std::uint8_t* destRow = dest + by * 4 * destRowPitch;
+
+			for(size_t bx = 0; bx < blocksWide; ++bx, srcBlock += blockSize)
+			{
+				const size_t cols = std::min<size_t>(4, width - bx * 4);
+				std::uint8_t* destBlock = destRow + bx * 4 * pixelSize;
+
+				if(rows == 4 && cols == 4)
+				{
+					decoder(srcBlock, destBlock, destRowPitch);
+					continue;
+				}
+
+				// Edge block: decode to a tile and copy the part inside the surface.
+				std::uint8_t tile[4 * 4 * 4];
+				decoder(srcBlock, tile, 4 * pixelSize);
+				for(size_t row = 0; row < rows; ++row)
+					memcpy(destBlock + row * destRowPitch, tile + row * 4 * pixelSize, cols * pixelSize);
+			}
+		}
+	}
+}
+
+bool BcDecoder::IsSupported(DXGI_FORMAT format)
+{
+	return GetBlockDecoder(format, false) != nullptr;
+}
+
+size_t BcDecoder::GetBlockSize(DXGI_FORMAT format)
+{
+	if(!IsSupported(format))
+		return 0;
+
+	switch(format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+		return 8;
+	default:
+		return 16;
+	}
+}
+
+size_t BcDecoder::GetOutputPixelSize(DXGI_FORMAT format)
+{
+	switch(format)
+	{
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+		return 1;
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+bool BcDecoder::Decode(DXGI_FORMAT format,
+	const std::uint8_t* src, size_t srcRowPitch,
+	size_t width, size_t height,
+	std::uint8_t* dest, size_t destRowPitch,
+	const BcDecodeOptions& options)
+{
+	BlockDecoder decoder = GetBlockDecoder(format, options.UseSimd);
+	if(decoder == nullptr || src == nullptr || dest == nullptr)
+		return false;
+
+	const size_t blockSize = GetBlockSize(format);
+	const size_t pixelSize = GetOutputPixelSize(format);
+	const size_t blocksWide = (width + 3) / 4;
+	const size_t blocksHigh = (height + 3) / 4;
+
+	// Bands of block rows, each about MinBlocksPerBand blocks, so small surfaces
+	// stay on the calling thread.
+	const size_t rowsPerBand = std::max<size_t>(MinBlocksPerBand / std::max<size_t>(blocksWide, 1), 1);
+	const size_t bandCount = (blocksHigh + rowsPerBand - 1) / rowsPerBand;
+
+	ParallelFor(bandCount, options.ThreadCount, [&](size_t band)
+	{
+		const size_t first = band * rowsPerBand;
+		DecodeBlockRows(decoder, blockSize, pixelSize, src, srcRowPitch, width, height,
+			dest, destRowPitch, first, std::min(first + rowsPerBand, blocksHigh));
+	});
+
+	return true;
+}
+
+bool BcDecoder::Decode(DXGI_FORMAT format, const DdsImage::Subresource& subresource,
+	std::uint8_t* dest, size_t destRowPitch,
+	const BcDecodeOptions& options)
+{
+	return Decode(format, subresource.Data, subresource.RowPitch,
+		subresource.Width, subresource.Height, dest, destRowPitch, options);
+}
+
+void BcDecoder::DecodeBlockBC1(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	GetBlockDecoder(DXGI_FORMAT_BC1_UNORM, true)(block, dest, destRowPitch);
+}
+
+void BcDecoder::DecodeBlockBC2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	GetBlockDecoder(DXGI_FORMAT_BC2_UNORM, true)(block, dest, destRowPitch);
+}
+
+void BcDecoder::DecodeBlockBC3(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	GetBlockDecoder(DXGI_FORMAT_BC3_UNORM, true)(block, dest, destRowPitch);
+}
+
+void BcDecoder::DecodeBlockBC4(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	GetBlockDecoder(DXGI_FORMAT_BC4_UNORM, true)(block, dest, destRowPitch);
+}
+
+void BcDecoder::DecodeBlockBC5(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	GetBlockDecoder(DXGI_FORMAT_BC5_UNORM, true)(block, dest, destRowPitch);
+}
+
+void BcDecoder::DecodeBlockBC7(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch)
+{
+	DecodeBC7Block(block, dest, destRowPitch);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DdsImage.h"
+
+// CPU decoder for block-compressed textures, for thumbnails, validating encoders
+// and devices without the format.
+//
+// BC1, BC2, BC3 and BC7 decode to RGBA8, BC4 to R8 and BC5 to RG8 (UNORM and
+// SRGB/TYPELESS variants; the bytes are the same, colour space is the caller's
+// business).  BC6H and the SNORM variants are not supported.
+//
+// BC1-BC5 palette lookups run in SSE2 where available: every pixel's index is
+// compared against each palette entry and the matching entries are OR-ed
+// together, so a block row is a handful of branchless vector ops.  BC7 modes are
+// chosen per block and decoded with scalar code.  Large surfaces are split into
+// bands of block rows decoded with ParallelFor.
+//
+// Interpolation follows the D3D rules with integer rounding; hardware decoders
+// may differ from it by one unit on BC1-BC3 interpolated colours.
+struct BcDecodeOptions
+{
+	unsigned ThreadCount = 0; // 0 = all hardware threads
+	bool UseSimd = true;      // false runs the scalar reference path
+};
+
+class BcDecoder
+{
+public:
+	static bool IsSupported(DXGI_FORMAT format);
+
+	// 8 for BC1/BC4, 16 for the others; 0 if unsupported.
+	static size_t GetBlockSize(DXGI_FORMAT format);
+
+	// Bytes per decoded pixel: 1 (R8) for BC4, 2 (RG8) for BC5, else 4 (RGBA8).
+	static size_t GetOutputPixelSize(DXGI_FORMAT format);
+
+	// Decodes width x height pixels.  src holds rows of 4x4 blocks srcRowPitch
+	// bytes apart; dest rows are destRowPitch bytes apart.  Blocks on the right
+	// and bottom edges are clipped.  Returns false for unsupported formats.
+	static bool Decode(DXGI_FORMAT format,
+		const std::uint8_t* src, size_t srcRowPitch,
+		size_t width, size_t height,
+		std::uint8_t* dest, size_t destRowPitch,
+		const BcDecodeOptions& options = BcDecodeOptions());
+
+	// One 2D subresource (or the first slice of a 3D one) of a parsed DDS.
+	static bool Decode(DXGI_FORMAT format, const DdsImage::Subresource& subresource,
+		std::uint8_t* dest, size_t destRowPitch,
+		const BcDecodeOptions& options = BcDecodeOptions());
+
+	// One block into a 4x4 tile of GetOutputPixelSize() pixels, rows destRowPitch apart.
+	static void DecodeBlockBC1(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+	static void DecodeBlockBC2(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+	static void DecodeBlockBC3(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+	static void DecodeBlockBC4(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+	static void DecodeBlockBC5(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+	static void DecodeBlockBC7(const std::uint8_t* block, std::uint8_t* dest, size_t destRowPitch);
+};
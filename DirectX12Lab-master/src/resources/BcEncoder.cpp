@@ -0,0 +1,1420 @@
+#include "BcEncoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "BcDecoder.h"
+#include "BcTables.h"
+#include "../core/ParallelFor.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BC_ENCODER_SSE2 1
+#include <emmintrin.h>
+#else
+#define BC_ENCODER_SSE2 0
+#endif
+
+namespace
+{
+	typedef void (*BlockEncoder)(const std::uint8_t* pixels, std::uint8_t* block, const BcEncodeOptions& options);
+
+	// Blocks per ParallelFor item.  Encoding costs far more per block than
+	// decoding, so bands are much smaller than BcDecoder's.
+	const size_t MinBlocksPerBand = 256;
+
+	//----------------------------------------------------------------------------
+	// Fitting helpers
+	//----------------------------------------------------------------------------
+
+	// Mean and unit principal axis of count points of channels (3 or 4) values.
+	void ComputePrincipalAxis(const float (*points)[4], size_t count, unsigned channels, float mean[4], float axis[4])
+	{
+		for(unsigned c = 0; c < 4; ++c)
+			mean[c] = axis[c] = 0.0f;
+		if(count == 0)
+			return;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			for(unsigned c = 0; c < channels; ++c)
+				mean[c] += points[i][c];
+		}
+		for(unsigned c = 0; c < channels; ++c)
+			mean[c] /= (float)count;
+
+		float cov[4][4] = {};
+		for(size_t i = 0; i < count; ++i)
+		{
+			float d[4];
+			for(unsigned c = 0; c < channels; ++c)
+				d[c] = points[i][c] - mean[c];
+			for(unsigned a = 0; a < channels; ++a)
+			{
+				for(unsigned b = a; b < channels; ++b)
+					cov[a][b] += d[a] * d[b];
+			}
+		}
+
+		unsigned largest = 0;
+		for(unsigned a = 0; a < channels; ++a)
+		{
+			for(unsigned b = 0; b < a; ++b)
+				cov[a][b] = cov[b][a];
+			if(cov[a][a] > cov[largest][largest])
+				largest = a;
+		}
+
+		if(cov[largest][largest] <= 0.0f)
+			return;
+
+		// Power iteration from the row of the largest variance.
+		float v[4] = {};
+		for(unsigned c = 0; c < channels; ++c)
+			v[c] = cov[largest][c];
+
+		for(int iteration = 0; iteration < 8; ++iteration)
+		{
+			float w[4] = {};
+			float norm = 0.0f;
+			for(unsigned a = 0; a < channels; ++a)
+			{
+				for(unsigned b = 0; b < channels; ++b)
+					w[a] += cov[a][b] * v[b];
+				norm = std::max(norm, std::fabs(w[a]));
+			}
+			if(norm == 0.0f)
+				break;
+			for(unsigned c = 0; c < channels; ++c)
+				v[c] = w[c] / norm;
+		}
+
+		float length = 0.0f;
+		for(unsigned c = 0; c < channels; ++c)
+			length += v[c] * v[c];
+		length = std::sqrt(length);
+		if(length == 0.0f)
+			return;
+
+		for(unsigned c = 0; c < channels; ++c)
+			axis[c] = v[c] / length;
+	}
+
+	// Endpoints at the extreme projections of the points on their principal axis.
+	void FitRange(const float (*points)[4], size_t count, unsigned channels, float e0[4], float e1[4])
+	{
+		float mean[4];
+		float axis[4];
+		ComputePrincipalAxis(points, count, channels, mean, axis);
+
+		float minT = 0.0f;
+		float maxT = 0.0f;
+		for(size_t i = 0; i < count; ++i)
+		{
+			float t = 0.0f;
+			for(unsigned c = 0; c < channels; ++c)
+				t += (points[i][c] - mean[c]) * axis[c];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for(unsigned c = 0; c < channels; ++c)
+		{
+			e0[c] = std::min(std::max(mean[c] + minT * axis[c], 0.0f), 255.0f);
+			e1[c] = std::min(std::max(mean[c] + maxT * axis[c], 0.0f), 255.0f);
+		}
+	}
+
+	// Least-squares endpoints for points reconstructed as w * e0 + (1 - w) * e1.
+	// Returns false when the weights do not determine both endpoints.
+	bool FitLeastSquares(const float (*points)[4], const float* weights, size_t count, unsigned firstChannel,
+		unsigned endChannel, float e0[4], float e1[4])
+	{
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float da[4] = {}, db[4] = {};
+		for(size_t i = 0; i < count; ++i)
+		{
+			const float a = weights[i];
+			const float b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for(unsigned c = firstChannel; c < endChannel; ++c)
+			{
+				da[c] += a * points[i][c];
+				db[c] += b * points[i][c];
+			}
+		}
+
+		const float det = aa * bb - ab * ab;
+		if(std::fabs(det) < 1e-6f)
+			return false;
+
+		const float inv = 1.0f / det;
+		for(unsigned c = firstChannel; c < endChannel; ++c)
+		{
+			e0[c] = std::min(std::max((bb * da[c] - ab * db[c]) * inv, 0.0f), 255.0f);
+			e1[c] = std::min(std::max((aa * db[c] - ab * da[c]) * inv, 0.0f), 255.0f);
+		}
+		return true;
+	}
+
+	inline int Square(int value)
+	{
+		return value * value;
+	}
+
+	//----------------------------------------------------------------------------
+	// BC1 / BC3 colour
+	//----------------------------------------------------------------------------
+
+	enum ColorMode
+	{
+		ColorMode_Bc3,      // always four colours, endpoint order free
+		ColorMode_Bc1Four,  // c0 > c1
+		ColorMode_Bc1Three, // c0 <= c1: three colours plus transparent black
+	};
+
+	struct ColorResult
+	{
+		std::uint16_t C0 = 0;
+		std::uint16_t C1 = 0;
+		std::uint32_t Indices = 0;
+		std::uint32_t Error = ~0u;
+	};
+
+	inline std::uint16_t Pack565(const float color[4])
+	{
+		const int r = std::min(std::max((int)(color[0] * 31.0f / 255.0f + 0.5f), 0), 31);
+		const int g = std::min(std::max((int)(color[1] * 63.0f / 255.0f + 0.5f), 0), 63);
+		const int b = std::min(std::max((int)(color[2] * 31.0f / 255.0f + 0.5f), 0), 31);
+		return (std::uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	inline int ColorDistance(std::uint32_t a, std::uint32_t b)
+	{
+		return Square((int)(a & 255) - (int)(b & 255))
+			+ Square((int)((a >> 8) & 255) - (int)((b >> 8) & 255))
+			+ Square((int)((a >> 16) & 255) - (int)((b >> 16) & 255));
+	}
+
+	// Nearest of the first paletteCount entries (RGB) for each pixel; ties go
+	// to the lower index.  Returns the summed error.
+	std::uint32_t AssignColorIndicesScalar(const std::uint32_t pixels[16], const std::uint32_t palette[4],
+		unsigned paletteCount, std::uint32_t& indices, std::uint32_t errors[16])
+	{
+		std::uint32_t total = 0;
+		indices = 0;
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			int best = ColorDistance(pixels[i], palette[0]);
+			unsigned bestIndex = 0;
+			for(unsigned k = 1; k < paletteCount; ++k)
+			{
+				const int distance = ColorDistance(pixels[i], palette[k]);
+				if(distance < best)
+				{
+					best = distance;
+					bestIndex = k;
+				}
+			}
+			indices |= bestIndex << (2 * i);
+			errors[i] = (std::uint32_t)best;
+			total += (std::uint32_t)best;
+		}
+		return total;
+	}
+
+#if BC_ENCODER_SSE2
+	// Four pixels per iteration: channels widened to 16 bits, squared and summed
+	// with madd, then a running compare/select keeps the nearest entry.
+	std::uint32_t AssignColorIndicesSse2(const std::uint32_t pixels[16], const std::uint32_t palette[4],
+		unsigned paletteCount, std::uint32_t& indices, std::uint32_t errors[16])
+	{
+		const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i zero = _mm_setzero_si128();
+
+		__m128i colors[4];
+		for(unsigned k = 0; k < paletteCount; ++k)
+			colors[k] = _mm_unpacklo_epi8(_mm_and_si128(_mm_set1_epi32((int)palette[k]), rgbMask), zero);
+
+		std::uint32_t total = 0;
+		indices = 0;
+		for(unsigned group = 0; group < 4; ++group)
+		{
+			const __m128i px = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + group * 4)), rgbMask);
+			const __m128i lo = _mm_unpacklo_epi8(px, zero);
+			const __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+			__m128i best = zero;
+			__m128i bestIndex = zero;
+			for(unsigned k = 0; k < paletteCount; ++k)
+			{
+				const __m128i dlo = _mm_sub_epi16(lo, colors[k]);
+				const __m128i dhi = _mm_sub_epi16(hi, colors[k]);
+				const __m128 slo = _mm_castsi128_ps(_mm_madd_epi16(dlo, dlo)); // rg, b of pixels 0 and 1
+				const __m128 shi = _mm_castsi128_ps(_mm_madd_epi16(dhi, dhi)); // pixels 2 and 3
+				const __m128i distance = _mm_add_epi32(
+					_mm_castps_si128(_mm_shuffle_ps(slo, shi, _MM_SHUFFLE(2, 0, 2, 0))),
+					_mm_castps_si128(_mm_shuffle_ps(slo, shi, _MM_SHUFFLE(3, 1, 3, 1))));
+
+				if(k == 0)
+				{
+					best = distance;
+					continue;
+				}
+
+				const __m128i less = _mm_cmplt_epi32(distance, best);
+				best = _mm_or_si128(_mm_and_si128(less, distance), _mm_andnot_si128(less, best));
+				bestIndex = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32((int)k)), _mm_andnot_si128(less, bestIndex));
+			}
+
+			alignas(16) std::uint32_t groupIndices[4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(errors + group * 4), best);
+			_mm_store_si128(reinterpret_cast<__m128i*>(groupIndices), bestIndex);
+			for(unsigned j = 0; j < 4; ++j)
+			{
+				indices |= groupIndices[j] << (2 * (group * 4 + j));
+				total += errors[group * 4 + j];
+			}
+		}
+		return total;
+	}
+#endif
+
+	struct ColorBlock
+	{
+		std::uint32_t Pixels[16];
+		float Points[16][4];          // opaque pixels only, PointCount of them
+		std::uint8_t PointPixel[16];  // pixel index of each point
+		size_t PointCount = 0;
+		std::uint16_t TransparentMask = 0;
+		bool UseSimd = true;
+	};
+
+	ColorResult EvaluateColor(const ColorBlock& block, std::uint16_t c0, std::uint16_t c1, ColorMode mode)
+	{
+		if((mode == ColorMode_Bc1Four && c0 < c1) || (mode == ColorMode_Bc1Three && c0 > c1))
+			std::swap(c0, c1);
+
+		const std::uint8_t endpoints[4] = { (std::uint8_t)c0, (std::uint8_t)(c0 >> 8), (std::uint8_t)c1, (std::uint8_t)(c1 >> 8) };
+		std::uint32_t palette[4];
+		BcBuildColorPalette(endpoints, mode != ColorMode_Bc3, palette);
+
+		// In three-colour mode index 3 is transparent, so opaque pixels may not use it.
+		const unsigned paletteCount = (mode != ColorMode_Bc3 && c0 <= c1) ? 3 : 4;
+
+		ColorResult result;
+		result.C0 = c0;
+		result.C1 = c1;
+
+		std::uint32_t errors[16];
+#if BC_ENCODER_SSE2
+		if(block.UseSimd)
+			result.Error = AssignColorIndicesSse2(block.Pixels, palette, paletteCount, result.Indices, errors);
+		else
+#endif
+			result.Error = AssignColorIndicesScalar(block.Pixels, palette, paletteCount, result.Indices, errors);
+
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			if(block.TransparentMask & (1u << i))
+			{
+				result.Indices |= 3u << (2 * i);
+				result.Error -= errors[i];
+			}
+		}
+		return result;
+	}
+
+	// Index -> weight of c0 in the palette order of BcBuildColorPalette.
+	const float FourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	const float ThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+
+	bool RefineColor(const ColorBlock& block, const ColorResult& current, bool threeColor, std::uint16_t& c0, std::uint16_t& c1)
+	{
+		const float* table = threeColor ? ThreeColorWeights : FourColorWeights;
+
+		float weights[16];
+		for(size_t i = 0; i < block.PointCount; ++i)
+			weights[i] = table[(current.Indices >> (2 * block.PointPixel[i])) & 3];
+
+		float e0[4];
+		float e1[4];
+		if(!FitLeastSquares(block.Points, weights, block.PointCount, 0, 3, e0, e1))
+			return false;
+
+		c0 = Pack565(e0);
+		c1 = Pack565(e1);
+		return true;
+	}
+
+	// Endpoint pairs whose 2/3 interpolant hits each 8-bit value most closely,
+	// for blocks of one colour.
+	struct SingleColorTables
+	{
+		std::uint8_t Match5[256][2];
+		std::uint8_t Match6[256][2];
+
+		SingleColorTables()
+		{
+			Build(Match5, 5);
+			Build(Match6, 6);
+		}
+
+		static void Build(std::uint8_t (*table)[2], unsigned bits)
+		{
+			const int size = 1 << bits;
+			for(int value = 0; value < 256; ++value)
+			{
+				int bestError = 256 * 256;
+				for(int e0 = 0; e0 < size; ++e0)
+				{
+					for(int e1 = 0; e1 < size; ++e1)
+					{
+						const int a = (e0 << (8 - bits)) | (e0 >> (2 * bits - 8));
+						const int b = (e1 << (8 - bits)) | (e1 >> (2 * bits - 8));
+						// Penalize far-apart endpoints a little: decoders differ in rounding.
+						const int error = Square((2 * a + b + 1) / 3 - value) * 100 + std::abs(a - b);
+						if(error < bestError)
+						{
+							bestError = error;
+							table[value][0] = (std::uint8_t)e0;
+							table[value][1] = (std::uint8_t)e1;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	const SingleColorTables& GetSingleColorTables()
+	{
+		static const SingleColorTables tables;
+		return tables;
+	}
+
+	void EncodeColorBlock(const std::uint8_t* pixels, bool bc1, const BcEncodeOptions& options, std::uint8_t* out)
+	{
+		ColorBlock block;
+		block.UseSimd = options.UseSimd;
+		memcpy(block.Pixels, pixels, sizeof(block.Pixels));
+
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			const std::uint8_t* p = pixels + i * 4;
+			if(bc1 && p[3] < options.AlphaThreshold)
+			{
+				block.TransparentMask |= (std::uint16_t)(1u << i);
+				continue;
+			}
+			block.Points[block.PointCount][0] = p[0];
+			block.Points[block.PointCount][1] = p[1];
+			block.Points[block.PointCount][2] = p[2];
+			block.Points[block.PointCount][3] = 0.0f;
+			block.PointPixel[block.PointCount] = (std::uint8_t)i;
+			++block.PointCount;
+		}
+
+		ColorResult best;
+		if(block.PointCount == 0)
+		{
+			// Fully transparent: three-colour mode, every index 3.
+			best.C0 = 0;
+			best.C1 = 0xFFFF;
+			best.Indices = 0xFFFFFFFF;
+		}
+		else
+		{
+			const ColorMode mode = !bc1 ? ColorMode_Bc3 : (block.TransparentMask != 0 ? ColorMode_Bc1Three : ColorMode_Bc1Four);
+
+			bool solid = true;
+			for(size_t i = 1; i < block.PointCount && solid; ++i)
+				solid = (block.Pixels[block.PointPixel[i]] & 0xFFFFFF) == (block.Pixels[block.PointPixel[0]] & 0xFFFFFF);
+
+			if(solid && mode != ColorMode_Bc1Three)
+			{
+				const SingleColorTables& tables = GetSingleColorTables();
+				const std::uint8_t* p = pixels + block.PointPixel[0] * 4;
+				const std::uint16_t c0 = (std::uint16_t)((tables.Match5[p[0]][0] << 11) | (tables.Match6[p[1]][0] << 5) | tables.Match5[p[2]][0]);
+				const std::uint16_t c1 = (std::uint16_t)((tables.Match5[p[0]][1] << 11) | (tables.Match6[p[1]][1] << 5) | tables.Match5[p[2]][1]);
+				best = EvaluateColor(block, c0, c1, mode);
+			}
+
+			float e0[4];
+			float e1[4];
+			FitRange(block.Points, block.PointCount, 3, e0, e1);
+			ColorResult candidate = EvaluateColor(block, Pack565(e0), Pack565(e1), mode);
+			if(candidate.Error < best.Error)
+				best = candidate;
+
+			const int iterations = options.Quality == BcQuality_Fast ? 0 : (options.Quality == BcQuality_Normal ? 1 : 3);
+			ColorMode refineMode = mode;
+			for(int pass = 0; pass < (options.Quality == BcQuality_High && mode == ColorMode_Bc1Four ? 2 : 1); ++pass)
+			{
+				if(pass == 1)
+				{
+					// Opaque BC1 blocks may still do better with the halfway colour.
+					refineMode = ColorMode_Bc1Three;
+					candidate = EvaluateColor(block, best.C0, best.C1, refineMode);
+				}
+				else
+				{
+					candidate = best;
+				}
+
+				for(int i = 0; i < iterations && candidate.Error > 0; ++i)
+				{
+					std::uint16_t c0;
+					std::uint16_t c1;
+					const bool threeColor = refineMode != ColorMode_Bc3 && candidate.C0 <= candidate.C1;
+					if(!RefineColor(block, candidate, threeColor, c0, c1))
+						break;
+
+					const ColorResult refined = EvaluateColor(block, c0, c1, refineMode);
+					if(refined.Error >= candidate.Error)
+						break;
+					candidate = refined;
+				}
+
+				if(candidate.Error < best.Error)
+					best = candidate;
+			}
+		}
+
+		out[0] = (std::uint8_t)best.C0;
+		out[1] = (std::uint8_t)(best.C0 >> 8);
+		out[2] = (std::uint8_t)best.C1;
+		out[3] = (std::uint8_t)(best.C1 >> 8);
+		memcpy(out + 4, &best.Indices, 4); // little-endian, as the DDS data
+	}
+
+	//----------------------------------------------------------------------------
+	// BC3 alpha (BC4 block)
+	//----------------------------------------------------------------------------
+
+	std::uint32_t EvaluateAlpha(const std::uint8_t alpha[16], std::uint8_t a0, std::uint8_t a1, std::uint64_t& bits)
+	{
+		const std::uint8_t endpoints[2] = { a0, a1 };
+		std::uint8_t palette[8];
+		BcBuildChannelPalette(endpoints, palette);
+
+		std::uint32_t total = 0;
+		bits = 0;
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			int best = Square(alpha[i] - palette[0]);
+			unsigned bestIndex = 0;
+			for(unsigned k = 1; k < 8 && best > 0; ++k)
+			{
+				const int error = Square(alpha[i] - palette[k]);
+				if(error < best)
+				{
+					best = error;
+					bestIndex = k;
+				}
+			}
+			bits |= (std::uint64_t)bestIndex << (3 * i);
+			total += (std::uint32_t)best;
+		}
+		return total;
+	}
+
+	void EncodeAlphaBlock(const std::uint8_t* pixels, const BcEncodeOptions& options, std::uint8_t* out)
+	{
+		std::uint8_t alpha[16];
+		for(unsigned i = 0; i < 16; ++i)
+			alpha[i] = pixels[i * 4 + 3];
+
+		const std::uint8_t minAlpha = *std::min_element(alpha, alpha + 16);
+		const std::uint8_t maxAlpha = *std::max_element(alpha, alpha + 16);
+
+		std::uint8_t bestA0 = maxAlpha;
+		std::uint8_t bestA1 = minAlpha;
+		std::uint64_t bestBits = 0;
+		std::uint32_t bestError = 0;
+
+		if(minAlpha != maxAlpha)
+		{
+			const int radius = options.Quality == BcQuality_Fast ? 0 : (options.Quality == BcQuality_Normal ? 1 : 2);
+
+			// Eight-value mode between the extremes (a0 > a1).
+			bestError = ~0u;
+			for(int d0 = -radius; d0 <= radius; ++d0)
+			{
+				for(int d1 = -radius; d1 <= radius; ++d1)
+				{
+					const int a0 = maxAlpha + d0;
+					const int a1 = minAlpha + d1;
+					if(a0 > 255 || a1 < 0 || a0 <= a1)
+						continue;
+
+					std::uint64_t bits;
+					const std::uint32_t error = EvaluateAlpha(alpha, (std::uint8_t)a0, (std::uint8_t)a1, bits);
+					if(error < bestError)
+					{
+						bestError = error;
+						bestA0 = (std::uint8_t)a0;
+						bestA1 = (std::uint8_t)a1;
+						bestBits = bits;
+					}
+				}
+			}
+
+			// Six-value mode (a0 <= a1) spanning the values other than 0 and 255,
+			// which it represents exactly.
+			int low = 255;
+			int high = 0;
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(alpha[i] != 0 && alpha[i] != 255)
+				{
+					low = std::min<int>(low, alpha[i]);
+					high = std::max<int>(high, alpha[i]);
+				}
+			}
+			if(low > high)
+				low = high = 0;
+
+			for(int d0 = -radius; d0 <= radius && bestError > 0; ++d0)
+			{
+				for(int d1 = -radius; d1 <= radius; ++d1)
+				{
+					const int a0 = low + d0;
+					const int a1 = high + d1;
+					if(a0 < 0 || a1 > 255 || a0 > a1)
+						continue;
+
+					std::uint64_t bits;
+					const std::uint32_t error = EvaluateAlpha(alpha, (std::uint8_t)a0, (std::uint8_t)a1, bits);
+					if(error < bestError)
+					{
+						bestError = error;
+						bestA0 = (std::uint8_t)a0;
+						bestA1 = (std::uint8_t)a1;
+						bestBits = bits;
+					}
+				}
+			}
+		}
+
+		out[0] = bestA0;
+		out[1] = bestA1;
+		for(unsigned i = 0; i < 6; ++i)
+			out[2 + i] = (std::uint8_t)(bestBits >> (8 * i));
+	}
+
+	void EncodeBC1(const std::uint8_t* pixels, std::uint8_t* block, const BcEncodeOptions& options)
+	{
+		EncodeColorBlock(pixels, true, options, block);
+	}
+
+	void EncodeBC3(const std::uint8_t* pixels, std::uint8_t* block, const BcEncodeOptions& options)
+	{
+		EncodeAlphaBlock(pixels, options, block);
+		EncodeColorBlock(pixels, false, options, block + 8);
+	}
+
+	//----------------------------------------------------------------------------
+	// BC7
+	//----------------------------------------------------------------------------
+
+	class Bc7BitWriter
+	{
+	public:
+		void Write(std::uint32_t value, unsigned count)
+		{
+			for(unsigned i = 0; i < count; ++i, ++mPos)
+			{
+				if((value >> i) & 1)
+					mBits[mPos >> 3] |= (std::uint8_t)(1u << (mPos & 7));
+			}
+		}
+
+		const std::uint8_t* GetBits()const { return mBits; }
+
+	private:
+		std::uint8_t mBits[16] = {};
+		unsigned mPos = 0;
+	};
+
+	inline std::uint32_t Bc7Dequantize(std::uint32_t quantized, unsigned bits, int pbit)
+	{
+		if(pbit < 0)
+			return Bc7Expand(quantized, bits);
+		return Bc7Expand((quantized << 1) | (std::uint32_t)pbit, bits + 1);
+	}
+
+	// Closest bits-wide value to an 8-bit target, with pbit appended when >= 0.
+	std::uint32_t Bc7Quantize(float value, unsigned bits, int pbit)
+	{
+		const unsigned total = bits + (pbit >= 0 ? 1 : 0);
+		const int scaled = (int)std::floor(value * (float)((1 << total) - 1) / 255.0f + 0.5f);
+		const int center = pbit >= 0 ? (scaled - pbit) >> 1 : scaled;
+
+		std::uint32_t best = 0;
+		float bestError = 1e9f;
+		for(int q = center - 1; q <= center + 1; ++q)
+		{
+			if(q < 0 || q >= (1 << bits))
+				continue;
+			const float error = std::fabs((float)Bc7Dequantize((std::uint32_t)q, bits, pbit) - value);
+			if(error < bestError)
+			{
+				bestError = error;
+				best = (std::uint32_t)q;
+			}
+		}
+		return best;
+	}
+
+	struct Bc7State
+	{
+		std::uint32_t Quantized[6][4] = {}; // per endpoint, without the p-bit
+		std::uint32_t PBits[6] = {};
+		std::uint8_t Values[6][4] = {};     // dequantized
+		std::uint8_t Indices[16] = {};
+		std::uint8_t AlphaIndices[16] = {}; // second index set, modes 4/5
+		std::uint32_t Error = ~0u;
+	};
+
+	struct Bc7Context
+	{
+		const Bc7Mode* Mode = nullptr;
+		unsigned ModeIndex = 0;
+		unsigned Partition = 0;
+		unsigned Rotation = 0;
+		bool SeparateAlpha = false;
+		unsigned ColorChannels = 4; // channels driven by the primary indices
+		std::uint8_t Pixels[16][4];
+		std::uint8_t Subsets[16];
+	};
+
+	float EndpointError(const float target[4], const Bc7Context& ctx, int pbit, std::uint32_t quantized[4])
+	{
+		const Bc7Mode& mode = *ctx.Mode;
+		float error = 0.0f;
+		for(unsigned c = 0; c < 4; ++c)
+		{
+			const unsigned bits = c < 3 ? mode.ColorBits : mode.AlphaBits;
+			if(bits == 0)
+			{
+				quantized[c] = 0;
+				continue;
+			}
+			quantized[c] = Bc7Quantize(target[c], bits, pbit);
+			const std::uint32_t value = Bc7Dequantize(quantized[c], bits, pbit);
+			const float d = (float)value - target[c];
+			error += d * d;
+
+			// Opaque must stay opaque (alpha test, blending), whatever it costs RGB.
+			if(c == 3 && target[c] > 254.5f && value != 255)
+				error += 1e6f;
+		}
+		return error;
+	}
+
+	// ends[endpoint][channel] in 0..255 to quantized endpoints with p-bits.
+	void QuantizeBc7Endpoints(const Bc7Context& ctx, const float (*ends)[4], Bc7State& state)
+	{
+		const Bc7Mode& mode = *ctx.Mode;
+		const unsigned numEndpoints = mode.NumSubsets * 2u;
+
+		for(unsigned e = 0; e < numEndpoints; ++e)
+		{
+			if(mode.EndpointPBits == 0 && mode.SharedPBits == 0)
+			{
+				EndpointError(ends[e], ctx, -1, state.Quantized[e]);
+				state.PBits[e] = 0;
+			}
+			else if(mode.EndpointPBits != 0)
+			{
+				std::uint32_t q0[4], q1[4];
+				const float error0 = EndpointError(ends[e], ctx, 0, q0);
+				const float error1 = EndpointError(ends[e], ctx, 1, q1);
+				state.PBits[e] = error1 < error0 ? 1 : 0;
+				memcpy(state.Quantized[e], error1 < error0 ? q1 : q0, sizeof(q0));
+			}
+			else if((e & 1) == 0)
+			{
+				// One p-bit for both endpoints of the subset.
+				std::uint32_t q00[4], q01[4], q10[4], q11[4];
+				const float error0 = EndpointError(ends[e], ctx, 0, q00) + EndpointError(ends[e + 1], ctx,0, q01);
+				const float error1 = EndpointError(ends[e], ctx, 1, q10) + EndpointError(ends[e + 1], ctx,1, q11);
+				const bool one = error1 < error0;
+				state.PBits[e] = state.PBits[e + 1] = one ? 1 : 0;
+				memcpy(state.Quantized[e], one ? q10 : q00, sizeof(q00));
+				memcpy(state.Quantized[e + 1], one ? q11 : q01, sizeof(q01));
+			}
+		}
+
+		const bool hasPBits = mode.EndpointPBits != 0 || mode.SharedPBits != 0;
+		for(unsigned e = 0; e < numEndpoints; ++e)
+		{
+			const int pbit = hasPBits ? (int)state.PBits[e] : -1;
+			for(unsigned c = 0; c < 3; ++c)
+				state.Values[e][c] = (std::uint8_t)Bc7Dequantize(state.Quantized[e][c], mode.ColorBits, pbit);
+			state.Values[e][3] = mode.AlphaBits != 0
+				? (std::uint8_t)Bc7Dequantize(state.Quantized[e][3], mode.AlphaBits, pbit)
+				: 255;
+		}
+	}
+
+	// Projects the pixel on the endpoint line for the likely index and measures
+	// only it and its neighbours instead of the whole palette (up to 16 entries);
+	// the weights are near-uniform, so the nearest entry is among them.
+	template<unsigned FirstChannel, unsigned EndChannel>
+	class Bc7IndexSearch
+	{
+	public:
+		Bc7IndexSearch(const std::uint8_t* e0, const std::uint8_t* e1, unsigned indexBits)
+			: mCount(1u << indexBits)
+		{
+			const std::uint8_t* weights = Bc7WeightTable(indexBits);
+			int lengthSquared = 0;
+			for(unsigned c = FirstChannel; c < EndChannel; ++c)
+			{
+				mOrigin[c] = e0[c];
+				mDirection[c] = e1[c] - e0[c];
+				lengthSquared += mDirection[c] * mDirection[c];
+				for(unsigned k = 0; k < mCount; ++k)
+					mPalette[k][c] = (std::uint8_t)Bc7Interpolate(e0[c], e1[c], weights[k]);
+			}
+			mScale = lengthSquared > 0 ? (float)(mCount - 1) / (float)lengthSquared : 0.0f;
+		}
+
+		// Index of the nearest entry (the lowest on ties); error gets its distance.
+		unsigned Find(const std::uint8_t* p, std::uint32_t& error)const
+		{
+			int dot = 0;
+			for(unsigned c = FirstChannel; c < EndChannel; ++c)
+				dot += (p[c] - mOrigin[c]) * mDirection[c];
+
+			const int guess = std::min(std::max((int)std::floor((float)dot * mScale + 0.5f), 0), (int)mCount - 1);
+			const unsigned first = (unsigned)std::max(guess - 1, 0);
+			const unsigned last = std::min((unsigned)guess + 1, mCount - 1);
+
+			int best = 1 << 30;
+			unsigned bestIndex = first;
+			for(unsigned k = first; k <= last; ++k)
+			{
+				int distance = 0;
+				for(unsigned c = FirstChannel; c < EndChannel; ++c)
+					distance += Square(p[c] - mPalette[k][c]);
+				if(distance < best)
+				{
+					best = distance;
+					bestIndex = k;
+				}
+			}
+
+			error = (std::uint32_t)best;
+			return bestIndex;
+		}
+
+	private:
+		unsigned mCount;
+		int mOrigin[4] = {};
+		int mDirection[4] = {};
+		float mScale;
+		std::uint8_t mPalette[16][4] = {};
+	};
+
+	template<unsigned ColorChannels>
+	void AssignBc7Indices(const Bc7Context& ctx, Bc7State& state)
+	{
+		const Bc7Mode& mode = *ctx.Mode;
+
+		std::uint32_t total = 0;
+		for(unsigned s = 0; s < mode.NumSubsets; ++s)
+		{
+			const Bc7IndexSearch<0, ColorChannels> search(state.Values[2 * s], state.Values[2 * s + 1], mode.IndexBits);
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(ctx.Subsets[i] != s)
+					continue;
+				std::uint32_t error;
+				state.Indices[i] = (std::uint8_t)search.Find(ctx.Pixels[i], error);
+				total += error;
+			}
+		}
+
+		if(ColorChannels == 3)
+		{
+			const Bc7IndexSearch<3, 4> search(state.Values[0], state.Values[1], mode.IndexBits2);
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				std::uint32_t error;
+				state.AlphaIndices[i] = (std::uint8_t)search.Find(ctx.Pixels[i], error);
+				total += error;
+			}
+		}
+
+		state.Error = total;
+	}
+
+	void AssignBc7Indices(const Bc7Context& ctx, Bc7State& state)
+	{
+		if(ctx.SeparateAlpha)
+			AssignBc7Indices<3>(ctx, state);
+		else
+			AssignBc7Indices<4>(ctx, state);
+	}
+
+	// Least-squares endpoints from the current indices; false if nothing changed.
+	bool RefineBc7Endpoints(const Bc7Context& ctx, const Bc7State& state, float (*ends)[4])
+	{
+		const Bc7Mode& mode = *ctx.Mode;
+		const std::uint8_t* colorWeights = Bc7WeightTable(mode.IndexBits);
+		bool refined = false;
+
+		for(unsigned s = 0; s < mode.NumSubsets; ++s)
+		{
+			float points[16][4];
+			float weights[16];
+			size_t count = 0;
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(ctx.Subsets[i] != s)
+					continue;
+				for(unsigned c = 0; c < 4; ++c)
+					points[count][c] = ctx.Pixels[i][c];
+				weights[count] = 1.0f - colorWeights[state.Indices[i]] / 64.0f;
+				++count;
+			}
+			refined |= FitLeastSquares(points, weights, count, 0, ctx.ColorChannels, ends[2 * s], ends[2 * s + 1]);
+		}
+
+		if(ctx.SeparateAlpha)
+		{
+			const std::uint8_t* alphaWeights = Bc7WeightTable(mode.IndexBits2);
+			float points[16][4];
+			float weights[16];
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				points[i][3] = ctx.Pixels[i][3];
+				weights[i] = 1.0f - alphaWeights[state.AlphaIndices[i]] / 64.0f;
+			}
+			refined |= FitLeastSquares(points, weights, 16, 3, 4, ends[0], ends[1]);
+		}
+
+		return refined;
+	}
+
+	void PackBc7Block(const Bc7Context& ctx, Bc7State state, std::uint8_t* out)
+	{
+		const Bc7Mode& mode = *ctx.Mode;
+		const unsigned numEndpoints = mode.NumSubsets * 2u;
+
+		// Anchor indices must have a 0 top bit: swap the subset's endpoints and
+		// mirror its indices where they do not.
+		const std::uint8_t colorMax = (std::uint8_t)((1u << mode.IndexBits) - 1);
+		const unsigned swapEnd = ctx.SeparateAlpha ? 3 : 4;
+		for(unsigned s = 0; s < mode.NumSubsets; ++s)
+		{
+			unsigned anchor = 0;
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(ctx.Subsets[i] == s && Bc7IsAnchor(mode.NumSubsets, ctx.Partition, i))
+				{
+					anchor = i;
+					break;
+				}
+			}
+
+			if(state.Indices[anchor] <= colorMax >> 1)
+				continue;
+
+			for(unsigned c = 0; c < swapEnd; ++c)
+				std::swap(state.Quantized[2 * s][c], state.Quantized[2 * s + 1][c]);
+			std::swap(state.PBits[2 * s], state.PBits[2 * s + 1]);
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(ctx.Subsets[i] == s)
+					state.Indices[i] = (std::uint8_t)(colorMax - state.Indices[i]);
+			}
+		}
+
+		if(ctx.SeparateAlpha)
+		{
+			const std::uint8_t alphaMax = (std::uint8_t)((1u << mode.IndexBits2) - 1);
+			if(state.AlphaIndices[0] > alphaMax >> 1)
+			{
+				std::swap(state.Quantized[0][3], state.Quantized[1][3]);
+				for(unsigned i = 0; i < 16; ++i)
+					state.AlphaIndices[i] = (std::uint8_t)(alphaMax - state.AlphaIndices[i]);
+			}
+		}
+
+		Bc7BitWriter writer;
+		writer.Write(1u << ctx.ModeIndex, ctx.ModeIndex + 1);
+		writer.Write(ctx.Partition, mode.PartitionBits);
+		writer.Write(ctx.Rotation, mode.RotationBits);
+		writer.Write(0, mode.IndexSelectionBits);
+
+		for(unsigned c = 0; c < 3; ++c)
+		{
+			for(unsigned e = 0; e < numEndpoints; ++e)
+				writer.Write(state.Quantized[e][c], mode.ColorBits);
+		}
+		if(mode.AlphaBits != 0)
+		{
+			for(unsigned e = 0; e < numEndpoints; ++e)
+				writer.Write(state.Quantized[e][3], mode.AlphaBits);
+		}
+
+		if(mode.EndpointPBits != 0)
+		{
+			for(unsigned e = 0; e < numEndpoints; ++e)
+				writer.Write(state.PBits[e], 1);
+		}
+		else if(mode.SharedPBits != 0)
+		{
+			for(unsigned s = 0; s < mode.NumSubsets; ++s)
+				writer.Write(state.PBits[2 * s], 1);
+		}
+
+		for(unsigned i = 0; i < 16; ++i)
+			writer.Write(state.Indices[i], Bc7IsAnchor(mode.NumSubsets, ctx.Partition, i) ? mode.IndexBits - 1u : mode.IndexBits);
+		if(ctx.SeparateAlpha)
+		{
+			for(unsigned i = 0; i < 16; ++i)
+				writer.Write(state.AlphaIndices[i], i == 0 ? mode.IndexBits2 - 1u : mode.IndexBits2);
+		}
+
+		memcpy(out, writer.GetBits(), 16);
+	}
+
+	// Encodes with one mode/partition/rotation; returns the squared error.
+	std::uint32_t EncodeBc7Mode(const std::uint8_t pixels[16][4], unsigned modeIndex, unsigned partition,
+		unsigned rotation, int refineIterations, std::uint8_t* out)
+	{
+		Bc7Context ctx;
+		ctx.Mode = &Bc7Modes[modeIndex];
+		ctx.ModeIndex = modeIndex;
+		ctx.Partition = partition;
+		ctx.Rotation = rotation;
+		ctx.SeparateAlpha = ctx.Mode->IndexBits2 != 0;
+		ctx.ColorChannels = ctx.SeparateAlpha ? 3 : 4;
+
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			memcpy(ctx.Pixels[i], pixels[i], 4);
+			if(rotation != 0)
+				std::swap(ctx.Pixels[i][3], ctx.Pixels[i][rotation - 1]);
+			ctx.Subsets[i] = (std::uint8_t)Bc7GetSubset(ctx.Mode->NumSubsets, partition, i);
+		}
+
+		float ends[6][4] = {};
+		for(unsigned s = 0; s < ctx.Mode->NumSubsets; ++s)
+		{
+			float points[16][4];
+			size_t count = 0;
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				if(ctx.Subsets[i] != s)
+					continue;
+				for(unsigned c = 0; c < 4; ++c)
+					points[count][c] = ctx.Pixels[i][c];
+				++count;
+			}
+			FitRange(points, count, ctx.ColorChannels, ends[2 * s], ends[2 * s + 1]);
+		}
+
+		if(ctx.SeparateAlpha)
+		{
+			std::uint8_t low = 255;
+			std::uint8_t high = 0;
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				low = std::min(low, ctx.Pixels[i][3]);
+				high = std::max(high, ctx.Pixels[i][3]);
+			}
+			ends[0][3] = low;
+			ends[1][3] = high;
+		}
+
+		Bc7State best;
+		QuantizeBc7Endpoints(ctx, ends, best);
+		AssignBc7Indices(ctx, best);
+
+		for(int i = 0; i < refineIterations && best.Error > 0; ++i)
+		{
+			if(!RefineBc7Endpoints(ctx, best, ends))
+				break;
+
+			Bc7State refined;
+			QuantizeBc7Endpoints(ctx, ends, refined);
+			AssignBc7Indices(ctx, refined);
+			if(refined.Error >= best.Error)
+				break;
+			best = refined;
+		}
+
+		PackBc7Block(ctx, best, out);
+		return best.Error;
+	}
+
+	// First and second moments of a set of pixels.  They add up, so a partition
+	// sums them per subset and derives subset 0 from the block total.
+	struct PixelMoments
+	{
+		float Count = 0.0f;
+		float Sum[4] = {};
+		float Products[4][4] = {}; // upper triangle used
+
+		void Add(const PixelMoments& other, float sign)
+		{
+			Count += sign * other.Count;
+			for(unsigned a = 0; a < 4; ++a)
+			{
+				Sum[a] += sign * other.Sum[a];
+				for(unsigned b = a; b < 4; ++b)
+					Products[a][b] += sign * other.Products[a][b];
+			}
+		}
+
+		// Squared distance of the pixels from their best-fit line: the covariance
+		// trace minus its largest eigenvalue, estimated by two power steps.
+		float GetLineError()const
+		{
+			if(Count < 2.0f)
+				return 0.0f;
+
+			float cov[4][4];
+			float trace = 0.0f;
+			unsigned largest = 0;
+			for(unsigned a = 0; a < 4; ++a)
+			{
+				for(unsigned b = a; b < 4; ++b)
+					cov[a][b] = cov[b][a] = Products[a][b] - Sum[a] * Sum[b] / Count;
+				trace += cov[a][a];
+				if(cov[a][a] > cov[largest][largest])
+					largest = a;
+			}
+			if(cov[largest][largest] <= 0.0f)
+				return 0.0f;
+
+			float v[4] = { cov[largest][0], cov[largest][1], cov[largest][2], cov[largest][3] };
+			float w[4];
+			for(int iteration = 0; iteration < 2; ++iteration)
+			{
+				for(unsigned a = 0; a < 4; ++a)
+					w[a] = cov[a][0] * v[0] + cov[a][1] * v[1] + cov[a][2] * v[2] + cov[a][3] * v[3];
+				const float norm = std::max(std::max(std::fabs(w[0]), std::fabs(w[1])), std::max(std::fabs(w[2]), std::fabs(w[3])));
+				if(norm == 0.0f)
+					return trace;
+				for(unsigned a = 0; a < 4; ++a)
+					v[a] = w[a] / norm;
+			}
+
+			// Rayleigh quotient of v.
+			float vv = 0.0f;
+			float vcv = 0.0f;
+			for(unsigned a = 0; a < 4; ++a)
+			{
+				vv += v[a] * v[a];
+				vcv += v[a] * (cov[a][0] * v[0] + cov[a][1] * v[1] + cov[a][2] * v[2] + cov[a][3] * v[3]);
+			}
+			return std::max(trace - vcv / vv, 0.0f);
+		}
+	};
+
+	// Partitions of numSubsets ordered by how far their pixels are from one
+	// line per subset, the cheapest predictor of the fitted error.
+	void RankBc7Partitions(const std::uint8_t pixels[16][4], unsigned numSubsets, unsigned* order)
+	{
+		PixelMoments pixelMoments[16];
+		PixelMoments total;
+		for(unsigned i = 0; i < 16; ++i)
+		{
+			PixelMoments& m = pixelMoments[i];
+			m.Count = 1.0f;
+			for(unsigned a = 0; a < 4; ++a)
+			{
+				m.Sum[a] = pixels[i][a];
+				for(unsigned b = a; b < 4; ++b)
+					m.Products[a][b] = (float)(pixels[i][a] * pixels[i][b]);
+			}
+			total.Add(m, 1.0f);
+		}
+
+		float scores[64];
+		for(unsigned p = 0; p < 64; ++p)
+		{
+			PixelMoments subsets[3];
+			for(unsigned i = 0; i < 16; ++i)
+			{
+				const unsigned s = Bc7GetSubset(numSubsets, p, i);
+				if(s != 0)
+					subsets[s].Add(pixelMoments[i], 1.0f);
+			}
+
+			subsets[0] = total;
+			scores[p] = 0.0f;
+			for(unsigned s = 1; s < numSubsets; ++s)
+			{
+				subsets[0].Add(subsets[s], -1.0f);
+				scores[p] += subsets[s].GetLineError();
+			}
+			scores[p] += subsets[0].GetLineError();
+			order[p] = p;
+		}
+
+		std::sort(order, order + 64, [&](unsigned a, unsigned b) { return scores[a] < scores[b]; });
+	}
+
+	void EncodeBC7(const std::uint8_t* pixelBytes, std::uint8_t* block, const BcEncodeOptions& options)
+	{
+		std::uint8_t pixels[16][4];
+		memcpy(pixels, pixelBytes, sizeof(pixels));
+
+		bool opaque = true;
+		for(unsigned i = 0; i < 16 && opaque; ++i)
+			opaque = pixels[i][3] == 255;
+
+		const int refine = options.Quality == BcQuality_Fast ? 0 : (options.Quality == BcQuality_Normal ? 1 : 2);
+
+		const bool high = options.Quality == BcQuality_High;
+
+		// Normal stops when mode 6 is already within about one step per channel,
+		// which smooth content (most blocks) is.
+		std::uint32_t bestError = EncodeBc7Mode(pixels, 6, 0, 0, refine, block);
+		if(options.Quality == BcQuality_Fast || bestError == 0 || (!high && bestError <= 16 * 4))
+			return;
+
+		std::uint8_t candidate[16];
+		auto tryMode = [&](unsigned modeIndex, unsigned partition, unsigned rotation)
+		{
+			if(bestError == 0)
+				return;
+			const std::uint32_t error = EncodeBc7Mode(pixels, modeIndex, partition, rotation, refine, candidate);
+			if(error < bestError)
+			{
+				bestError = error;
+				memcpy(block, candidate, 16);
+			}
+		};
+
+		unsigned order[64];
+		RankBc7Partitions(pixels, 2, order);
+		const unsigned tries2 = high ? 8 : 4;
+
+		if(opaque)
+		{
+			for(unsigned i = 0; i < tries2; ++i)
+			{
+				tryMode(1, order[i], 0);
+				if(high)
+					tryMode(3, order[i], 0);
+			}
+
+			if(high)
+			{
+				// Mode 0 has only the first 16 three-subset partitions.
+				RankBc7Partitions(pixels, 3, order);
+				for(unsigned i = 0, mode0 = 0; i < 64 && (i < 8 || mode0 < 4); ++i)
+				{
+					if(i < 8)
+						tryMode(2, order[i], 0);
+					if(order[i] < 16 && mode0 < 4)
+					{
+						tryMode(0, order[i], 0);
+						++mode0;
+					}
+				}
+			}
+		}
+		else
+		{
+			for(unsigned rotation = 0; rotation < (high ? 4u : 1u); ++rotation)
+				tryMode(5, 0, rotation);
+
+			for(unsigned i = 0; i < tries2; ++i)
+				tryMode(7, order[i], 0);
+		}
+	}
+
+	//----------------------------------------------------------------------------
+
+	BlockEncoder GetBlockEncoder(DXGI_FORMAT format, size_t& blockSize)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			blockSize = 8;
+			return EncodeBC1;
+
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			blockSize = 16;
+			return EncodeBC3;
+
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			blockSize = 16;
+			return EncodeBC7;
+
+		default:
+			blockSize = 0;
+			return nullptr;
+		}
+	}
+
+	void EncodeBlockRows(BlockEncoder encoder, size_t blockSize,
+		const std::uint8_t* rgba, size_t rowPitch, size_t width, size_t height,
+		std::uint8_t* dest, size_t destRowPitch,
+		size_t firstBlockRow, size_t endBlockRow, const BcEncodeOptions& options)
+	{
+		const size_t blocksWide = (width + 3) / 4;
+
+		std::uint8_t pixels[64];
+		for(size_t by = firstBlockRow; by < endBlockRow; ++by)
+		{
+			for(size_t bx = 0; bx < blocksWide; ++bx)
+			{
+				// Edge blocks repeat the last row/column, which costs no accuracy inside.
+				for(size_t y = 0; y < 4; ++y)
+				{
+					const size_t sy = std::min(by * 4 + y, height - 1);
+					for(size_t x = 0; x < 4; ++x)
+					{
+						const size_t sx = std::min(bx * 4 + x, width - 1);
+						memcpy(pixels + (y * 4 + x) * 4, rgba + sy * rowPitch + sx * 4, 4);
+					}
+				}
+
+				encoder(pixels, dest + by * destRowPitch + bx * blockSize, options);
+			}
+		}
+	}
+
+	bool IsRgba8(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	}
+}
+
+bool BcEncoder::IsSupported(DXGI_FORMAT format)
+{
+	size_t blockSize;
+	return GetBlockEncoder(format, blockSize) != nullptr;
+}
+
+bool BcEncoder::Encode(DXGI_FORMAT format,
+	const std::uint8_t* rgba, size_t rowPitch,
+	size_t width, size_t height,
+	std::uint8_t* dest, size_t destRowPitch,
+	const BcEncodeOptions& options)
+{
+	size_t blockSize;
+	BlockEncoder encoder = GetBlockEncoder(format, blockSize);
+	if(encoder == nullptr || rgba == nullptr || dest == nullptr || width == 0 || height == 0)
+		return false;
+
+	const size_t blocksWide = (width + 3) / 4;
+	const size_t blocksHigh = (height + 3) / 4;
+
+	// Small bands handed out one at a time keep the threads busy when detail is
+	// uneven across the image.
+	const size_t bandRows = std::max<size_t>(MinBlocksPerBand / blocksWide, 1);
+	const size_t bandCount = (blocksHigh + bandRows - 1) / bandRows;
+
+	ParallelFor(bandCount, options.ThreadCount, [&](size_t band)
+	{
+		const size_t first = band * bandRows;
+		EncodeBlockRows(encoder, blockSize, rgba, rowPitch, width, height, dest, destRowPitch,
+			first, std::min(first + bandRows, blocksHigh), options);
+	});
+
+	return true;
+}
+
+bool BcEncoder::Encode(const MipChain& source, DXGI_FORMAT format, MipChain& out,
+	const BcEncodeOptions& options, BcEncodeStats* stats)
+{
+	if(!IsRgba8(source.GetFormat()) || !IsSupported(format))
+		return false;
+
+	out.Reset(format, source.GetWidth(), source.GetHeight(), source.GetMipCount(), source.GetArraySize());
+	out.SetCubeMap(source.IsCubeMap());
+
+	const auto start = std::chrono::steady_clock::now();
+
+	size_t pixels = 0;
+	for(size_t item = 0; item < source.GetArraySize(); ++item)
+	{
+		for(size_t mip = 0; mip < source.GetMipCount(); ++mip)
+		{
+			const DdsImage::Subresource& src = source.GetSubresource(mip, item);
+			const DdsImage::Subresource& dst = out.GetSubresource(mip, item);
+			if(!Encode(format, src.Data, src.RowPitch, src.Width, src.Height,
+				out.GetMutableData(mip, item), dst.RowPitch, options))
+			{
+				return false;
+			}
+			pixels += src.Width * src.Height;
+		}
+	}
+
+	if(stats != nullptr)
+	{
+		stats->Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stats->MegapixelsPerSecond = stats->Seconds > 0.0 ? (double)pixels / stats->Seconds * 1e-6 : 0.0;
+		ComputePsnr(source, out, stats->PsnrRgb, stats->PsnrAlpha);
+	}
+
+	return true;
+}
+
+void BcEncoder::ComputePsnr(const MipChain& original, const MipChain& encoded, double& psnrRgb, double& psnrAlpha)
+{
+	double errorRgb = 0.0;
+	double errorAlpha = 0.0;
+	double pixels = 0.0;
+
+	std::vector<std::uint8_t> decoded;
+	for(size_t item = 0; item < original.GetArraySize(); ++item)
+	{
+		for(size_t mip = 0; mip < original.GetMipCount(); ++mip)
+		{
+			const DdsImage::Subresource& src = original.GetSubresource(mip, item);
+			decoded.resize(src.Width * src.Height * 4);
+			BcDecoder::Decode(encoded.GetFormat(), encoded.GetSubresource(mip, item), decoded.data(), src.Width * 4);
+
+			for(size_t y = 0; y < src.Height; ++y)
+			{
+				const std::uint8_t* a = src.Data + y * src.RowPitch;
+				const std::uint8_t* b = decoded.data() + y * src.Width * 4;
+				for(size_t x = 0; x < src.Width * 4; x += 4)
+				{
+					errorRgb += Square(a[x] - b[x]) + Square(a[x + 1] - b[x + 1]) + Square(a[x + 2] - b[x + 2]);
+					errorAlpha += Square(a[x + 3] - b[x + 3]);
+				}
+			}
+			pixels += (double)(src.Width * src.Height);
+		}
+	}
+
+	auto toPsnr = [](double mse) { return mse > 0.0 ? std::min(10.0 * std::log10(255.0 * 255.0 / mse), 99.0) : 99.0; };
+	psnrRgb = pixels > 0.0 ? toPsnr(errorRgb / (pixels * 3.0)) : 99.0;
+	psnrAlpha = pixels > 0.0 ? toPsnr(errorAlpha / pixels) : 99.0;
+}
+
+void BcEncoder::EncodeBlockBC1(const std::uint8_t pixels[64], std::uint8_t block[8], const BcEncodeOptions& options)
+{
+	EncodeBC1(pixels, block, options);
+}
+
+void BcEncoder::EncodeBlockBC3(const std::uint8_t pixels[64], std::uint8_t block[16], const BcEncodeOptions& options)
+{
+	EncodeBC3(pixels, block, options);
+}
+
+void BcEncoder::EncodeBlockBC7(const std::uint8_t pixels[64], std::uint8_t block[16], const BcEncodeOptions& options)
+{
+	EncodeBC7(pixels, block, options);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MipGenerator.h"
+
+enum BcQuality
+{
+	BcQuality_Fast,   // BC1/BC3: endpoints from the principal axis; BC7: mode 6 only
+	BcQuality_Normal, // + least-squares endpoint refinement; BC7: + best 2-subset partitions
+	BcQuality_High,   // + more refinement and 3-colour BC1; BC7: all modes except 4
+};
+
+struct BcEncodeOptions
+{
+	BcQuality Quality = BcQuality_Normal;
+	std::uint8_t AlphaThreshold = 128; // BC1: pixels with less alpha become transparent
+	unsigned ThreadCount = 0;          // 0 = all hardware threads
+	bool UseSimd = true;               // false runs the scalar reference path
+};
+
+struct BcEncodeStats
+{
+	double Seconds = 0.0;
+	double MegapixelsPerSecond = 0.0;
+	double PsnrRgb = 0.0;   // dB over every subresource, decoded with BcDecoder
+	double PsnrAlpha = 0.0; // 99 when alpha survives exactly
+};
+
+// CPU block compressor for the content pipeline: RGBA8 in, BC1/BC3/BC7 out.
+//
+// BC1 and BC3 colour endpoints start from the extremes of the pixels projected
+// on their principal axis (range fit) and are refined by least squares over
+// the chosen indices.  Index selection, the inner loop, measures all 16 pixels
+// against the palette with SSE2.  BC3 alpha tries both BC4 palette modes.
+//
+// BC7 fits endpoints per subset the same way, with p-bits chosen per endpoint,
+// and picks the lowest-error mode and partition among the candidates allowed by
+// BcQuality.  Fast is mode 6 alone; partitions are ranked by a cheap residual
+// estimate so only the best few are fully encoded.
+//
+// Surfaces are split into bands of block rows encoded with ParallelFor.  The
+// encoded texture goes to disk with DdsWriter and loads with the normal loaders.
+class BcEncoder
+{
+public:
+	// BC1, BC3 and BC7, UNORM or _SRGB (the encoder works on the stored bytes).
+	static bool IsSupported(DXGI_FORMAT format);
+
+	// Encodes width x height RGBA8 pixels, rows rowPitch bytes apart, into rows
+	// of blocks destRowPitch bytes apart.  Edge blocks repeat the last column/row.
+	static bool Encode(DXGI_FORMAT format,
+		const std::uint8_t* rgba, size_t rowPitch,
+		size_t width, size_t height,
+		std::uint8_t* dest, size_t destRowPitch,
+		const BcEncodeOptions& options = BcEncodeOptions());
+
+	// Every subresource of an R8G8B8A8_UNORM(_SRGB) chain, e.g. from MipGenerator.
+	// stats, when given, also gets the PSNR of the result.
+	static bool Encode(const MipChain& source, DXGI_FORMAT format, MipChain& out,
+		const BcEncodeOptions& options = BcEncodeOptions(), BcEncodeStats* stats = nullptr);
+
+	// Decodes encoded and compares it with the RGBA8 original, same layout.
+	static void ComputePsnr(const MipChain& original, const MipChain& encoded,
+		double& psnrRgb, double& psnrAlpha);
+
+	// One 4x4 block of RGBA8 pixels (64 bytes, row-major).
+	static void EncodeBlockBC1(const std::uint8_t pixels[64], std::uint8_t block[8],
+		const BcEncodeOptions& options = BcEncodeOptions());
+	static void EncodeBlockBC3(const std::uint8_t pixels[64], std::uint8_t block[16],
+		const BcEncodeOptions& options = BcEncodeOptions());
+	static void EncodeBlockBC7(const std::uint8_t pixels[64], std::uint8_t block[16],
+		const BcEncodeOptions& options = BcEncodeOptions());
+};
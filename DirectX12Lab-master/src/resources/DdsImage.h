@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_WIN32)
+#include <dxgiformat.h>
+#else
+#include <directx/dxgiformat.h> // DirectX-Headers
+#endif
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//
+// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+//--------------------------------------------------------------------------------------
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+#define DDS_ALPHAPIXELS 0x00000001  // DDPF_ALPHAPIXELS
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_HEADER_FLAGS_TEXTURE        0x00001007  // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+#define DDS_HEADER_FLAGS_MIPMAP         0x00020000  // DDSD_MIPMAPCOUNT
+#define DDS_HEADER_FLAGS_PITCH          0x00000008  // DDSD_PITCH
+#define DDS_HEADER_FLAGS_LINEARSIZE     0x00080000  // DDSD_LINEARSIZE
+
+#define DDS_SURFACE_FLAGS_TEXTURE 0x00001000 // DDSCAPS_TEXTURE
+#define DDS_SURFACE_FLAGS_MIPMAP  0x00400008 // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+#define DDS_SURFACE_FLAGS_CUBEMAP 0x00000008 // DDSCAPS_COMPLEX
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+// DDS_HEADER_DXT10::resourceDimension / miscFlag, same values as D3D10/11.
+#define DDS_DIMENSION_TEXTURE1D 2
+#define DDS_DIMENSION_TEXTURE2D 3
+#define DDS_DIMENSION_TEXTURE3D 4
+
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+//--------------------------------------------------------------------------------------
+// Read-only view of a DDS file in memory.
+//
+// Parse() validates the magic, header, DX10 extension, format, dimensions and that
+// the whole mip chain of every array item fits in the data.  It allocates nothing
+// and keeps pointers into the caller's buffer, which must outlive the view.  No
+// graphics API is involved, so the same code validates files in tools and on
+// non-Windows machines; the D3D loaders in TextureLoaderDDS are thin wrappers.
+//--------------------------------------------------------------------------------------
+class DdsImage
+{
+public:
+    enum Result
+    {
+        Result_Ok = 0,
+        Result_InvalidArg,      // null data
+        Result_BadFile,         // too small, bad magic or header sizes
+        Result_InvalidData,     // inconsistent header fields
+        Result_NotSupported,    // valid DDS we can not use
+        Result_Truncated,       // pixel data shorter than the header promises
+    };
+
+    enum Dimension
+    {
+        Dimension_Unknown = 0,
+        Dimension_Texture1D = DDS_DIMENSION_TEXTURE1D,
+        Dimension_Texture2D = DDS_DIMENSION_TEXTURE2D,
+        Dimension_Texture3D = DDS_DIMENSION_TEXTURE3D,
+    };
+
+    // Hardware limits (D3D11/12 feature level 11), enforced because file metadata
+    // is not trusted beyond what a device could create.
+    static const size_t MaxMipLevels = 15;
+    static const size_t MaxTexture1DSize = 16384;
+    static const size_t MaxTexture2DSize = 16384;
+    static const size_t MaxTextureCubeSize = 16384;
+    static const size_t MaxTexture3DSize = 2048;
+    static const size_t MaxArraySize = 2048;
+
+    struct Subresource
+    {
+        const uint8_t* Data = nullptr;
+        size_t RowPitch = 0;    // bytes per row of pixels or row of 4x4 blocks
+        size_t SlicePitch = 0;  // bytes per 2D slice
+        size_t NumRows = 0;
+        size_t Width = 0;
+        size_t Height = 0;
+        size_t Depth = 0;
+    };
+
+    DdsImage() = default;
+
+    Result Parse(const uint8_t* ddsData, size_t ddsDataSize);
+
+    const DDS_HEADER* GetHeader()const { return mHeader; }
+    const DDS_HEADER_DXT10* GetHeaderDXT10()const { return mHeaderDXT10; }
+
+    Dimension GetDimension()const { return mDimension; }
+    DXGI_FORMAT GetFormat()const { return mFormat; }
+    size_t GetWidth()const { return mWidth; }
+    size_t GetHeight()const { return mHeight; }
+    size_t GetDepth()const { return mDepth; }
+    size_t GetMipCount()const { return mMipCount; }
+
+    // Number of array items; 6 per cube for cube maps.
+    size_t GetArraySize()const { return mArraySize; }
+    bool IsCubeMap()const { return mIsCubeMap; }
+    size_t GetSubresourceCount()const { return mMipCount * mArraySize; }
+
+    // DDS_ALPHA_MODE value (0 when unknown).
+    uint32_t GetAlphaMode()const;
+
+    const uint8_t* GetBitData()const { return mBitData; }
+    size_t GetBitSize()const { return mBitSize; }
+
+    // Number of top mips to drop so no remaining dimension exceeds maxSize (0 = no
+    // limit).  Never drops the last mip.
+    size_t GetSkipMipsForMaxSize(size_t maxSize)const;
+
+    // Subresources in D3D order (mip fastest, then array item), starting at mip
+    // firstMip of each item.  out must hold (GetMipCount() - firstMip) * GetArraySize().
+    // Returns the number written.
+    size_t GetSubresources(size_t firstMip, Subresource* out, size_t outCount)const;
+
+    Subresource GetSubresource(size_t mip, size_t arrayItem)const;
+
+    static size_t BitsPerPixel( DXGI_FORMAT fmt );
+
+    static void GetSurfaceInfo( size_t width,
+                                size_t height,
+                                DXGI_FORMAT fmt,
+                                size_t* outNumBytes,
+                                size_t* outRowBytes,
+                                size_t* outNumRows );
+
+    static DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf );
+
+    static DXGI_FORMAT MakeSRGB( DXGI_FORMAT format );
+
+    static const char* ResultToString(Result result);
+
+private:
+    Result Validate();
+
+    // Bytes of one array item's full mip chain.
+    size_t ComputeItemSize()const;
+
+private:
+    const DDS_HEADER* mHeader = nullptr;
+    const DDS_HEADER_DXT10* mHeaderDXT10 = nullptr;
+    const uint8_t* mBitData = nullptr;
+    size_t mBitSize = 0;
+
+    Dimension mDimension = Dimension_Unknown;
+    DXGI_FORMAT mFormat = DXGI_FORMAT_UNKNOWN;
+    size_t mWidth = 0;
+    size_t mHeight = 0;
+    size_t mDepth = 0;
+    size_t mMipCount = 0;
+    size_t mArraySize = 0;
+    bool mIsCubeMap = false;
+
+    size_t mItemSize = 0;
+};
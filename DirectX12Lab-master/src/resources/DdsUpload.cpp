@@ -0,0 +1,196 @@
+#include "DdsUpload.h"
+
+#include <utility>
+
+#include "TextureFootprint.h"
+
+using Microsoft::WRL::ComPtr;
+
+static UINT64 AlignUp(UINT64 value, UINT64 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void GetSubresourceFootprint(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc, UINT sub,
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout, UINT& numRows, UINT64& rowSize)
+{
+    TextureFootprintDesc footprintDesc;
+    footprintDesc.Dimension = static_cast<FootprintDimension>(desc.Dimension);
+    footprintDesc.Format = desc.Format;
+    footprintDesc.Width = desc.Width;
+    footprintDesc.Height = desc.Height;
+    footprintDesc.DepthOrArraySize = desc.DepthOrArraySize;
+    footprintDesc.MipLevels = desc.MipLevels;
+
+    SubresourceFootprint footprint;
+    if(desc.SampleDesc.Count > 1 || !TextureFootprint::Compute(footprintDesc, sub, 0, footprint))
+    {
+        device->GetCopyableFootprints(&desc, sub, 1, 0, &layout, &numRows, &rowSize, nullptr);
+        return;
+    }
+
+    layout.Offset = footprint.Offset;
+    layout.Footprint.Format = footprint.Format;
+    layout.Footprint.Width = footprint.Width;
+    layout.Footprint.Height = footprint.Height;
+    layout.Footprint.Depth = footprint.Depth;
+    layout.Footprint.RowPitch = footprint.RowPitch;
+    numRows = footprint.NumRows;
+    rowSize = footprint.RowSizeInBytes;
+}
+
+void FillSubresourceData(const DdsImage::Subresource* subresources, size_t count, D3D12_SUBRESOURCE_DATA* out)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        out[i].pData = subresources[i].Data;
+        out[i].RowPitch = static_cast<LONG_PTR>(subresources[i].RowPitch);
+        out[i].SlicePitch = static_cast<LONG_PTR>(subresources[i].SlicePitch);
+    }
+}
+
+std::vector<D3D12_SUBRESOURCE_DATA> MakeSubresourceData(const MipChain& chain)
+{
+    const std::vector<DdsImage::Subresource>& subresources = chain.GetSubresources();
+
+    std::vector<D3D12_SUBRESOURCE_DATA> data(subresources.size());
+    FillSubresourceData(subresources.data(), subresources.size(), data.data());
+    return data;
+}
+
+D3D12_RESOURCE_DESC MakeDdsTextureDesc(const DdsImage& image, UINT firstMip)
+{
+    const bool is3D = image.GetDimension() == DdsImage::Dimension_Texture3D;
+    const DdsImage::Subresource top = image.GetSubresource(firstMip, 0);
+
+    D3D12_RESOURCE_DESC texDesc = {};
+    texDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(image.GetDimension());
+    texDesc.Width = top.Width;
+    texDesc.Height = (UINT)top.Height;
+    texDesc.DepthOrArraySize = is3D ? (UINT16)top.Depth : (UINT16)image.GetArraySize();
+    texDesc.MipLevels = (UINT16)(image.GetMipCount() - firstMip);
+    texDesc.Format = image.GetFormat();
+    texDesc.SampleDesc.Count = 1;
+    texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+    return texDesc;
+}
+
+DdsUploadResult CreateDdsTexture(
+    ID3D12Device* device,
+    ID3D12GraphicsCommandList* cmdList,
+    UploadRing& uploadRing,
+    UINT64 fenceValue,
+    GpuHeap* gpuHeap,
+    const DdsImage& image,
+    UINT firstMip,
+    UINT uploadEnd,
+    ComPtr<ID3D12Resource>& texture,
+    GpuHeapAllocation* heapAllocation)
+{
+    texture = nullptr;
+
+    const D3D12_RESOURCE_DESC texDesc = MakeDdsTextureDesc(image, firstMip);
+
+    const UINT newMips = texDesc.MipLevels;
+    const UINT arraySize = texDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : texDesc.DepthOrArraySize;
+
+    // Stage only the mips that come from the file, packed back to back.
+    UINT64 stagingSize = 0;
+    for(UINT item = 0; item < arraySize; ++item)
+    {
+        for(UINT mip = firstMip; mip < uploadEnd; ++mip)
+        {
+            const UINT sub = D3D12CalcSubresource(mip - firstMip, item, 0, newMips, arraySize);
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout;
+            UINT numRows = 0;
+            UINT64 rowSize = 0;
+            GetSubresourceFootprint(device, texDesc, sub, layout, numRows, rowSize);
+
+            stagingSize = AlignUp(stagingSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+            stagingSize += (UINT64)layout.Footprint.RowPitch * numRows * layout.Footprint.Depth;
+        }
+    }
+
+    // The texture is created before the staging space: a ring allocation can not
+    // be handed back, but an unused texture can.
+    ComPtr<ID3D12Resource> created;
+    GpuHeapAllocation placement;
+    HRESULT hr;
+    if(gpuHeap != nullptr)
+    {
+        hr = gpuHeap->CreateResource(texDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, created, &placement);
+    }
+    else
+    {
+        CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+
+        hr = device->CreateCommittedResource(
+            &defaultHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &texDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(created.GetAddressOf()));
+    }
+
+    if(FAILED(hr))
+        return DdsUpload_Failed;
+
+    UploadRing::Allocation staging;
+    if(stagingSize > 0 &&
+        !uploadRing.Allocate(stagingSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, fenceValue, staging))
+    {
+        created = nullptr;
+        if(gpuHeap != nullptr)
+            gpuHeap->Release(placement);
+
+        // A request larger than the ring fails for good unless the ring falls back
+        // to a one-off buffer, which Allocate() already tried.
+        return stagingSize > uploadRing.GetCapacity() ? DdsUpload_Failed : DdsUpload_RingFull;
+    }
+
+    // File -> staging -> texture.
+    UINT64 stagingOffset = 0;
+    for(UINT item = 0; item < arraySize; ++item)
+    {
+        for(UINT mip = firstMip; mip < uploadEnd; ++mip)
+        {
+            const UINT sub = D3D12CalcSubresource(mip - firstMip, item, 0, newMips, arraySize);
+            const DdsImage::Subresource src = image.GetSubresource(mip, item);
+
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout;
+            UINT numRows = 0;
+            UINT64 rowSize = 0;
+            GetSubresourceFootprint(device, texDesc, sub, layout, numRows, rowSize);
+
+            stagingOffset = AlignUp(stagingOffset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+            layout.Offset = staging.Offset + stagingOffset;
+
+            BYTE* dest = staging.CpuAddress + stagingOffset;
+            const size_t rowBytes = (size_t)std::min<UINT64>(rowSize, src.RowPitch);
+            for(UINT z = 0; z < layout.Footprint.Depth; ++z)
+            {
+                const BYTE* srcSlice = src.Data + src.SlicePitch * z;
+                BYTE* destSlice = dest + (size_t)layout.Footprint.RowPitch * numRows * z;
+                for(UINT row = 0; row < numRows; ++row)
+                {
+                    memcpy(destSlice + (size_t)layout.Footprint.RowPitch * row,
+                        srcSlice + src.RowPitch * row, rowBytes);
+                }
+            }
+
+            stagingOffset += (UINT64)layout.Footprint.RowPitch * numRows * layout.Footprint.Depth;
+
+            CD3DX12_TEXTURE_COPY_LOCATION dst(created.Get(), sub);
+            CD3DX12_TEXTURE_COPY_LOCATION srcLoc(staging.Resource, layout);
+            cmdList->CopyTextureRegion(&dst, 0, 0, 0, &srcLoc, nullptr);
+        }
+    }
+
+    texture = std::move(created);
+    if(heapAllocation != nullptr)
+        *heapAllocation = placement;
+
+    return DdsUpload_Done;
+}
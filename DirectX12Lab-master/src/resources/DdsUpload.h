@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "../graphics/Dx12Utils.h"
+#include "../graphics/GpuHeap.h"
+#include "../graphics/UploadRing.h"
+#include "DdsImage.h"
+#include "MipGenerator.h"
+
+// Copy layout of one subresource, at offset 0.  Computed on the CPU; the device
+// is only asked for layouts TextureFootprint does not know (MSAA, other formats).
+void GetSubresourceFootprint(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc, UINT sub,
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout, UINT& numRows, UINT64& rowSize);
+
+// pData/RowPitch/SlicePitch of each subresource, for UpdateSubresources().
+void FillSubresourceData(const DdsImage::Subresource* subresources, size_t count, D3D12_SUBRESOURCE_DATA* out);
+
+// The whole generated chain, in the order CreateTexture/UpdateSubresources expect.
+std::vector<D3D12_SUBRESOURCE_DATA> MakeSubresourceData(const MipChain& chain);
+
+// Texture holding mips [firstMip, mipCount) of every array item of image.
+D3D12_RESOURCE_DESC MakeDdsTextureDesc(const DdsImage& image, UINT firstMip);
+
+enum DdsUploadResult
+{
+    DdsUpload_Done,
+    DdsUpload_RingFull, // no staging room right now; retry after UploadRing::Reclaim()
+    DdsUpload_Failed,   // staging larger than the whole ring, or the texture could not be created
+};
+
+// Creates the MakeDdsTextureDesc(image, firstMip) texture in the COPY_DEST state
+// (placed in gpuHeap when given) and records copies of file mips
+// [firstMip, uploadEnd) into it, staged through uploadRing under fenceValue.  The
+// caller fills the remaining mips, if any, and transitions the texture.
+//
+// Anything but DdsUpload_Done leaves texture null and records nothing.  A placed
+// texture's handle goes to heapAllocation, for GpuHeap::Release() once the GPU
+// is done with it.
+DdsUploadResult CreateDdsTexture(
+    ID3D12Device* device,
+    ID3D12GraphicsCommandList* cmdList,
+    UploadRing& uploadRing,
+    UINT64 fenceValue,
+    GpuHeap* gpuHeap,
+    const DdsImage& image,
+    UINT firstMip,
+    UINT uploadEnd,
+    Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+    GpuHeapAllocation* heapAllocation = nullptr);
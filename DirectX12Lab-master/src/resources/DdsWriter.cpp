@@ -0,0 +1,180 @@
+#include "DdsWriter.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+			(format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+
+	DDS_PIXELFORMAT MakeMaskFormat(uint32_t flags, uint32_t bitCount, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+	{
+		DDS_PIXELFORMAT ddpf = {};
+		ddpf.size = sizeof(DDS_PIXELFORMAT);
+		ddpf.flags = flags | (a != 0 ? DDS_ALPHAPIXELS : 0);
+		ddpf.RGBBitCount = bitCount;
+		ddpf.RBitMask = r;
+		ddpf.GBitMask = g;
+		ddpf.BBitMask = b;
+		ddpf.ABitMask = a;
+		return ddpf;
+	}
+
+	DDS_PIXELFORMAT MakeFourCCFormat(uint32_t fourCC)
+	{
+		DDS_PIXELFORMAT ddpf = {};
+		ddpf.size = sizeof(DDS_PIXELFORMAT);
+		ddpf.flags = DDS_FOURCC;
+		ddpf.fourCC = fourCC;
+		return ddpf;
+	}
+
+	template<class T>
+	void Append(std::vector<uint8_t>& out, const T& value)
+	{
+		const size_t offset = out.size();
+		out.resize(offset + sizeof(T));
+		memcpy(out.data() + offset, &value, sizeof(T));
+	}
+}
+
+//--------------------------------------------------------------------------------------
+bool DdsWriter::GetLegacyPixelFormat(DXGI_FORMAT format, DDS_PIXELFORMAT& ddpf)
+{
+	switch(format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:     ddpf = MakeMaskFormat(DDS_RGB, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000); return true;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:     ddpf = MakeMaskFormat(DDS_RGB, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000); return true;
+	case DXGI_FORMAT_B8G8R8X8_UNORM:     ddpf = MakeMaskFormat(DDS_RGB, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000); return true;
+	case DXGI_FORMAT_R16G16_UNORM:       ddpf = MakeMaskFormat(DDS_RGB, 32, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000); return true;
+	case DXGI_FORMAT_B5G5R5A1_UNORM:     ddpf = MakeMaskFormat(DDS_RGB, 16, 0x7c00, 0x03e0, 0x001f, 0x8000); return true;
+	case DXGI_FORMAT_B5G6R5_UNORM:       ddpf = MakeMaskFormat(DDS_RGB, 16, 0xf800, 0x07e0, 0x001f, 0x0000); return true;
+	case DXGI_FORMAT_B4G4R4A4_UNORM:     ddpf = MakeMaskFormat(DDS_RGB, 16, 0x0f00, 0x00f0, 0x000f, 0xf000); return true;
+	case DXGI_FORMAT_R8_UNORM:           ddpf = MakeMaskFormat(DDS_LUMINANCE, 8, 0xff, 0, 0, 0); return true;
+	case DXGI_FORMAT_R16_UNORM:          ddpf = MakeMaskFormat(DDS_LUMINANCE, 16, 0xffff, 0, 0, 0); return true;
+	case DXGI_FORMAT_R8G8_UNORM:         ddpf = MakeMaskFormat(DDS_LUMINANCE, 16, 0x00ff, 0, 0, 0xff00); return true;
+	case DXGI_FORMAT_A8_UNORM:           ddpf = MakeMaskFormat(DDS_ALPHA, 8, 0, 0, 0, 0xff); ddpf.flags = DDS_ALPHA; return true;
+
+	case DXGI_FORMAT_BC1_UNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '1')); return true;
+	case DXGI_FORMAT_BC2_UNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '3')); return true;
+	case DXGI_FORMAT_BC3_UNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '5')); return true;
+	case DXGI_FORMAT_BC4_UNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('A', 'T', 'I', '1')); return true;
+	case DXGI_FORMAT_BC4_SNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('B', 'C', '4', 'S')); return true;
+	case DXGI_FORMAT_BC5_UNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('A', 'T', 'I', '2')); return true;
+	case DXGI_FORMAT_BC5_SNORM:          ddpf = MakeFourCCFormat(MAKEFOURCC('B', 'C', '5', 'S')); return true;
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:    ddpf = MakeFourCCFormat(MAKEFOURCC('R', 'G', 'B', 'G')); return true;
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:    ddpf = MakeFourCCFormat(MAKEFOURCC('G', 'R', 'G', 'B')); return true;
+	case DXGI_FORMAT_YUY2:               ddpf = MakeFourCCFormat(MAKEFOURCC('Y', 'U', 'Y', '2')); return true;
+
+	// D3DFMT values stored as the FourCC.
+	case DXGI_FORMAT_R16G16B16A16_UNORM: ddpf = MakeFourCCFormat(36); return true;
+	case DXGI_FORMAT_R16G16B16A16_SNORM: ddpf = MakeFourCCFormat(110); return true;
+	case DXGI_FORMAT_R16_FLOAT:          ddpf = MakeFourCCFormat(111); return true;
+	case DXGI_FORMAT_R16G16_FLOAT:       ddpf = MakeFourCCFormat(112); return true;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT: ddpf = MakeFourCCFormat(113); return true;
+	case DXGI_FORMAT_R32_FLOAT:          ddpf = MakeFourCCFormat(114); return true;
+	case DXGI_FORMAT_R32G32_FLOAT:       ddpf = MakeFourCCFormat(115); return true;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT: ddpf = MakeFourCCFormat(116); return true;
+
+	default:
+		return false;
+	}
+}
+
+//--------------------------------------------------------------------------------------
+bool DdsWriter::Write(const MipChain& chain, std::vector<uint8_t>& out, const DdsWriteOptions& options)
+{
+	out.clear();
+
+	if(chain.GetFormat() == DXGI_FORMAT_UNKNOWN || chain.GetSubresources().empty())
+	{
+		return false;
+	}
+
+	if(chain.IsCubeMap() && (chain.GetArraySize() % 6 != 0 || chain.GetWidth() != chain.GetHeight()))
+	{
+		return false;
+	}
+
+	const bool compressed = IsBlockCompressed(chain.GetFormat());
+
+	size_t numBytes = 0;
+	size_t rowBytes = 0;
+	DdsImage::GetSurfaceInfo(chain.GetWidth(), chain.GetHeight(), chain.GetFormat(), &numBytes, &rowBytes, nullptr);
+
+	DDS_HEADER header = {};
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP |
+		(compressed ? DDS_HEADER_FLAGS_LINEARSIZE : DDS_HEADER_FLAGS_PITCH);
+	header.height = static_cast<uint32_t>(chain.GetHeight());
+	header.width = static_cast<uint32_t>(chain.GetWidth());
+	header.pitchOrLinearSize = static_cast<uint32_t>(compressed ? numBytes : rowBytes);
+	header.mipMapCount = static_cast<uint32_t>(chain.GetMipCount());
+	header.caps = DDS_SURFACE_FLAGS_TEXTURE | (chain.GetMipCount() > 1 ? DDS_SURFACE_FLAGS_MIPMAP : 0);
+
+	if(chain.IsCubeMap())
+	{
+		header.caps |= DDS_SURFACE_FLAGS_CUBEMAP;
+		header.caps2 = DDS_CUBEMAP_ALLFACES;
+	}
+
+	// The legacy header has no array size: one texture, or one cube.
+	const size_t legacyItems = chain.IsCubeMap() ? 6 : 1;
+	const bool legacy = options.LegacyHeader && options.AlphaMode == 0 &&
+						chain.GetArraySize() == legacyItems &&
+						GetLegacyPixelFormat(chain.GetFormat(), header.ddspf);
+
+	out.reserve(sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) + chain.GetDataSize());
+	if(legacy)
+	{
+		Append(out, DDS_MAGIC);
+		Append(out, header);
+	}
+	else
+	{
+		header.ddspf = MakeFourCCFormat(MAKEFOURCC('D', 'X', '1', '0'));
+
+		DDS_HEADER_DXT10 headerDXT10 = {};
+		headerDXT10.dxgiFormat = chain.GetFormat();
+		headerDXT10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+		headerDXT10.miscFlag = chain.IsCubeMap() ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+		headerDXT10.arraySize = static_cast<uint32_t>(chain.GetArraySize() / legacyItems);
+		headerDXT10.miscFlags2 = options.AlphaMode & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+
+		Append(out, DDS_MAGIC);
+		Append(out, header);
+		Append(out, headerDXT10);
+	}
+
+	// Same order as the file: every mip of item 0, then item 1, ...
+	for(const DdsImage::Subresource& subresource : chain.GetSubresources())
+	{
+		out.insert(out.end(), subresource.Data, subresource.Data + subresource.SlicePitch * subresource.Depth);
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+bool DdsWriter::WriteFile(const MipChain& chain, const std::wstring& fileName, const DdsWriteOptions& options)
+{
+	std::vector<uint8_t> data;
+	if(!Write(chain, data, options))
+	{
+		return false;
+	}
+
+	std::ofstream file(std::filesystem::path(fileName), std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return file.good();
+}
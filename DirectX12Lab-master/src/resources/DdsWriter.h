@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MipGenerator.h"
+
+struct DdsWriteOptions
+{
+	bool LegacyHeader = false; // DX9-style header when the format and layout have one, for old tools
+	uint32_t AlphaMode = 0;    // DDS_ALPHA_MODE value stored in the DX10 header
+};
+
+//--------------------------------------------------------------------------------------
+// Serializes an in-memory texture back to a DDS file.
+//
+// Files carry the DX10 header extension by default, so any DXGI format, array
+// size and cube count round-trips, and DdsImage::Parse / CreateDDSTextureFromFile12
+// read them back unchanged.  With LegacyHeader, single textures and single cubes
+// in a format GetDXGIFormat maps back (RGBA8, BGRA8, BC1-BC5, float, ...) get the
+// plain header instead.  Pixel data is the MipChain's, which already has DDS layout.
+//--------------------------------------------------------------------------------------
+class DdsWriter
+{
+public:
+	// The whole chain as a 2D texture (array) or cube map (array).  Returns false
+	// for an empty chain or a cube map whose array size is not a multiple of 6.
+	static bool Write(const MipChain& chain, std::vector<uint8_t>& out,
+		const DdsWriteOptions& options = DdsWriteOptions());
+
+	// Write() to fileName, replacing it.
+	static bool WriteFile(const MipChain& chain, const std::wstring& fileName,
+		const DdsWriteOptions& options = DdsWriteOptions());
+
+	// Inverse of DdsImage::GetDXGIFormat; false when format needs the DX10 header.
+	static bool GetLegacyPixelFormat(DXGI_FORMAT format, DDS_PIXELFORMAT& ddpf);
+};
@@ -0,0 +1,84 @@
+#include "Dx12TextureCache.h"
+
+#include <cassert>
+
+#include "DdsImage.h"
+#include "TextureLoaderDDS.h"
+
+UINT64 CalcTextureBytes(const D3D12_RESOURCE_DESC& desc)
+{
+    const bool is3D = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+    const UINT64 arraySize = is3D ? 1 : desc.DepthOrArraySize;
+
+    UINT64 width = desc.Width;
+    UINT64 height = desc.Height;
+    UINT64 depth = is3D ? desc.DepthOrArraySize : 1;
+
+    UINT64 itemBytes = 0;
+    for(UINT mip = 0; mip < desc.MipLevels; ++mip)
+    {
+        size_t numBytes = 0;
+        DdsImage::GetSurfaceInfo((size_t)width, (size_t)height, desc.Format, &numBytes, nullptr, nullptr);
+        itemBytes += (UINT64)numBytes * depth;
+
+        width = std::max<UINT64>(width / 2, 1);
+        height = std::max<UINT64>(height / 2, 1);
+        depth = std::max<UINT64>(depth / 2, 1);
+    }
+
+    return itemBytes * arraySize;
+}
+
+DdsTextureLoader::DdsTextureLoader(ID3D12Device* device, size_t maxsize)
+: mDevice(device), mMaxSize(maxsize)
+{
+}
+
+void DdsTextureLoader::BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue)
+{
+    mCmdList = cmdList;
+    mFenceValue = fenceValue;
+    mRecordingThread = std::this_thread::get_id();
+}
+
+void DdsTextureLoader::Reclaim(UINT64 completedFenceValue)
+{
+    while(!mPendingUploads.empty() && mPendingUploads.front().FenceValue <= completedFenceValue)
+        mPendingUploads.pop_front();
+}
+
+Dx12TextureCache::Loader DdsTextureLoader::GetLoader()
+{
+    return [this](const std::wstring& path, Dx12TextureCache::LoadResult& out)
+    {
+        return Load(path, out);
+    };
+}
+
+bool DdsTextureLoader::Load(const std::wstring& path, Dx12TextureCache::LoadResult& out)
+{
+    // The cache runs the loader on the thread that missed; the command list is
+    // not free-threaded.
+    assert(mCmdList != nullptr);
+    assert(std::this_thread::get_id() == mRecordingThread);
+
+    auto texture = std::make_shared<Texture>();
+    texture->Filename = path;
+
+    int nameLength = WideCharToMultiByte(CP_UTF8, 0, path.c_str(), (int)path.size(), nullptr, 0, nullptr, nullptr);
+    texture->Name.resize(nameLength);
+    WideCharToMultiByte(CP_UTF8, 0, path.c_str(), (int)path.size(), &texture->Name[0], nameLength, nullptr, nullptr);
+
+    PendingUpload upload;
+    HRESULT hr = DirectX::CreateDDSTextureFromFile12(mDevice, mCmdList, path.c_str(),
+        texture->Resource, upload.UploadHeap, mMaxSize);
+    if(FAILED(hr))
+        return false;
+
+    upload.FenceValue = mFenceValue;
+    mPendingUploads.push_back(std::move(upload));
+
+    out.Bytes = CalcTextureBytes(texture->Resource->GetDesc());
+    out.Texture = std::move(texture);
+    return true;
+}
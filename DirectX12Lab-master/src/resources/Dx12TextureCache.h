@@ -0,0 +1,57 @@
+#pragma once
+
+#include <deque>
+#include <thread>
+
+#include "../graphics/Dx12Utils.h"
+#include "TextureCache.h"
+
+typedef TextureCache<Texture> Dx12TextureCache;
+
+// Bytes of all subresources of a texture as laid out in a DDS file, from
+// DdsImage::GetSurfaceInfo; what the cache budget counts.
+UINT64 CalcTextureBytes(const D3D12_RESOURCE_DESC& desc);
+
+// Loader for Dx12TextureCache that reads DDS files with CreateDDSTextureFromFile12.
+//
+// The copies are recorded into one command list, so cache misses must happen on
+// the thread recording it (asserted); only hits may come from other threads.  The
+// upload heap of each copy is kept here, not in the cached Texture, until
+// Reclaim() sees its fence complete, so the cache budget counts what stays
+// resident.  Handles are usable once the frame's list has executed.
+class DdsTextureLoader
+{
+public:
+    DdsTextureLoader(ID3D12Device* device, size_t maxsize = 0);
+    DdsTextureLoader(const DdsTextureLoader& rhs) = delete;
+    DdsTextureLoader& operator=(const DdsTextureLoader& rhs) = delete;
+
+    // Copies recorded until the next BeginFrame() go into cmdList and are covered
+    // by fenceValue.  The calling thread becomes the only one allowed to miss.
+    void BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue);
+
+    // Frees the upload heaps of copies covered by completedFenceValue.
+    void Reclaim(UINT64 completedFenceValue);
+
+    // For the cache's constructor; refers to this object, which must outlive it.
+    Dx12TextureCache::Loader GetLoader();
+
+private:
+    struct PendingUpload
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> UploadHeap;
+        UINT64 FenceValue = 0;
+    };
+
+    bool Load(const std::wstring& path, Dx12TextureCache::LoadResult& out);
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    size_t mMaxSize = 0;
+
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+    UINT64 mFenceValue = 0;
+    std::thread::id mRecordingThread;
+
+    std::deque<PendingUpload> mPendingUploads;
+};
@@ -0,0 +1,61 @@
+#include "Dx12TextureUploadTarget.h"
+
+using Microsoft::WRL::ComPtr;
+
+Dx12TextureUploadTarget::Dx12TextureUploadTarget(ID3D12Device* device, UploadRing& uploadRing, GpuHeap* gpuHeap)
+: mDevice(device), mUploadRing(uploadRing), mGpuHeap(gpuHeap)
+{
+}
+
+void Dx12TextureUploadTarget::BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue)
+{
+    mCmdList = cmdList;
+    mFenceValue = fenceValue;
+}
+
+TextureUploadResult Dx12TextureUploadTarget::Upload(const LoadedTexture& texture)
+{
+    assert(mCmdList != nullptr);
+
+    const DdsImage& image = texture.Image;
+    ComPtr<ID3D12Resource> resource;
+    switch(CreateDdsTexture(mDevice, mCmdList, mUploadRing, mFenceValue,
+        mGpuHeap, image, 0, (UINT)image.GetMipCount(), resource))
+    {
+    case DdsUpload_Done:     break;
+    case DdsUpload_RingFull: return TextureUpload_Busy;
+    default:                 return TextureUpload_Failed;
+    }
+
+    auto toShaderResource = CD3DX12_RESOURCE_BARRIER::Transition(
+        resource.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    mCmdList->ResourceBarrier(1, &toShaderResource);
+
+    UploadedTexture uploaded;
+    uploaded.RequestId = texture.RequestId;
+    uploaded.Path = texture.Path;
+    uploaded.UserData = texture.UserData;
+    uploaded.Resource = std::move(resource);
+    mCompleted.push_back(std::move(uploaded));
+
+    return TextureUpload_Done;
+}
+
+void Dx12TextureUploadTarget::OnLoadFailed(const LoadedTexture& texture)
+{
+    UploadedTexture failed;
+    failed.RequestId = texture.RequestId;
+    failed.Path = texture.Path;
+    failed.UserData = texture.UserData;
+    mCompleted.push_back(std::move(failed));
+}
+
+void Dx12TextureUploadTarget::TakeCompleted(std::vector<UploadedTexture>& out)
+{
+    out.insert(out.end(),
+        std::make_move_iterator(mCompleted.begin()),
+        std::make_move_iterator(mCompleted.end()));
+    mCompleted.clear();
+}
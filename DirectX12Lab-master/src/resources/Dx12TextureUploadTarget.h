@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "AsyncTextureLoader.h"
+#include "DdsUpload.h"
+
+// Records the GPU copies for textures finished by an AsyncTextureLoader.
+//
+// Every Upload() creates the full texture and stages its mips through the shared
+// UploadRing; when the ring is full it refuses and the loader offers the texture
+// again next frame.  A texture that needs more staging than the whole ring fails
+// and is reported like a file that could not be loaded.  Finished textures are collected for TakeCompleted() and are
+// usable once the command list of the frame they were uploaded in has executed.
+class Dx12TextureUploadTarget : public ITextureUploadTarget
+{
+public:
+    struct UploadedTexture
+    {
+        std::uint64_t RequestId = 0;
+        std::string Path;
+        void* UserData = nullptr;
+
+        // Null when the file could not be loaded.
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+    };
+
+    Dx12TextureUploadTarget(ID3D12Device* device, UploadRing& uploadRing, GpuHeap* gpuHeap = nullptr);
+    Dx12TextureUploadTarget(const Dx12TextureUploadTarget& rhs) = delete;
+    Dx12TextureUploadTarget& operator=(const Dx12TextureUploadTarget& rhs) = delete;
+
+    // Copies go into cmdList and are covered by fenceValue.  Call before
+    // AsyncTextureLoader::ProcessCompletions().
+    void BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue);
+
+    TextureUploadResult Upload(const LoadedTexture& texture) override;
+    void OnLoadFailed(const LoadedTexture& texture) override;
+
+    // Appends the textures finished since the last call to out.
+    void TakeCompleted(std::vector<UploadedTexture>& out);
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    UploadRing& mUploadRing;
+    GpuHeap* mGpuHeap = nullptr;
+
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+    UINT64 mFenceValue = 0;
+
+    std::vector<UploadedTexture> mCompleted;
+};
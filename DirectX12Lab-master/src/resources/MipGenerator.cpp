@@ -0,0 +1,580 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PixelConverter.h"
+#include "../core/ParallelFor.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define MIP_GENERATOR_SSE2 0
+#endif
+
+namespace
+{
+	enum ChannelType
+	{
+		Channel_UNorm8,
+		Channel_Float16,
+		Channel_Float32,
+	};
+
+	struct PixelFormat
+	{
+		ChannelType Type = Channel_UNorm8;
+		size_t Channels = 0;
+		bool Srgb = false;
+
+		size_t GetPixelSize()const
+		{
+			return Channels * (Type == Channel_UNorm8 ? 1 : (Type == Channel_Float16 ? 2 : 4));
+		}
+	};
+
+	bool GetPixelFormat(DXGI_FORMAT format, PixelFormat& out)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_R8_UNORM:                out = { Channel_UNorm8, 1, false }; return true;
+		case DXGI_FORMAT_R8G8_UNORM:              out = { Channel_UNorm8, 2, false }; return true;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:          out = { Channel_UNorm8, 4, false }; return true;
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:     out = { Channel_UNorm8, 4, true }; return true;
+		case DXGI_FORMAT_R16_FLOAT:               out = { Channel_Float16, 1, false }; return true;
+		case DXGI_FORMAT_R16G16_FLOAT:            out = { Channel_Float16, 2, false }; return true;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:      out = { Channel_Float16, 4, false }; return true;
+		case DXGI_FORMAT_R32_FLOAT:               out = { Channel_Float32, 1, false }; return true;
+		case DXGI_FORMAT_R32G32_FLOAT:            out = { Channel_Float32, 2, false }; return true;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:      out = { Channel_Float32, 4, false }; return true;
+		default:
+			return false;
+		}
+	}
+
+	// Below this many destination pixels a level is filtered on one thread.
+	const size_t MinPixelsPerThread = 64 * 1024;
+
+	//----------------------------------------------------------------------------
+	// Conversions
+	//----------------------------------------------------------------------------
+
+	float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	struct SrgbTables
+	{
+		float ToLinear[256];
+		float Thresholds[255]; // linear value halfway (in sRGB) between codes k and k + 1
+
+		SrgbTables()
+		{
+			for(int i = 0; i < 256; ++i)
+				ToLinear[i] = SrgbToLinear(i / 255.0f);
+			for(int i = 0; i < 255; ++i)
+				Thresholds[i] = SrgbToLinear((i + 0.5f) / 255.0f);
+		}
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	inline std::uint8_t LinearToSrgb8(const SrgbTables& tables, float value)
+	{
+		return (std::uint8_t)(std::upper_bound(tables.Thresholds, tables.Thresholds + 255, value) - tables.Thresholds);
+	}
+
+	inline std::uint8_t FloatToUNorm8(float value)
+	{
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return (std::uint8_t)(value * 255.0f + 0.5f);
+	}
+
+	void LoadRow(const PixelFormat& format, const std::uint8_t* src, size_t width, float* out, bool useSimd)
+	{
+		const size_t count = width * format.Channels;
+
+		switch(format.Type)
+		{
+		case Channel_UNorm8:
+		{
+			size_t i = 0;
+			if(format.Srgb)
+			{
+				const SrgbTables& tables = GetSrgbTables();
+				for(; i < count; i += 4)
+				{
+					out[i + 0] = tables.ToLinear[src[i + 0]];
+					out[i + 1] = tables.ToLinear[src[i + 1]];
+					out[i + 2] = tables.ToLinear[src[i + 2]];
+					out[i + 3] = src[i + 3] * (1.0f / 255.0f);
+				}
+				break;
+			}
+#if MIP_GENERATOR_SSE2
+			if(useSimd)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+				for(; i + 16 <= count; i += 16)
+				{
+					const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+					const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+					_mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+					_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+					_mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+					_mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+				}
+			}
+#endif
+			for(; i < count; ++i)
+				out[i] = src[i] * (1.0f / 255.0f);
+			break;
+		}
+
+		case Channel_Float16:
+			PixelConverter::HalfToFloat(reinterpret_cast<const std::uint16_t*>(src), out, count, useSimd);
+			break;
+
+		case Channel_Float32:
+			memcpy(out, src, count * sizeof(float));
+			break;
+		}
+
+		(void)useSimd;
+	}
+
+	void StoreRow(const PixelFormat& format, const float* src, size_t width, std::uint8_t* out, bool useSimd)
+	{
+		const size_t count = width * format.Channels;
+
+		switch(format.Type)
+		{
+		case Channel_UNorm8:
+		{
+			size_t i = 0;
+			if(format.Srgb)
+			{
+				const SrgbTables& tables = GetSrgbTables();
+				for(; i < count; i += 4)
+				{
+					out[i + 0] = LinearToSrgb8(tables, src[i + 0]);
+					out[i + 1] = LinearToSrgb8(tables, src[i + 1]);
+					out[i + 2] = LinearToSrgb8(tables, src[i + 2]);
+					out[i + 3] = FloatToUNorm8(src[i + 3]);
+				}
+				break;
+			}
+#if MIP_GENERATOR_SSE2
+			if(useSimd)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 scale = _mm_set1_ps(255.0f);
+				const __m128 half = _mm_set1_ps(0.5f);
+				for(; i + 16 <= count; i += 16)
+				{
+					__m128i v[4];
+					for(int k = 0; k < 4; ++k)
+					{
+						const __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + k * 4), zero), one);
+						v[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), half));
+					}
+					const __m128i words = _mm_packs_epi32(v[0], v[1]);
+					const __m128i words2 = _mm_packs_epi32(v[2], v[3]);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words2));
+				}
+			}
+#endif
+			for(; i < count; ++i)
+				out[i] = FloatToUNorm8(src[i]);
+			break;
+		}
+
+		case Channel_Float16:
+			PixelConverter::FloatToHalf(src, reinterpret_cast<std::uint16_t*>(out), count, useSimd);
+			break;
+
+		case Channel_Float32:
+			memcpy(out, src, count * sizeof(float));
+			break;
+		}
+
+		(void)useSimd;
+	}
+
+	//----------------------------------------------------------------------------
+	// Filters
+	//----------------------------------------------------------------------------
+
+	// Source indices and weights for each destination pixel along one axis,
+	// TapCount per pixel, unused taps have weight 0.
+	struct FilterTaps
+	{
+		size_t TapCount = 0;
+		std::vector<std::int32_t> Indices;
+		std::vector<float> Weights;
+	};
+
+	const double KaiserAlpha = 4.0;
+	const double KaiserRadius = 3.0; // in destination pixels
+
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for(int k = 1; k < 32; ++k)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+			if(term < sum * 1e-12)
+				break;
+		}
+		return sum;
+	}
+
+	double Kaiser(double t)
+	{
+		if(std::fabs(t) >= KaiserRadius)
+			return 0.0;
+
+		const double pi = 3.14159265358979323846;
+		const double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+		const double x = t / KaiserRadius;
+		return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0 - x * x)) / BesselI0(KaiserAlpha);
+	}
+
+	std::int32_t AddressIndex(std::int64_t index, size_t size, MipAddressMode mode)
+	{
+		const std::int64_t n = (std::int64_t)size;
+		if(mode == MipAddress_Wrap)
+			return (std::int32_t)(((index % n) + n) % n);
+		return (std::int32_t)std::min(std::max<std::int64_t>(index, 0), n - 1);
+	}
+
+	void BuildTaps(size_t srcSize, size_t dstSize, MipFilter filter, MipAddressMode mode, FilterTaps& taps)
+	{
+		const double scale = (double)srcSize / (double)dstSize;
+
+		std::vector<std::int64_t> first(dstSize);
+		std::vector<std::int64_t> last(dstSize);
+		for(size_t d = 0; d < dstSize; ++d)
+		{
+			if(filter == MipFilter_Box)
+			{
+				first[d] = (std::int64_t)std::floor(d * scale);
+				last[d] = (std::int64_t)std::ceil((d + 1) * scale) - 1;
+			}
+			else
+			{
+				const double center = (d + 0.5) * scale;
+				first[d] = (std::int64_t)std::floor(center - KaiserRadius * scale);
+				last[d] = (std::int64_t)std::ceil(center + KaiserRadius * scale);
+			}
+		}
+
+		taps.TapCount = 0;
+		for(size_t d = 0; d < dstSize; ++d)
+			taps.TapCount = std::max(taps.TapCount, (size_t)(last[d] - first[d] + 1));
+
+		taps.Indices.assign(dstSize * taps.TapCount, 0);
+		taps.Weights.assign(dstSize * taps.TapCount, 0.0f);
+
+		std::vector<double> weights(taps.TapCount);
+		for(size_t d = 0; d < dstSize; ++d)
+		{
+			double total = 0.0;
+			for(std::int64_t i = first[d]; i <= last[d]; ++i)
+			{
+				double w;
+				if(filter == MipFilter_Box)
+				{
+					// Overlap of source pixel [i, i+1) with the footprint.
+					w = std::min<double>((double)(i + 1), (d + 1) * scale) - std::max<double>((double)i, d * scale);
+				}
+				else
+				{
+					w = Kaiser((i + 0.5 - (d + 0.5) * scale) / scale);
+				}
+				weights[(size_t)(i - first[d])] = w;
+				total += w;
+			}
+
+			const size_t base = d * taps.TapCount;
+			for(std::int64_t i = first[d]; i <= last[d]; ++i)
+			{
+				const size_t k = (size_t)(i - first[d]);
+				taps.Indices[base + k] = AddressIndex(i, srcSize, mode);
+				taps.Weights[base + k] = (float)(weights[k] / total);
+			}
+		}
+	}
+
+	// out[i] += weight * row[i]
+	void AccumulateRow(float* out, const float* row, size_t count, float weight, bool useSimd)
+	{
+		size_t i = 0;
+#if MIP_GENERATOR_SSE2
+		if(useSimd)
+		{
+			const __m128 w = _mm_set1_ps(weight);
+			for(; i + 4 <= count; i += 4)
+				_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(row + i), w)));
+		}
+#endif
+		for(; i < count; ++i)
+			out[i] += weight * row[i];
+
+		(void)useSimd;
+	}
+
+	void FilterRowHorizontal(const float* src, size_t channels, const FilterTaps& taps, size_t dstWidth,
+		float* out, bool useSimd)
+	{
+		const size_t tapCount = taps.TapCount;
+
+#if MIP_GENERATOR_SSE2
+		if(useSimd && channels == 4)
+		{
+			for(size_t x = 0; x < dstWidth; ++x)
+			{
+				const std::int32_t* indices = &taps.Indices[x * tapCount];
+				const float* weights = &taps.Weights[x * tapCount];
+
+				__m128 sum = _mm_setzero_ps();
+				for(size_t k = 0; k < tapCount; ++k)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + indices[k] * 4), _mm_set1_ps(weights[k])));
+				_mm_storeu_ps(out + x * 4, sum);
+			}
+			return;
+		}
+#endif
+		(void)useSimd;
+
+		for(size_t x = 0; x < dstWidth; ++x)
+		{
+			const std::int32_t* indices = &taps.Indices[x * tapCount];
+			const float* weights = &taps.Weights[x * tapCount];
+
+			for(size_t c = 0; c < channels; ++c)
+			{
+				float sum = 0.0f;
+				for(size_t k = 0; k < tapCount; ++k)
+					sum += src[indices[k] * channels + c] * weights[k];
+				out[x * channels + c] = sum;
+			}
+		}
+	}
+
+	struct Level
+	{
+		const std::uint8_t* Src;
+		size_t SrcRowPitch;
+		size_t SrcWidth;
+		std::uint8_t* Dst;
+		size_t DstRowPitch;
+		size_t DstWidth;
+	};
+
+	// Destination rows [firstRow, endRow) of one level of one item.
+	void FilterRows(const PixelFormat& format, const Level& level,
+		const FilterTaps& horizontal, const FilterTaps& vertical,
+		size_t firstRow, size_t endRow, bool useSimd)
+	{
+		const size_t channels = format.Channels;
+		const size_t srcCount = level.SrcWidth * channels;
+
+		// Converted source rows, reused while the vertical window slides down.
+		const size_t slots = vertical.TapCount;
+		std::vector<float> cache(slots * srcCount);
+		std::vector<std::int64_t> cachedRow(slots, -1);
+
+		std::vector<float> column(srcCount);
+		std::vector<float> row(level.DstWidth * channels);
+
+		for(size_t y = firstRow; y < endRow; ++y)
+		{
+			std::fill(column.begin(), column.end(), 0.0f);
+
+			const std::int32_t* indices = &vertical.Indices[y * slots];
+			const float* weights = &vertical.Weights[y * slots];
+			for(size_t k = 0; k < slots; ++k)
+			{
+				if(weights[k] == 0.0f)
+					continue;
+
+				const std::int32_t srcRow = indices[k];
+				const size_t slot = (size_t)srcRow % slots;
+				float* converted = &cache[slot * srcCount];
+				if(cachedRow[slot] != srcRow)
+				{
+					LoadRow(format, level.Src + srcRow * level.SrcRowPitch, level.SrcWidth, converted, useSimd);
+					cachedRow[slot] = srcRow;
+				}
+				AccumulateRow(column.data(), converted, srcCount, weights[k], useSimd);
+			}
+
+			FilterRowHorizontal(column.data(), channels, horizontal, level.DstWidth, row.data(), useSimd);
+			StoreRow(format, row.data(), level.DstWidth, level.Dst + y * level.DstRowPitch, useSimd);
+		}
+	}
+}
+
+void MipChain::Reset(DXGI_FORMAT format, size_t width, size_t height, size_t mipCount, size_t arraySize)
+{
+	mFormat = format;
+	mWidth = width;
+	mHeight = height;
+	mMipCount = mipCount;
+	mArraySize = arraySize;
+	mIsCubeMap = false;
+
+	// Lay out every subresource, then allocate once.
+	mSubresources.assign(mipCount * arraySize, DdsImage::Subresource());
+	std::vector<size_t> offsets(mSubresources.size());
+	size_t totalSize = 0;
+	for(size_t item = 0; item < arraySize; ++item)
+	{
+		size_t w = width;
+		size_t h = height;
+		for(size_t mip = 0; mip < mipCount; ++mip)
+		{
+			DdsImage::Subresource& sub = mSubresources[item * mipCount + mip];
+			DdsImage::GetSurfaceInfo(w, h, format, &sub.SlicePitch, &sub.RowPitch, &sub.NumRows);
+			sub.Width = w;
+			sub.Height = h;
+			sub.Depth = 1;
+
+			offsets[item * mipCount + mip] = totalSize;
+			totalSize += sub.SlicePitch;
+
+			w = std::max<size_t>(w / 2, 1);
+			h = std::max<size_t>(h / 2, 1);
+		}
+	}
+
+	mData.assign(totalSize, 0);
+	for(size_t i = 0; i < mSubresources.size(); ++i)
+		mSubresources[i].Data = mData.data() + offsets[i];
+}
+
+bool MipGenerator::IsSupported(DXGI_FORMAT format)
+{
+	PixelFormat pixelFormat;
+	return GetPixelFormat(format, pixelFormat);
+}
+
+size_t MipGenerator::ComputeMipCount(size_t width, size_t height)
+{
+	size_t size = std::max(width, height);
+	size_t count = 1;
+	while(size > 1)
+	{
+		size >>= 1;
+		++count;
+	}
+	return count;
+}
+
+bool MipGenerator::Generate(const DdsImage& image, MipChain& out, const MipGenerateOptions& options)
+{
+	if(image.GetDimension() != DdsImage::Dimension_Texture1D && image.GetDimension() != DdsImage::Dimension_Texture2D)
+		return false;
+
+	const DdsImage::Subresource first = image.GetSubresource(0, 0);
+	const size_t itemPitch = image.GetArraySize() > 1
+		? (size_t)(image.GetSubresource(0, 1).Data - first.Data)
+		: first.SlicePitch;
+
+	if(!Generate(image.GetFormat(), first.Data, first.RowPitch, itemPitch,
+		image.GetWidth(), image.GetHeight(), image.GetArraySize(), out, options))
+	{
+		return false;
+	}
+
+	out.SetCubeMap(image.IsCubeMap());
+	return true;
+}
+
+bool MipGenerator::Generate(DXGI_FORMAT format,
+	const std::uint8_t* src, size_t rowPitch, size_t itemPitch,
+	size_t width, size_t height, size_t arraySize,
+	MipChain& out,
+	const MipGenerateOptions& options)
+{
+	PixelFormat pixelFormat;
+	if(!GetPixelFormat(format, pixelFormat) || src == nullptr || width == 0 || height == 0 || arraySize == 0)
+		return false;
+
+	if(options.ForceSrgb && pixelFormat.Type == Channel_UNorm8 && pixelFormat.Channels == 4)
+		pixelFormat.Srgb = true;
+
+	const size_t fullCount = std::min(ComputeMipCount(width, height), size_t(DdsImage::MaxMipLevels));
+	const size_t mipCount = options.MipCount != 0 ? std::min(options.MipCount, fullCount) : fullCount;
+
+	out.Reset(format, width, height, mipCount, arraySize);
+
+	for(size_t item = 0; item < arraySize; ++item)
+	{
+		const DdsImage::Subresource& top = out.GetSubresource(0, item);
+		for(size_t y = 0; y < height; ++y)
+			memcpy(out.GetMutableData(0, item) + y * top.RowPitch, src + item * itemPitch + y * rowPitch, top.RowPitch);
+	}
+
+	const unsigned maxThreads = options.ThreadCount != 0 ? options.ThreadCount : GetHardwareThreadCount();
+
+	FilterTaps horizontal;
+	FilterTaps vertical;
+	for(size_t mip = 1; mip < mipCount; ++mip)
+	{
+		const DdsImage::Subresource& srcLevel = out.GetSubresource(mip - 1, 0);
+		const DdsImage::Subresource& dstLevel = out.GetSubresource(mip, 0);
+
+		BuildTaps(srcLevel.Width, dstLevel.Width, options.Filter, options.AddressMode, horizontal);
+		BuildTaps(srcLevel.Height, dstLevel.Height, options.Filter, options.AddressMode, vertical);
+
+		// Work items are bands of rows of every array item.
+		const size_t pixels = dstLevel.Width * dstLevel.Height * arraySize;
+		const unsigned threadCount = (unsigned)std::min<size_t>(maxThreads, std::max<size_t>(pixels / MinPixelsPerThread, 1));
+		const size_t bandsPerItem = std::min<size_t>(dstLevel.Height,
+			std::max<size_t>((threadCount * 4 + arraySize - 1) / arraySize, 1));
+		const size_t rowsPerBand = (dstLevel.Height + bandsPerItem - 1) / bandsPerItem;
+
+		ParallelFor(arraySize * bandsPerItem, threadCount, [&](size_t task)
+		{
+			const size_t item = task / bandsPerItem;
+			const size_t band = task % bandsPerItem;
+			const size_t firstRow = band * rowsPerBand;
+			const size_t endRow = std::min(firstRow + rowsPerBand, dstLevel.Height);
+			if(firstRow >= endRow)
+				return;
+
+			const DdsImage::Subresource& s = out.GetSubresource(mip - 1, item);
+			const DdsImage::Subresource& d = out.GetSubresource(mip, item);
+
+			Level level;
+			level.Src = s.Data;
+			level.SrcRowPitch = s.RowPitch;
+			level.SrcWidth = s.Width;
+			level.Dst = out.GetMutableData(mip, item);
+			level.DstRowPitch = d.RowPitch;
+			level.DstWidth = d.Width;
+
+			FilterRows(pixelFormat, level, horizontal, vertical, firstRow, endRow, options.UseSimd);
+		});
+	}
+
+	return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DdsImage.h"
+
+enum MipFilter
+{
+	MipFilter_Box,    // area average; 2x2 for even sizes, fractional 3 taps for odd
+	MipFilter_Kaiser, // Kaiser-windowed sinc, sharper, may ring slightly
+};
+
+enum MipAddressMode
+{
+	MipAddress_Clamp,
+	MipAddress_Wrap,  // for tiling textures
+};
+
+struct MipGenerateOptions
+{
+	MipFilter Filter = MipFilter_Box;
+	MipAddressMode AddressMode = MipAddress_Clamp;
+	bool ForceSrgb = false;   // filter 8-bit UNORM colour as sRGB too (_SRGB formats always are)
+	size_t MipCount = 0;      // 0 = full chain
+	unsigned ThreadCount = 0; // 0 = all hardware threads
+	bool UseSimd = true;      // false runs the scalar reference path
+};
+
+// A texture in memory: every mip of every array item, tightly packed, in one
+// allocation.  GetSubresources() is in D3D order (mip fastest, then array item)
+// and maps 1:1 onto D3D12_SUBRESOURCE_DATA (see MakeSubresourceData in DdsUpload.h).
+class MipChain
+{
+public:
+	// Lays out and zero-fills mipCount mips of arraySize items (any format
+	// DdsImage::GetSurfaceInfo knows, block-compressed included).
+	void Reset(DXGI_FORMAT format, size_t width, size_t height, size_t mipCount, size_t arraySize);
+
+	// Items are cube faces, six per cube (+X, -X, +Y, -Y, +Z, -Z).  Reset clears it.
+	void SetCubeMap(bool cubeMap) { mIsCubeMap = cubeMap; }
+	bool IsCubeMap()const { return mIsCubeMap; }
+
+	DXGI_FORMAT GetFormat()const { return mFormat; }
+	size_t GetWidth()const { return mWidth; }
+	size_t GetHeight()const { return mHeight; }
+	size_t GetMipCount()const { return mMipCount; }
+	size_t GetArraySize()const { return mArraySize; }
+
+	const std::vector<DdsImage::Subresource>& GetSubresources()const { return mSubresources; }
+	const DdsImage::Subresource& GetSubresource(size_t mip, size_t arrayItem)const
+	{
+		return mSubresources[arrayItem * mMipCount + mip];
+	}
+
+	std::uint8_t* GetMutableData(size_t mip, size_t arrayItem)
+	{
+		return const_cast<std::uint8_t*>(GetSubresource(mip, arrayItem).Data);
+	}
+
+	const std::uint8_t* GetData()const { return mData.data(); }
+	size_t GetDataSize()const { return mData.size(); }
+
+private:
+	DXGI_FORMAT mFormat = DXGI_FORMAT_UNKNOWN;
+	size_t mWidth = 0;
+	size_t mHeight = 0;
+	size_t mMipCount = 0;
+	size_t mArraySize = 0;
+	bool mIsCubeMap = false;
+
+	std::vector<std::uint8_t> mData;
+	std::vector<DdsImage::Subresource> mSubresources;
+};
+
+// CPU mip-chain generation for uncompressed textures, at load time for DDS files
+// shipped without mips or offline in tools.  D3D12 has no GenerateMips, so this
+// replaces the D3D11 loader's autogen path.
+//
+// Supported: R8/R8G8/R8G8B8A8/B8G8R8A8/B8G8R8X8 UNORM (and _SRGB), and R/RG/RGBA
+// 16-bit and 32-bit FLOAT.  Each level is filtered from the previous one with a
+// separable filter in float; _SRGB (or ForceSrgb) colour is converted to linear
+// first so averages do not darken, alpha stays linear.
+//
+// The filter passes run in SSE2 (4 floats, i.e. one RGBA pixel, at a time) and
+// each level is split into bands of rows, across all array items and cube faces,
+// filtered with ParallelFor.
+class MipGenerator
+{
+public:
+	static bool IsSupported(DXGI_FORMAT format);
+
+	// floor(log2(max(width, height))) + 1.
+	static size_t ComputeMipCount(size_t width, size_t height);
+
+	// Replaces the mips of a 1D/2D (array, cube) DDS by filtering mip 0 of each
+	// item.  Returns false for 3D, compressed or unsupported formats.
+	static bool Generate(const DdsImage& image, MipChain& out,
+		const MipGenerateOptions& options = MipGenerateOptions());
+
+	// arraySize images of width x height pixels, rows rowPitch and images
+	// itemPitch bytes apart.
+	static bool Generate(DXGI_FORMAT format,
+		const std::uint8_t* src, size_t rowPitch, size_t itemPitch,
+		size_t width, size_t height, size_t arraySize,
+		MipChain& out,
+		const MipGenerateOptions& options = MipGenerateOptions());
+};
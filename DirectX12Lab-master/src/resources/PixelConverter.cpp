@@ -0,0 +1,723 @@
+#include "PixelConverter.h"
+#include "../core/ParallelFor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PIXEL_CONVERTER_SSE2 1
+#include <emmintrin.h>
+#else
+#define PIXEL_CONVERTER_SSE2 0
+#endif
+
+namespace
+{
+	typedef void (*RowConverter)(const std::uint8_t* src, std::uint8_t* dest, size_t width);
+
+	// Conversions are memory bound; below this many pixels a surface stays on one thread.
+	const size_t MinPixelsPerThread = 128 * 1024;
+	const size_t MinPixelsPerBand = 16 * 1024;
+
+	inline std::uint32_t FloatBits(float value)
+	{
+		std::uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	inline float BitsFloat(std::uint32_t bits)
+	{
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	inline std::uint16_t Load16(const std::uint8_t* src)
+	{
+		std::uint16_t value;
+		memcpy(&value, src, sizeof(value));
+		return value;
+	}
+
+	//----------------------------------------------------------------------------
+	// Scalar reference kernels
+	//----------------------------------------------------------------------------
+
+	inline std::uint8_t Expand5(unsigned value) { return (std::uint8_t)((value << 3) | (value >> 2)); }
+	inline std::uint8_t Expand6(unsigned value) { return (std::uint8_t)((value << 2) | (value >> 4)); }
+	inline std::uint8_t Expand4(unsigned value) { return (std::uint8_t)(value * 17); }
+
+	void Rgb24ToRgba8(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 3, dest += 4)
+		{
+			dest[0] = src[2];
+			dest[1] = src[1];
+			dest[2] = src[0];
+			dest[3] = 255;
+		}
+	}
+
+	void B5G6R5ToRgba8(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 2, dest += 4)
+		{
+			const unsigned p = Load16(src);
+			dest[0] = Expand5(p >> 11);
+			dest[1] = Expand6((p >> 5) & 0x3F);
+			dest[2] = Expand5(p & 0x1F);
+			dest[3] = 255;
+		}
+	}
+
+	void B5G5R5A1ToRgba8(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 2, dest += 4)
+		{
+			const unsigned p = Load16(src);
+			dest[0] = Expand5((p >> 10) & 0x1F);
+			dest[1] = Expand5((p >> 5) & 0x1F);
+			dest[2] = Expand5(p & 0x1F);
+			dest[3] = (p & 0x8000) != 0 ? 255 : 0;
+		}
+	}
+
+	void B4G4R4A4ToRgba8(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 2, dest += 4)
+		{
+			const unsigned p = Load16(src);
+			dest[0] = Expand4((p >> 8) & 0xF);
+			dest[1] = Expand4((p >> 4) & 0xF);
+			dest[2] = Expand4(p & 0xF);
+			dest[3] = Expand4(p >> 12);
+		}
+	}
+
+	void SwapRedBlue(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 4, dest += 4)
+		{
+			const std::uint8_t r = src[2];
+			const std::uint8_t b = src[0];
+			dest[0] = r;
+			dest[1] = src[1];
+			dest[2] = b;
+			dest[3] = src[3];
+		}
+	}
+
+	void Bgrx8ToRgba8(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t x = 0; x < width; ++x, src += 4, dest += 4)
+		{
+			const std::uint8_t r = src[2];
+			const std::uint8_t b = src[0];
+			dest[0] = r;
+			dest[1] = src[1];
+			dest[2] = b;
+			dest[3] = 255;
+		}
+	}
+
+	float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	struct SrgbTables
+	{
+		float ToLinear[256];
+		float Alpha[256];
+		std::uint16_t ToLinearHalf[256];
+		std::uint16_t AlphaHalf[256];
+
+		SrgbTables()
+		{
+			for(int i = 0; i < 256; ++i)
+			{
+				ToLinear[i] = SrgbToLinear(i / 255.0f);
+				Alpha[i] = i * (1.0f / 255.0f);
+				ToLinearHalf[i] = PixelConverter::FloatToHalf(ToLinear[i]);
+				AlphaHalf[i] = PixelConverter::FloatToHalf(Alpha[i]);
+			}
+		}
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	void SrgbToLinearHalf(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const SrgbTables& tables = GetSrgbTables();
+		for(size_t x = 0; x < width; ++x, src += 4, dest += 8)
+		{
+			const std::uint16_t pixel[4] =
+			{
+				tables.ToLinearHalf[src[0]], tables.ToLinearHalf[src[1]], tables.ToLinearHalf[src[2]], tables.AlphaHalf[src[3]]
+			};
+			memcpy(dest, pixel, sizeof(pixel));
+		}
+	}
+
+	void SrgbToLinearFloat(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const SrgbTables& tables = GetSrgbTables();
+		for(size_t x = 0; x < width; ++x, src += 4, dest += 16)
+		{
+			const float pixel[4] =
+			{
+				tables.ToLinear[src[0]], tables.ToLinear[src[1]], tables.ToLinear[src[2]], tables.Alpha[src[3]]
+			};
+			memcpy(dest, pixel, sizeof(pixel));
+		}
+	}
+
+	void HalfToFloatRgba(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t i = 0; i < width * 4; ++i)
+		{
+			const float value = PixelConverter::HalfToFloat(Load16(src + i * 2));
+			memcpy(dest + i * 4, &value, sizeof(value));
+		}
+	}
+
+	void FloatToHalfRgba(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		for(size_t i = 0; i < width * 4; ++i)
+		{
+			float value;
+			memcpy(&value, src + i * 4, sizeof(value));
+			const std::uint16_t half = PixelConverter::FloatToHalf(value);
+			memcpy(dest + i * 2, &half, sizeof(half));
+		}
+	}
+
+#if PIXEL_CONVERTER_SSE2
+	//----------------------------------------------------------------------------
+	// SSE2 kernels; each finishes its row with the scalar one
+	//----------------------------------------------------------------------------
+
+	// R, G, B, A in the low bytes of 16-bit lanes -> eight RGBA8 pixels.
+	inline void StoreRgba8x8(std::uint8_t* dest, __m128i r, __m128i g, __m128i b, __m128i a)
+	{
+		const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+
+	inline __m128i Expand5x8(__m128i value) { return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2)); }
+	inline __m128i Expand6x8(__m128i value) { return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4)); }
+	inline __m128i Expand4x8(__m128i value) { return _mm_or_si128(value, _mm_slli_epi16(value, 4)); }
+
+	void Rgb24ToRgba8Sse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const __m128i lowByte = _mm_set1_epi32(0xFF);
+		const __m128i greenByte = _mm_set1_epi32(0xFF00);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+
+		// Four pixels (12 bytes) per step from a 16-byte load, so two spare pixels
+		// must follow in the row.
+		size_t x = 0;
+		for(; x + 6 <= width; x += 4)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+			const __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+			const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+			const __m128i bgr = _mm_unpacklo_epi64(p01, p23); // B | G << 8 | R << 16 | junk
+
+			const __m128i r = _mm_and_si128(_mm_srli_epi32(bgr, 16), lowByte);
+			const __m128i g = _mm_and_si128(bgr, greenByte);
+			const __m128i b = _mm_slli_epi32(_mm_and_si128(bgr, lowByte), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + x * 4),
+				_mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, alpha)));
+		}
+		Rgb24ToRgba8(src + x * 3, dest + x * 4, width - x);
+	}
+
+	void B5G6R5ToRgba8Sse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const __m128i mask5 = _mm_set1_epi16(0x1F);
+		const __m128i mask6 = _mm_set1_epi16(0x3F);
+		const __m128i opaque = _mm_set1_epi16(0xFF);
+
+		size_t x = 0;
+		for(; x + 8 <= width; x += 8)
+		{
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+			StoreRgba8x8(dest + x * 4,
+				Expand5x8(_mm_srli_epi16(p, 11)),
+				Expand6x8(_mm_and_si128(_mm_srli_epi16(p, 5), mask6)),
+				Expand5x8(_mm_and_si128(p, mask5)),
+				opaque);
+		}
+		B5G6R5ToRgba8(src + x * 2, dest + x * 4, width - x);
+	}
+
+	void B5G5R5A1ToRgba8Sse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const __m128i mask5 = _mm_set1_epi16(0x1F);
+		const __m128i mask8 = _mm_set1_epi16(0xFF);
+
+		size_t x = 0;
+		for(; x + 8 <= width; x += 8)
+		{
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+			StoreRgba8x8(dest + x * 4,
+				Expand5x8(_mm_and_si128(_mm_srli_epi16(p, 10), mask5)),
+				Expand5x8(_mm_and_si128(_mm_srli_epi16(p, 5), mask5)),
+				Expand5x8(_mm_and_si128(p, mask5)),
+				_mm_and_si128(_mm_srai_epi16(p, 15), mask8));
+		}
+		B5G5R5A1ToRgba8(src + x * 2, dest + x * 4, width - x);
+	}
+
+	void B4G4R4A4ToRgba8Sse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const __m128i mask4 = _mm_set1_epi16(0xF);
+
+		size_t x = 0;
+		for(; x + 8 <= width; x += 8)
+		{
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+			StoreRgba8x8(dest + x * 4,
+				Expand4x8(_mm_and_si128(_mm_srli_epi16(p, 8), mask4)),
+				Expand4x8(_mm_and_si128(_mm_srli_epi16(p, 4), mask4)),
+				Expand4x8(_mm_and_si128(p, mask4)),
+				Expand4x8(_mm_srli_epi16(p, 12)));
+		}
+		B4G4R4A4ToRgba8(src + x * 2, dest + x * 4, width - x);
+	}
+
+	template <bool Opaque>
+	void SwapRedBlueSse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		const __m128i greenAlpha = _mm_set1_epi32((int)0xFF00FF00u);
+		const __m128i lowByte = _mm_set1_epi32(0xFF);
+		const __m128i thirdByte = _mm_set1_epi32(0xFF0000);
+		const __m128i alpha = _mm_set1_epi32(Opaque ? (int)0xFF000000u : 0);
+
+		size_t x = 0;
+		for(; x + 4 <= width; x += 4)
+		{
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+			const __m128i ga = _mm_or_si128(_mm_and_si128(p, greenAlpha), alpha);
+			const __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), lowByte);
+			const __m128i b = _mm_and_si128(_mm_slli_epi32(p, 16), thirdByte);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + x * 4), _mm_or_si128(ga, _mm_or_si128(r, b)));
+		}
+		if(Opaque)
+			Bgrx8ToRgba8(src + x * 4, dest + x * 4, width - x);
+		else
+			SwapRedBlue(src + x * 4, dest + x * 4, width - x);
+	}
+
+	// Four halves in the low 16 bits of each lane; same steps as HalfToFloat().
+	inline __m128 HalfToFloat4(__m128i half)
+	{
+		const __m128i shiftedExp = _mm_set1_epi32(0x7C00 << 13);
+		const __m128i expAdjust = _mm_set1_epi32((127 - 15) << 23);
+		const __m128i oneExp = _mm_set1_epi32(1 << 23);
+		const __m128 denormMagic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+
+		__m128i bits = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7FFF)), 13);
+		const __m128i exp = _mm_and_si128(bits, shiftedExp);
+		bits = _mm_add_epi32(bits, expAdjust);
+
+		const __m128i infNan = _mm_cmpeq_epi32(exp, shiftedExp);
+		bits = _mm_add_epi32(bits, _mm_and_si128(infNan, expAdjust));
+
+		const __m128i denormal = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+		const __m128i renormalized = _mm_castps_si128(
+			_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, oneExp)), denormMagic));
+		bits = _mm_or_si128(_mm_andnot_si128(denormal, bits), _mm_and_si128(denormal, renormalized));
+
+		const __m128i sign = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16);
+		return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+	}
+
+	// Four halves in the low 16 bits of each lane; same steps as FloatToHalf().
+	inline __m128i FloatToHalf4(__m128 value)
+	{
+		const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+		const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+		const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i normalMin = _mm_set1_epi32(113 << 23);
+
+		__m128i bits = _mm_castps_si128(value);
+		const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000u));
+		bits = _mm_xor_si128(bits, sign);
+
+		// Sign removed, so the signed compares order the bits correctly.
+		const __m128i overflow = _mm_cmpgt_epi32(bits, _mm_sub_epi32(f16Max, _mm_set1_epi32(1)));
+		const __m128i nan = _mm_cmpgt_epi32(bits, f32Infinity);
+		const __m128i special = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(nan, _mm_set1_epi32(0x0200)));
+
+		const __m128i denormal = _mm_cmplt_epi32(bits, normalMin);
+		const __m128i denormalHalf = _mm_sub_epi32(_mm_castps_si128(
+			_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(denormMagic))), denormMagic);
+
+		const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+		__m128i normal = _mm_add_epi32(bits, _mm_set1_epi32((int)((std::uint32_t)(15 - 127) << 23) + 0xFFF));
+		normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+		__m128i half = _mm_or_si128(_mm_andnot_si128(denormal, normal), _mm_and_si128(denormal, denormalHalf));
+		half = _mm_or_si128(_mm_andnot_si128(overflow, half), _mm_and_si128(overflow, special));
+		return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+	}
+
+	void HalfToFloatSse2(const std::uint16_t* src, float* dest, size_t count)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for(; i + 8 <= count; i += 8)
+		{
+			const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_ps(dest + i, HalfToFloat4(_mm_unpacklo_epi16(halves, zero)));
+			_mm_storeu_ps(dest + i + 4, HalfToFloat4(_mm_unpackhi_epi16(halves, zero)));
+		}
+		for(; i < count; ++i)
+			dest[i] = PixelConverter::HalfToFloat(src[i]);
+	}
+
+	// packs_epi32 saturates signed values, so the 16-bit results are sign-extended first.
+	inline __m128i SignExtend16(__m128i value)
+	{
+		return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+	}
+
+	void FloatToHalfSse2(const float* src, std::uint16_t* dest, size_t count)
+	{
+		size_t i = 0;
+		for(; i + 8 <= count; i += 8)
+		{
+			const __m128i lo = SignExtend16(FloatToHalf4(_mm_loadu_ps(src + i)));
+			const __m128i hi = SignExtend16(FloatToHalf4(_mm_loadu_ps(src + i + 4)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(lo, hi));
+		}
+		for(; i < count; ++i)
+			dest[i] = PixelConverter::FloatToHalf(src[i]);
+	}
+
+	void HalfToFloatRgbaSse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		PixelConverter::HalfToFloat(reinterpret_cast<const std::uint16_t*>(src), reinterpret_cast<float*>(dest), width * 4, true);
+	}
+
+	void FloatToHalfRgbaSse2(const std::uint8_t* src, std::uint8_t* dest, size_t width)
+	{
+		PixelConverter::FloatToHalf(reinterpret_cast<const float*>(src), reinterpret_cast<std::uint16_t*>(dest), width * 4, true);
+	}
+#endif
+
+	struct ConversionInfo
+	{
+		size_t SourcePixelSize;
+		size_t DestPixelSize;
+		RowConverter Scalar;
+		RowConverter Simd;
+	};
+
+#if PIXEL_CONVERTER_SSE2
+#define PIXEL_CONVERTER_SIMD(kernel) kernel
+#else
+#define PIXEL_CONVERTER_SIMD(kernel) nullptr
+#endif
+
+	// Indexed by PixelConversion.
+	const ConversionInfo Conversions[PixelConversion_Count] =
+	{
+		{ 3, 4, Rgb24ToRgba8, PIXEL_CONVERTER_SIMD(Rgb24ToRgba8Sse2) },
+		{ 2, 4, B5G6R5ToRgba8, PIXEL_CONVERTER_SIMD(B5G6R5ToRgba8Sse2) },
+		{ 2, 4, B5G5R5A1ToRgba8, PIXEL_CONVERTER_SIMD(B5G5R5A1ToRgba8Sse2) },
+		{ 2, 4, B4G4R4A4ToRgba8, PIXEL_CONVERTER_SIMD(B4G4R4A4ToRgba8Sse2) },
+		{ 4, 4, SwapRedBlue, PIXEL_CONVERTER_SIMD(SwapRedBlueSse2<false>) },
+		{ 4, 4, Bgrx8ToRgba8, PIXEL_CONVERTER_SIMD(SwapRedBlueSse2<true>) },
+		{ 4, 8, SrgbToLinearHalf, nullptr },   // table lookups; SSE2 has no gather
+		{ 4, 16, SrgbToLinearFloat, nullptr },
+		{ 8, 16, HalfToFloatRgba, PIXEL_CONVERTER_SIMD(HalfToFloatRgbaSse2) },
+		{ 16, 8, FloatToHalfRgba, PIXEL_CONVERTER_SIMD(FloatToHalfRgbaSse2) },
+	};
+
+#undef PIXEL_CONVERTER_SIMD
+
+	// One surface of a conversion.
+	struct Surface
+	{
+		const std::uint8_t* Src;
+		size_t SrcRowPitch;
+		std::uint8_t* Dest;
+		size_t DestRowPitch;
+		size_t Width;
+		size_t Height;
+	};
+
+	// Work items are bands of rows of every surface.
+	void ConvertSurfaces(const ConversionInfo& info, const Surface* surfaces, size_t count,
+		const PixelConvertOptions& options, PixelConvertStats* stats)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		struct Band
+		{
+			size_t Surface;
+			size_t FirstRow;
+			size_t EndRow;
+		};
+
+		std::vector<Band> bands;
+		size_t pixels = 0;
+		for(size_t s = 0; s < count; ++s)
+		{
+			const size_t rowsPerBand = std::max<size_t>(MinPixelsPerBand / std::max<size_t>(surfaces[s].Width, 1), 1);
+			for(size_t row = 0; row < surfaces[s].Height; row += rowsPerBand)
+				bands.push_back({ s, row, std::min(row + rowsPerBand, surfaces[s].Height) });
+			pixels += surfaces[s].Width * surfaces[s].Height;
+		}
+
+		const RowConverter convert = options.UseSimd && info.Simd != nullptr ? info.Simd : info.Scalar;
+
+		const unsigned maxThreads = options.ThreadCount != 0 ? options.ThreadCount : GetHardwareThreadCount();
+		const unsigned threadCount = (unsigned)std::min<size_t>(maxThreads, std::max<size_t>(pixels / MinPixelsPerThread, 1));
+
+		ParallelFor(bands.size(), threadCount, [&](size_t index)
+		{
+			const Band& band = bands[index];
+			const Surface& surface = surfaces[band.Surface];
+			for(size_t y = band.FirstRow; y < band.EndRow; ++y)
+				convert(surface.Src + y * surface.SrcRowPitch, surface.Dest + y * surface.DestRowPitch, surface.Width);
+		});
+
+		if(stats != nullptr)
+		{
+			stats->Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			stats->MegapixelsPerSecond = stats->Seconds > 0.0 ? (double)pixels / stats->Seconds * 1e-6 : 0.0;
+		}
+	}
+
+	// source(mip, item) for every subresource of out, which is already laid out.
+	template <typename GetSource>
+	void ConvertChain(const ConversionInfo& info, const GetSource& getSource, MipChain& out,
+		const PixelConvertOptions& options, PixelConvertStats* stats)
+	{
+		std::vector<Surface> surfaces;
+		surfaces.reserve(out.GetMipCount() * out.GetArraySize());
+		for(size_t item = 0; item < out.GetArraySize(); ++item)
+		{
+			for(size_t mip = 0; mip < out.GetMipCount(); ++mip)
+			{
+				const DdsImage::Subresource src = getSource(mip, item);
+				const DdsImage::Subresource& dst = out.GetSubresource(mip, item);
+				surfaces.push_back({ src.Data, src.RowPitch, out.GetMutableData(mip, item), dst.RowPitch, dst.Width, dst.Height });
+			}
+		}
+
+		ConvertSurfaces(info, surfaces.data(), surfaces.size(), options, stats);
+	}
+}
+
+bool PixelConverter::GetConversion(DXGI_FORMAT from, DXGI_FORMAT to, PixelConversion& out)
+{
+	switch(from)
+	{
+	case DXGI_FORMAT_B5G6R5_UNORM:
+		out = PixelConversion_B5G6R5ToRgba8;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+		out = PixelConversion_B5G5R5A1ToRgba8;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+		out = PixelConversion_B4G4R4A4ToRgba8;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		out = PixelConversion_SwapRedBlue;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		out = PixelConversion_SwapRedBlue;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+		out = PixelConversion_Bgrx8ToRgba8;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		out = PixelConversion_Bgrx8ToRgba8;
+		return to == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		out = PixelConversion_SwapRedBlue;
+		return to == DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		if(to == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+			out = PixelConversion_SwapRedBlue;
+		else if(to == DXGI_FORMAT_R16G16B16A16_FLOAT)
+			out = PixelConversion_SrgbToLinearHalf;
+		else if(to == DXGI_FORMAT_R32G32B32A32_FLOAT)
+			out = PixelConversion_SrgbToLinearFloat;
+		else
+			return false;
+		return true;
+
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		out = PixelConversion_HalfToFloat;
+		return to == DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		out = PixelConversion_FloatToHalf;
+		return to == DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+	default:
+		return false;
+	}
+}
+
+size_t PixelConverter::GetSourcePixelSize(PixelConversion conversion)
+{
+	return conversion < PixelConversion_Count ? Conversions[conversion].SourcePixelSize : 0;
+}
+
+size_t PixelConverter::GetDestPixelSize(PixelConversion conversion)
+{
+	return conversion < PixelConversion_Count ? Conversions[conversion].DestPixelSize : 0;
+}
+
+bool PixelConverter::Convert(PixelConversion conversion,
+	const std::uint8_t* src, size_t srcRowPitch,
+	size_t width, size_t height,
+	std::uint8_t* dest, size_t destRowPitch,
+	const PixelConvertOptions& options, PixelConvertStats* stats)
+{
+	if(conversion >= PixelConversion_Count || src == nullptr || dest == nullptr || width == 0 || height == 0)
+		return false;
+
+	const Surface surface = { src, srcRowPitch, dest, destRowPitch, width, height };
+	ConvertSurfaces(Conversions[conversion], &surface, 1, options, stats);
+	return true;
+}
+
+bool PixelConverter::Convert(const DdsImage& image, DXGI_FORMAT format, MipChain& out,
+	const PixelConvertOptions& options, PixelConvertStats* stats)
+{
+	PixelConversion conversion;
+	if((image.GetDimension() != DdsImage::Dimension_Texture1D && image.GetDimension() != DdsImage::Dimension_Texture2D) ||
+		!GetConversion(image.GetFormat(), format, conversion))
+	{
+		return false;
+	}
+
+	out.Reset(format, image.GetWidth(), image.GetHeight(), image.GetMipCount(), image.GetArraySize());
+	out.SetCubeMap(image.IsCubeMap());
+
+	ConvertChain(Conversions[conversion], [&](size_t mip, size_t item) { return image.GetSubresource(mip, item); },
+		out, options, stats);
+	return true;
+}
+
+bool PixelConverter::Convert(const MipChain& source, DXGI_FORMAT format, MipChain& out,
+	const PixelConvertOptions& options, PixelConvertStats* stats)
+{
+	PixelConversion conversion;
+	if(&source == &out || !GetConversion(source.GetFormat(), format, conversion))
+		return false;
+
+	out.Reset(format, source.GetWidth(), source.GetHeight(), source.GetMipCount(), source.GetArraySize());
+	out.SetCubeMap(source.IsCubeMap());
+
+	ConvertChain(Conversions[conversion], [&](size_t mip, size_t item) { return source.GetSubresource(mip, item); },
+		out, options, stats);
+	return true;
+}
+
+void PixelConverter::HalfToFloat(const std::uint16_t* src, float* dest, size_t count, bool useSimd)
+{
+#if PIXEL_CONVERTER_SSE2
+	if(useSimd)
+	{
+		HalfToFloatSse2(src, dest, count);
+		return;
+	}
+#endif
+	for(size_t i = 0; i < count; ++i)
+		dest[i] = HalfToFloat(src[i]);
+
+	(void)useSimd;
+}
+
+void PixelConverter::FloatToHalf(const float* src, std::uint16_t* dest, size_t count, bool useSimd)
+{
+#if PIXEL_CONVERTER_SSE2
+	if(useSimd)
+	{
+		FloatToHalfSse2(src, dest, count);
+		return;
+	}
+#endif
+	for(size_t i = 0; i < count; ++i)
+		dest[i] = FloatToHalf(src[i]);
+
+	(void)useSimd;
+}
+
+float PixelConverter::HalfToFloat(std::uint16_t half)
+{
+	const std::uint32_t shiftedExp = 0x7C00u << 13;
+	std::uint32_t bits = (half & 0x7FFFu) << 13;
+	const std::uint32_t exp = bits & shiftedExp;
+	bits += (127 - 15) << 23;
+
+	if(exp == shiftedExp)
+	{
+		bits += (128 - 16) << 23; // Inf/NaN
+	}
+	else if(exp == 0)
+	{
+		bits += 1 << 23;          // denormal: renormalize
+		bits = FloatBits(BitsFloat(bits) - BitsFloat(113u << 23));
+	}
+
+	return BitsFloat(bits | ((std::uint32_t)(half & 0x8000u) << 16));
+}
+
+std::uint16_t PixelConverter::FloatToHalf(float value)
+{
+	const std::uint32_t f32Infinity = 255u << 23;
+	const std::uint32_t f16Max = (127u + 16u) << 23;
+	const std::uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	std::uint32_t bits = FloatBits(value);
+	const std::uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	std::uint32_t half;
+	if(bits >= f16Max)
+	{
+		half = bits > f32Infinity ? 0x7E00u : 0x7C00u;
+	}
+	else if(bits < (113u << 23))
+	{
+		half = FloatBits(BitsFloat(bits) + BitsFloat(denormMagic)) - denormMagic;
+	}
+	else
+	{
+		const std::uint32_t mantissaOdd = (bits >> 13) & 1;
+		bits += ((std::uint32_t)(15 - 127) << 23) + 0xFFFu;
+		bits += mantissaOdd;
+		half = bits >> 13;
+	}
+
+	return (std::uint16_t)(half | (sign >> 16));
+}
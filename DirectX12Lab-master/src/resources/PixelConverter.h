@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MipGenerator.h"
+
+enum PixelConversion
+{
+	PixelConversion_Rgb24ToRgba8,       // D3DFMT_R8G8B8 (bytes B, G, R) -> R8G8B8A8, opaque
+	PixelConversion_B5G6R5ToRgba8,      // -> R8G8B8A8, opaque
+	PixelConversion_B5G5R5A1ToRgba8,    // -> R8G8B8A8
+	PixelConversion_B4G4R4A4ToRgba8,    // -> R8G8B8A8
+	PixelConversion_SwapRedBlue,        // B8G8R8A8 <-> R8G8B8A8
+	PixelConversion_Bgrx8ToRgba8,       // B8G8R8X8 -> R8G8B8A8, opaque
+	PixelConversion_SrgbToLinearHalf,   // R8G8B8A8_SRGB -> linear R16G16B16A16_FLOAT
+	PixelConversion_SrgbToLinearFloat,  // R8G8B8A8_SRGB -> linear R32G32B32A32_FLOAT
+	PixelConversion_HalfToFloat,        // R16G16B16A16_FLOAT -> R32G32B32A32_FLOAT
+	PixelConversion_FloatToHalf,        // R32G32B32A32_FLOAT -> R16G16B16A16_FLOAT
+	PixelConversion_Count,
+};
+
+struct PixelConvertOptions
+{
+	unsigned ThreadCount = 0; // 0 = all hardware threads
+	bool UseSimd = true;      // false runs the scalar reference path
+};
+
+struct PixelConvertStats
+{
+	double Seconds = 0.0;
+	double MegapixelsPerSecond = 0.0;
+};
+
+// Format conversion on the CPU, for textures in a format the device can not
+// sample (B5G6R5, B4G4R4A4 and 24-bit RGB on some hardware) and for tools that
+// feed MipGenerator or BcEncoder.
+//
+// The 8-bit swizzles and the 16-bit expansions handle four to eight pixels per
+// step in SSE2 with shifts and masks; the 5- and 6-bit channels are widened by
+// bit replication, so 0 and the maximum map to 0 and 255.  Half <-> float runs
+// eight values at a time, rounding to nearest even like MipGenerator.  sRGB to
+// linear is a 256-entry table lookup, colour only, alpha scaled as is.
+//
+// Surfaces are split into bands of rows, across every subresource, converted
+// with ParallelFor.
+class PixelConverter
+{
+public:
+	// The conversion from one DXGI format to another, if there is one.  24-bit RGB
+	// has no DXGI format and is only reachable through the enum.
+	static bool GetConversion(DXGI_FORMAT from, DXGI_FORMAT to, PixelConversion& out);
+
+	// Bytes per pixel read and written.
+	static size_t GetSourcePixelSize(PixelConversion conversion);
+	static size_t GetDestPixelSize(PixelConversion conversion);
+
+	// width x height pixels, rows srcRowPitch and destRowPitch bytes apart.
+	static bool Convert(PixelConversion conversion,
+		const std::uint8_t* src, size_t srcRowPitch,
+		size_t width, size_t height,
+		std::uint8_t* dest, size_t destRowPitch,
+		const PixelConvertOptions& options = PixelConvertOptions(), PixelConvertStats* stats = nullptr);
+
+	// Every subresource of a 1D/2D (array, cube) DDS, e.g. one the device can not
+	// sample, into format.  Returns false for 3D textures or formats GetConversion
+	// has nothing for.
+	static bool Convert(const DdsImage& image, DXGI_FORMAT format, MipChain& out,
+		const PixelConvertOptions& options = PixelConvertOptions(), PixelConvertStats* stats = nullptr);
+
+	// Every subresource of a chain.
+	static bool Convert(const MipChain& source, DXGI_FORMAT format, MipChain& out,
+		const PixelConvertOptions& options = PixelConvertOptions(), PixelConvertStats* stats = nullptr);
+
+	// count values of any R16.._FLOAT / R32.._FLOAT pair.
+	static void HalfToFloat(const std::uint16_t* src, float* dest, size_t count, bool useSimd = true);
+	static void FloatToHalf(const float* src, std::uint16_t* dest, size_t count, bool useSimd = true);
+
+	static float HalfToFloat(std::uint16_t half);
+	static std::uint16_t FloatToHalf(float value); // round to nearest even; overflow goes to Inf
+};
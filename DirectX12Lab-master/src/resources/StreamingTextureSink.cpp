@@ -0,0 +1,150 @@
+#include "StreamingTextureSink.h"
+
+#include <algorithm>
+
+using Microsoft::WRL::ComPtr;
+
+StreamingTextureSink::StreamingTextureSink(ID3D12Device* device, UploadRing& uploadRing, GpuHeap* gpuHeap)
+: mDevice(device), mUploadRing(uploadRing), mGpuHeap(gpuHeap)
+{
+}
+
+StreamingTextureSink::~StreamingTextureSink()
+{
+    // The owner flushes the queue before destroying the sink.
+    for(Texture& texture : mTextures)
+        Retire(texture);
+
+    Reclaim(~0ull);
+}
+
+void StreamingTextureSink::BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue)
+{
+    mCmdList = cmdList;
+    mFenceValue = fenceValue;
+}
+
+void StreamingTextureSink::Reclaim(UINT64 completedFenceValue)
+{
+    while(!mRetired.empty() && mRetired.front().FenceValue <= completedFenceValue)
+    {
+        if(mGpuHeap != nullptr)
+            mGpuHeap->Release(mRetired.front().HeapAllocation);
+
+        mRetired.pop_front();
+    }
+}
+
+ID3D12Resource* StreamingTextureSink::GetTexture(StreamTextureId id)const
+{
+    return id < mTextures.size() ? mTextures[id].Resource.Get() : nullptr;
+}
+
+UINT StreamingTextureSink::GetFirstMip(StreamTextureId id)const
+{
+    return id < mTextures.size() ? mTextures[id].FirstMip : 0;
+}
+
+UINT64 StreamingTextureSink::GetVersion(StreamTextureId id)const
+{
+    return id < mTextures.size() ? mTextures[id].Version : 0;
+}
+
+MipLoadResult StreamingTextureSink::LoadMips(StreamTextureId id, const DdsImage& image,
+    std::uint32_t firstMip, std::uint32_t previousFirstMip)
+{
+    switch(Rebuild(id, image, firstMip, previousFirstMip))
+    {
+    case DdsUpload_Done:     return MipLoad_Done;
+    case DdsUpload_RingFull: return MipLoad_Busy;
+    default:                 return MipLoad_Failed;
+    }
+}
+
+bool StreamingTextureSink::EvictMips(StreamTextureId id, const DdsImage& image, std::uint32_t firstMip)
+{
+    // Nothing to upload, but the smaller texture still has to be created.
+    return Rebuild(id, image, firstMip, firstMip) == DdsUpload_Done;
+}
+
+void StreamingTextureSink::Release(StreamTextureId id)
+{
+    if(id < mTextures.size())
+    {
+        Retire(mTextures[id]);
+        mTextures[id] = Texture();
+    }
+}
+
+DdsUploadResult StreamingTextureSink::Rebuild(StreamTextureId id, const DdsImage& image, UINT firstMip, UINT uploadEnd)
+{
+    assert(mCmdList != nullptr);
+
+    if(id >= mTextures.size())
+        mTextures.resize(id + 1);
+
+    Texture& current = mTextures[id];
+
+    GpuHeapAllocation heapAllocation;
+    ComPtr<ID3D12Resource> texture;
+    const DdsUploadResult result = CreateDdsTexture(mDevice, mCmdList, mUploadRing, mFenceValue,
+        mGpuHeap, image, firstMip, uploadEnd, texture, &heapAllocation);
+    if(result != DdsUpload_Done)
+        return result;
+
+    const UINT mipCount = (UINT)image.GetMipCount();
+    const UINT newMips = mipCount - firstMip;
+    const UINT arraySize = image.GetDimension() == DdsImage::Dimension_Texture3D ? 1 : (UINT)image.GetArraySize();
+
+    // Resident mips: old texture -> new texture.
+    if(current.Resource != nullptr && uploadEnd < mipCount)
+    {
+        const UINT oldMips = mipCount - current.FirstMip;
+
+        auto toCopySource = CD3DX12_RESOURCE_BARRIER::Transition(
+            current.Resource.Get(),
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_COPY_SOURCE);
+        mCmdList->ResourceBarrier(1, &toCopySource);
+
+        for(UINT item = 0; item < arraySize; ++item)
+        {
+            for(UINT mip = std::max(uploadEnd, current.FirstMip); mip < mipCount; ++mip)
+            {
+                CD3DX12_TEXTURE_COPY_LOCATION dst(texture.Get(),
+                    D3D12CalcSubresource(mip - firstMip, item, 0, newMips, arraySize));
+                CD3DX12_TEXTURE_COPY_LOCATION src(current.Resource.Get(),
+                    D3D12CalcSubresource(mip - current.FirstMip, item, 0, oldMips, arraySize));
+                mCmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+            }
+        }
+    }
+
+    auto toShaderResource = CD3DX12_RESOURCE_BARRIER::Transition(
+        texture.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    mCmdList->ResourceBarrier(1, &toShaderResource);
+
+    const UINT64 version = current.Version + 1;
+    Retire(current);
+
+    current.Resource = texture;
+    current.HeapAllocation = heapAllocation;
+    current.FirstMip = firstMip;
+    current.Version = version;
+
+    return DdsUpload_Done;
+}
+
+void StreamingTextureSink::Retire(Texture& texture)
+{
+    if(texture.Resource == nullptr)
+        return;
+
+    RetiredTexture retired;
+    retired.Resource = std::move(texture.Resource);
+    retired.HeapAllocation = texture.HeapAllocation;
+    retired.FenceValue = mFenceValue;
+    mRetired.push_back(std::move(retired));
+}
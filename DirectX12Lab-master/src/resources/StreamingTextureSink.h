@@ -0,0 +1,79 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "../graphics/Dx12Utils.h"
+#include "../graphics/GpuHeap.h"
+#include "../graphics/UploadRing.h"
+#include "DdsUpload.h"
+#include "TextureStreamer.h"
+
+// D3D12 side of TextureStreamer.
+//
+// A streamed texture is a plain 2D/3D/array texture holding only the resident mips
+// [firstMip, mipCount) of the DDS file.  Changing the resident range creates a new
+// texture of the new size: mips already on the GPU are copied from the old one and
+// missing mips are staged through the UploadRing from the (mapped) file.  The old
+// texture is kept until the fence of the frame that copied from it completes.
+//
+// Because the texture is replaced, SRVs must be recreated when GetVersion()
+// changes; the SRV's mip 0 is file mip GetFirstMip().
+class StreamingTextureSink : public IMipUploadSink
+{
+public:
+    StreamingTextureSink(ID3D12Device* device, UploadRing& uploadRing, GpuHeap* gpuHeap = nullptr);
+    StreamingTextureSink(const StreamingTextureSink& rhs) = delete;
+    StreamingTextureSink& operator=(const StreamingTextureSink& rhs) = delete;
+    ~StreamingTextureSink();
+
+    // Copies recorded until the next BeginFrame() go into cmdList and are covered
+    // by fenceValue.  Call before TextureStreamer::Register()/Update().
+    void BeginFrame(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue);
+
+    // Frees textures replaced or released before completedFenceValue.
+    void Reclaim(UINT64 completedFenceValue);
+
+    ID3D12Resource* GetTexture(StreamTextureId id)const;
+    UINT GetFirstMip(StreamTextureId id)const;
+    UINT64 GetVersion(StreamTextureId id)const;
+
+    MipLoadResult LoadMips(StreamTextureId id, const DdsImage& image,
+        std::uint32_t firstMip, std::uint32_t previousFirstMip) override;
+    bool EvictMips(StreamTextureId id, const DdsImage& image, std::uint32_t firstMip) override;
+    void Release(StreamTextureId id) override;
+
+private:
+    struct Texture
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+        GpuHeapAllocation HeapAllocation; // when placed in mGpuHeap
+        UINT FirstMip = 0;
+        UINT64 Version = 0;
+    };
+
+    struct RetiredTexture
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+        GpuHeapAllocation HeapAllocation;
+        UINT64 FenceValue = 0;
+    };
+
+    // Replaces the texture with one holding mips [firstMip, mipCount); mips below
+    // uploadEnd come from the file, the rest from the current texture.  Anything
+    // but DdsUpload_Done changes nothing.
+    DdsUploadResult Rebuild(StreamTextureId id, const DdsImage& image, UINT firstMip, UINT uploadEnd);
+
+    void Retire(Texture& texture);
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    UploadRing& mUploadRing;
+    GpuHeap* mGpuHeap = nullptr;
+
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+    UINT64 mFenceValue = 0;
+
+    std::vector<Texture> mTextures; // indexed by StreamTextureId
+    std::deque<RetiredTexture> mRetired;
+};
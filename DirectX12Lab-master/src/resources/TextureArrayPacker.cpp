@@ -0,0 +1,174 @@
+#include "TextureArrayPacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	bool ReadFile(const std::wstring& fileName, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(std::filesystem::path(fileName), std::ios::binary | std::ios::ate);
+		if(!file.is_open())
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return file.good();
+	}
+}
+
+//--------------------------------------------------------------------------------------
+TextureArrayPacker::Result TextureArrayPacker::Pack(const DdsImage* const* images, size_t count,
+	const TexturePackOptions& options, MipChain& out)
+{
+	if(!images || count == 0)
+	{
+		return Result_InvalidArg;
+	}
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(!images[i] || images[i]->GetFormat() == DXGI_FORMAT_UNKNOWN)
+		{
+			return Result_InvalidArg;
+		}
+	}
+
+	const DdsImage& first = *images[0];
+	const DXGI_FORMAT format = first.GetFormat();
+	const size_t width = first.GetWidth();
+	const size_t height = first.GetHeight();
+
+	size_t arraySize = 0;
+	size_t shortestChain = DdsImage::MaxMipLevels;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const DdsImage& image = *images[i];
+		if(image.GetDimension() != DdsImage::Dimension_Texture2D)
+		{
+			return Result_NotSupported;
+		}
+		if(image.GetFormat() != format)
+		{
+			return Result_FormatMismatch;
+		}
+		if(image.GetWidth() != width || image.GetHeight() != height)
+		{
+			return Result_SizeMismatch;
+		}
+
+		arraySize += image.GetArraySize();
+		shortestChain = std::min(shortestChain, image.GetMipCount());
+	}
+
+	if(options.CubeMap)
+	{
+		if(width != height)
+		{
+			return Result_SizeMismatch;
+		}
+		if(arraySize % 6 != 0)
+		{
+			return Result_NotSupported;
+		}
+	}
+
+	if(arraySize > DdsImage::MaxArraySize)
+	{
+		return Result_NotSupported;
+	}
+
+	const bool generate = options.GenerateMips && MipGenerator::IsSupported(format);
+	const size_t mipCount = generate
+		? std::min(MipGenerator::ComputeMipCount(width, height), size_t(DdsImage::MaxMipLevels))
+		: shortestChain;
+
+	MipGenerateOptions mipOptions = options.MipOptions;
+	mipOptions.MipCount = mipCount;
+
+	out.Reset(format, width, height, mipCount, arraySize);
+	out.SetCubeMap(options.CubeMap);
+
+	MipChain generated;
+	size_t outItem = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const DdsImage& image = *images[i];
+
+		// Short chains are regenerated whole, so every level of an item comes
+		// from the same filter.
+		const bool regenerate = image.GetMipCount() < mipCount;
+		if(regenerate && !MipGenerator::Generate(image, generated, mipOptions))
+		{
+			return Result_NotSupported;
+		}
+
+		for(size_t item = 0; item < image.GetArraySize(); ++item, ++outItem)
+		{
+			for(size_t mip = 0; mip < mipCount; ++mip)
+			{
+				const DdsImage::Subresource src = regenerate
+					? generated.GetSubresource(mip, item)
+					: image.GetSubresource(mip, item);
+				const DdsImage::Subresource& dst = out.GetSubresource(mip, outItem);
+
+				memcpy(out.GetMutableData(mip, outItem), src.Data, dst.SlicePitch);
+			}
+		}
+	}
+
+	return Result_Ok;
+}
+
+//--------------------------------------------------------------------------------------
+TextureArrayPacker::Result TextureArrayPacker::PackFiles(const std::vector<std::wstring>& inputs,
+	const std::wstring& output, const TexturePackOptions& options, const DdsWriteOptions& writeOptions)
+{
+	if(inputs.empty())
+	{
+		return Result_InvalidArg;
+	}
+
+	std::vector<std::vector<uint8_t>> files(inputs.size());
+	std::vector<DdsImage> images(inputs.size());
+	std::vector<const DdsImage*> imagePointers(inputs.size());
+	for(size_t i = 0; i < inputs.size(); ++i)
+	{
+		if(!ReadFile(inputs[i], files[i]) ||
+			images[i].Parse(files[i].data(), files[i].size()) != DdsImage::Result_Ok)
+		{
+			return Result_ReadFailed;
+		}
+		imagePointers[i] = &images[i];
+	}
+
+	MipChain packed;
+	const Result result = Pack(imagePointers.data(), imagePointers.size(), options, packed);
+	if(result != Result_Ok)
+	{
+		return result;
+	}
+
+	return DdsWriter::WriteFile(packed, output, writeOptions) ? Result_Ok : Result_WriteFailed;
+}
+
+//--------------------------------------------------------------------------------------
+const char* TextureArrayPacker::ResultToString(Result result)
+{
+	switch(result)
+	{
+	case Result_Ok:             return "ok";
+	case Result_InvalidArg:     return "invalid argument";
+	case Result_FormatMismatch: return "textures have different formats";
+	case Result_SizeMismatch:   return "textures have different sizes";
+	case Result_NotSupported:   return "unsupported dimension, face count or array size";
+	case Result_ReadFailed:     return "could not read an input DDS file";
+	case Result_WriteFailed:    return "could not write the output DDS file";
+	}
+	return "unknown";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "DdsImage.h"
+#include "DdsWriter.h"
+#include "MipGenerator.h"
+
+struct TexturePackOptions
+{
+	bool CubeMap = false;            // items are faces, six per cube (+X, -X, +Y, -Y, +Z, -Z)
+	bool GenerateMips = true;        // complete short mip chains where MipGenerator supports the format
+	MipGenerateOptions MipOptions;   // filter for generated mips; MipCount is ignored
+};
+
+//--------------------------------------------------------------------------------------
+// Combines same-format, same-size 2D textures into one Texture2DArray or cube map
+// (array), so the renderer binds one SRV and indexes it instead of holding a
+// descriptor per texture.
+//
+// Output items are the input items in order (an input that is itself an array or
+// a cube contributes all of its items).  The result always has a full mip chain
+// when the format can be filtered: inputs shipped with fewer mips are regenerated
+// from their top level.  Block-compressed inputs can not be filtered, so the
+// chain is cut to the shortest input's.
+//--------------------------------------------------------------------------------------
+class TextureArrayPacker
+{
+public:
+	enum Result
+	{
+		Result_Ok = 0,
+		Result_InvalidArg,      // no images, null entries
+		Result_FormatMismatch,  // inputs of different DXGI formats
+		Result_SizeMismatch,    // inputs of different sizes, or non-square faces
+		Result_NotSupported,    // 1D/3D input, face count not a multiple of 6, too many items
+		Result_ReadFailed,      // PackFiles: an input is missing or not a valid DDS
+		Result_WriteFailed,     // PackFiles: the output could not be written
+	};
+
+	static Result Pack(const DdsImage* const* images, size_t count,
+		const TexturePackOptions& options, MipChain& out);
+
+	// Loads each input, packs them and writes the result as a DDS file.
+	static Result PackFiles(const std::vector<std::wstring>& inputs, const std::wstring& output,
+		const TexturePackOptions& options = TexturePackOptions(),
+		const DdsWriteOptions& writeOptions = DdsWriteOptions());
+
+	static const char* ResultToString(Result result);
+};
@@ -0,0 +1,494 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	struct PackRect
+	{
+		size_t X = 0;
+		size_t Y = 0;
+		size_t Width = 0;
+		size_t Height = 0;
+	};
+
+	size_t RoundUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	size_t NextPowerOfTwo(size_t value)
+	{
+		size_t result = 1;
+		while(result < value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Maximal rectangles (Jukka Jylanki, "A Thousand Ways to Pack the Bin"): the free
+	// space is kept as every maximal empty rectangle, possibly overlapping, and each
+	// cell goes where it leaves the shortest leftover side.
+	class MaxRectsBin
+	{
+	public:
+		MaxRectsBin(size_t width, size_t height)
+		{
+			mFree.push_back({ 0, 0, width, height });
+		}
+
+		bool Insert(size_t width, size_t height, PackRect& out)
+		{
+			size_t bestShort = SIZE_MAX;
+			size_t bestLong = SIZE_MAX;
+			for(const PackRect& free : mFree)
+			{
+				if(free.Width < width || free.Height < height)
+				{
+					continue;
+				}
+
+				const size_t leftoverX = free.Width - width;
+				const size_t leftoverY = free.Height - height;
+				const size_t shortSide = std::min(leftoverX, leftoverY);
+				const size_t longSide = std::max(leftoverX, leftoverY);
+				if(shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+				{
+					bestShort = shortSide;
+					bestLong = longSide;
+					out = { free.X, free.Y, width, height };
+				}
+			}
+
+			if(bestShort == SIZE_MAX)
+			{
+				return false;
+			}
+
+			Place(out);
+			return true;
+		}
+
+	private:
+		static bool Contains(const PackRect& a, const PackRect& b)
+		{
+			return b.X >= a.X && b.Y >= a.Y && b.X + b.Width <= a.X + a.Width && b.Y + b.Height <= a.Y + a.Height;
+		}
+
+		void Place(const PackRect& used)
+		{
+			mSplit.clear();
+			for(const PackRect& free : mFree)
+			{
+				if(used.X >= free.X + free.Width || used.X + used.Width <= free.X ||
+					used.Y >= free.Y + free.Height || used.Y + used.Height <= free.Y)
+				{
+					mSplit.push_back(free);
+					continue;
+				}
+
+				// Up to four maximal pieces of free around used.
+				if(used.X > free.X)
+				{
+					mSplit.push_back({ free.X, free.Y, used.X - free.X, free.Height });
+				}
+				if(used.X + used.Width < free.X + free.Width)
+				{
+					mSplit.push_back({ used.X + used.Width, free.Y, free.X + free.Width - (used.X + used.Width), free.Height });
+				}
+				if(used.Y > free.Y)
+				{
+					mSplit.push_back({ free.X, free.Y, free.Width, used.Y - free.Y });
+				}
+				if(used.Y + used.Height < free.Y + free.Height)
+				{
+					mSplit.push_back({ free.X, used.Y + used.Height, free.Width, free.Y + free.Height - (used.Y + used.Height) });
+				}
+			}
+
+			// Drop rectangles inside others; of two equal ones keep the first.
+			mFree.clear();
+			for(size_t i = 0; i < mSplit.size(); ++i)
+			{
+				bool redundant = false;
+				for(size_t j = 0; j < mSplit.size() && !redundant; ++j)
+				{
+					if(i != j && Contains(mSplit[j], mSplit[i]))
+					{
+						redundant = !Contains(mSplit[i], mSplit[j]) || j < i;
+					}
+				}
+				if(!redundant)
+				{
+					mFree.push_back(mSplit[i]);
+				}
+			}
+		}
+
+	private:
+		std::vector<PackRect> mFree;
+		std::vector<PackRect> mSplit;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Bottom-left skyline: only the top edge of the packed area is tracked, so space
+	// under an overhang is lost, but each insert is linear in the skyline length.
+	class SkylineBin
+	{
+	public:
+		SkylineBin(size_t width, size_t height)
+			: mWidth(width), mHeight(height)
+		{
+			mNodes.push_back({ 0, 0, width });
+		}
+
+		bool Insert(size_t width, size_t height, PackRect& out)
+		{
+			size_t bestIndex = SIZE_MAX;
+			size_t bestTop = SIZE_MAX;
+			size_t bestWidth = SIZE_MAX;
+			size_t bestY = 0;
+			for(size_t i = 0; i < mNodes.size(); ++i)
+			{
+				size_t y;
+				if(!Fit(i, width, height, y))
+				{
+					continue;
+				}
+				if(y + height < bestTop || (y + height == bestTop && mNodes[i].Width < bestWidth))
+				{
+					bestIndex = i;
+					bestTop = y + height;
+					bestWidth = mNodes[i].Width;
+					bestY = y;
+				}
+			}
+
+			if(bestIndex == SIZE_MAX)
+			{
+				return false;
+			}
+
+			out = { mNodes[bestIndex].X, bestY, width, height };
+			Place(bestIndex, out);
+			return true;
+		}
+
+	private:
+		struct Node
+		{
+			size_t X;
+			size_t Y;
+			size_t Width;
+		};
+
+		// Lowest y at which width x height sits on the skyline from node index.
+		bool Fit(size_t index, size_t width, size_t height, size_t& y)const
+		{
+			if(mNodes[index].X + width > mWidth)
+			{
+				return false;
+			}
+
+			y = 0;
+			size_t remaining = width;
+			for(size_t i = index; remaining > 0; ++i)
+			{
+				y = std::max(y, mNodes[i].Y);
+				if(y + height > mHeight)
+				{
+					return false;
+				}
+				remaining -= std::min(remaining, mNodes[i].Width);
+			}
+			return true;
+		}
+
+		void Place(size_t index, const PackRect& placed)
+		{
+			mNodes.insert(mNodes.begin() + index, { placed.X, placed.Y + placed.Height, placed.Width });
+
+			// Trim the nodes now under the new one.
+			const size_t end = placed.X + placed.Width;
+			for(size_t i = index + 1; i < mNodes.size();)
+			{
+				Node& node = mNodes[i];
+				if(node.X >= end)
+				{
+					break;
+				}
+
+				const size_t covered = end - node.X;
+				if(node.Width <= covered)
+				{
+					mNodes.erase(mNodes.begin() + i);
+					continue;
+				}
+				node.X += covered;
+				node.Width -= covered;
+				break;
+			}
+
+			// Merge neighbours at the same height.
+			for(size_t i = 0; i + 1 < mNodes.size();)
+			{
+				if(mNodes[i].Y == mNodes[i + 1].Y)
+				{
+					mNodes[i].Width += mNodes[i + 1].Width;
+					mNodes.erase(mNodes.begin() + i + 1);
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+	private:
+		size_t mWidth;
+		size_t mHeight;
+		std::vector<Node> mNodes;
+	};
+
+	template<class Bin>
+	bool PackCells(const std::vector<PackRect>& cells, const std::vector<size_t>& order,
+		size_t width, size_t height, std::vector<PackRect>& placed)
+	{
+		Bin bin(width, height);
+		for(size_t index : order)
+		{
+			if(!bin.Insert(cells[index].Width, cells[index].Height, placed[index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t AddressTexel(std::ptrdiff_t index, size_t size, MipAddressMode mode)
+	{
+		const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(size);
+		if(mode == MipAddress_Wrap)
+		{
+			return static_cast<size_t>((index % count + count) % count);
+		}
+		return static_cast<size_t>(std::min(std::max<std::ptrdiff_t>(index, 0), count - 1));
+	}
+}
+
+//--------------------------------------------------------------------------------------
+void AtlasRegion::RemapTexCoords(float* uv, size_t count, size_t stride)const
+{
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(uv);
+	for(size_t i = 0; i < count; ++i, bytes += stride)
+	{
+		float* texCoord = reinterpret_cast<float*>(bytes);
+		texCoord[0] = texCoord[0] * ScaleU + OffsetU;
+		texCoord[1] = texCoord[1] * ScaleV + OffsetV;
+	}
+}
+
+void AtlasRegion::GetTransform(float matrix[4][4])const
+{
+	for(int r = 0; r < 4; ++r)
+	{
+		for(int c = 0; c < 4; ++c)
+		{
+			matrix[r][c] = r == c ? 1.0f : 0.0f;
+		}
+	}
+	matrix[0][0] = ScaleU;
+	matrix[1][1] = ScaleV;
+	matrix[3][0] = OffsetU;
+	matrix[3][1] = OffsetV;
+}
+
+//--------------------------------------------------------------------------------------
+bool TextureAtlas::Pack(const AtlasImage* images, size_t count, const AtlasOptions& options, AtlasLayout& out)
+{
+	out = AtlasLayout();
+	if(!images || count == 0 || options.MaxSize == 0)
+	{
+		return false;
+	}
+
+	out.MipCount = std::max<size_t>(options.MipCount, 1);
+	out.Gutter = options.Gutter != 0 ? options.Gutter : size_t(1) << (out.MipCount - 1);
+	out.Alignment = (options.BlockAligned ? 4 : 1) << (out.MipCount - 1);
+
+	std::vector<PackRect> cells(count);
+	size_t area = 0;
+	size_t maxWidth = 0;
+	size_t maxHeight = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(images[i].Width == 0 || images[i].Height == 0)
+		{
+			return false;
+		}
+
+		cells[i].Width = RoundUp(images[i].Width + 2 * out.Gutter, out.Alignment);
+		cells[i].Height = RoundUp(images[i].Height + 2 * out.Gutter, out.Alignment);
+		area += cells[i].Width * cells[i].Height;
+		maxWidth = std::max(maxWidth, cells[i].Width);
+		maxHeight = std::max(maxHeight, cells[i].Height);
+	}
+
+	// Large cells first: they are the hard ones to fit late.
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		const size_t sideA = std::max(cells[a].Width, cells[a].Height);
+		const size_t sideB = std::max(cells[b].Width, cells[b].Height);
+		if(sideA != sideB)
+		{
+			return sideA > sideB;
+		}
+		return cells[a].Width * cells[a].Height > cells[b].Width * cells[b].Height;
+	});
+
+	auto fitSize = [&](size_t size)
+	{
+		return options.PowerOfTwo ? NextPowerOfTwo(size) : RoundUp(size, out.Alignment);
+	};
+
+	size_t width = fitSize(std::max(maxWidth, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(area))))));
+	size_t height = fitSize(std::max(maxHeight, (area + width - 1) / width));
+
+	std::vector<PackRect> placed(count);
+	for(;;)
+	{
+		if(width > options.MaxSize || height > options.MaxSize)
+		{
+			return false;
+		}
+
+		const bool packed = options.Packer == AtlasPacker_Skyline
+			? PackCells<SkylineBin>(cells, order, width, height, placed)
+			: PackCells<MaxRectsBin>(cells, order, width, height, placed);
+		if(packed)
+		{
+			break;
+		}
+
+		// Grow the shorter side (the other one once it is at the limit).
+		const bool growWidth = (width <= height && width < options.MaxSize) || height >= options.MaxSize;
+		size_t& side = growWidth ? width : height;
+		side = options.PowerOfTwo ? side * 2 : RoundUp(side + std::max(side / 8, out.Alignment), out.Alignment);
+	}
+
+	if(!options.PowerOfTwo)
+	{
+		width = 0;
+		height = 0;
+		for(const PackRect& cell : placed)
+		{
+			width = std::max(width, cell.X + cell.Width);
+			height = std::max(height, cell.Y + cell.Height);
+		}
+	}
+
+	out.Width = width;
+	out.Height = height;
+	out.Regions.resize(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		AtlasRegion& region = out.Regions[i];
+		region.X = placed[i].X + out.Gutter;
+		region.Y = placed[i].Y + out.Gutter;
+		region.Width = images[i].Width;
+		region.Height = images[i].Height;
+		region.ScaleU = static_cast<float>(region.Width) / static_cast<float>(width);
+		region.ScaleV = static_cast<float>(region.Height) / static_cast<float>(height);
+		region.OffsetU = static_cast<float>(region.X) / static_cast<float>(width);
+		region.OffsetV = static_cast<float>(region.Y) / static_cast<float>(height);
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+bool TextureAtlas::Compose(DXGI_FORMAT format, const AtlasImage* images, size_t count,
+	const AtlasLayout& layout, MipChain& out, const AtlasComposeOptions& options)
+{
+	if(!images || count != layout.Regions.size() || layout.Width == 0 || layout.Height == 0)
+	{
+		return false;
+	}
+
+	// Whole-byte pixels only: block-compressed atlases are encoded after composing.
+	size_t numRows = 0;
+	DdsImage::GetSurfaceInfo(layout.Width, layout.Height, format, nullptr, nullptr, &numRows);
+	const size_t bitsPerPixel = DdsImage::BitsPerPixel(format);
+	if(bitsPerPixel == 0 || bitsPerPixel % 8 != 0 || numRows != layout.Height)
+	{
+		return false;
+	}
+	const size_t pixelSize = bitsPerPixel / 8;
+
+	MipChain top;
+	top.Reset(format, layout.Width, layout.Height, 1, 1);
+	const size_t rowPitch = top.GetSubresource(0, 0).RowPitch;
+	uint8_t* atlas = top.GetMutableData(0, 0);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		const AtlasImage& image = images[i];
+		const AtlasRegion& region = layout.Regions[i];
+		if(!image.Data || image.Width != region.Width || image.Height != region.Height)
+		{
+			return false;
+		}
+
+		// The whole cell: the image, its gutter and the alignment padding, the
+		// last two continuing the image's edges.
+		const size_t cellX = region.X - layout.Gutter;
+		const size_t cellY = region.Y - layout.Gutter;
+		const size_t cellWidth = RoundUp(region.Width + 2 * layout.Gutter, layout.Alignment);
+		const size_t cellHeight = RoundUp(region.Height + 2 * layout.Gutter, layout.Alignment);
+		const std::ptrdiff_t gutter = static_cast<std::ptrdiff_t>(layout.Gutter);
+
+		for(size_t y = 0; y < cellHeight; ++y)
+		{
+			const size_t sy = AddressTexel(static_cast<std::ptrdiff_t>(y) - gutter, image.Height, image.AddressMode);
+			const uint8_t* src = image.Data + sy * image.RowPitch;
+			uint8_t* dst = atlas + (cellY + y) * rowPitch + cellX * pixelSize;
+
+			memcpy(dst + layout.Gutter * pixelSize, src, image.Width * pixelSize);
+			for(size_t x = 0; x < cellWidth; ++x)
+			{
+				if(x == layout.Gutter)
+				{
+					x += image.Width - 1;
+					continue;
+				}
+				const size_t sx = AddressTexel(static_cast<std::ptrdiff_t>(x) - gutter, image.Width, image.AddressMode);
+				memcpy(dst + x * pixelSize, src + sx * pixelSize, pixelSize);
+			}
+		}
+	}
+
+	if(layout.MipCount <= 1 || !MipGenerator::IsSupported(format))
+	{
+		out = std::move(top);
+		return true;
+	}
+
+	// Cells are aligned to 1 << (MipCount - 1), so a 2x2 box never averages texels
+	// of two cells; a wider filter (Kaiser) would pull neighbours through the gutter.
+	MipGenerateOptions mipOptions;
+	mipOptions.Filter = MipFilter_Box;
+	mipOptions.AddressMode = MipAddress_Clamp;
+	mipOptions.ForceSrgb = options.ForceSrgb;
+	mipOptions.MipCount = layout.MipCount;
+	mipOptions.ThreadCount = options.ThreadCount;
+	mipOptions.UseSimd = options.UseSimd;
+	return MipGenerator::Generate(format, atlas, rowPitch, top.GetDataSize(),
+		layout.Width, layout.Height, 1, out, mipOptions);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MipGenerator.h"
+
+enum AtlasPacker
+{
+	AtlasPacker_MaxRects, // best-short-side-fit maximal rectangles, the tightest
+	AtlasPacker_Skyline,  // bottom-left skyline, faster on thousands of images
+};
+
+struct AtlasOptions
+{
+	AtlasPacker Packer = AtlasPacker_MaxRects;
+	size_t MaxSize = 4096;        // atlas width and height limit
+	size_t MipCount = 4;          // mip levels kept free of bleeding between images
+	size_t Gutter = 0;            // border texels around each image at mip 0; 0 = 1 << (MipCount - 1)
+	bool BlockAligned = true;     // cells on 4x4 block boundaries at every kept level, for BCn
+	bool PowerOfTwo = true;       // atlas size; otherwise trimmed to the used area
+};
+
+// The MipGenerateOptions that Compose() leaves to the caller.  The filter, the
+// address mode and the mip count are fixed by the layout.
+struct AtlasComposeOptions
+{
+	bool ForceSrgb = false;   // filter 8-bit UNORM colour as sRGB too (_SRGB formats always are)
+	unsigned ThreadCount = 0; // 0 = all hardware threads
+	bool UseSimd = true;      // false runs the scalar reference path
+};
+
+// An input image.  Pack() only reads Width and Height.
+struct AtlasImage
+{
+	const uint8_t* Data = nullptr;
+	size_t RowPitch = 0;
+	size_t Width = 0;
+	size_t Height = 0;
+	MipAddressMode AddressMode = MipAddress_Clamp; // how the gutter continues the image
+};
+
+// Where an image landed, and the UV transform that goes with it:
+// atlasUV = uv * Scale + Offset.
+struct AtlasRegion
+{
+	size_t X = 0;       // the image inside the atlas, gutter excluded
+	size_t Y = 0;
+	size_t Width = 0;
+	size_t Height = 0;
+
+	float ScaleU = 1.0f;
+	float ScaleV = 1.0f;
+	float OffsetU = 0.0f;
+	float OffsetV = 0.0f;
+
+	// count (u, v) float pairs, stride bytes apart, e.g. &vertices[0].TexCoord.x
+	// and sizeof(ObjVertex).  UVs outside [0, 1] would reach the neighbours, so
+	// tiling textures can not be atlased this way.
+	void RemapTexCoords(float* uv, size_t count, size_t stride)const;
+
+	// The same remap as a row-vector matrix in XMFLOAT4X4 layout, to append to a
+	// material's transform: MatTransform = MatTransform * remap.
+	void GetTransform(float matrix[4][4])const;
+};
+
+struct AtlasLayout
+{
+	size_t Width = 0;
+	size_t Height = 0;
+	size_t MipCount = 1;
+	size_t Gutter = 0;
+	size_t Alignment = 1;             // cell size and position granularity, in texels
+	std::vector<AtlasRegion> Regions; // one per input image, same order
+};
+
+// Packs many small textures into one, so they share a resource, a descriptor
+// and a residency decision instead of each needing their own.
+//
+// Every image gets a cell: the image plus a gutter that continues its edges
+// (clamped or wrapped), rounded up to the cell alignment.  The alignment is
+// (BlockAligned ? 4 : 1) << (MipCount - 1) texels, so down to the last kept mip
+// cells start on whole texels, and on whole 4x4 blocks, so BcEncoder never mixes
+// two images in one block, and the gutter is still at least one texel wide.
+// Images are not rotated; rotation would need a per-vertex swizzle.
+class TextureAtlas
+{
+public:
+	// Chooses the smallest atlas (growing from the total area) that holds every
+	// cell.  Returns false if they do not fit in MaxSize x MaxSize.
+	static bool Pack(const AtlasImage* images, size_t count, const AtlasOptions& options, AtlasLayout& out);
+
+	// Copies the images and their gutters into a layout.MipCount mip atlas of
+	// format (uncompressed; every image already in it).  Mips are generated by
+	// MipGenerator with MipFilter_Box when it supports format, otherwise out has
+	// only mip 0.  The cell alignment keeps each 2x2 box inside one cell down to
+	// the last kept mip.
+	static bool Compose(DXGI_FORMAT format, const AtlasImage* images, size_t count,
+		const AtlasLayout& layout, MipChain& out,
+		const AtlasComposeOptions& options = AtlasComposeOptions());
+};
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Thread-safe registry of loaded textures keyed by file path.
+//
+// Acquire() returns a reference-counted Handle.  The first request for a path runs
+// the loader on the calling thread; requests for the same path made meanwhile from
+// other threads wait for that load instead of starting their own.  Entries nobody
+// holds a handle to stay cached in LRU order and are evicted, oldest first, while
+// the bytes reported by the loader exceed the budget.  Entries with handles are
+// never evicted, so the budget may be exceeded by what is in use.
+//
+// The cache does not know about the GPU: an evicted texture is passed to the evict
+// callback (if set) so the owner can defer the release until the GPU is done with
+// it; otherwise it is destroyed on the spot.
+template<typename T>
+class TextureCache
+{
+	struct Entry;
+
+public:
+	struct LoadResult
+	{
+		std::shared_ptr<T> Texture;
+		std::uint64_t Bytes = 0;
+	};
+
+	// Returns false when the file can not be loaded.
+	typedef std::function<bool(const std::wstring& path, LoadResult& out)> Loader;
+	typedef std::function<void(std::shared_ptr<T>&& texture)> EvictCallback;
+
+	struct Stats
+	{
+		std::uint64_t Hits = 0;
+		std::uint64_t Misses = 0;       // loads started
+		std::uint64_t Coalesced = 0;    // requests that waited on another thread's load
+		std::uint64_t Failures = 0;
+		std::uint64_t Evictions = 0;
+		std::uint64_t UsedBytes = 0;    // all cached entries
+		std::uint64_t ReferencedBytes = 0;
+		std::uint64_t BudgetBytes = 0;  // 0 = unlimited
+		std::uint32_t EntryCount = 0;
+		std::uint32_t UnreferencedCount = 0;
+
+		double GetHitRate()const
+		{
+			const std::uint64_t total = Hits + Coalesced + Misses;
+			return total > 0 ? (double)(Hits + Coalesced) / (double)total : 0.0;
+		}
+	};
+
+	class Handle
+	{
+	public:
+		Handle() = default;
+
+		Handle(const Handle& rhs) : mCache(rhs.mCache), mEntry(rhs.mEntry)
+		{
+			// rhs holds a reference, so the entry can not be evicted meanwhile.
+			if(mEntry != nullptr)
+				mEntry->RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		Handle(Handle&& rhs) noexcept : mCache(rhs.mCache), mEntry(std::move(rhs.mEntry))
+		{
+			rhs.mCache = nullptr;
+		}
+
+		Handle& operator=(Handle rhs) noexcept
+		{
+			std::swap(mCache, rhs.mCache);
+			std::swap(mEntry, rhs.mEntry);
+			return *this;
+		}
+
+		~Handle() { Reset(); }
+
+		void Reset()
+		{
+			if(mEntry != nullptr && mEntry->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				mCache->OnUnreferenced(mEntry.get());
+
+			mCache = nullptr;
+			mEntry.reset();
+		}
+
+		bool IsValid()const { return mEntry != nullptr; }
+		explicit operator bool()const { return IsValid(); }
+
+		T* Get()const { return mEntry != nullptr ? mEntry->Texture.get() : nullptr; }
+		T* operator->()const { return Get(); }
+		T& operator*()const { return *Get(); }
+
+		const std::wstring& GetPath()const { return mEntry->Path; }
+		std::uint64_t GetBytes()const { return mEntry->Bytes; }
+
+	private:
+		friend class TextureCache;
+
+		Handle(TextureCache* cache, std::shared_ptr<Entry> entry) : mCache(cache), mEntry(std::move(entry)) {}
+
+		TextureCache* mCache = nullptr;
+
+		// Keeps the entry's memory valid between dropping the last reference and
+		// OnUnreferenced() taking the lock, during which it may be evicted.
+		std::shared_ptr<Entry> mEntry;
+	};
+
+	explicit TextureCache(Loader loader, std::uint64_t budgetBytes = 0)
+	: mLoader(std::move(loader)), mBudget(budgetBytes)
+	{
+	}
+
+	TextureCache(const TextureCache& rhs) = delete;
+	TextureCache& operator=(const TextureCache& rhs) = delete;
+
+	~TextureCache()
+	{
+		// Handles point into the cache; they must all be gone by now.
+		assert(mReferencedBytes == 0);
+		Trim(0);
+	}
+
+	void SetEvictCallback(EvictCallback callback)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mEvictCallback = std::move(callback);
+	}
+
+	// Returns an invalid handle when the loader fails.
+	Handle Acquire(const std::wstring& path)
+	{
+		const std::wstring key = NormalizePath(path);
+
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for(auto it = mEntries.find(key); it != mEntries.end(); it = mEntries.find(key))
+		{
+			std::shared_ptr<Entry> entry = it->second;
+			if(entry->Status == Status_Ready)
+			{
+				++mStats.Hits;
+				AddRef(*entry);
+				return Handle(this, entry);
+			}
+
+			++mStats.Coalesced;
+			mLoadDone.wait(lock, [&entry]() { return entry->Status != Status_Loading; });
+			if(entry->Status == Status_Failed)
+				return Handle();
+
+			// The loader's handle may already be gone and the entry evicted before
+			// we woke up; look it up again.
+			if(!entry->Evicted)
+			{
+				AddRef(*entry);
+				return Handle(this, entry);
+			}
+		}
+
+		++mStats.Misses;
+
+		std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+		entry->Path = key;
+		entry->Status = Status_Loading;
+		entry->RefCount.store(1, std::memory_order_relaxed);
+		mEntries.emplace(key, entry);
+
+		// Load without the lock so other paths (and other threads) are not blocked.
+		lock.unlock();
+
+		LoadResult result;
+		bool ok = false;
+		try
+		{
+			ok = mLoader(path, result) && result.Texture != nullptr;
+		}
+		catch(...)
+		{
+			FinishLoad(entry, false, result);
+			throw;
+		}
+
+		FinishLoad(entry, ok, result);
+		return ok ? Handle(this, entry) : Handle();
+	}
+
+	// Cached and ready, without loading or waiting.
+	bool Contains(const std::wstring& path)const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto it = mEntries.find(NormalizePath(path));
+		return it != mEntries.end() && it->second->Status == Status_Ready;
+	}
+
+	void SetBudget(std::uint64_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mBudget = bytes;
+		EvictToBudget();
+	}
+
+	// Evicts unreferenced entries until at most maxBytes are cached.
+	void Trim(std::uint64_t maxBytes)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		EvictWhile([this, maxBytes]() { return mUsedBytes > maxBytes; });
+	}
+
+	Stats GetStats()const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		Stats stats = mStats;
+		stats.UsedBytes = mUsedBytes;
+		stats.ReferencedBytes = mReferencedBytes;
+		stats.BudgetBytes = mBudget;
+		stats.EntryCount = (std::uint32_t)mEntries.size();
+		stats.UnreferencedCount = (std::uint32_t)mLru.size();
+		return stats;
+	}
+
+	// Case and separator insensitive for ASCII paths, matching Windows lookups.
+	static std::wstring NormalizePath(const std::wstring& path)
+	{
+		std::wstring key = path;
+		for(wchar_t& c : key)
+		{
+			if(c == L'/')
+				c = L'\\';
+			else if(c >= L'A' && c <= L'Z')
+				c = c - L'A' + L'a';
+		}
+		return key;
+	}
+
+private:
+	enum LoadStatus
+	{
+		Status_Loading,
+		Status_Ready,
+		Status_Failed,
+	};
+
+	struct Entry
+	{
+		std::wstring Path;
+		std::shared_ptr<T> Texture;
+		std::uint64_t Bytes = 0;
+		LoadStatus Status = Status_Loading;
+
+		// Changed without the cache lock only by handle copies (from >= 1) and
+		// releases; 1 -> 0 then takes the lock in OnUnreferenced().
+		std::atomic<std::uint32_t> RefCount{ 0 };
+
+		// Under the lock: a ready entry is either referenced (counted in
+		// mReferencedBytes) or in the LRU list, never both.
+		bool InLru = false;
+		bool Evicted = false;
+		typename std::list<Entry*>::iterator LruPos;
+	};
+
+	void FinishLoad(const std::shared_ptr<Entry>& entry, bool ok, LoadResult& result)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if(ok)
+			{
+				entry->Texture = std::move(result.Texture);
+				entry->Bytes = result.Bytes;
+				entry->Status = Status_Ready;
+
+				mUsedBytes += entry->Bytes;
+				mReferencedBytes += entry->Bytes;
+			}
+			else
+			{
+				// Forget the path so a later request tries again.
+				entry->Status = Status_Failed;
+				mEntries.erase(entry->Path);
+				++mStats.Failures;
+			}
+
+			EvictToBudget();
+		}
+
+		mLoadDone.notify_all();
+	}
+
+	// Called with the lock held.
+	void AddRef(Entry& entry)
+	{
+		entry.RefCount.fetch_add(1, std::memory_order_relaxed);
+
+		if(entry.InLru)
+		{
+			mLru.erase(entry.LruPos);
+			entry.InLru = false;
+			mReferencedBytes += entry.Bytes;
+		}
+	}
+
+	void OnUnreferenced(Entry* entry)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// Acquire() may have revived the entry before we got the lock, and another
+		// handle's release may already have queued (or even evicted) it.
+		if(entry->RefCount.load(std::memory_order_acquire) != 0 || entry->InLru || entry->Evicted)
+			return;
+
+		mReferencedBytes -= entry->Bytes;
+
+		entry->LruPos = mLru.insert(mLru.end(), entry);
+		entry->InLru = true;
+
+		EvictToBudget();
+	}
+
+	// Called with the lock held.
+	void EvictToBudget()
+	{
+		if(mBudget > 0)
+			EvictWhile([this]() { return mUsedBytes > mBudget; });
+	}
+
+	template<typename Predicate>
+	void EvictWhile(Predicate overBudget)
+	{
+		while(!mLru.empty() && overBudget())
+		{
+			Entry* victim = mLru.front();
+			mLru.pop_front();
+
+			victim->InLru = false;
+			victim->Evicted = true;
+
+			std::shared_ptr<T> texture = std::move(victim->Texture);
+			mUsedBytes -= victim->Bytes;
+			++mStats.Evictions;
+
+			// May destroy the entry, which owns the path string.
+			const std::wstring key = victim->Path;
+			mEntries.erase(key);
+
+			if(mEvictCallback)
+				mEvictCallback(std::move(texture));
+		}
+	}
+
+private:
+	Loader mLoader;
+	EvictCallback mEvictCallback;
+
+	mutable std::mutex mMutex;
+	std::condition_variable mLoadDone;
+
+	std::unordered_map<std::wstring, std::shared_ptr<Entry>> mEntries;
+	std::list<Entry*> mLru; // unreferenced ready entries, least recently used first
+
+	std::uint64_t mBudget = 0;
+	std::uint64_t mUsedBytes = 0;
+	std::uint64_t mReferencedBytes = 0;
+	Stats mStats;
+};
@@ -0,0 +1,252 @@
+#include "TextureFootprint.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+			(format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+
+	// Two pixels share each element (4:2:2 and the RGBG formats).
+	bool IsPacked(DXGI_FORMAT format)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_R8G8_B8G8_UNORM:
+		case DXGI_FORMAT_G8R8_G8B8_UNORM:
+		case DXGI_FORMAT_YUY2:
+		case DXGI_FORMAT_Y210:
+		case DXGI_FORMAT_Y216:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// The format and size D3D12 copies a plane of a planar texture as.  Returns
+	// false when format is not planar.
+	bool GetPlane(DXGI_FORMAT format, uint32_t plane, uint32_t& width, uint32_t& height, DXGI_FORMAT& planeFormat)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_NV12:
+		case DXGI_FORMAT_420_OPAQUE:
+			planeFormat = plane == 0 ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R8G8_UNORM;
+			break;
+
+		case DXGI_FORMAT_P010:
+		case DXGI_FORMAT_P016:
+			planeFormat = plane == 0 ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R16G16_UNORM;
+			break;
+
+		case DXGI_FORMAT_NV11:
+			planeFormat = plane == 0 ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R8G8_UNORM;
+			if(plane == 1)
+			{
+				width = (width + 3) / 4; // 4:1:1, full height
+			}
+			return true;
+
+		case DXGI_FORMAT_R24G8_TYPELESS:
+		case DXGI_FORMAT_D24_UNORM_S8_UINT:
+		case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+		case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+			planeFormat = plane == 0 ? DXGI_FORMAT_R24G8_TYPELESS : DXGI_FORMAT_R8_TYPELESS;
+			return true;
+
+		case DXGI_FORMAT_R32G8X24_TYPELESS:
+		case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+		case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+		case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+			planeFormat = plane == 0 ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_R8_TYPELESS;
+			return true;
+
+		default:
+			return false;
+		}
+
+		// 4:2:0 chroma, half size both ways.
+		if(plane == 1)
+		{
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+		}
+		return true;
+	}
+
+	uint32_t GetMipLevels(const TextureFootprintDesc& desc)
+	{
+		if(desc.MipLevels != 0)
+		{
+			return desc.MipLevels;
+		}
+
+		// 0 creates the full chain.
+		uint64_t size = std::max<uint64_t>(desc.Width, desc.Height);
+		if(desc.Dimension == FootprintDimension_Texture3D)
+		{
+			size = std::max<uint64_t>(size, desc.DepthOrArraySize);
+		}
+
+		uint32_t levels = 1;
+		while(size > 1)
+		{
+			size >>= 1;
+			++levels;
+		}
+		return levels;
+	}
+}
+
+//--------------------------------------------------------------------------------------
+bool TextureFootprint::IsSupported(DXGI_FORMAT format)
+{
+	return GetPlaneCount(format) != 0;
+}
+
+//--------------------------------------------------------------------------------------
+uint32_t TextureFootprint::GetPlaneCount(DXGI_FORMAT format)
+{
+	uint32_t width = 1;
+	uint32_t height = 1;
+	DXGI_FORMAT planeFormat = DXGI_FORMAT_UNKNOWN;
+	if(GetPlane(format, 0, width, height, planeFormat))
+	{
+		return 2;
+	}
+
+	return DdsImage::BitsPerPixel(format) != 0 ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------------------
+uint32_t TextureFootprint::GetSubresourceCount(const TextureFootprintDesc& desc)
+{
+	if(desc.Dimension == FootprintDimension_Buffer)
+	{
+		return 1;
+	}
+
+	const uint32_t arraySize = desc.Dimension == FootprintDimension_Texture3D ? 1 : desc.DepthOrArraySize;
+	return GetMipLevels(desc) * arraySize * GetPlaneCount(desc.Format);
+}
+
+//--------------------------------------------------------------------------------------
+bool TextureFootprint::Compute(const TextureFootprintDesc& desc, uint32_t subresource, uint64_t offset,
+	SubresourceFootprint& out)
+{
+	out = SubresourceFootprint();
+
+	if(desc.Dimension == FootprintDimension_Buffer)
+	{
+		const uint64_t rowPitch = AlignUp(desc.Width, RowPitchAlignment);
+		if(subresource != 0 || rowPitch > UINT32_MAX)
+		{
+			return false;
+		}
+
+		out.Offset = offset;
+		out.Width = static_cast<uint32_t>(desc.Width);
+		out.Height = 1;
+		out.Depth = 1;
+		out.RowPitch = static_cast<uint32_t>(rowPitch);
+		out.NumRows = 1;
+		out.RowSizeInBytes = desc.Width;
+		return true;
+	}
+
+	const bool is3D = desc.Dimension == FootprintDimension_Texture3D;
+	const uint32_t mipLevels = GetMipLevels(desc);
+	const uint32_t arraySize = is3D ? 1 : desc.DepthOrArraySize;
+	if(desc.Width == 0 || desc.Width > UINT32_MAX || desc.Height == 0 || arraySize == 0 ||
+		subresource >= GetSubresourceCount(desc))
+	{
+		return false;
+	}
+
+	const uint32_t mip = subresource % mipLevels;
+	const uint32_t plane = subresource / (mipLevels * arraySize);
+
+	uint32_t width = std::max<uint32_t>(1, static_cast<uint32_t>(desc.Width) >> mip);
+	uint32_t height = desc.Dimension == FootprintDimension_Texture1D ? 1 : std::max<uint32_t>(1, desc.Height >> mip);
+	const uint32_t depth = is3D ? std::max<uint32_t>(1, desc.DepthOrArraySize >> mip) : 1;
+
+	DXGI_FORMAT format = desc.Format;
+	GetPlane(desc.Format, plane, width, height, format);
+
+	size_t rowBytes = 0;
+	size_t numRows = 0;
+	DdsImage::GetSurfaceInfo(width, height, format, nullptr, &rowBytes, &numRows);
+
+	// Copies work on whole blocks, so the footprint covers them.
+	if(IsBlockCompressed(format))
+	{
+		width = static_cast<uint32_t>(AlignUp(width, 4));
+		height = static_cast<uint32_t>(AlignUp(height, 4));
+	}
+	else if(IsPacked(format))
+	{
+		width = static_cast<uint32_t>(AlignUp(width, 2));
+	}
+
+	const uint64_t rowPitch = AlignUp(rowBytes, RowPitchAlignment);
+	if(rowPitch > UINT32_MAX)
+	{
+		return false;
+	}
+
+	out.Offset = AlignUp(offset, PlacementAlignment);
+	out.Format = format;
+	out.Width = width;
+	out.Height = height;
+	out.Depth = depth;
+	out.RowPitch = static_cast<uint32_t>(rowPitch);
+	out.NumRows = static_cast<uint32_t>(numRows);
+	out.RowSizeInBytes = rowBytes;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+bool TextureFootprint::Compute(const TextureFootprintDesc& desc, uint32_t firstSubresource,
+	uint32_t numSubresources, uint64_t baseOffset,
+	SubresourceFootprint* out, uint64_t* totalBytes)
+{
+	uint64_t offset = baseOffset;
+	uint64_t firstOffset = baseOffset;
+	uint64_t end = baseOffset;
+	for(uint32_t i = 0; i < numSubresources; ++i)
+	{
+		SubresourceFootprint footprint;
+		if(!Compute(desc, firstSubresource + i, offset, footprint))
+		{
+			return false;
+		}
+
+		if(i == 0)
+		{
+			firstOffset = footprint.Offset;
+		}
+		if(out != nullptr)
+		{
+			out[i] = footprint;
+		}
+
+		end = footprint.Offset + uint64_t(footprint.RowPitch) * (uint64_t(footprint.NumRows) * footprint.Depth - 1) +
+			footprint.RowSizeInBytes;
+		offset = GetEnd(footprint);
+	}
+
+	if(totalBytes != nullptr)
+	{
+		*totalBytes = end - firstOffset;
+	}
+	return true;
+}
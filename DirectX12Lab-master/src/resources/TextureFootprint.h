@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "DdsImage.h"
+
+// Values match D3D12_RESOURCE_DIMENSION (and DdsImage::Dimension for textures).
+enum FootprintDimension
+{
+	FootprintDimension_Buffer = 1,
+	FootprintDimension_Texture1D = 2,
+	FootprintDimension_Texture2D = 3,
+	FootprintDimension_Texture3D = 4,
+};
+
+// The D3D12_RESOURCE_DESC fields a copy layout depends on.
+struct TextureFootprintDesc
+{
+	FootprintDimension Dimension = FootprintDimension_Texture2D;
+	DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+	uint64_t Width = 0;             // bytes for buffers
+	uint32_t Height = 1;
+	uint32_t DepthOrArraySize = 1;
+	uint32_t MipLevels = 1;
+};
+
+// One subresource in an upload buffer, laid out like D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+// plus GetCopyableFootprints' pNumRows and pRowSizeInBytes.
+struct SubresourceFootprint
+{
+	uint64_t Offset = 0;         // from the start of the buffer
+	DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN; // the plane's format for planar textures
+	uint32_t Width = 0;          // rounded up to whole blocks
+	uint32_t Height = 0;
+	uint32_t Depth = 0;
+	uint32_t RowPitch = 0;       // RowSizeInBytes rounded up to RowPitchAlignment
+	uint32_t NumRows = 0;        // rows of pixels, or of 4x4 blocks
+	uint64_t RowSizeInBytes = 0; // bytes of data in each row
+};
+
+//--------------------------------------------------------------------------------------
+// ID3D12Device::GetCopyableFootprints on the CPU.
+//
+// Reproduces the D3D12 copy layout: rows RowPitchAlignment (256) bytes apart,
+// subresources placed on PlacementAlignment (512) boundaries, block-compressed
+// sizes rounded up to whole blocks and planar formats (NV12, P010, depth-stencil,
+// ...) split into one subresource per plane.  Formats are those DdsImage::BitsPerPixel
+// knows.  Needs no device, so uploads lay out their staging memory without a
+// call into the runtime or a footprint array, and tools can size uploads offline.
+//--------------------------------------------------------------------------------------
+class TextureFootprint
+{
+public:
+	static const uint32_t RowPitchAlignment = 256;  // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	static const uint32_t PlacementAlignment = 512; // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+	// False for formats whose layout is not known here; use the device for those.
+	static bool IsSupported(DXGI_FORMAT format);
+
+	// 2 for planar formats, 1 otherwise (0 when not supported).
+	static uint32_t GetPlaneCount(DXGI_FORMAT format);
+
+	// desc's subresource count, planes included.
+	static uint32_t GetSubresourceCount(const TextureFootprintDesc& desc);
+
+	// Footprint of one subresource (mip + item * MipLevels + plane * MipLevels *
+	// ArraySize), placed at offset rounded up to PlacementAlignment.
+	static bool Compute(const TextureFootprintDesc& desc, uint32_t subresource, uint64_t offset,
+		SubresourceFootprint& out);
+
+	// Same as GetCopyableFootprints: numSubresources footprints placed one after
+	// the other from baseOffset.  out may be null.  totalBytes, when given, gets
+	// the bytes from the first footprint to the end of the last row of the last
+	// one (rows are not padded after it).
+	static bool Compute(const TextureFootprintDesc& desc, uint32_t firstSubresource,
+		uint32_t numSubresources, uint64_t baseOffset,
+		SubresourceFootprint* out, uint64_t* totalBytes);
+
+	// Where the next subresource may start: the end of footprint's padded rows.
+	static uint64_t GetEnd(const SubresourceFootprint& footprint)
+	{
+		return footprint.Offset + uint64_t(footprint.RowPitch) * footprint.NumRows * footprint.Depth;
+	}
+};
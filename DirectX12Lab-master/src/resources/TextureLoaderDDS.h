@@ -25,6 +25,9 @@
 #define _Use_decl_annotations_
 #endif
 
+class GpuHeap;
+struct GpuHeapAllocation;
+
 namespace DirectX
 {
     enum DDS_ALPHA_MODE
@@ -46,6 +49,8 @@ namespace DirectX
                                         _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
                                       );
 
+	// With gpuHeap the texture is placed in it instead of getting a committed heap;
+	// heapAllocation receives the handle to GpuHeap::Release() it with.
 	HRESULT CreateDDSTextureFromMemory12(_In_ ID3D12Device* device,
 		                                 _In_ ID3D12GraphicsCommandList* cmdList,
 		                                 _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -53,7 +58,9 @@ namespace DirectX
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                                 _In_ size_t maxsize = 0,
-		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 _In_opt_ GpuHeap* gpuHeap = nullptr,
+		                                 _Out_opt_ GpuHeapAllocation* heapAllocation = nullptr
 		                                 );
 
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
@@ -70,7 +77,9 @@ namespace DirectX
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                               _In_ size_t maxsize = 0,
-		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                               _In_opt_ GpuHeap* gpuHeap = nullptr,
+		                               _Out_opt_ GpuHeapAllocation* heapAllocation = nullptr
 		                               );
 
     // Standard version with optional auto-gen mipmap support
@@ -0,0 +1,347 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+TextureStreamer::TextureStreamer(IMipUploadSink& sink, const Config& config)
+: mSink(sink), mConfig(config)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for(StreamTextureId id = 0; id < (StreamTextureId)mEntries.size(); ++id)
+	{
+		if(mEntries[id].Live)
+			mSink.Release(id);
+	}
+}
+
+std::uint32_t TextureStreamer::ComputeDesiredMip(std::size_t width, std::size_t height,
+	std::uint32_t mipCount, float screenTexels)
+{
+	if(mipCount == 0)
+		return 0;
+
+	const float largest = (float)std::max(width, height);
+	if(screenTexels <= 0.0f)
+		return mipCount - 1;
+	if(screenTexels >= largest)
+		return 0;
+
+	// Mip m has largest / 2^m texels across; pick the smallest one that still
+	// covers the screen footprint.
+	const float ratio = largest / screenTexels;
+	std::uint32_t mip = (std::uint32_t)std::floor(std::log2(ratio));
+	return std::min(mip, mipCount - 1);
+}
+
+StreamTextureId TextureStreamer::Register(const DdsImage& image)
+{
+	if(image.GetMipCount() == 0)
+		return InvalidId;
+
+	StreamTextureId id;
+	if(mFreeIds.empty())
+	{
+		id = (StreamTextureId)mEntries.size();
+		mEntries.emplace_back();
+	}
+	else
+	{
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+	}
+
+	Entry& entry = mEntries[id];
+	entry = Entry();
+	entry.Image = &image;
+	entry.MipCount = (std::uint32_t)image.GetMipCount();
+	entry.ResidentMip = entry.MipCount;
+	entry.LastRequestFrame = mFrameIndex;
+	entry.Live = true;
+
+	// Byte size of each mip over all array items, accumulated from the smallest.
+	entry.SuffixBytes.assign(entry.MipCount + 1, 0);
+	for(std::uint32_t mip = entry.MipCount; mip > 0; --mip)
+	{
+		DdsImage::Subresource sub = image.GetSubresource(mip - 1, 0);
+		std::uint64_t mipBytes = (std::uint64_t)sub.SlicePitch * sub.Depth * image.GetArraySize();
+		entry.SuffixBytes[mip - 1] = entry.SuffixBytes[mip] + mipBytes;
+	}
+
+	// The tail is the first mip that fits in TailSize.
+	entry.TailMip = entry.MipCount - 1;
+	for(std::uint32_t mip = 0; mip < entry.MipCount; ++mip)
+	{
+		DdsImage::Subresource sub = image.GetSubresource(mip, 0);
+		if(sub.Width <= mConfig.TailSize && sub.Height <= mConfig.TailSize)
+		{
+			entry.TailMip = mip;
+			break;
+		}
+	}
+	entry.DesiredMip = entry.TailMip;
+
+	// The tail is small and makes the texture usable, so it ignores the budget;
+	// if the sink is busy, Update() retries.
+	Load(id, entry.TailMip);
+	mStats.ResidentBytes = mResidentBytes;
+
+	return id;
+}
+
+void TextureStreamer::Unregister(StreamTextureId id)
+{
+	if(id >= mEntries.size() || !mEntries[id].Live)
+		return;
+
+	Entry& entry = mEntries[id];
+	mResidentBytes -= BytesFor(entry, entry.ResidentMip);
+	mSink.Release(id);
+
+	entry = Entry();
+	mFreeIds.push_back(id);
+	mStats.ResidentBytes = mResidentBytes;
+}
+
+void TextureStreamer::RequestResolution(StreamTextureId id, float screenTexels)
+{
+	if(id >= mEntries.size() || !mEntries[id].Live)
+		return;
+
+	Entry& entry = mEntries[id];
+	entry.RequestedTexels = std::max(entry.RequestedTexels, screenTexels);
+	entry.LastRequestFrame = mFrameIndex;
+}
+
+void TextureStreamer::Update(std::uint64_t frameIndex)
+{
+	mStats.UploadedBytes = 0;
+	mStats.Loads = 0;
+	mStats.Evictions = 0;
+	mStats.PendingTextures = 0;
+	const std::uint64_t stallsBefore = mStats.BudgetStalls;
+
+	// Desired mips from this frame's requests.
+	mCandidates.clear();
+	for(StreamTextureId id = 0; id < (StreamTextureId)mEntries.size(); ++id)
+	{
+		Entry& entry = mEntries[id];
+		if(!entry.Live)
+			continue;
+
+		if(entry.RequestedTexels > 0.0f)
+		{
+			std::uint32_t mip = ComputeDesiredMip(entry.Image->GetWidth(), entry.Image->GetHeight(),
+				entry.MipCount, entry.RequestedTexels);
+			entry.DesiredMip = std::min(mip + mMipBias, entry.TailMip);
+		}
+		else if(frameIndex - entry.LastRequestFrame > mConfig.IdleFrames)
+		{
+			entry.DesiredMip = entry.TailMip;
+		}
+		entry.DesiredMip = std::max(entry.DesiredMip, entry.FinestLoadableMip);
+		entry.RequestedTexels = 0.0f;
+
+		if(entry.ResidentMip > entry.DesiredMip)
+			mCandidates.push_back(id);
+	}
+
+	// Most under-resolved first; among equals the most recently requested.
+	std::sort(mCandidates.begin(), mCandidates.end(), [this](StreamTextureId a, StreamTextureId b)
+	{
+		const Entry& ea = mEntries[a];
+		const Entry& eb = mEntries[b];
+		const std::uint32_t gapA = ea.ResidentMip - ea.DesiredMip;
+		const std::uint32_t gapB = eb.ResidentMip - eb.DesiredMip;
+		if(gapA != gapB)
+			return gapA > gapB;
+		return ea.LastRequestFrame > eb.LastRequestFrame;
+	});
+
+	std::uint64_t uploadBudget = mConfig.MaxUploadBytesPerUpdate;
+	for(StreamTextureId id : mCandidates)
+	{
+		Entry& entry = mEntries[id];
+
+		if(mStats.Loads >= mConfig.MaxLoadsPerUpdate)
+		{
+			++mStats.PendingTextures;
+			continue;
+		}
+
+		// Go as far toward the desired mip as the upload limit allows, but always
+		// at least one level so large mips can not starve.
+		std::uint32_t target = entry.ResidentMip - 1;
+		while(target > entry.DesiredMip &&
+			BytesFor(entry, target - 1) - BytesFor(entry, entry.ResidentMip) <= uploadBudget)
+		{
+			--target;
+		}
+
+		const std::uint64_t need = BytesFor(entry, target) - BytesFor(entry, entry.ResidentMip);
+		if(need > uploadBudget && mStats.Loads > 0)
+		{
+			++mStats.PendingTextures;
+			continue;
+		}
+
+		if(!MakeRoom(need, id))
+		{
+			++mStats.BudgetStalls;
+			++mStats.PendingTextures;
+			continue;
+		}
+
+		const MipLoadResult result = Load(id, target);
+		if(result != MipLoad_Done)
+		{
+			// A busy sink may still take a smaller load, so keep going; a failed one
+			// was capped by Load() and is not pending any more.
+			if(result == MipLoad_Busy)
+				++mStats.PendingTextures;
+			continue;
+		}
+
+		uploadBudget = need < uploadBudget ? uploadBudget - need : 0;
+		mStats.UploadedBytes += need;
+		++mStats.Loads;
+
+		if(entry.ResidentMip > entry.DesiredMip)
+			++mStats.PendingTextures;
+	}
+
+	// Surplus mips survive while they fit; drop them once the budget shrank below
+	// what is resident.
+	if(mResidentBytes > mConfig.BudgetBytes)
+		MakeRoom(0, InvalidId);
+
+	// When even the wanted mips do not fit, coarsen every request by one more
+	// level; mips that become surplus are evicted next update.  Relax
+	// only when one finer level (about 4x the bytes for 2D mips) would fit, so
+	// the bias does not flip every frame.
+	const bool starved = mStats.BudgetStalls != stallsBefore || mResidentBytes > mConfig.BudgetBytes;
+	if(starved && mMipBias < DdsImage::MaxMipLevels)
+		++mMipBias;
+	else if(!starved && mMipBias > 0 && mResidentBytes < mConfig.BudgetBytes / 4)
+		--mMipBias;
+
+	mStats.MipBias = mMipBias;
+	mStats.ResidentBytes = mResidentBytes;
+	mFrameIndex = frameIndex + 1;
+}
+
+std::uint32_t TextureStreamer::GetResidentMip(StreamTextureId id)const
+{
+	return id < mEntries.size() ? mEntries[id].ResidentMip : 0;
+}
+
+std::uint32_t TextureStreamer::GetDesiredMip(StreamTextureId id)const
+{
+	return id < mEntries.size() ? mEntries[id].DesiredMip : 0;
+}
+
+std::uint32_t TextureStreamer::GetTailMip(StreamTextureId id)const
+{
+	return id < mEntries.size() ? mEntries[id].TailMip : 0;
+}
+
+std::uint64_t TextureStreamer::GetResidentBytes(StreamTextureId id)const
+{
+	return id < mEntries.size() ? BytesFor(mEntries[id], mEntries[id].ResidentMip) : 0;
+}
+
+std::uint64_t TextureStreamer::BytesFor(const Entry& entry, std::uint32_t firstMip)const
+{
+	return firstMip < entry.SuffixBytes.size() ? entry.SuffixBytes[firstMip] : 0;
+}
+
+MipLoadResult TextureStreamer::Load(StreamTextureId id, std::uint32_t firstMip)
+{
+	Entry& entry = mEntries[id];
+	assert(firstMip < entry.ResidentMip);
+
+	const MipLoadResult result = mSink.LoadMips(id, *entry.Image, firstMip, entry.ResidentMip);
+	if(result == MipLoad_Failed)
+	{
+		// Never ask for these mips again; a smaller step may still work.
+		entry.FinestLoadableMip = std::max(entry.FinestLoadableMip, firstMip + 1);
+		entry.DesiredMip = std::max(entry.DesiredMip, entry.FinestLoadableMip);
+		++mStats.LoadFailures;
+	}
+	if(result != MipLoad_Done)
+		return result;
+
+	mResidentBytes += BytesFor(entry, firstMip) - BytesFor(entry, entry.ResidentMip);
+	entry.ResidentMip = firstMip;
+	return MipLoad_Done;
+}
+
+bool TextureStreamer::Evict(StreamTextureId id, std::uint32_t firstMip)
+{
+	Entry& entry = mEntries[id];
+	assert(firstMip > entry.ResidentMip && firstMip <= entry.TailMip);
+
+	if(!mSink.EvictMips(id, *entry.Image, firstMip))
+		return false;
+
+	mResidentBytes -= BytesFor(entry, entry.ResidentMip) - BytesFor(entry, firstMip);
+	entry.ResidentMip = firstMip;
+	++mStats.Evictions;
+	return true;
+}
+
+bool TextureStreamer::MakeRoom(std::uint64_t needBytes, StreamTextureId requester)
+{
+	if(mResidentBytes + needBytes <= mConfig.BudgetBytes)
+		return true;
+
+	// Only mips finer than a texture's desired mip are surplus; the tail and
+	// anything currently wanted are never evicted to make room.
+	mVictims.clear();
+	for(StreamTextureId id = 0; id < (StreamTextureId)mEntries.size(); ++id)
+	{
+		const Entry& entry = mEntries[id];
+		if(entry.Live && id != requester && entry.ResidentMip < entry.DesiredMip)
+			mVictims.push_back(id);
+	}
+
+	// Check the whole surplus first so nothing is evicted for a load that can
+	// not fit anyway.
+	std::uint64_t surplus = 0;
+	for(StreamTextureId id : mVictims)
+		surplus += BytesFor(mEntries[id], mEntries[id].ResidentMip) - BytesFor(mEntries[id], mEntries[id].DesiredMip);
+
+	const std::uint64_t over = mResidentBytes + needBytes - mConfig.BudgetBytes;
+	if(requester != InvalidId && surplus < over)
+		return false;
+
+	// Least recently requested first.
+	std::sort(mVictims.begin(), mVictims.end(), [this](StreamTextureId a, StreamTextureId b)
+	{
+		return mEntries[a].LastRequestFrame < mEntries[b].LastRequestFrame;
+	});
+
+	for(StreamTextureId id : mVictims)
+	{
+		if(mResidentBytes + needBytes <= mConfig.BudgetBytes)
+			break;
+
+		const Entry& entry = mEntries[id];
+
+		// Drop one level at a time so a victim keeps as much detail as fits.
+		std::uint32_t firstMip = entry.ResidentMip + 1;
+		while(firstMip < entry.DesiredMip &&
+			mResidentBytes - (BytesFor(entry, entry.ResidentMip) - BytesFor(entry, firstMip)) + needBytes > mConfig.BudgetBytes)
+		{
+			++firstMip;
+		}
+
+		// A victim the sink can not shrink right now keeps its mips; try the next.
+		Evict(id, firstMip);
+	}
+
+	return mResidentBytes + needBytes <= mConfig.BudgetBytes;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DdsImage.h"
+
+typedef std::uint32_t StreamTextureId;
+
+enum MipLoadResult
+{
+	MipLoad_Done,
+	MipLoad_Busy,   // no room for the work right now; the streamer retries next update
+	MipLoad_Failed, // can never succeed, e.g. more staging than the sink has at all
+};
+
+// Receives the residency decisions of TextureStreamer and does the actual work
+// (GPU copies, uploads).  Mips are always resident as a contiguous range
+// [firstMip, mipCount) of every array item.
+class IMipUploadSink
+{
+public:
+	virtual ~IMipUploadSink() = default;
+
+	// Make mips [firstMip, mipCount) resident; [previousFirstMip, mipCount) already
+	// are (previousFirstMip == mipCount when nothing is).  Anything but
+	// MipLoad_Done must leave the resident range as it was.
+	virtual MipLoadResult LoadMips(StreamTextureId id, const DdsImage& image,
+		std::uint32_t firstMip, std::uint32_t previousFirstMip) = 0;
+
+	// Shrink the resident range to [firstMip, mipCount).  Returns false, changing
+	// nothing, when that is not possible right now.
+	virtual bool EvictMips(StreamTextureId id, const DdsImage& image, std::uint32_t firstMip) = 0;
+
+	// The texture is no longer streamed; release everything.
+	virtual void Release(StreamTextureId id) = 0;
+};
+
+// Decides which mips of each streamed texture should be resident.
+//
+// Registering a texture makes its mip tail (every mip no larger than TailSize)
+// resident at once, so it can be drawn immediately.  Each frame the renderer
+// reports how large a texture appears on screen with RequestResolution(); Update()
+// turns that into a desired mip and streams the missing finer mips in, most
+// under-resolved textures first, within BudgetBytes and a per-update upload limit.
+// Finer mips than needed are kept until memory is short, then evicted starting
+// with the textures that were requested least recently.  If the wanted mips alone
+// exceed the budget, a global mip bias coarsens every request until they fit.
+// A load the sink can never do caps that texture at the next coarser mip for
+// good; a busy sink only postpones the load.
+//
+// The streamer keeps a reference to each DdsImage (and thus to its mapped file),
+// which must stay valid until Unregister().
+class TextureStreamer
+{
+public:
+	static const StreamTextureId InvalidId = ~0u;
+
+	struct Config
+	{
+		std::uint64_t BudgetBytes = 256ull * 1024 * 1024;
+		std::uint32_t TailSize = 64;                         // texels
+		std::uint64_t MaxUploadBytesPerUpdate = 16ull * 1024 * 1024;
+		std::uint32_t MaxLoadsPerUpdate = 8;
+		std::uint32_t IdleFrames = 120; // unrequested this long => only the tail is desired
+	};
+
+	struct Stats
+	{
+		std::uint64_t ResidentBytes = 0;
+		std::uint64_t UploadedBytes = 0;    // in the last Update()
+		std::uint32_t Loads = 0;            // in the last Update()
+		std::uint32_t Evictions = 0;        // in the last Update()
+		std::uint32_t PendingTextures = 0;  // wanting finer mips after the last Update()
+		std::uint64_t BudgetStalls = 0;     // loads skipped for lack of memory, total
+		std::uint64_t LoadFailures = 0;     // loads the sink can never do, total
+		std::uint32_t MipBias = 0;          // added to every desired mip while memory is short
+	};
+
+	TextureStreamer(IMipUploadSink& sink, const Config& config);
+	TextureStreamer(const TextureStreamer& rhs) = delete;
+	TextureStreamer& operator=(const TextureStreamer& rhs) = delete;
+	~TextureStreamer();
+
+	StreamTextureId Register(const DdsImage& image);
+	void Unregister(StreamTextureId id);
+
+	// screenTexels: how many texels across the texture's largest dimension would
+	// map 1:1 to pixels, e.g. projected size in pixels times UV scale.  Several
+	// requests in one frame keep the largest.
+	void RequestResolution(StreamTextureId id, float screenTexels);
+
+	void Update(std::uint64_t frameIndex);
+
+	std::uint32_t GetResidentMip(StreamTextureId id)const;
+	std::uint32_t GetDesiredMip(StreamTextureId id)const;
+	std::uint32_t GetTailMip(StreamTextureId id)const;
+	std::uint64_t GetResidentBytes(StreamTextureId id)const;
+
+	const Stats& GetStats()const { return mStats; }
+	const Config& GetConfig()const { return mConfig; }
+	void SetBudget(std::uint64_t bytes) { mConfig.BudgetBytes = bytes; }
+
+	// Finest mip worth having when the texture covers screenTexels texels.
+	static std::uint32_t ComputeDesiredMip(std::size_t width, std::size_t height,
+		std::uint32_t mipCount, float screenTexels);
+
+private:
+	struct Entry
+	{
+		const DdsImage* Image = nullptr;
+		std::uint32_t MipCount = 0;
+		std::uint32_t TailMip = 0;
+		std::uint32_t ResidentMip = 0;  // == MipCount when nothing is resident
+		std::uint32_t DesiredMip = 0;
+		std::uint32_t FinestLoadableMip = 0; // raised when the sink fails a load outright
+		float RequestedTexels = 0.0f;   // this frame
+		std::uint64_t LastRequestFrame = 0;
+		bool Live = false;
+
+		// SuffixBytes[m] = bytes of mips [m, MipCount) over all array items.
+		std::vector<std::uint64_t> SuffixBytes;
+	};
+
+	std::uint64_t BytesFor(const Entry& entry, std::uint32_t firstMip)const;
+	MipLoadResult Load(StreamTextureId id, std::uint32_t firstMip);
+	bool Evict(StreamTextureId id, std::uint32_t firstMip);
+
+	// Evicts surplus mips of other textures until needBytes fit in the budget.
+	bool MakeRoom(std::uint64_t needBytes, StreamTextureId requester);
+
+private:
+	IMipUploadSink& mSink;
+	Config mConfig;
+
+	std::vector<Entry> mEntries;
+	std::vector<StreamTextureId> mFreeIds;
+
+	std::uint64_t mFrameIndex = 0;
+	std::uint64_t mResidentBytes = 0;
+	std::uint32_t mMipBias = 0;
+	Stats mStats;
+
+	// Scratch lists reused every Update().
+	std::vector<StreamTextureId> mCandidates;
+	std::vector<StreamTextureId> mVictims;
+};
@@ -1,11 +1,27 @@
 
 #include "CameraComponent.h"
+#include "../math/Halton.h"
+
+#include <cassert>
+#include <cmath>
 
 using namespace DirectX;
 
+namespace
+{
+	const XMFLOAT4X4 Identity(
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
 CameraComponent::CameraComponent()
+: mView(Identity), mProj(Identity), mProjUnjittered(Identity),
+  mViewProj(Identity), mInvView(Identity), mInvProj(Identity), mInvViewProj(Identity),
+  mViewProjUnjittered(Identity), mPrevViewProj(Identity)
 {
-	SetLens(0.25f*MathUtils::Pi, 1.0f, 1.0f, 1000.0f);
+	SetLens(0.25f*XM_PI, 1.0f, 1.0f, 1000.0f);
 }
 
 CameraComponent::~CameraComponent()
@@ -122,7 +138,87 @@ void CameraComponent::SetLens(float fovY, float aspect, float zn, float zf)
 	mFarWindowHeight  = 2.0f * mFarZ * tanf( 0.5f*mFovY );
 
 	XMMATRIX P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
+	XMStoreFloat4x4(&mProjUnjittered, P);
+
+	RebuildProj();
+}
+
+void CameraComponent::RebuildProj()
+{
+	XMMATRIX P = XMLoadFloat4x4(&mProjUnjittered);
+	if(mJitterEnabled)
+		P = JitterProjection(P, mJitterPixels, mViewportWidth, mViewportHeight);
+
 	XMStoreFloat4x4(&mProj, P);
+
+	XMVECTOR det = XMMatrixDeterminant(P);
+	XMStoreFloat4x4(&mInvProj, XMMatrixInverse(&det, P));
+
+	mViewProjDirty = true;
+}
+
+void CameraComponent::SetJitterEnabled(bool enabled, std::uint32_t phaseCount)
+{
+	assert(phaseCount > 0);
+
+	mJitterEnabled = enabled;
+	mJitterPhaseCount = phaseCount;
+	mJitterPixels = XMFLOAT2(0.0f, 0.0f);
+
+	RebuildProj();
+}
+
+bool CameraComponent::GetJitterEnabled()const
+{
+	return mJitterEnabled;
+}
+
+void CameraComponent::BeginFrame(std::uint64_t frameIndex, std::uint32_t viewportWidth, std::uint32_t viewportHeight)
+{
+	// Last frame's matrices become the history.  On the very first frame there is
+	// no history, so the previous matrix is the current one (zero motion).
+	UpdateViewMatrix();
+	mPrevViewProj = mViewProjUnjittered;
+	mHasPrevViewProj = true;
+
+	mViewportWidth = viewportWidth > 0 ? viewportWidth : 1;
+	mViewportHeight = viewportHeight > 0 ? viewportHeight : 1;
+
+	if(mJitterEnabled)
+	{
+		mJitterPixels = ComputeJitterPixels(frameIndex, mJitterPhaseCount);
+		RebuildProj();
+	}
+}
+
+XMFLOAT2 CameraComponent::GetJitterPixels()const
+{
+	return mJitterPixels;
+}
+
+XMFLOAT2 CameraComponent::ComputeJitterPixels(std::uint64_t frameIndex, std::uint32_t phaseCount)
+{
+	// Skip index 0 of the sequence, which is (0, 0) for every base.
+	const std::uint32_t index = (std::uint32_t)(frameIndex % phaseCount) + 1;
+
+	return XMFLOAT2(
+		Halton(index, 2) - 0.5f,
+		Halton(index, 3) - 0.5f);
+}
+
+XMMATRIX CameraComponent::JitterProjection(CXMMATRIX proj, const XMFLOAT2& jitterPixels,
+	std::uint32_t viewportWidth, std::uint32_t viewportHeight)
+{
+	// With row vectors, clip.x = ... + z*m[2][0] and clip.w = z for a perspective
+	// projection, so adding to row 2 translates NDC by a constant after the divide.
+	// NDC spans 2 units across the viewport and its y axis points up.
+	XMFLOAT4X4 P;
+	XMStoreFloat4x4(&P, proj);
+
+	P(2, 0) += 2.0f * jitterPixels.x / (float)viewportWidth;
+	P(2, 1) -= 2.0f * jitterPixels.y / (float)viewportHeight;
+
+	return XMLoadFloat4x4(&P);
 }
 
 void CameraComponent::LookAt(FXMVECTOR pos, FXMVECTOR target, FXMVECTOR worldUp)
@@ -161,6 +257,11 @@ XMMATRIX CameraComponent::GetProj()const
 	return XMLoadFloat4x4(&mProj);
 }
 
+XMMATRIX CameraComponent::GetProjUnjittered()const
+{
+	return XMLoadFloat4x4(&mProjUnjittered);
+}
+
 
 XMFLOAT4X4 CameraComponent::GetView4x4f()const
 {
@@ -173,6 +274,68 @@ XMFLOAT4X4 CameraComponent::GetProj4x4f()const
 	return mProj;
 }
 
+XMMATRIX CameraComponent::GetViewProj()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return XMLoadFloat4x4(&mViewProj);
+}
+
+XMMATRIX CameraComponent::GetInvView()const
+{
+	assert(!mViewDirty);
+	return XMLoadFloat4x4(&mInvView);
+}
+
+XMMATRIX CameraComponent::GetInvProj()const
+{
+	return XMLoadFloat4x4(&mInvProj);
+}
+
+XMMATRIX CameraComponent::GetInvViewProj()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return XMLoadFloat4x4(&mInvViewProj);
+}
+
+XMFLOAT4X4 CameraComponent::GetViewProj4x4f()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return mViewProj;
+}
+
+XMFLOAT4X4 CameraComponent::GetInvViewProj4x4f()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return mInvViewProj;
+}
+
+XMMATRIX CameraComponent::GetViewProjUnjittered()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return XMLoadFloat4x4(&mViewProjUnjittered);
+}
+
+XMMATRIX CameraComponent::GetPrevViewProj()const
+{
+	return mHasPrevViewProj ? XMLoadFloat4x4(&mPrevViewProj) : GetViewProjUnjittered();
+}
+
+XMFLOAT4X4 CameraComponent::GetViewProjUnjittered4x4f()const
+{
+	assert(!mViewDirty && !mViewProjDirty);
+	return mViewProjUnjittered;
+}
+
+XMFLOAT4X4 CameraComponent::GetPrevViewProj4x4f()const
+{
+	return mHasPrevViewProj ? mPrevViewProj : GetViewProjUnjittered4x4f();
+}
+
+std::uint64_t CameraComponent::GetGeneration()const
+{
+	return mGeneration;
+}
+
 void CameraComponent::Strafe(float d)
 {
 	// mPosition += d*mRight
@@ -265,7 +428,33 @@ void CameraComponent::UpdateViewMatrix()
 		mView(2, 3) = 0.0f;
 		mView(3, 3) = 1.0f;
 
+		// The view matrix is a rigid transform, so its inverse is just the camera
+		// basis vectors and position written as rows; no general inverse needed.
+		mInvView = XMFLOAT4X4(
+			mRight.x,    mRight.y,    mRight.z,    0.0f,
+			mUp.x,       mUp.y,       mUp.z,       0.0f,
+			mLook.x,     mLook.y,     mLook.z,     0.0f,
+			mPosition.x, mPosition.y, mPosition.z, 1.0f);
+
 		mViewDirty = false;
+		mViewProjDirty = true;
+	}
+
+	if(mViewProjDirty)
+	{
+		XMMATRIX V = XMLoadFloat4x4(&mView);
+		XMMATRIX P = XMLoadFloat4x4(&mProj);
+		XMMATRIX invV = XMLoadFloat4x4(&mInvView);
+		XMMATRIX invP = XMLoadFloat4x4(&mInvProj);
+		XMMATRIX unjitteredP = XMLoadFloat4x4(&mProjUnjittered);
+
+		// (V*P)^-1 = P^-1 * V^-1
+		XMStoreFloat4x4(&mViewProj, XMMatrixMultiply(V, P));
+		XMStoreFloat4x4(&mInvViewProj, XMMatrixMultiply(invP, invV));
+		XMStoreFloat4x4(&mViewProjUnjittered, XMMatrixMultiply(V, unjitteredP));
+
+		mViewProjDirty = false;
+		++mGeneration;
 	}
 }
 
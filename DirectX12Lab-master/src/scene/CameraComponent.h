@@ -2,7 +2,8 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include "../graphics/Dx12Utils.h"
+#include <DirectXMath.h>
+#include <cstdint>
 
 class CameraComponent
 {
@@ -45,13 +46,57 @@ public:
 	void LookAt(DirectX::FXMVECTOR pos, DirectX::FXMVECTOR target, DirectX::FXMVECTOR worldUp);
 	void LookAt(const DirectX::XMFLOAT3& pos, const DirectX::XMFLOAT3& target, const DirectX::XMFLOAT3& up);
 
-	// Get View/Proj matrices.
+	// Get View/Proj matrices.  GetProj() includes the current sub-pixel jitter when
+	// jitter is enabled; GetProjUnjittered() never does.
 	DirectX::XMMATRIX GetView()const;
 	DirectX::XMMATRIX GetProj()const;
+	DirectX::XMMATRIX GetProjUnjittered()const;
 
 	DirectX::XMFLOAT4X4 GetView4x4f()const;
 	DirectX::XMFLOAT4X4 GetProj4x4f()const;
 
+	// Get cached combined and inverse matrices.  These are rebuilt together with the
+	// view matrix in UpdateViewMatrix(), so they are only valid after that call.
+	DirectX::XMMATRIX GetViewProj()const;
+	DirectX::XMMATRIX GetInvView()const;
+	DirectX::XMMATRIX GetInvProj()const;
+	DirectX::XMMATRIX GetInvViewProj()const;
+
+	DirectX::XMFLOAT4X4 GetViewProj4x4f()const;
+	DirectX::XMFLOAT4X4 GetInvViewProj4x4f()const;
+
+	// Unjittered view-projection of this frame and of the previous frame (as it was
+	// when BeginFrame() was called).  Used to compute motion vectors for temporal
+	// accumulation; jitter is left out so static geometry gets zero motion.
+	DirectX::XMMATRIX GetViewProjUnjittered()const;
+	DirectX::XMMATRIX GetPrevViewProj()const;
+	DirectX::XMFLOAT4X4 GetViewProjUnjittered4x4f()const;
+	DirectX::XMFLOAT4X4 GetPrevViewProj4x4f()const;
+
+	// Sub-pixel projection jitter for temporal accumulation.  The jitter cycles
+	// through the first phaseCount points of the Halton(2,3) sequence.
+	void SetJitterEnabled(bool enabled, std::uint32_t phaseCount = 8);
+	bool GetJitterEnabled()const;
+
+	// Call once per frame before moving the camera: records the previous frame's
+	// view-projection and selects the jitter for frameIndex, scaled so that one
+	// unit equals one pixel of a viewport of the given size.
+	void BeginFrame(std::uint64_t frameIndex, std::uint32_t viewportWidth, std::uint32_t viewportHeight);
+
+	// Current jitter in pixels, each component in [-0.5, 0.5).
+	DirectX::XMFLOAT2 GetJitterPixels()const;
+
+	// Returns the jitter in pixels for a frame of a phaseCount-long Halton(2,3) cycle.
+	static DirectX::XMFLOAT2 ComputeJitterPixels(std::uint64_t frameIndex, std::uint32_t phaseCount);
+
+	// Returns proj with a pixel-space offset baked in as an NDC translation.
+	static DirectX::XMMATRIX JitterProjection(DirectX::CXMMATRIX proj, const DirectX::XMFLOAT2& jitterPixels,
+		std::uint32_t viewportWidth, std::uint32_t viewportHeight);
+
+	// Incremented every time UpdateViewMatrix() produces new matrices.  Consumers
+	// remember the last value they saw and skip their own work while it is unchanged.
+	std::uint64_t GetGeneration()const;
+
 	// Strafe/Walk the camera a distance d.
 	void Strafe(float d);
 	void Walk(float d);
@@ -65,6 +110,8 @@ public:
 
 private:
 
+	void RebuildProj();
+
 	// CameraComponent coordinate system with coordinates relative to world space.
 	DirectX::XMFLOAT3 mPosition = { 0.0f, 0.0f, 0.0f };
 	DirectX::XMFLOAT3 mRight = { 1.0f, 0.0f, 0.0f };
@@ -80,10 +127,30 @@ private:
 	float mFarWindowHeight = 0.0f;
 
 	bool mViewDirty = true;
-
-	// Cache View/Proj matrices.
-	DirectX::XMFLOAT4X4 mView = MathUtils::Identity4x4();
-	DirectX::XMFLOAT4X4 mProj = MathUtils::Identity4x4();
+	bool mViewProjDirty = true;
+
+	std::uint64_t mGeneration = 0;
+
+	// Projection jitter state.
+	bool mJitterEnabled = false;
+	std::uint32_t mJitterPhaseCount = 8;
+	std::uint32_t mViewportWidth = 1;
+	std::uint32_t mViewportHeight = 1;
+	DirectX::XMFLOAT2 mJitterPixels = { 0.0f, 0.0f };
+	bool mHasPrevViewProj = false;
+
+	// Cache View/Proj matrices.  All start out as identity (see the constructor).
+	DirectX::XMFLOAT4X4 mView;
+	DirectX::XMFLOAT4X4 mProj;
+	DirectX::XMFLOAT4X4 mProjUnjittered;
+
+	// Cache combined and inverse matrices.
+	DirectX::XMFLOAT4X4 mViewProj;
+	DirectX::XMFLOAT4X4 mInvView;
+	DirectX::XMFLOAT4X4 mInvProj;
+	DirectX::XMFLOAT4X4 mInvViewProj;
+	DirectX::XMFLOAT4X4 mViewProjUnjittered;
+	DirectX::XMFLOAT4X4 mPrevViewProj;
 };
 
 #endif // CAMERA_H
\ No newline at end of file
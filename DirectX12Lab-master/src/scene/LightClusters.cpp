@@ -0,0 +1,278 @@
+#include "LightClusters.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "../core/ParallelFor.h"
+
+using namespace DirectX;
+
+LightClusters::LightClusters()
+{
+}
+
+void LightClusters::SetGridSize(std::uint32_t gridX, std::uint32_t gridY, std::uint32_t gridZ)
+{
+	assert(gridX > 0 && gridY > 0 && gridZ > 0);
+
+	mGridX = gridX;
+	mGridY = gridY;
+	mGridZ = gridZ;
+	mBoundsDirty = true;
+}
+
+void LightClusters::SetMaxLightsPerCluster(std::uint32_t maxLights)
+{
+	assert(maxLights > 0);
+	mMaxLightsPerCluster = maxLights;
+}
+
+void LightClusters::SetWorkerCount(std::uint32_t workerCount)
+{
+	mWorkerCount = workerCount;
+}
+
+std::uint32_t LightClusters::GetGridX()const
+{
+	return mGridX;
+}
+
+std::uint32_t LightClusters::GetGridY()const
+{
+	return mGridY;
+}
+
+std::uint32_t LightClusters::GetGridZ()const
+{
+	return mGridZ;
+}
+
+std::uint32_t LightClusters::GetClusterCount()const
+{
+	return mGridX * mGridY * mGridZ;
+}
+
+const std::vector<LightClusters::ClusterRange>& LightClusters::GetClusterRanges()const
+{
+	return mClusterRanges;
+}
+
+const std::vector<std::uint32_t>& LightClusters::GetLightIndices()const
+{
+	return mLightIndices;
+}
+
+void LightClusters::GetSliceScaleBias(float& scale, float& bias)const
+{
+	// No bounds yet, or a depth range the slices can not be built from.
+	if(!(mBoundsNearZ > 0.0f && mBoundsFarZ > mBoundsNearZ))
+	{
+		scale = 0.0f;
+		bias = 0.0f;
+		return;
+	}
+
+	const float logRatio = logf(mBoundsFarZ / mBoundsNearZ);
+
+	scale = (float)mGridZ / logRatio;
+	bias = -(float)mGridZ * logf(mBoundsNearZ) / logRatio;
+}
+
+std::size_t LightClusters::GetPackedByteSize()const
+{
+	return GetPackedIndexOffset() + mLightIndices.size() * sizeof(std::uint32_t);
+}
+
+std::size_t LightClusters::GetPackedIndexOffset()const
+{
+	return mClusterRanges.size() * sizeof(ClusterRange);
+}
+
+void LightClusters::WritePacked(void* dst)const
+{
+	std::uint8_t* bytes = reinterpret_cast<std::uint8_t*>(dst);
+
+	memcpy(bytes, mClusterRanges.data(), mClusterRanges.size() * sizeof(ClusterRange));
+	memcpy(bytes + GetPackedIndexOffset(), mLightIndices.data(), mLightIndices.size() * sizeof(std::uint32_t));
+}
+
+float LightClusters::SpotCutoffCos(float spotPower)
+{
+	// Spot attenuation is pow(max(cos, 0), SpotPower); solve for pow(...) = 1/256.
+	return powf(1.0f / 256.0f, 1.0f / std::max(spotPower, 1e-3f));
+}
+
+void LightClusters::RebuildClusterBounds(const ViewDesc& view)
+{
+	mBoundsFovY = view.FovY;
+	mBoundsAspect = view.Aspect;
+	mBoundsNearZ = view.NearZ;
+	mBoundsFarZ = view.FarZ;
+	mBoundsDirty = false;
+
+	const std::uint32_t clusterCount = GetClusterCount();
+	mClusterMin.resize(clusterCount);
+	mClusterMax.resize(clusterCount);
+
+	const float tanHalfFovY = tanf(0.5f * mBoundsFovY);
+	const float tanHalfFovX = tanHalfFovY * mBoundsAspect;
+	const float ratio = mBoundsFarZ / mBoundsNearZ;
+
+	for(std::uint32_t z = 0; z < mGridZ; ++z)
+	{
+		// Exponential slices keep clusters roughly cubic along the view direction.
+		const float sliceNear = mBoundsNearZ * powf(ratio, (float)z / (float)mGridZ);
+		const float sliceFar = mBoundsNearZ * powf(ratio, (float)(z + 1) / (float)mGridZ);
+
+		for(std::uint32_t y = 0; y < mGridY; ++y)
+		{
+			// Tile row 0 is the top of the screen (NDC y = +1).
+			const float ndcY0 = 1.0f - 2.0f * (float)(y + 1) / (float)mGridY;
+			const float ndcY1 = 1.0f - 2.0f * (float)y / (float)mGridY;
+
+			for(std::uint32_t x = 0; x < mGridX; ++x)
+			{
+				const float ndcX0 = -1.0f + 2.0f * (float)x / (float)mGridX;
+				const float ndcX1 = -1.0f + 2.0f * (float)(x + 1) / (float)mGridX;
+
+				// The tile's side planes pass through the eye, so the extremes are at
+				// the near or far depth of the slice depending on the sign.
+				float xs[4] = {
+					ndcX0 * tanHalfFovX * sliceNear, ndcX1 * tanHalfFovX * sliceNear,
+					ndcX0 * tanHalfFovX * sliceFar,  ndcX1 * tanHalfFovX * sliceFar };
+				float ys[4] = {
+					ndcY0 * tanHalfFovY * sliceNear, ndcY1 * tanHalfFovY * sliceNear,
+					ndcY0 * tanHalfFovY * sliceFar,  ndcY1 * tanHalfFovY * sliceFar };
+
+				const std::uint32_t c = x + mGridX * (y + mGridY * z);
+				mClusterMin[c] = XMFLOAT3(
+					*std::min_element(xs, xs + 4), *std::min_element(ys, ys + 4), sliceNear);
+				mClusterMax[c] = XMFLOAT3(
+					*std::max_element(xs, xs + 4), *std::max_element(ys, ys + 4), sliceFar);
+			}
+		}
+	}
+}
+
+void LightClusters::Bin(const ViewDesc& viewDesc,
+	const Light* pointLights, std::size_t pointLightCount,
+	const Light* spotLights, std::size_t spotLightCount)
+{
+	assert(viewDesc.NearZ > 0.0f && viewDesc.FarZ > viewDesc.NearZ);
+
+	if(mBoundsDirty ||
+		mBoundsFovY != viewDesc.FovY || mBoundsAspect != viewDesc.Aspect ||
+		mBoundsNearZ != viewDesc.NearZ || mBoundsFarZ != viewDesc.FarZ)
+	{
+		RebuildClusterBounds(viewDesc);
+	}
+
+	// Move every light into view space once; the cluster bounds are view space.
+	XMMATRIX view = XMLoadFloat4x4(&viewDesc.View);
+
+	mViewLights.resize(pointLightCount + spotLightCount);
+	for(std::size_t i = 0; i < pointLightCount; ++i)
+	{
+		const Light& l = pointLights[i];
+		ViewLight& v = mViewLights[i];
+
+		XMStoreFloat3(&v.Position, XMVector3TransformCoord(XMLoadFloat3(&l.Position), view));
+		v.Radius = l.FalloffEnd;
+		v.Direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+		v.CutoffCos = -1.0f;
+		v.IsSpot = false;
+	}
+	for(std::size_t i = 0; i < spotLightCount; ++i)
+	{
+		const Light& l = spotLights[i];
+		ViewLight& v = mViewLights[pointLightCount + i];
+
+		XMStoreFloat3(&v.Position, XMVector3TransformCoord(XMLoadFloat3(&l.Position), view));
+		XMStoreFloat3(&v.Direction, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&l.Direction), view)));
+		v.Radius = l.FalloffEnd;
+		v.CutoffCos = SpotCutoffCos(l.SpotPower);
+		v.IsSpot = true;
+	}
+
+	const std::uint32_t clusterCount = GetClusterCount();
+	mClusterRanges.assign(clusterCount, ClusterRange());
+	mScratchIndices.resize((std::size_t)clusterCount * mMaxLightsPerCluster);
+
+	// Depth slices are independent, one ParallelFor item each.  Going wide only
+	// pays off once there is a fair amount of work.
+	const std::uint32_t workerCount = mViewLights.size() < 32 ? 1 : mWorkerCount;
+	ParallelFor(mGridZ, workerCount, [this](std::size_t z)
+	{
+		BinSlices((std::uint32_t)z, (std::uint32_t)z + 1);
+	});
+
+	// Compact the fixed-width scratch lists into one tightly packed index list.
+	std::uint32_t total = 0;
+	for(std::uint32_t c = 0; c < clusterCount; ++c)
+	{
+		mClusterRanges[c].Offset = total;
+		total += mClusterRanges[c].Count;
+	}
+
+	mLightIndices.resize(total);
+	for(std::uint32_t c = 0; c < clusterCount; ++c)
+	{
+		const ClusterRange& r = mClusterRanges[c];
+		if(r.Count > 0)
+		{
+			memcpy(&mLightIndices[r.Offset], &mScratchIndices[(std::size_t)c * mMaxLightsPerCluster],
+				r.Count * sizeof(std::uint32_t));
+		}
+	}
+}
+
+void LightClusters::BinSlices(std::uint32_t firstSlice, std::uint32_t lastSlice)
+{
+	const std::uint32_t lightCount = (std::uint32_t)mViewLights.size();
+
+	for(std::uint32_t z = firstSlice; z < lastSlice; ++z)
+	{
+		for(std::uint32_t c = z * mGridX * mGridY; c < (z + 1) * mGridX * mGridY; ++c)
+		{
+			XMVECTOR boxMin = XMLoadFloat3(&mClusterMin[c]);
+			XMVECTOR boxMax = XMLoadFloat3(&mClusterMax[c]);
+
+			// Bounding sphere of the cluster, used by the cone test.
+			XMVECTOR boxCenter = XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f);
+			float boxRadius = XMVectorGetX(XMVector3Length(XMVectorSubtract(boxMax, boxCenter)));
+
+			std::uint32_t* dst = &mScratchIndices[(std::size_t)c * mMaxLightsPerCluster];
+			std::uint32_t count = 0;
+
+			for(std::uint32_t i = 0; i < lightCount && count < mMaxLightsPerCluster; ++i)
+			{
+				const ViewLight& l = mViewLights[i];
+				XMVECTOR pos = XMLoadFloat3(&l.Position);
+
+				// Sphere vs. AABB.
+				XMVECTOR closest = XMVectorClamp(pos, boxMin, boxMax);
+				float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(pos, closest)));
+				if(distSq > l.Radius * l.Radius)
+					continue;
+
+				if(l.IsSpot)
+				{
+					// Cone vs. sphere: distance from the cluster sphere center to the cone
+					// surface, plus range checks in front of and behind the apex.
+					XMVECTOR v = XMVectorSubtract(boxCenter, pos);
+					float vLenSq = XMVectorGetX(XMVector3LengthSq(v));
+					float v1Len = XMVectorGetX(XMVector3Dot(v, XMLoadFloat3(&l.Direction)));
+					float sinAngle = sqrtf(std::max(0.0f, 1.0f - l.CutoffCos * l.CutoffCos));
+					float distClosest = l.CutoffCos * sqrtf(std::max(0.0f, vLenSq - v1Len * v1Len)) - v1Len * sinAngle;
+
+					if(distClosest > boxRadius || v1Len > boxRadius + l.Radius || v1Len < -boxRadius)
+						continue;
+				}
+
+				dst[count++] = i;
+			}
+
+			mClusterRanges[c].Count = count;
+		}
+	}
+}
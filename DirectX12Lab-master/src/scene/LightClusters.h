@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "../graphics/Light.h"
+
+// Clustered forward light binning.
+//
+// The view frustum is sliced into a GridX * GridY * GridZ grid of froxels
+// (screen tiles times exponential depth slices).  Every frame the point and spot
+// lights are tested against the view space bounds of each froxel and the result
+// is packed into two flat arrays the pixel shader can index:
+//
+//   ClusterRange[cluster] = { offset, count } into LightIndices
+//   LightIndices[]        = light indices, grouped per cluster
+//
+// Per-cluster lists are capped at MaxLightsPerCluster so the cost per pixel stays
+// bounded no matter how many lights are in the scene.  Binning touches no D3D or
+// Windows objects; WritePacked() copies the result into any mapped upload memory.
+class LightClusters
+{
+public:
+	struct ClusterRange
+	{
+		std::uint32_t Offset = 0;
+		std::uint32_t Count = 0;
+	};
+
+	// The camera to bin for: its view matrix (CameraComponent::GetView4x4f()) and
+	// the perspective projection parameters.
+	struct ViewDesc
+	{
+		DirectX::XMFLOAT4X4 View;
+		float FovY = 0.0f;
+		float Aspect = 1.0f;
+		float NearZ = 0.0f;
+		float FarZ = 0.0f;
+	};
+
+	LightClusters();
+
+	// Grid resolution and per-cluster cap.  Takes effect on the next Bin() call.
+	void SetGridSize(std::uint32_t gridX, std::uint32_t gridY, std::uint32_t gridZ);
+	void SetMaxLightsPerCluster(std::uint32_t maxLights);
+
+	// Number of threads used for binning, from the shared ParallelFor pool; 0 picks
+	// every hardware thread.
+	void SetWorkerCount(std::uint32_t workerCount);
+
+	// Assigns lights to clusters for the given view.  Point light i gets index i
+	// and spot light j gets index pointLightCount + j in LightIndices.
+	void Bin(const ViewDesc& view,
+		const Light* pointLights, std::size_t pointLightCount,
+		const Light* spotLights, std::size_t spotLightCount);
+
+	std::uint32_t GetGridX()const;
+	std::uint32_t GetGridY()const;
+	std::uint32_t GetGridZ()const;
+	std::uint32_t GetClusterCount()const;
+
+	const std::vector<ClusterRange>& GetClusterRanges()const;
+	const std::vector<std::uint32_t>& GetLightIndices()const;
+
+	// Maps a view space depth to its slice: slice = log(z) * scale + bias.  Both
+	// are 0 until the first Bin() with a valid depth range.
+	void GetSliceScaleBias(float& scale, float& bias)const;
+
+	// Total number of bytes WritePacked() writes, and the byte offset of the light
+	// index list within it.  Ranges come first, indices follow.
+	std::size_t GetPackedByteSize()const;
+	std::size_t GetPackedIndexOffset()const;
+	void WritePacked(void* dst)const;
+
+	// Returns the cosine of the cone angle beyond which a spot light with the
+	// given SpotPower contributes less than 1/256 of its peak intensity.
+	static float SpotCutoffCos(float spotPower);
+
+private:
+	void RebuildClusterBounds(const ViewDesc& view);
+	void BinSlices(std::uint32_t firstSlice, std::uint32_t lastSlice);
+
+	struct ViewLight
+	{
+		DirectX::XMFLOAT3 Position; // view space
+		float Radius;
+		DirectX::XMFLOAT3 Direction; // view space, spot lights only
+		float CutoffCos;            // spot lights only
+		bool IsSpot;
+	};
+
+	std::uint32_t mGridX = 16;
+	std::uint32_t mGridY = 9;
+	std::uint32_t mGridZ = 24;
+	std::uint32_t mMaxLightsPerCluster = 64;
+	std::uint32_t mWorkerCount = 0;
+
+	// Lens the cluster bounds were built for.
+	float mBoundsFovY = 0.0f;
+	float mBoundsAspect = 0.0f;
+	float mBoundsNearZ = 0.0f;
+	float mBoundsFarZ = 0.0f;
+	bool mBoundsDirty = true;
+
+	// View space AABB of every cluster.
+	std::vector<DirectX::XMFLOAT3> mClusterMin;
+	std::vector<DirectX::XMFLOAT3> mClusterMax;
+
+	std::vector<ViewLight> mViewLights;
+
+	// Per-cluster scratch lists written by the workers, MaxLightsPerCluster wide.
+	std::vector<std::uint32_t> mScratchIndices;
+	std::vector<ClusterRange> mClusterRanges;
+	std::vector<std::uint32_t> mLightIndices;
+};
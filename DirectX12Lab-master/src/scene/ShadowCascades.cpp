@@ -0,0 +1,189 @@
+#include "ShadowCascades.h"
+
+using namespace DirectX;
+
+ShadowCascades::ShadowCascades()
+{
+}
+
+void ShadowCascades::SetCascadeCount(int cascadeCount)
+{
+	mCascadeCount = MathUtils::Clamp(cascadeCount, 1, MaxCascades);
+}
+
+void ShadowCascades::SetSplitLambda(float lambda)
+{
+	mSplitLambda = MathUtils::Clamp(lambda, 0.0f, 1.0f);
+}
+
+void ShadowCascades::SetShadowMapSize(std::uint32_t size)
+{
+	assert(size > 2); // Update() pads the cascade radius by one texel
+	mShadowMapSize = size;
+}
+
+void ShadowCascades::SetMaxShadowDistance(float distance)
+{
+	mMaxShadowDistance = distance;
+}
+
+void ShadowCascades::SetCasterDepthExtent(float extent)
+{
+	mCasterDepthExtent = extent;
+}
+
+int ShadowCascades::GetCascadeCount()const
+{
+	return mCascadeCount;
+}
+
+const ShadowCascades::Cascade& ShadowCascades::GetCascade(int i)const
+{
+	assert(i >= 0 && i < mCascadeCount);
+	return mCascades[i];
+}
+
+void ShadowCascades::ComputeSplits(float zn, float zf, int cascadeCount, float lambda, float* outSplits)
+{
+	// Blend the logarithmic split, which matches perspective aliasing, with the
+	// uniform split, which keeps the near cascades from becoming too thin.
+	const float ratio = zf / zn;
+	const float range = zf - zn;
+
+	outSplits[0] = zn;
+	for(int i = 1; i < cascadeCount; ++i)
+	{
+		float p = (float)i / (float)cascadeCount;
+		float logSplit = zn * powf(ratio, p);
+		float uniformSplit = zn + range * p;
+
+		outSplits[i] = MathUtils::Lerp(uniformSplit, logSplit, lambda);
+	}
+	outSplits[cascadeCount] = zf;
+}
+
+void ShadowCascades::Update(const CameraComponent& camera, const XMFLOAT3& lightDirW)
+{
+	const float zn = camera.GetNearZ();
+	float zf = camera.GetFarZ();
+	if(mMaxShadowDistance > 0.0f)
+		zf = MathUtils::Min(zf, mMaxShadowDistance);
+
+	float splits[MaxCascades + 1];
+	ComputeSplits(zn, zf, mCascadeCount, mSplitLambda, splits);
+
+	// One light orientation for all cascades, positioned at the world origin so that
+	// texel snapping below is relative to a fixed world grid.
+	XMVECTOR lightDir = XMVector3Normalize(XMLoadFloat3(&lightDirW));
+	XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	if(XMVectorGetX(XMVectorAbs(XMVector3Dot(lightDir, up))) > 0.99f)
+		up = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+
+	XMMATRIX lightRotation = XMMatrixLookToLH(XMVectorZero(), lightDir, up);
+	XMStoreFloat4x4(&mLightRotation, lightRotation);
+
+	// Frustum slice corners are expressed in view space as (+-x*z, +-y*z, z).
+	const float tanHalfFovY = tanf(0.5f * camera.GetFovY());
+	const float tanHalfFovX = tanHalfFovY * camera.GetAspect();
+
+	// View space -> light space in one transform.
+	XMMATRIX viewToLight = XMMatrixMultiply(camera.GetInvView(), lightRotation);
+
+	// Transform NDC [-1,1]^2 to texture space [0,1]^2.
+	XMMATRIX T(
+		0.5f, 0.0f, 0.0f, 0.0f,
+		0.0f, -0.5f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.5f, 0.5f, 0.0f, 1.0f);
+
+	for(int i = 0; i < mCascadeCount; ++i)
+	{
+		Cascade& c = mCascades[i];
+		c.SplitNear = splits[i];
+		c.SplitFar = splits[i + 1];
+
+		// The bounding sphere of the slice is rotation invariant: its center lies on the
+		// view axis and its radius depends only on the split distances and lens.
+		XMVECTOR corners[8];
+		for(int j = 0; j < 8; ++j)
+		{
+			float z = (j & 4) ? c.SplitFar : c.SplitNear;
+			float x = ((j & 1) ? 1.0f : -1.0f) * tanHalfFovX * z;
+			float y = ((j & 2) ? 1.0f : -1.0f) * tanHalfFovY * z;
+			corners[j] = XMVectorSet(x, y, z, 1.0f);
+		}
+
+		XMVECTOR centerV = XMVectorZero();
+		for(int j = 0; j < 8; ++j)
+			centerV = XMVectorAdd(centerV, corners[j]);
+		centerV = XMVectorScale(centerV, 1.0f / 8.0f);
+
+		XMVECTOR radiusSq = XMVectorZero();
+		for(int j = 0; j < 8; ++j)
+			radiusSq = XMVectorMax(radiusSq, XMVector3LengthSq(XMVectorSubtract(corners[j], centerV)));
+
+		// Round the radius up so float noise never changes the projection size.
+		float radius = XMVectorGetX(XMVectorSqrt(radiusSq));
+		radius = ceilf(radius * 16.0f) / 16.0f;
+
+		XMFLOAT3 center;
+		XMStoreFloat3(&center, XMVector3TransformCoord(centerV, viewToLight));
+
+		// Snapping moves the center by up to one texel, so pad the radius by one
+		// texel first.  With r' = r * N / (N - 2) a texel is 2r' / N and r' minus
+		// one texel is r, so the slice's sphere stays covered wherever it snaps.
+		const float mapSize = (float)mShadowMapSize;
+		radius = radius * mapSize / (mapSize - 2.0f);
+
+		// Snap the light space center to whole texels so the shadow map moves in
+		// texel-sized steps as the camera translates.
+		const float texelSize = (2.0f * radius) / mapSize;
+		center.x = floorf(center.x / texelSize) * texelSize;
+		center.y = floorf(center.y / texelSize) * texelSize;
+
+		c.LightSpaceMin = XMFLOAT3(center.x - radius, center.y - radius, center.z - radius - mCasterDepthExtent);
+		c.LightSpaceMax = XMFLOAT3(center.x + radius, center.y + radius, center.z + radius);
+
+		XMMATRIX lightProj = XMMatrixOrthographicOffCenterLH(
+			c.LightSpaceMin.x, c.LightSpaceMax.x,
+			c.LightSpaceMin.y, c.LightSpaceMax.y,
+			c.LightSpaceMin.z, c.LightSpaceMax.z);
+
+		c.LightView = mLightRotation;
+		XMStoreFloat4x4(&c.LightProj, lightProj);
+		XMStoreFloat4x4(&c.ShadowTransform, lightRotation * lightProj * T);
+	}
+}
+
+void ShadowCascades::CullCasters(const BoundingSphere* casters, std::size_t casterCount,
+	std::uint8_t* outCascadeMasks)const
+{
+	XMMATRIX lightRotation = XMLoadFloat4x4(&mLightRotation);
+
+	XMVECTOR boxMin[MaxCascades];
+	XMVECTOR boxMax[MaxCascades];
+	for(int i = 0; i < mCascadeCount; ++i)
+	{
+		boxMin[i] = XMLoadFloat3(&mCascades[i].LightSpaceMin);
+		boxMax[i] = XMLoadFloat3(&mCascades[i].LightSpaceMax);
+	}
+
+	// Sphere vs. axis aligned box in light space: the distance from the center to
+	// the box is found by clamping the center into the box.
+	for(std::size_t k = 0; k < casterCount; ++k)
+	{
+		XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&casters[k].Center), lightRotation);
+		XMVECTOR radiusSq = XMVectorReplicate(casters[k].Radius * casters[k].Radius);
+
+		std::uint8_t mask = 0;
+		for(int i = 0; i < mCascadeCount; ++i)
+		{
+			XMVECTOR closest = XMVectorClamp(center, boxMin[i], boxMax[i]);
+			XMVECTOR distSq = XMVector3LengthSq(XMVectorSubtract(center, closest));
+			if(XMVector3LessOrEqual(distSq, radiusSq))
+				mask |= (std::uint8_t)(1u << i);
+		}
+
+		outCascadeMasks[k] = mask;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CameraComponent.h"
+#include "../math/MathUtils.h"
+
+#include <DirectXCollision.h>
+
+// Computes cascaded shadow map splits and light matrices from a camera frustum.
+//
+// All cascades share one light orientation (a rotation looking down the light
+// direction), so a caster is transformed into light space once and then tested
+// against every cascade's box in the same pass.  Each cascade is fitted to the
+// bounding sphere of its frustum slice, which keeps the projection size constant
+// while the camera rotates, and its origin is snapped to whole shadow map texels
+// so the shadow edges do not shimmer while the camera moves.
+class ShadowCascades
+{
+public:
+	static const int MaxCascades = 4;
+
+	struct Cascade
+	{
+		// View space depth range covered by this cascade.
+		float SplitNear = 0.0f;
+		float SplitFar = 0.0f;
+
+		DirectX::XMFLOAT4X4 LightView = MathUtils::Identity4x4();
+		DirectX::XMFLOAT4X4 LightProj = MathUtils::Identity4x4();
+
+		// LightView * LightProj * NDC->texture space, ready for the shader.
+		DirectX::XMFLOAT4X4 ShadowTransform = MathUtils::Identity4x4();
+
+		// Light space box of the orthographic volume, used for caster culling.
+		DirectX::XMFLOAT3 LightSpaceMin = { 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT3 LightSpaceMax = { 0.0f, 0.0f, 0.0f };
+	};
+
+	ShadowCascades();
+
+	// cascadeCount in [1, MaxCascades].  lambda blends between uniform (0) and
+	// logarithmic (1) split distances.  maxShadowDistance clamps the far plane
+	// used for splitting; 0 means use the camera far plane.
+	void SetCascadeCount(int cascadeCount);
+	void SetSplitLambda(float lambda);
+	void SetShadowMapSize(std::uint32_t size);
+	void SetMaxShadowDistance(float distance);
+
+	// Distance casters may sit in front of a cascade (towards the light) and still
+	// be rendered into it.
+	void SetCasterDepthExtent(float extent);
+
+	int GetCascadeCount()const;
+	const Cascade& GetCascade(int i)const;
+
+	// Recomputes every cascade for the camera's current view.  The camera view
+	// matrix must be up to date (UpdateViewMatrix() called).
+	void Update(const CameraComponent& camera, const DirectX::XMFLOAT3& lightDirW);
+
+	// Writes, for every caster bounding sphere, a bit mask of the cascades it
+	// overlaps (bit i set for cascade i).  Casters with a zero mask can be skipped.
+	void CullCasters(const DirectX::BoundingSphere* casters, std::size_t casterCount,
+		std::uint8_t* outCascadeMasks)const;
+
+	// Practical split scheme (Zhang et al.): writes cascadeCount + 1 distances,
+	// from zn to zf inclusive.
+	static void ComputeSplits(float zn, float zf, int cascadeCount, float lambda, float* outSplits);
+
+private:
+	int mCascadeCount = 4;
+	float mSplitLambda = 0.75f;
+	std::uint32_t mShadowMapSize = 2048;
+	float mMaxShadowDistance = 0.0f;
+	float mCasterDepthExtent = 100.0f;
+
+	DirectX::XMFLOAT4X4 mLightRotation = MathUtils::Identity4x4();
+
+	Cascade mCascades[MaxCascades];
+};
@@ -0,0 +1,321 @@
+#include "Test.h"
+#include "../src/core/MpscQueue.h"
+#include "../src/resources/AsyncTextureLoader.h"
+#include "../src/resources/DdsWriter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// A scratch directory of DDS files, removed again when the test ends.
+	class TempFiles
+	{
+	public:
+		TempFiles()
+		: mDirectory(std::filesystem::temp_directory_path() / "DirectX12LabTests_AsyncTextureLoader")
+		{
+			std::filesystem::remove_all(mDirectory);
+			std::filesystem::create_directories(mDirectory);
+		}
+
+		~TempFiles()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(mDirectory, error);
+		}
+
+		// size x size RGBA8, one mip: size * size * 4 bytes of pixel data.
+		std::string WriteTexture(const char* name, size_t size)
+		{
+			MipChain chain;
+			chain.Reset(DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1);
+			const std::filesystem::path path = mDirectory / name;
+			CHECK(DdsWriter::WriteFile(chain, path.wstring()));
+			return path.string();
+		}
+
+		std::string WriteGarbage(const char* name)
+		{
+			const std::filesystem::path path = mDirectory / name;
+			std::ofstream file(path, std::ios::binary);
+			file << "not a DDS file, just some bytes that are long enough to be read";
+			return path.string();
+		}
+
+		std::string GetMissing(const char* name)const
+		{
+			return (mDirectory / name).string();
+		}
+
+	private:
+		std::filesystem::path mDirectory;
+	};
+
+	// Records every texture it sees.  Upload() answers from a script keyed by
+	// request id: a number of Busy answers first, or Failed.
+	class MockTarget : public ITextureUploadTarget
+	{
+	public:
+		TextureUploadResult Upload(const LoadedTexture& texture) override
+		{
+			++Offers[texture.RequestId];
+			if(FailIds.count(texture.RequestId) != 0)
+				return TextureUpload_Failed;
+
+			int& busy = BusyCounts[texture.RequestId];
+			if(busy > 0)
+			{
+				--busy;
+				return TextureUpload_Busy;
+			}
+
+			++Uploads[texture.RequestId];
+			UploadOrder.push_back(texture.RequestId);
+			Widths[texture.RequestId] = texture.Image.GetWidth();
+			UserData[texture.RequestId] = texture.UserData;
+			return TextureUpload_Done;
+		}
+
+		void OnLoadFailed(const LoadedTexture& texture) override
+		{
+			++Failures[texture.RequestId];
+			if(texture.FileError != 0)
+				++FileErrors;
+			else if(texture.Result != DdsImage::Result_Ok)
+				++ParseErrors;
+		}
+
+		std::map<std::uint64_t, int> Offers;
+		std::map<std::uint64_t, int> Uploads;
+		std::map<std::uint64_t, int> Failures;
+		std::map<std::uint64_t, int> BusyCounts;
+		std::map<std::uint64_t, size_t> Widths;
+		std::map<std::uint64_t, void*> UserData;
+		std::map<std::uint64_t, bool> FailIds;
+		std::vector<std::uint64_t> UploadOrder;
+		int FileErrors = 0;
+		int ParseErrors = 0;
+	};
+
+	// ProcessCompletions() until count textures were uploaded or nothing moves.
+	void Drain(AsyncTextureLoader& loader, ITextureUploadTarget& target, std::uint64_t count)
+	{
+		loader.WaitIdle();
+		for(int i = 0; i < 1000 && loader.GetStats().Uploaded + loader.GetStats().Failed < count; ++i)
+			loader.ProcessCompletions(target);
+	}
+}
+
+TEST(AsyncTextureLoader_DeliversEachRequestOnce)
+{
+	TempFiles files;
+	const std::string paths[] = {
+		files.WriteTexture("a.dds", 16), files.WriteTexture("b.dds", 32),
+		files.WriteTexture("c.dds", 64), files.WriteTexture("d.dds", 128),
+	};
+	const size_t widths[] = { 16, 32, 64, 128 };
+
+	MockTarget target;
+	std::map<std::uint64_t, int> expectedFile;
+	{
+		AsyncTextureLoader loader(4);
+		for(int i = 0; i < 40; ++i)
+		{
+			const std::uint64_t id = loader.Request(paths[i % 4], reinterpret_cast<void*>((std::uintptr_t)(i + 1)));
+			expectedFile[id] = i % 4;
+		}
+
+		Drain(loader, target, 40);
+
+		const AsyncTextureLoader::Stats stats = loader.GetStats();
+		CHECK(stats.Requested == 40);
+		CHECK(stats.Loaded == 40);
+		CHECK(stats.Uploaded == 40);
+		CHECK(stats.Failed == 0);
+		CHECK(stats.InFlight == 0);
+
+		// Nothing is left to deliver twice.
+		CHECK(loader.ProcessCompletions(target) == 0);
+	}
+
+	CHECK(target.Uploads.size() == 40);
+	for(const auto& upload : target.Uploads)
+	{
+		CHECK(upload.second == 1);
+		CHECK(expectedFile.count(upload.first) == 1);
+		CHECK(target.Widths[upload.first] == widths[expectedFile[upload.first]]);
+		CHECK(target.UserData[upload.first] != nullptr);
+	}
+	CHECK(target.Failures.empty());
+}
+
+TEST(AsyncTextureLoader_BusyTargetIsOfferedTheSameTextureAgain)
+{
+	TempFiles files;
+	const std::string path = files.WriteTexture("busy.dds", 32);
+
+	MockTarget target;
+	AsyncTextureLoader loader(1);
+	const std::uint64_t first = loader.Request(path);
+	const std::uint64_t second = loader.Request(path);
+	target.BusyCounts[first] = 2;
+	loader.WaitIdle();
+
+	// The busy texture blocks the call; nothing behind it jumps the queue.
+	CHECK(loader.ProcessCompletions(target) == 0);
+	CHECK(loader.ProcessCompletions(target) == 0);
+	CHECK(target.Offers[first] == 2);
+	CHECK(target.Offers[second] == 0);
+
+	CHECK(loader.ProcessCompletions(target) == 2);
+	CHECK(target.Offers[first] == 3);
+	CHECK(target.Uploads[first] == 1);
+	CHECK(target.Uploads[second] == 1);
+	CHECK(target.UploadOrder.size() == 2 && target.UploadOrder[0] == first);
+	CHECK(loader.GetStats().Failed == 0);
+}
+
+TEST(AsyncTextureLoader_ReportsFailures)
+{
+	TempFiles files;
+	const std::string good = files.WriteTexture("good.dds", 16);
+	const std::string garbage = files.WriteGarbage("garbage.dds");
+	const std::string missing = files.GetMissing("missing.dds");
+
+	MockTarget target;
+	AsyncTextureLoader loader(2);
+	const std::uint64_t missingId = loader.Request(missing);
+	const std::uint64_t garbageId = loader.Request(garbage);
+	const std::uint64_t refusedId = loader.Request(good);
+	const std::uint64_t goodId = loader.Request(good);
+	target.FailIds[refusedId] = true;
+
+	Drain(loader, target, 4);
+
+	CHECK(target.Failures[missingId] == 1);
+	CHECK(target.Failures[garbageId] == 1);
+	CHECK(target.Failures[refusedId] == 1);
+	CHECK(target.Failures.count(goodId) == 0);
+	CHECK(target.FileErrors == 1);
+	CHECK(target.ParseErrors == 1);
+
+	// Files that never parsed are not offered for upload; a refused one only once.
+	CHECK(target.Offers.count(missingId) == 0);
+	CHECK(target.Offers.count(garbageId) == 0);
+	CHECK(target.Offers[refusedId] == 1);
+	CHECK(target.Uploads[goodId] == 1);
+
+	const AsyncTextureLoader::Stats stats = loader.GetStats();
+	CHECK(stats.Failed == 3);
+	CHECK(stats.Uploaded == 1);
+	CHECK(stats.Loaded == 4);
+}
+
+TEST(AsyncTextureLoader_CapsBytesPerCall)
+{
+	TempFiles files;
+	const std::string path = files.WriteTexture("64.dds", 64); // 16384 bytes
+
+	MockTarget target;
+	AsyncTextureLoader loader(2);
+	for(int i = 0; i < 8; ++i)
+		loader.Request(path);
+	loader.WaitIdle();
+
+	// Stops once the cap is reached: 16384 < 20000, 32768 is not.
+	CHECK(loader.ProcessCompletions(target, 20000) == 2);
+
+	// At least one texture per call, however small the cap.
+	CHECK(loader.ProcessCompletions(target, 1) == 1);
+
+	// An exact multiple stops right at the cap.
+	CHECK(loader.ProcessCompletions(target, 3 * 16384) == 3);
+
+	CHECK(loader.ProcessCompletions(target) == 2);
+	CHECK(loader.ProcessCompletions(target) == 0);
+	CHECK(target.Uploads.size() == 8);
+}
+
+TEST(AsyncTextureLoader_WaitIdle)
+{
+	TempFiles files;
+	const std::string path = files.WriteTexture("idle.dds", 128);
+
+	AsyncTextureLoader loader(3);
+	loader.WaitIdle(); // nothing requested: returns at once
+
+	for(int i = 0; i < 64; ++i)
+		loader.Request(path);
+	loader.WaitIdle();
+
+	const AsyncTextureLoader::Stats stats = loader.GetStats();
+	CHECK(stats.InFlight == 0);
+	CHECK(stats.Loaded == 64);
+	CHECK(stats.Requested == 64);
+	CHECK(stats.Uploaded == 0);
+}
+
+namespace
+{
+	struct Item : public MpscNode
+	{
+		int Producer = 0;
+		int Sequence = 0;
+	};
+}
+
+TEST(MpscQueue_KeepsEachProducersOrder)
+{
+	const int producers = 4;
+	const int perProducer = 20000;
+
+	std::vector<Item> items((size_t)producers * perProducer);
+	MpscQueue<Item> queue;
+
+	std::vector<std::thread> threads;
+	for(int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&items, &queue, p]()
+		{
+			for(int i = 0; i < perProducer; ++i)
+			{
+				Item& item = items[(size_t)p * perProducer + i];
+				item.Producer = p;
+				item.Sequence = i;
+				queue.Push(&item);
+			}
+		});
+	}
+
+	// Consume while the producers are still pushing.
+	std::vector<int> next(producers, 0);
+	int received = 0;
+	bool ordered = true;
+	while(received < producers * perProducer)
+	{
+		Item* item = queue.Pop();
+		if(item == nullptr)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if(item->Sequence != next[item->Producer])
+			ordered = false;
+		next[item->Producer] = item->Sequence + 1;
+		++received;
+	}
+
+	for(std::thread& thread : threads)
+		thread.join();
+
+	CHECK(ordered);
+	CHECK(queue.Pop() == nullptr);
+	for(int p = 0; p < producers; ++p)
+		CHECK(next[p] == perProducer);
+}
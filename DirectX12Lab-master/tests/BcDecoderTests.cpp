@@ -0,0 +1,335 @@
+#include "Test.h"
+#include "../src/resources/BcDecoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Expected values follow the D3D block-compression rules (BC1-BC5 palettes with
+// integer rounding, BC7 per the format spec), computed by hand.
+namespace
+{
+	// Writes BC7 fields LSB first, as the format lays them out.
+	struct BitWriter
+	{
+		std::uint8_t Bytes[16] = {};
+		unsigned Position = 0;
+
+		void Write(std::uint32_t value, unsigned bits)
+		{
+			for(unsigned i = 0; i < bits; ++i, ++Position)
+			{
+				if((value >> i) & 1)
+					Bytes[Position >> 3] |= (std::uint8_t)(1 << (Position & 7));
+			}
+		}
+	};
+
+	// BC4 block: endpoints red0/red1 and a 3-bit index per pixel.
+	void MakeBc4Block(std::uint8_t red0, std::uint8_t red1, const unsigned (&indices)[16], std::uint8_t* block)
+	{
+		std::uint64_t bits = 0;
+		for(int i = 0; i < 16; ++i)
+			bits |= (std::uint64_t)indices[i] << (3 * i);
+
+		block[0] = red0;
+		block[1] = red1;
+		for(int i = 0; i < 6; ++i)
+			block[2 + i] = (std::uint8_t)(bits >> (8 * i));
+	}
+
+	const DXGI_FORMAT DecodedFormats[] =
+	{
+		DXGI_FORMAT_BC1_UNORM,
+		DXGI_FORMAT_BC2_UNORM,
+		DXGI_FORMAT_BC3_UNORM,
+		DXGI_FORMAT_BC4_UNORM,
+		DXGI_FORMAT_BC5_UNORM,
+		DXGI_FORMAT_BC7_UNORM,
+	};
+
+	const char* GetFormatName(DXGI_FORMAT format)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_UNORM: return "BC1";
+		case DXGI_FORMAT_BC2_UNORM: return "BC2";
+		case DXGI_FORMAT_BC3_UNORM: return "BC3";
+		case DXGI_FORMAT_BC4_UNORM: return "BC4";
+		case DXGI_FORMAT_BC5_UNORM: return "BC5";
+		case DXGI_FORMAT_BC7_UNORM: return "BC7";
+		default:                    return "?";
+		}
+	}
+
+	std::vector<std::uint8_t> MakeRandomBlocks(DXGI_FORMAT format, size_t width, size_t height, std::mt19937& rng)
+	{
+		std::vector<std::uint8_t> blocks(((width + 3) / 4) * ((height + 3) / 4) * BcDecoder::GetBlockSize(format));
+		for(std::uint8_t& value : blocks)
+			value = (std::uint8_t)rng();
+		return blocks;
+	}
+}
+
+TEST(BcDecoder_Bc1FourColour)
+{
+	// c0 = pure red (0xF800) > c1 = pure blue (0x001F); pixels 0-3 use indices 0-3.
+	const std::uint8_t block[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC1(block, out, 16);
+
+	const std::uint8_t expected[4][4] =
+	{
+		{ 255, 0, 0, 255 },
+		{ 0, 0, 255, 255 },
+		{ 170, 0, 85, 255 }, // (2 * c0 + c1) / 3
+		{ 85, 0, 170, 255 }, // (c0 + 2 * c1) / 3
+	};
+	for(int row = 0; row < 4; ++row)
+		for(int x = 0; x < 4; ++x)
+			CHECK(std::memcmp(out + row * 16 + x * 4, expected[x], 4) == 0);
+}
+
+TEST(BcDecoder_Bc1ThreeColour)
+{
+	// c0 <= c1: index 2 is the average, index 3 transparent black.
+	const std::uint8_t block[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0x00, 0x00, 0x00 };
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC1(block, out, 16);
+
+	const std::uint8_t average[4] = { 128, 0, 128, 255 };
+	const std::uint8_t transparent[4] = { 0, 0, 0, 0 };
+	CHECK(std::memcmp(out + 8, average, 4) == 0);
+	CHECK(std::memcmp(out + 12, transparent, 4) == 0);
+}
+
+TEST(BcDecoder_Bc2Alpha)
+{
+	// Explicit 4-bit alpha, expanded by replication; colour black.
+	std::uint8_t block[16] = {};
+	block[0] = 0xF0;
+	block[1] = 0x5A;
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC2(block, out, 16);
+
+	CHECK(out[3] == 0);
+	CHECK(out[7] == 255);
+	CHECK(out[11] == 0xAA);
+	CHECK(out[15] == 0x55);
+	CHECK(out[19] == 0);
+}
+
+TEST(BcDecoder_Bc4Palettes)
+{
+	const unsigned indices[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 0, 0, 0, 0, 0, 0, 0 };
+	std::uint8_t block[8];
+	std::uint8_t out[16];
+
+	// red0 > red1: eight interpolated values.
+	MakeBc4Block(255, 0, indices, block);
+	BcDecoder::DecodeBlockBC4(block, out, 4);
+	const std::uint8_t eight[8] = { 255, 0, 219, 182, 146, 109, 73, 36 };
+	CHECK(std::memcmp(out, eight, 8) == 0);
+
+	// red0 <= red1: six interpolated values plus 0 and 255.
+	MakeBc4Block(0, 255, indices, block);
+	BcDecoder::DecodeBlockBC4(block, out, 4);
+	const std::uint8_t six[8] = { 0, 255, 51, 102, 153, 204, 0, 255 };
+	CHECK(std::memcmp(out, six, 8) == 0);
+}
+
+TEST(BcDecoder_Bc3AndBc5UseBc4Channels)
+{
+	const unsigned indices[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+	std::uint8_t bc3[16] = {};
+	MakeBc4Block(255, 0, indices, bc3);
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC3(bc3, out, 16);
+	CHECK(out[3] == 255 && out[7] == 0 && out[11] == 219);
+
+	std::uint8_t bc5[16];
+	MakeBc4Block(255, 0, indices, bc5);
+	MakeBc4Block(0, 255, indices, bc5 + 8);
+	BcDecoder::DecodeBlockBC5(bc5, out, 8);
+	CHECK(out[0] == 255 && out[1] == 0);
+	CHECK(out[4] == 219 && out[5] == 51);
+}
+
+TEST(BcDecoder_Bc7Mode6)
+{
+	// Endpoints 255 and 0 in every channel; pixel i uses 4-bit index i.
+	BitWriter bits;
+	bits.Write(1 << 6, 7);
+	for(int channel = 0; channel < 4; ++channel)
+	{
+		bits.Write(127, 7);
+		bits.Write(0, 7);
+	}
+	bits.Write(1, 1); // p-bits
+	bits.Write(0, 1);
+	bits.Write(0, 3); // anchor index
+	for(unsigned i = 1; i < 16; ++i)
+		bits.Write(i, 4);
+	CHECK(bits.Position == 128);
+
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC7(bits.Bytes, out, 16);
+
+	const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	for(int i = 0; i < 16; ++i)
+	{
+		const int expected = ((64 - weights[i]) * 255 + 32) >> 6;
+		CHECK(out[i * 4] == expected && out[i * 4 + 3] == expected);
+	}
+}
+
+TEST(BcDecoder_Bc7Mode5Rotation)
+{
+	// Rotation 1 swaps alpha and red: red endpoints 127 (-> 255), alpha 10.
+	BitWriter bits;
+	bits.Write(1 << 5, 6);
+	bits.Write(1, 2);
+	for(int channel = 0; channel < 3; ++channel)
+	{
+		bits.Write(channel == 0 ? 127 : 0, 7);
+		bits.Write(channel == 0 ? 127 : 0, 7);
+	}
+	bits.Write(10, 8);
+	bits.Write(10, 8);
+	for(int i = 0; i < 16; ++i)
+		bits.Write(0, i == 0 ? 1 : 2);
+	for(int i = 0; i < 16; ++i)
+		bits.Write(0, i == 0 ? 1 : 2);
+	CHECK(bits.Position == 128);
+
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC7(bits.Bytes, out, 16);
+	CHECK(out[0] == 10 && out[1] == 0 && out[3] == 255);
+}
+
+TEST(BcDecoder_Bc7Mode1Partition)
+{
+	// Partition 13 puts the top two rows in subset 0 (black) and the bottom two in
+	// subset 1 (white); subset 1's anchor is pixel 15.
+	BitWriter bits;
+	bits.Write(1 << 1, 2);
+	bits.Write(13, 6);
+	for(int channel = 0; channel < 3; ++channel)
+	{
+		bits.Write(0, 6);
+		bits.Write(0, 6);
+		bits.Write(63, 6);
+		bits.Write(63, 6);
+	}
+	bits.Write(0, 1); // shared p-bits
+	bits.Write(1, 1);
+	for(int i = 0; i < 16; ++i)
+		bits.Write(0, (i == 0 || i == 15) ? 2 : 3);
+	CHECK(bits.Position == 128);
+
+	std::uint8_t out[64];
+	BcDecoder::DecodeBlockBC7(bits.Bytes, out, 16);
+	CHECK(out[0] == 0 && out[3] == 255);
+	CHECK(out[7 * 4] == 0);
+	CHECK(out[8 * 4] == 255 && out[15 * 4 + 2] == 255);
+}
+
+TEST(BcDecoder_Bc7ReservedModeIsZero)
+{
+	std::uint8_t block[16] = {};
+	block[5] = 0xFF;
+	std::uint8_t out[64];
+	std::memset(out, 7, sizeof(out));
+	BcDecoder::DecodeBlockBC7(block, out, 16);
+
+	bool allZero = true;
+	for(std::uint8_t value : out)
+		allZero = allZero && value == 0;
+	CHECK(allZero);
+}
+
+TEST(BcDecoder_UnsupportedFormats)
+{
+	CHECK(!BcDecoder::IsSupported(DXGI_FORMAT_BC6H_UF16));
+	CHECK(BcDecoder::GetBlockSize(DXGI_FORMAT_BC6H_UF16) == 0);
+
+	std::uint8_t block[16] = {};
+	std::uint8_t out[64];
+	CHECK(!BcDecoder::Decode(DXGI_FORMAT_BC6H_UF16, block, 16, 4, 4, out, 16));
+	CHECK(!BcDecoder::Decode(DXGI_FORMAT_R8G8B8A8_UNORM, block, 16, 4, 4, out, 16));
+}
+
+TEST(BcDecoder_SimdAndThreadsMatchScalar)
+{
+	// Random blocks exercise every mode; odd sizes clip the edge blocks, and the
+	// larger surface is split into several ParallelFor bands.
+	std::mt19937 rng(1);
+	const size_t sizes[][2] = { { 37, 23 }, { 520, 301 } };
+
+	for(DXGI_FORMAT format : DecodedFormats)
+	{
+		for(const auto& size : sizes)
+		{
+			const size_t width = size[0];
+			const size_t height = size[1];
+			const size_t pixelSize = BcDecoder::GetOutputPixelSize(format);
+			const size_t srcRowPitch = ((width + 3) / 4) * BcDecoder::GetBlockSize(format);
+			const size_t destRowPitch = width * pixelSize;
+			const std::vector<std::uint8_t> src = MakeRandomBlocks(format, width, height, rng);
+
+			// One guard byte past the last row catches writes outside the surface.
+			std::vector<std::uint8_t> scalar(destRowPitch * height + 1, 0xCD);
+			std::vector<std::uint8_t> simd(scalar);
+
+			BcDecodeOptions options;
+			options.UseSimd = false;
+			options.ThreadCount = 1;
+			CHECK(BcDecoder::Decode(format, src.data(), srcRowPitch, width, height, scalar.data(), destRowPitch, options));
+
+			options.UseSimd = true;
+			options.ThreadCount = 4;
+			CHECK(BcDecoder::Decode(format, src.data(), srcRowPitch, width, height, simd.data(), destRowPitch, options));
+
+			CHECK(scalar == simd);
+			CHECK(scalar.back() == 0xCD);
+		}
+	}
+}
+
+BENCHMARK(BcDecoder_Throughput)
+{
+	const size_t width = 4096;
+	const size_t height = 4096;
+	const int repeats = 3;
+	std::mt19937 rng(1);
+
+	for(DXGI_FORMAT format : DecodedFormats)
+	{
+		const size_t pixelSize = BcDecoder::GetOutputPixelSize(format);
+		const std::vector<std::uint8_t> src = MakeRandomBlocks(format, width, height, rng);
+		std::vector<std::uint8_t> dest(width * height * pixelSize);
+
+		struct Mode { const char* Name; bool UseSimd; unsigned ThreadCount; };
+		const Mode modes[] = { { "scalar", false, 1 }, { "simd", true, 1 }, { "simd, all threads", true, 0 } };
+		for(const Mode& mode : modes)
+		{
+			BcDecodeOptions options;
+			options.UseSimd = mode.UseSimd;
+			options.ThreadCount = mode.ThreadCount;
+
+			const auto start = std::chrono::steady_clock::now();
+			for(int i = 0; i < repeats; ++i)
+			{
+				BcDecoder::Decode(format, src.data(), (width / 4) * BcDecoder::GetBlockSize(format),
+					width, height, dest.data(), width * pixelSize, options);
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			std::printf("  %s %-18s %8.1f MP/s\n", GetFormatName(format), mode.Name,
+				repeats * (double)(width * height) / seconds / 1e6);
+		}
+	}
+}
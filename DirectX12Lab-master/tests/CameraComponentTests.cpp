@@ -0,0 +1,182 @@
+#include "Test.h"
+#include "../src/math/Halton.h"
+#include "../src/scene/CameraComponent.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace DirectX;
+
+namespace
+{
+	bool Near(float a, float b, float epsilon = 1e-5f)
+	{
+		return std::fabs(a - b) <= epsilon;
+	}
+
+	// Counts the elements of a and b that differ by more than epsilon.
+	int CountDifferent(const XMFLOAT4X4& a, const XMFLOAT4X4& b, float epsilon = 1e-5f)
+	{
+		int count = 0;
+		for(int r = 0; r < 4; ++r)
+		{
+			for(int c = 0; c < 4; ++c)
+			{
+				if(!Near(a(r, c), b(r, c), epsilon))
+					++count;
+			}
+		}
+		return count;
+	}
+
+	XMFLOAT4X4 Store(CXMMATRIX m)
+	{
+		XMFLOAT4X4 result;
+		XMStoreFloat4x4(&result, m);
+		return result;
+	}
+
+	void PlaceCamera(CameraComponent& camera)
+	{
+		camera.SetLens(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+		camera.LookAt(XMFLOAT3(0.0f, 2.0f, -10.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+		camera.UpdateViewMatrix();
+	}
+}
+
+TEST(CameraComponent_HaltonSequence)
+{
+	// Radical inverse of 1..6 in base 2 and base 3.
+	const float base2[] = { 1.0f / 2, 1.0f / 4, 3.0f / 4, 1.0f / 8, 5.0f / 8, 3.0f / 8 };
+	const float base3[] = { 1.0f / 3, 2.0f / 3, 1.0f / 9, 4.0f / 9, 7.0f / 9, 2.0f / 9 };
+	for(std::uint32_t i = 0; i < 6; ++i)
+	{
+		CHECK(Near(Halton(i + 1, 2), base2[i]));
+		CHECK(Near(Halton(i + 1, 3), base3[i]));
+	}
+	CHECK(Halton(0, 2) == 0.0f);
+
+	// Frame 0 uses index 1 of the sequence, centred on the pixel.
+	XMFLOAT2 jitter = CameraComponent::ComputeJitterPixels(0, 8);
+	CHECK(Near(jitter.x, 0.0f) && Near(jitter.y, 1.0f / 3 - 0.5f));
+
+	// The cycle repeats after phaseCount frames and stays inside the pixel.
+	for(std::uint64_t frame = 0; frame < 16; ++frame)
+	{
+		XMFLOAT2 a = CameraComponent::ComputeJitterPixels(frame, 8);
+		XMFLOAT2 b = CameraComponent::ComputeJitterPixels(frame + 8, 8);
+		CHECK(a.x == b.x && a.y == b.y);
+		CHECK(a.x >= -0.5f && a.x < 0.5f && a.y >= -0.5f && a.y < 0.5f);
+	}
+}
+
+TEST(CameraComponent_UnjitteredProjection)
+{
+	CameraComponent camera;
+	PlaceCamera(camera);
+
+	const XMFLOAT4X4 lens = Store(XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f));
+
+	// Jitter off: both projections are the plain lens.
+	camera.BeginFrame(1, 1920, 1080);
+	CHECK(CountDifferent(Store(camera.GetProj()), lens) == 0);
+	CHECK(CountDifferent(Store(camera.GetProjUnjittered()), lens) == 0);
+	CHECK(camera.GetJitterPixels().x == 0.0f && camera.GetJitterPixels().y == 0.0f);
+
+	// Jitter on: only the NDC translation terms of GetProj() move.
+	camera.SetJitterEnabled(true, 8);
+	camera.BeginFrame(1, 1920, 1080);
+	const XMFLOAT2 jitter = camera.GetJitterPixels();
+	CHECK(jitter.x != 0.0f && jitter.y != 0.0f);
+
+	const XMFLOAT4X4 proj = Store(camera.GetProj());
+	CHECK(CountDifferent(proj, lens) == 2);
+	CHECK(Near(proj(2, 0) - lens(2, 0), 2.0f * jitter.x / 1920.0f));
+	CHECK(Near(proj(2, 1) - lens(2, 1), -2.0f * jitter.y / 1080.0f));
+	CHECK(CountDifferent(Store(camera.GetProjUnjittered()), lens) == 0);
+
+	// The unjittered view-projection is built from the clean lens.
+	camera.UpdateViewMatrix();
+	const XMFLOAT4X4 expected = Store(XMMatrixMultiply(camera.GetView(), XMLoadFloat4x4(&lens)));
+	CHECK(CountDifferent(camera.GetViewProjUnjittered4x4f(), expected) == 0);
+	CHECK(CountDifferent(camera.GetViewProj4x4f(), expected) != 0);
+
+	// Turning jitter off again restores the lens.
+	camera.SetJitterEnabled(false);
+	CHECK(CountDifferent(Store(camera.GetProj()), lens) == 0);
+}
+
+TEST(CameraComponent_PrevViewProjAfterBeginFrame)
+{
+	CameraComponent camera;
+	PlaceCamera(camera);
+	camera.SetJitterEnabled(true, 8);
+	camera.UpdateViewMatrix();
+	const XMFLOAT4X4 placed = camera.GetViewProjUnjittered4x4f();
+
+	// First frame: no history, so the previous matrix is the current one.
+	camera.BeginFrame(0, 1280, 720);
+	CHECK(CountDifferent(camera.GetPrevViewProj4x4f(), placed) == 0);
+
+	// Moving during the frame changes the current matrix but not the history.
+	camera.Walk(2.0f);
+	camera.RotateY(0.1f);
+	camera.UpdateViewMatrix();
+	const XMFLOAT4X4 frame0 = camera.GetViewProjUnjittered4x4f();
+	CHECK(CountDifferent(frame0, placed) != 0);
+	CHECK(CountDifferent(camera.GetPrevViewProj4x4f(), placed) == 0);
+
+	// The next BeginFrame() keeps what frame 0 ended with, without jitter.
+	camera.BeginFrame(1, 1280, 720);
+	camera.UpdateViewMatrix();
+	CHECK(CountDifferent(camera.GetPrevViewProj4x4f(), frame0) == 0);
+	CHECK(CountDifferent(Store(camera.GetPrevViewProj()), frame0) == 0);
+	CHECK(CountDifferent(camera.GetViewProjUnjittered4x4f(), frame0) == 0);
+	CHECK(CountDifferent(camera.GetViewProj4x4f(), frame0) != 0);
+
+	// A camera that stops moving has zero motion from then on.
+	camera.BeginFrame(2, 1280, 720);
+	camera.UpdateViewMatrix();
+	CHECK(CountDifferent(camera.GetPrevViewProj4x4f(), camera.GetViewProjUnjittered4x4f()) == 0);
+}
+
+BENCHMARK(CameraComponent_StaticVersusMoving)
+{
+	typedef std::chrono::steady_clock BenchClock;
+	const int Frames = 1000000;
+
+	// The per-frame update path: UpdateViewMatrix() and reading the matrices a
+	// frame's constants need.  A static camera should only pay for the dirty checks.
+	CameraComponent still;
+	PlaceCamera(still);
+	const std::uint64_t stillGeneration = still.GetGeneration();
+
+	// Keeps the loop bodies from being optimized away.
+	volatile float sink = 0.0f;
+	BenchClock::time_point start = BenchClock::now();
+	for(int i = 0; i < Frames; ++i)
+	{
+		still.UpdateViewMatrix();
+		sink = still.GetViewProj4x4f()(0, 0) + still.GetInvViewProj4x4f()(3, 3);
+	}
+	const double stillSeconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+	CHECK(still.GetGeneration() == stillGeneration);
+
+	CameraComponent moving;
+	PlaceCamera(moving);
+	const std::uint64_t movingGeneration = moving.GetGeneration();
+
+	start = BenchClock::now();
+	for(int i = 0; i < Frames; ++i)
+	{
+		moving.RotateY(0.001f);
+		moving.UpdateViewMatrix();
+		sink = moving.GetViewProj4x4f()(0, 0) + moving.GetInvViewProj4x4f()(3, 3);
+	}
+	const double movingSeconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+	CHECK(moving.GetGeneration() == movingGeneration + Frames);
+
+	std::printf("  %-18s %8.1f ns per frame\n", "static camera", stillSeconds * 1e9 / Frames);
+	std::printf("  %-18s %8.1f ns per frame\n", "moving camera", movingSeconds * 1e9 / Frames);
+}
@@ -0,0 +1,129 @@
+#include "Test.h"
+#include "../src/graphics/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST(DescriptorAllocator_PersistentBestFit)
+{
+	DescriptorAllocator allocator(64, 0);
+
+	DescriptorAllocator::Range a = allocator.AllocatePersistent(8);
+	DescriptorAllocator::Range b = allocator.AllocatePersistent(4);
+	DescriptorAllocator::Range c = allocator.AllocatePersistent(16);
+	DescriptorAllocator::Range d = allocator.AllocatePersistent(2);
+	DescriptorAllocator::Range e = allocator.AllocatePersistent(34);
+	CHECK(a.Offset == 0 && b.Offset == 8 && c.Offset == 12 && d.Offset == 28 && e.Offset == 30);
+	CHECK(allocator.GetPersistentFreeCount() == 0);
+
+	// Holes of 4 at 8 and 2 at 28: each request takes the smallest one that fits.
+	allocator.FreePersistent(b);
+	allocator.FreePersistent(d);
+	CHECK(allocator.GetPersistentFreeBlockCount() == 2);
+
+	CHECK(allocator.AllocatePersistent(2).Offset == 28);
+	CHECK(allocator.AllocatePersistent(3).Offset == 8);
+	CHECK(allocator.GetPersistentFreeCount() == 1); // the remainder at 11
+	CHECK(!allocator.AllocatePersistent(2).IsValid());
+
+	CHECK(!allocator.AllocatePersistent(0).IsValid());
+	CHECK(!allocator.AllocatePersistent(65).IsValid());
+}
+
+TEST(DescriptorAllocator_FreeCoalesces)
+{
+	DescriptorAllocator allocator(100, 0);
+
+	std::vector<DescriptorAllocator::Range> ranges;
+	for(int i = 0; i < 10; ++i)
+		ranges.push_back(allocator.AllocatePersistent(10));
+	CHECK(allocator.GetPersistentFreeCount() == 0);
+	CHECK(!allocator.AllocatePersistent(1).IsValid());
+
+	// Every other range: five separate holes, none large enough for 20.
+	for(int i = 0; i < 10; i += 2)
+		allocator.FreePersistent(ranges[i]);
+	CHECK(allocator.GetPersistentFreeBlockCount() == 5);
+	CHECK(allocator.GetLargestPersistentFreeBlock() == 10);
+	CHECK(!allocator.AllocatePersistent(20).IsValid());
+
+	// Freeing the ones in between merges with both neighbours each time.
+	for(int i = 1; i < 10; i += 2)
+		allocator.FreePersistent(ranges[i]);
+	CHECK(allocator.GetPersistentFreeBlockCount() == 1);
+	CHECK(allocator.GetLargestPersistentFreeBlock() == 100);
+	CHECK(allocator.AllocatePersistent(100).Offset == 0);
+}
+
+TEST(DescriptorAllocator_RandomPersistentFreesBackToOneBlock)
+{
+	DescriptorAllocator allocator(4096, 0);
+	std::mt19937 random(5);
+	std::vector<DescriptorAllocator::Range> live;
+
+	for(int step = 0; step < 5000; ++step)
+	{
+		if(live.empty() || random() % 2 == 0)
+		{
+			DescriptorAllocator::Range range = allocator.AllocatePersistent(1 + random() % 32);
+			if(range.IsValid())
+				live.push_back(range);
+		}
+		else
+		{
+			const size_t index = random() % live.size();
+			allocator.FreePersistent(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	// No two live ranges overlap.
+	std::sort(live.begin(), live.end(), [](const DescriptorAllocator::Range& a, const DescriptorAllocator::Range& b)
+		{ return a.Offset < b.Offset; });
+	for(size_t i = 1; i < live.size(); ++i)
+		CHECK(live[i - 1].Offset + live[i - 1].Count <= live[i].Offset);
+
+	std::shuffle(live.begin(), live.end(), random);
+	for(const DescriptorAllocator::Range& range : live)
+		allocator.FreePersistent(range);
+
+	CHECK(allocator.GetPersistentFreeCount() == 4096);
+	CHECK(allocator.GetPersistentFreeBlockCount() == 1);
+}
+
+TEST(DescriptorAllocator_TransientRangesRecycleByFence)
+{
+	DescriptorAllocator allocator(16, 64);
+	CHECK(allocator.GetTotalCount() == 80);
+
+	// Transient ranges sit after the persistent region.
+	DescriptorAllocator::Range frame1 = allocator.AllocateTransient(24, 1);
+	DescriptorAllocator::Range frame2 = allocator.AllocateTransient(24, 2);
+	CHECK(frame1.Offset == 16 && frame2.Offset == 40);
+	CHECK(allocator.GetTransientUsedCount() == 48);
+
+	// Frame 3 needs 24: only 16 left at the end and the front is still in use.
+	CHECK(!allocator.AllocateTransient(24, 3).IsValid());
+
+	// Once the GPU passes frame 1 the range wraps to the front of the ring.
+	allocator.Reclaim(1);
+	DescriptorAllocator::Range frame3 = allocator.AllocateTransient(24, 3);
+	CHECK(frame3.IsValid() && frame3.Offset == 16);
+	CHECK(allocator.GetTransientUsedCount() == 24 + 16 + 24); // the skipped tail is charged
+
+	allocator.Reclaim(3);
+	CHECK(allocator.GetTransientUsedCount() == 0);
+
+	// Transient allocations never touch the persistent region.
+	CHECK(allocator.GetPersistentFreeCount() == 16);
+	CHECK(!allocator.AllocateTransient(65, 4).IsValid());
+}
+
+TEST(DescriptorAllocator_NoTransientRegion)
+{
+	DescriptorAllocator allocator(8, 0);
+	CHECK(!allocator.AllocateTransient(1, 1).IsValid());
+	CHECK(allocator.GetTransientUsedCount() == 0);
+}
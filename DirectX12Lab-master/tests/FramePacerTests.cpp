@@ -0,0 +1,197 @@
+#include "Test.h"
+#include "../src/core/FramePacer.h"
+
+#include <cmath>
+
+namespace
+{
+	// One tick per microsecond.  Sleeps advance time by the requested amount plus
+	// Oversleep, the way an OS sleep overshoots; spins jump straight to the deadline.
+	class FakeClock : public IClock
+	{
+	public:
+		std::int64_t Now()const override { return Ticks; }
+		double SecondsPerCount()const override { return 1e-6; }
+		const char* Name()const override { return "Fake"; }
+
+		void SleepFor(double seconds)const override
+		{
+			++SleepCalls;
+			LastSleepTicks = (std::int64_t)std::llround(seconds * 1e6);
+			Ticks += LastSleepTicks + Oversleep;
+		}
+
+		void SpinUntil(std::int64_t tick)const override
+		{
+			++SpinCalls;
+			if(Ticks < tick)
+			{
+				SpunTicks += tick - Ticks;
+				Ticks = tick;
+			}
+		}
+
+		mutable std::int64_t Ticks = 1000000;
+		mutable std::int64_t LastSleepTicks = 0;
+		mutable std::int64_t SpunTicks = 0;
+		mutable int SleepCalls = 0;
+		mutable int SpinCalls = 0;
+		std::int64_t Oversleep = 0;
+	};
+
+	bool Near(double a, double b)
+	{
+		return std::fabs(a - b) < 1e-9;
+	}
+}
+
+TEST(FramePacer_DisabledNeverWaits)
+{
+	FakeClock clock;
+	FramePacer pacer(clock);
+
+	for(int i = 0; i < 4; ++i)
+		pacer.WaitForNextFrame();
+
+	CHECK(clock.Ticks == 1000000);
+	CHECK(clock.SleepCalls == 0);
+	CHECK(clock.SpinCalls == 0);
+}
+
+TEST(FramePacer_SleepsThenSpinsToTheDeadline)
+{
+	FakeClock clock;
+	clock.Oversleep = 500;
+	FramePacer pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+	pacer.SetSpinThreshold(0.002);
+
+	// The first frame runs at once and schedules the next one 10 ms out.
+	const std::int64_t start = clock.Ticks;
+	pacer.WaitForNextFrame();
+	CHECK(clock.Ticks == start);
+
+	// 3 ms of work leaves 7 ms: sleep 5 ms, oversleep by 0.5 ms, spin the last 1.5 ms.
+	clock.Ticks += 3000;
+	pacer.WaitForNextFrame();
+	CHECK(clock.SleepCalls == 1);
+	CHECK(clock.LastSleepTicks == 5000);
+	CHECK(clock.SpunTicks == 1500);
+	CHECK(clock.Ticks == start + 10000);
+
+	// Inside the spin threshold there is no sleep at all.
+	clock.Ticks += 9000;
+	pacer.WaitForNextFrame();
+	CHECK(clock.SleepCalls == 1);
+	CHECK(clock.Ticks == start + 20000);
+}
+
+TEST(FramePacer_OversleepDoesNotDrift)
+{
+	FakeClock clock;
+	clock.Oversleep = 2500;
+	FramePacer pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+
+	const std::int64_t start = clock.Ticks;
+	pacer.WaitForNextFrame();
+
+	// Each sleep lands 0.5 ms past its deadline, but the frames stay on the 10 ms grid.
+	for(int frame = 1; frame <= 10; ++frame)
+	{
+		pacer.WaitForNextFrame();
+		CHECK(clock.Ticks == start + frame * 10000 + 500);
+	}
+}
+
+TEST(FramePacer_ResynchronizesAfterAStall)
+{
+	FakeClock clock;
+	FramePacer pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+
+	const std::int64_t start = clock.Ticks;
+	pacer.WaitForNextFrame();
+
+	// A 55 ms frame: no burst of catch-up frames, the schedule restarts from now.
+	clock.Ticks += 55000;
+	pacer.WaitForNextFrame();
+	CHECK(clock.Ticks == start + 55000);
+
+	pacer.WaitForNextFrame();
+	CHECK(clock.Ticks == start + 65000);
+}
+
+TEST(FramePacer_AccumulatesFixedSteps)
+{
+	FakeClock clock;
+	FramePacer pacer(clock);
+	pacer.SetFixedTimestep(0.01);
+
+	CHECK(pacer.AdvanceSimulation(0.004) == 0);
+	CHECK(Near(pacer.GetInterpolationAlpha(), 0.4));
+
+	// 4 ms carried over plus 21 ms: two steps, 5 ms left.
+	CHECK(pacer.AdvanceSimulation(0.021) == 2);
+	CHECK(Near(pacer.GetInterpolationAlpha(), 0.5));
+
+	CHECK(pacer.AdvanceSimulation(0.005) == 1);
+	CHECK(Near(pacer.GetInterpolationAlpha(), 0.0));
+
+	// Negative or zero frame times add nothing.
+	CHECK(pacer.AdvanceSimulation(-1.0) == 0);
+	CHECK(pacer.AdvanceSimulation(0.0) == 0);
+	CHECK(pacer.GetDroppedStepCount() == 0);
+}
+
+TEST(FramePacer_AlphaStaysBelowOne)
+{
+	FakeClock clock;
+	FramePacer pacer(clock);
+	pacer.SetFixedTimestep(1.0 / 60.0);
+
+	// Variable frame times around 144 Hz, 60 Hz and 30 Hz.
+	const double frames[] = { 1.0 / 144.0, 1.0 / 60.0, 1.0 / 30.0, 0.0123, 0.0004, 0.0311 };
+	int steps = 0;
+	double elapsed = 0.0;
+	for(int i = 0; i < 600; ++i)
+	{
+		const double frame = frames[i % 6];
+		elapsed += frame;
+		steps += pacer.AdvanceSimulation(frame);
+
+		const double alpha = pacer.GetInterpolationAlpha();
+		CHECK(alpha >= 0.0 && alpha < 1.0);
+	}
+
+	// Simulated time never runs ahead of real time nor falls a whole step behind.
+	const double simulated = steps / 60.0;
+	CHECK(simulated <= elapsed + 1e-9);
+	CHECK(elapsed - simulated < 1.0 / 60.0 + 1e-9);
+}
+
+TEST(FramePacer_ClampsCatchUpAfterALongStall)
+{
+	FakeClock clock;
+	FramePacer pacer(clock);
+	pacer.SetFixedTimestep(0.01);
+	pacer.SetMaxCatchUpSteps(5);
+
+	// A 1.234 s stall is 123 steps: run 5, drop 118, keep the 4 ms remainder.
+	CHECK(pacer.AdvanceSimulation(1.234) == 5);
+	CHECK(pacer.GetDroppedStepCount() == 118);
+	CHECK(std::fabs(pacer.GetInterpolationAlpha() - 0.4) < 1e-6);
+
+	// The next normal frame is back to a single step.
+	CHECK(pacer.AdvanceSimulation(0.01) == 1);
+	CHECK(pacer.GetDroppedStepCount() == 118);
+
+	pacer.Reset();
+	CHECK(pacer.GetDroppedStepCount() == 0);
+	CHECK(pacer.GetInterpolationAlpha() == 0.0);
+
+	// The limit never goes below one step per frame.
+	pacer.SetMaxCatchUpSteps(0);
+	CHECK(pacer.AdvanceSimulation(0.05) == 1);
+	CHECK(pacer.GetDroppedStepCount() == 4);
+}
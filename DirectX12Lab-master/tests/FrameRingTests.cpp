@@ -0,0 +1,117 @@
+#include "Test.h"
+#include "../src/graphics/FrameRing.h"
+
+namespace
+{
+	// The GPU as a counter: Complete() finishes work, WaitForValue() finishes
+	// everything up to the value, the way a blocking wait on the real fence ends.
+	class FakeFence : public IGpuFence
+	{
+	public:
+		std::uint64_t GetCompletedValue()const override { return Completed; }
+
+		void WaitForValue(std::uint64_t value) override
+		{
+			++Waits;
+			LastWaitValue = value;
+			if(Completed < value)
+				Completed = value;
+		}
+
+		std::uint64_t Completed = 0;
+		std::uint64_t LastWaitValue = 0;
+		int Waits = 0;
+	};
+}
+
+TEST(FrameRing_CyclesThroughSlots)
+{
+	FrameRing ring(3);
+	FakeFence fence;
+
+	CHECK(ring.GetFrameCount() == 3);
+	CHECK(ring.BeginFrame(fence) == 0);
+	ring.EndFrame(1);
+	CHECK(ring.BeginFrame(fence) == 1);
+	ring.EndFrame(2);
+	CHECK(ring.BeginFrame(fence) == 2);
+	ring.EndFrame(3);
+
+	// The first pass round the ring never waits: no slot has pending work yet.
+	CHECK(fence.Waits == 0);
+	CHECK(ring.GetStallCount() == 0);
+	CHECK(ring.GetFenceValue(0) == 1 && ring.GetFenceValue(1) == 2 && ring.GetFenceValue(2) == 3);
+	CHECK(ring.GetLastFenceValue() == 3);
+}
+
+TEST(FrameRing_DoesNotWaitWhenTheGpuKeepsUp)
+{
+	FrameRing ring(3);
+	FakeFence fence;
+
+	std::uint64_t fenceValue = 0;
+	for(int frame = 0; frame < 30; ++frame)
+	{
+		ring.BeginFrame(fence);
+		ring.EndFrame(++fenceValue);
+
+		// The GPU finishes each frame while the CPU records the next.
+		fence.Completed = fenceValue;
+	}
+
+	CHECK(fence.Waits == 0);
+	CHECK(ring.GetStallCount() == 0);
+}
+
+TEST(FrameRing_WaitsWhenTheCpuIsAFullRingAhead)
+{
+	FrameRing ring(3);
+	FakeFence fence;
+
+	// The GPU completes nothing: three frames are recorded, the fourth must wait
+	// for the first, which used the same slot.
+	std::uint64_t fenceValue = 0;
+	for(int frame = 0; frame < 3; ++frame)
+	{
+		ring.BeginFrame(fence);
+		ring.EndFrame(++fenceValue);
+	}
+	CHECK(fence.Waits == 0);
+
+	CHECK(ring.BeginFrame(fence) == 0);
+	CHECK(fence.Waits == 1);
+	CHECK(fence.LastWaitValue == 1);
+	CHECK(ring.GetStallCount() == 1);
+	ring.EndFrame(++fenceValue);
+
+	// The GPU is now two frames behind: slot 1 (fence 2) is still pending.
+	CHECK(ring.BeginFrame(fence) == 1);
+	CHECK(fence.Waits == 2);
+	CHECK(fence.LastWaitValue == 2);
+	ring.EndFrame(++fenceValue);
+
+	// Once the GPU catches up, slot 2's frame is done and there is no wait.
+	fence.Completed = 3;
+	CHECK(ring.BeginFrame(fence) == 2);
+	CHECK(fence.Waits == 2);
+	CHECK(ring.GetStallCount() == 2);
+	ring.EndFrame(++fenceValue);
+
+	CHECK(ring.GetLastFenceValue() == 6);
+}
+
+TEST(FrameRing_SingleSlotWaitsEveryFrame)
+{
+	FrameRing ring(1);
+	FakeFence fence;
+
+	for(std::uint64_t value = 1; value <= 5; ++value)
+	{
+		CHECK(ring.BeginFrame(fence) == 0);
+		ring.EndFrame(value);
+	}
+
+	// Every frame but the first waited for the one before it.
+	CHECK(ring.GetStallCount() == 4);
+	CHECK(fence.LastWaitValue == 4);
+}
@@ -0,0 +1,158 @@
+#include "Test.h"
+#include "../src/graphics/ObjectConstantPool.h"
+
+#include <vector>
+
+namespace
+{
+	// Stand-in for ObjectConstants: a world matrix, 64 bytes in a 256-byte stride.
+	struct Constants
+	{
+		float World[16] = {};
+	};
+
+	const std::uint32_t Stride = 256;
+	const int FrameCount = 3;
+
+	Constants MakeConstants(float value)
+	{
+		Constants constants;
+		for(float& element : constants.World)
+			element = value;
+		return constants;
+	}
+
+	// One mapped upload buffer per frame resource.
+	struct FrameBuffers
+	{
+		explicit FrameBuffers(std::uint32_t capacity)
+		{
+			for(std::vector<std::uint8_t>& buffer : Buffers)
+				buffer.assign(static_cast<size_t>(capacity) * Stride, 0);
+		}
+
+		const Constants& Get(int frame, std::uint32_t slot)const
+		{
+			return *reinterpret_cast<const Constants*>(&Buffers[frame][static_cast<size_t>(slot) * Stride]);
+		}
+
+		std::vector<std::uint8_t> Buffers[FrameCount];
+	};
+}
+
+TEST(ObjectConstantPool_NothingDirtyCopiesNothing)
+{
+	ObjectConstantPool<Constants> pool(16, Stride, FrameCount);
+	FrameBuffers frames(16);
+
+	CHECK(!pool.IsDirty());
+	ObjectConstantPool<Constants>::FlushStats stats = pool.Flush(frames.Buffers[0].data());
+	CHECK(stats.BytesCopied == 0);
+	CHECK(stats.SlotsCopied == 0);
+	CHECK(stats.CopyCalls == 0);
+
+	// Once every frame has its copy, the pool is clean again.
+	pool.Allocate(MakeConstants(1.0f));
+	for(int frame = 0; frame < FrameCount; ++frame)
+		pool.Flush(frames.Buffers[frame].data());
+
+	CHECK(!pool.IsDirty());
+	stats = pool.Flush(frames.Buffers[0].data());
+	CHECK(stats.BytesCopied == 0 && stats.CopyCalls == 0);
+	CHECK(pool.GetTotalBytesCopied() == FrameCount * sizeof(Constants));
+}
+
+TEST(ObjectConstantPool_OneSlot)
+{
+	ObjectConstantPool<Constants> pool(16, Stride, FrameCount);
+	FrameBuffers frames(16);
+
+	for(int i = 0; i < 8; ++i)
+		pool.Allocate(MakeConstants(0.0f));
+	for(int frame = 0; frame < FrameCount; ++frame)
+		pool.Flush(frames.Buffers[frame].data());
+
+	pool.Set(5, MakeConstants(5.0f));
+	const ObjectConstantPool<Constants>::FlushStats stats = pool.Flush(frames.Buffers[0].data());
+	CHECK(stats.SlotsCopied == 1);
+	CHECK(stats.CopyCalls == 1);
+	CHECK(stats.BytesCopied == sizeof(Constants)); // not the whole 256-byte stride
+	CHECK(frames.Get(0, 5).World[0] == 5.0f);
+	CHECK(frames.Get(0, 4).World[0] == 0.0f);
+	CHECK(frames.Get(0, 6).World[0] == 0.0f);
+}
+
+TEST(ObjectConstantPool_BatchesContiguousRuns)
+{
+	ObjectConstantPool<Constants> pool(32, Stride, FrameCount);
+	FrameBuffers frames(32);
+
+	// Allocation hands out low slots first.
+	for(std::uint32_t i = 0; i < 32; ++i)
+		CHECK(pool.Allocate(MakeConstants(0.0f)) == i);
+	for(int frame = 0; frame < FrameCount; ++frame)
+		pool.Flush(frames.Buffers[frame].data());
+
+	// 3..7 and 20..21 dirty, set out of order and some twice: two runs, two memcpys.
+	const std::uint32_t dirty[] = { 7, 20, 3, 5, 21, 4, 6, 5 };
+	for(std::uint32_t slot : dirty)
+		pool.Set(slot, MakeConstants((float)slot));
+
+	const ObjectConstantPool<Constants>::FlushStats stats = pool.Flush(frames.Buffers[0].data());
+	CHECK(stats.SlotsCopied == 7);
+	CHECK(stats.CopyCalls == 2);
+	CHECK(stats.BytesCopied == (4 * Stride + sizeof(Constants)) + (1 * Stride + sizeof(Constants)));
+
+	for(std::uint32_t slot = 0; slot < 32; ++slot)
+	{
+		const bool isDirty = (slot >= 3 && slot <= 7) || slot == 20 || slot == 21;
+		CHECK(frames.Get(0, slot).World[15] == (isDirty ? (float)slot : 0.0f));
+	}
+
+	// A freed slot in the middle splits the run.
+	pool.Set(10, MakeConstants(10.0f));
+	pool.Set(11, MakeConstants(11.0f));
+	pool.Set(12, MakeConstants(12.0f));
+	pool.Free(11);
+	pool.Flush(frames.Buffers[1].data());
+	// 3..7 and 20..21 still owe frame 1, then 10 and 12 on their own.
+	CHECK(pool.GetLastFlushStats().CopyCalls == 4);
+	CHECK(pool.GetLastFlushStats().SlotsCopied == 9);
+}
+
+TEST(ObjectConstantPool_DirtyForEveryFrameInFlight)
+{
+	ObjectConstantPool<Constants> pool(8, Stride, FrameCount);
+	FrameBuffers frames(8);
+
+	const std::uint32_t slot = pool.Allocate(MakeConstants(1.0f));
+
+	// Each frame resource gets the value exactly once, then the slot is clean.
+	for(int frame = 0; frame < FrameCount; ++frame)
+	{
+		CHECK(pool.IsDirty());
+		CHECK(pool.Flush(frames.Buffers[frame].data()).SlotsCopied == 1);
+		CHECK(frames.Get(frame, slot).World[0] == 1.0f);
+	}
+	CHECK(!pool.IsDirty());
+
+	// A change half way round restarts the count, so the frames that already had
+	// the old value get the new one too.
+	pool.Set(slot, MakeConstants(2.0f));
+	pool.Flush(frames.Buffers[0].data());
+	pool.Set(slot, MakeConstants(3.0f));
+	for(int i = 1; i <= FrameCount; ++i)
+	{
+		const int frame = i % FrameCount;
+		CHECK(pool.Flush(frames.Buffers[frame].data()).SlotsCopied == 1);
+	}
+	CHECK(!pool.IsDirty());
+	for(int frame = 0; frame < FrameCount; ++frame)
+		CHECK(frames.Get(frame, slot).World[0] == 3.0f);
+
+	// A slot freed while dirty is dropped without a copy.
+	pool.Set(slot, MakeConstants(4.0f));
+	pool.Free(slot);
+	CHECK(pool.Flush(frames.Buffers[1].data()).SlotsCopied == 0);
+	CHECK(!pool.IsDirty());
+}
@@ -0,0 +1,191 @@
+#include "Test.h"
+#include "../src/resources/PixelConverter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const char* const ConversionNames[PixelConversion_Count] =
+	{
+		"Rgb24ToRgba8", "B5G6R5ToRgba8", "B5G5R5A1ToRgba8", "B4G4R4A4ToRgba8", "SwapRedBlue",
+		"Bgrx8ToRgba8", "SrgbToLinearHalf", "SrgbToLinearFloat", "HalfToFloat", "FloatToHalf",
+	};
+
+	bool SameBits(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	// Random source pixels.  Float sources get finite values of every magnitude plus
+	// the special cases, instead of raw bits that would be mostly NaN payloads.
+	void FillSource(PixelConversion conversion, std::vector<std::uint8_t>& src, std::mt19937& random)
+	{
+		if(conversion != PixelConversion_FloatToHalf)
+		{
+			for(std::uint8_t& byte : src)
+				byte = (std::uint8_t)random();
+			return;
+		}
+
+		const float specials[] = { 0.0f, -0.0f, 65504.0f, 65520.0f, -1e30f, 6.1e-5f, 5.96e-8f, 2.98e-8f, 1.0f / 3.0f };
+		float* values = reinterpret_cast<float*>(src.data());
+		const size_t count = src.size() / sizeof(float);
+		std::uniform_real_distribution<float> exponent(-30.0f, 20.0f);
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(random() % 8 == 0)
+				values[i] = specials[random() % 9];
+			else
+				values[i] = (random() % 2 ? 1.0f : -1.0f) * std::exp2(exponent(random));
+		}
+	}
+}
+
+TEST(PixelConverter_SimdMatchesScalar)
+{
+	// Odd widths leave a tail after every SIMD step size (4, 8 and 16 pixels).
+	const size_t widths[] = { 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 100, 257 };
+	const size_t height = 3;
+
+	std::mt19937 random(7);
+	PixelConvertOptions scalar;
+	scalar.UseSimd = false;
+	scalar.ThreadCount = 1;
+	PixelConvertOptions simd;
+	simd.ThreadCount = 1;
+
+	for(int c = 0; c < PixelConversion_Count; ++c)
+	{
+		const PixelConversion conversion = (PixelConversion)c;
+		const size_t srcSize = PixelConverter::GetSourcePixelSize(conversion);
+		const size_t destSize = PixelConverter::GetDestPixelSize(conversion);
+
+		for(size_t width : widths)
+		{
+			// Unaligned, padded rows.
+			const size_t srcPitch = width * srcSize + 4;
+			const size_t destPitch = width * destSize + 12;
+			std::vector<std::uint8_t> src(srcPitch * height + 16);
+			FillSource(conversion, src, random);
+
+			std::vector<std::uint8_t> expected(destPitch * height, 0xCD);
+			std::vector<std::uint8_t> actual(destPitch * height, 0xCD);
+			CHECK(PixelConverter::Convert(conversion, src.data() + 4, srcPitch, width, height,
+				expected.data(), destPitch, scalar));
+			CHECK(PixelConverter::Convert(conversion, src.data() + 4, srcPitch, width, height,
+				actual.data(), destPitch, simd));
+
+			// The row padding is compared too: neither path may write past a row.
+			if(expected != actual)
+			{
+				std::printf("  %s, width %zu\n", ConversionNames[c], width);
+				CHECK(expected == actual);
+			}
+		}
+	}
+}
+
+TEST(PixelConverter_AllHalvesToFloat)
+{
+	std::vector<std::uint16_t> halves(65536);
+	for(size_t i = 0; i < halves.size(); ++i)
+		halves[i] = (std::uint16_t)i;
+
+	std::vector<float> scalar(halves.size());
+	std::vector<float> simd(halves.size());
+	PixelConverter::HalfToFloat(halves.data(), scalar.data(), halves.size(), false);
+	PixelConverter::HalfToFloat(halves.data(), simd.data(), halves.size(), true);
+
+	int mismatches = 0;
+	for(size_t i = 0; i < halves.size(); ++i)
+	{
+		if(!SameBits(scalar[i], simd[i]))
+			++mismatches;
+	}
+	CHECK(mismatches == 0);
+
+	// Every half comes back unchanged, NaNs as a NaN of the same sign.
+	std::vector<std::uint16_t> roundTrip(halves.size());
+	PixelConverter::FloatToHalf(simd.data(), roundTrip.data(), halves.size(), true);
+	int changed = 0;
+	for(size_t i = 0; i < halves.size(); ++i)
+	{
+		const bool isNan = (i & 0x7C00u) == 0x7C00u && (i & 0x03FFu) != 0;
+		if(isNan ? (roundTrip[i] & 0x7C00u) != 0x7C00u || (roundTrip[i] & 0x03FFu) == 0 || (roundTrip[i] & 0x8000u) != (i & 0x8000u)
+			: roundTrip[i] != halves[i])
+		{
+			++changed;
+		}
+	}
+	CHECK(changed == 0);
+}
+
+TEST(PixelConverter_FloatToHalfRoundsLikeScalar)
+{
+	// The exact value of every finite half and the points halfway to its neighbour,
+	// where round-to-nearest-even decides, plus one ulp either side of those.
+	std::vector<float> values;
+	for(std::uint32_t h = 0; h < 0x7C00u; ++h)
+	{
+		const float low = PixelConverter::HalfToFloat((std::uint16_t)h);
+		const float high = PixelConverter::HalfToFloat((std::uint16_t)(h + 1));
+		const float middle = low + (high - low) * 0.5f;
+		const float candidates[] = { low, middle, std::nextafter(middle, 0.0f), std::nextafter(middle, 1e9f) };
+		for(float value : candidates)
+		{
+			values.push_back(value);
+			values.push_back(-value);
+		}
+	}
+
+	std::vector<std::uint16_t> scalar(values.size());
+	std::vector<std::uint16_t> simd(values.size());
+	PixelConverter::FloatToHalf(values.data(), scalar.data(), values.size(), false);
+	PixelConverter::FloatToHalf(values.data(), simd.data(), values.size(), true);
+	CHECK(scalar == simd);
+}
+
+BENCHMARK(PixelConverter_Throughput)
+{
+	const size_t width = 2048;
+	const size_t height = 2048;
+
+	std::mt19937 random(3);
+	std::printf("  %-18s %10s %10s %10s   (MP/s)\n", "", "scalar", "simd", "threaded");
+
+	for(int c = 0; c < PixelConversion_Count; ++c)
+	{
+		const PixelConversion conversion = (PixelConversion)c;
+		const size_t srcPitch = width * PixelConverter::GetSourcePixelSize(conversion);
+		const size_t destPitch = width * PixelConverter::GetDestPixelSize(conversion);
+		std::vector<std::uint8_t> src(srcPitch * height);
+		std::vector<std::uint8_t> dest(destPitch * height);
+		FillSource(conversion, src, random);
+
+		PixelConvertOptions modes[3];
+		modes[0].UseSimd = false;
+		modes[0].ThreadCount = 1;
+		modes[1].ThreadCount = 1;
+		modes[2].ThreadCount = 0;
+
+		// Best of three runs of each.
+		double best[3] = {};
+		for(int mode = 0; mode < 3; ++mode)
+		{
+			for(int run = 0; run < 3; ++run)
+			{
+				PixelConvertStats stats;
+				PixelConverter::Convert(conversion, src.data(), srcPitch, width, height, dest.data(), destPitch,
+					modes[mode], &stats);
+				best[mode] = std::max(best[mode], stats.MegapixelsPerSecond);
+			}
+		}
+
+		std::printf("  %-18s %10.1f %10.1f %10.1f\n", ConversionNames[c], best[0], best[1], best[2]);
+	}
+}
@@ -0,0 +1,75 @@
+#include "Test.h"
+#include "../src/core/Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+	// Fewer zones per frame than a thread buffer holds, so nothing is dropped.
+	const int ZonesPerFrame = 4096;
+	const int Frames = 200;
+
+	// Keeps the loop bodies from being optimized away.
+	volatile int gSink = 0;
+
+	std::uint32_t FindCalls(const char* name, std::uint32_t depth)
+	{
+		for(const Profiler::ZoneStats& zone : Profiler::Get().GetLastFrameZones())
+		{
+			if(zone.Name == name && zone.Depth == depth)
+				return zone.Calls;
+		}
+		return 0;
+	}
+}
+
+BENCHMARK(Profiler_ScopeOverhead)
+{
+	typedef std::chrono::steady_clock BenchClock;
+
+	static const char* const FlatZone = "Flat";
+	static const char* const OuterZone = "Outer";
+	static const char* const InnerZone = "Inner";
+
+	Profiler& profiler = Profiler::Get();
+	profiler.EndFrame();
+	const std::uint64_t droppedBefore = profiler.GetDroppedEventCount();
+
+	// Only the zones are timed; EndFrame()'s drain and aggregation are not.
+	double flatSeconds = 0.0;
+	double nestedSeconds = 0.0;
+	for(int frame = 0; frame < Frames; ++frame)
+	{
+		BenchClock::time_point start = BenchClock::now();
+		for(int i = 0; i < ZonesPerFrame; ++i)
+		{
+			PROFILE_SCOPE(FlatZone);
+			gSink = i;
+		}
+		flatSeconds += std::chrono::duration<double>(BenchClock::now() - start).count();
+		profiler.EndFrame();
+		CHECK(FindCalls(FlatZone, 0) == (std::uint32_t)ZonesPerFrame);
+
+		start = BenchClock::now();
+		for(int i = 0; i < ZonesPerFrame / 2; ++i)
+		{
+			PROFILE_SCOPE(OuterZone);
+			{
+				PROFILE_SCOPE(InnerZone);
+				gSink = i;
+			}
+		}
+		nestedSeconds += std::chrono::duration<double>(BenchClock::now() - start).count();
+		profiler.EndFrame();
+		CHECK(FindCalls(InnerZone, 1) == (std::uint32_t)ZonesPerFrame / 2);
+	}
+
+	CHECK(profiler.GetDroppedEventCount() == droppedBefore);
+
+	const double zones = (double)ZonesPerFrame * Frames;
+	std::printf("  clock %s, %.1f ns per read\n", profiler.GetClock().Name(),
+		Clock::MeasureOverheadNs(profiler.GetClock()));
+	std::printf("  flat   %6.1f ns per zone (target < 50)\n", flatSeconds * 1e9 / zones);
+	std::printf("  nested %6.1f ns per zone (target < 50)\n", nestedSeconds * 1e9 / zones);
+}
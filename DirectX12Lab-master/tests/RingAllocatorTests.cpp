@@ -0,0 +1,153 @@
+#include "Test.h"
+#include "../src/graphics/RingAllocator.h"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// An allocation written into the backing buffer with its own byte value.
+	struct Written
+	{
+		std::uint64_t Offset;
+		std::uint64_t Size;
+		std::uint64_t FenceValue;
+		std::uint8_t Value;
+	};
+
+	void Fill(std::vector<std::uint8_t>& buffer, const Written& w)
+	{
+		for(std::uint64_t i = 0; i < w.Size; ++i)
+			buffer[(size_t)(w.Offset + i)] = w.Value;
+	}
+
+	bool Intact(const std::vector<std::uint8_t>& buffer, const Written& w)
+	{
+		for(std::uint64_t i = 0; i < w.Size; ++i)
+		{
+			if(buffer[(size_t)(w.Offset + i)] != w.Value)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(RingAllocator_AlignsOffsets)
+{
+	RingAllocator ring(4096);
+
+	CHECK(ring.Allocate(10, 1, 1) == 0);
+	CHECK(ring.Allocate(16, 256, 1) == 256);  // 10 -> 256, padding charged
+	CHECK(ring.Allocate(1, 16, 1) == 272);
+	CHECK(ring.GetUsedBytes() == 273);
+
+	// Zero-sized and oversized requests are refused.
+	CHECK(ring.Allocate(0, 1, 1) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(4097, 1, 1) == RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocator_FullRingWaitsForTheFence)
+{
+	RingAllocator ring(1024);
+
+	CHECK(ring.Allocate(512, 1, 1) == 0);
+	CHECK(ring.Allocate(512, 1, 2) == 512);
+	CHECK(ring.GetUsedBytes() == 1024);
+	CHECK(ring.Allocate(1, 1, 3) == RingAllocator::InvalidOffset);
+
+	// Nothing is released until its fence value has completed.
+	ring.Reclaim(0);
+	CHECK(ring.GetUsedBytes() == 1024);
+
+	ring.Reclaim(1);
+	CHECK(ring.GetUsedBytes() == 512);
+	CHECK(ring.Allocate(256, 1, 3) == 0);
+
+	ring.Reclaim(3);
+	CHECK(ring.GetUsedBytes() == 0);
+
+	// An empty ring starts over at 0 instead of wrapping.
+	CHECK(ring.Allocate(1024, 1, 4) == 0);
+}
+
+TEST(RingAllocator_WrapsAndChargesTheSkippedTail)
+{
+	RingAllocator ring(1000);
+
+	CHECK(ring.Allocate(400, 1, 1) == 0);
+	CHECK(ring.Allocate(400, 1, 2) == 400);
+	ring.Reclaim(1);
+	CHECK(ring.GetUsedBytes() == 400);
+
+	// 300 bytes do not fit in the 200 left at the end: they go to 0 and the 200
+	// skipped bytes are charged to them.
+	CHECK(ring.Allocate(300, 1, 3) == 0);
+	CHECK(ring.GetUsedBytes() == 400 + 200 + 300);
+
+	// The 100 bytes between the new head and the fence-2 region still fit...
+	CHECK(ring.Allocate(100, 1, 3) == 300);
+	// ...but nothing more until fence 2 completes.
+	CHECK(ring.Allocate(1, 1, 3) == RingAllocator::InvalidOffset);
+
+	// Reclaiming fence 3 frees the skipped tail along with the allocations.
+	ring.Reclaim(2);
+	CHECK(ring.GetUsedBytes() == 600);
+	ring.Reclaim(3);
+	CHECK(ring.GetUsedBytes() == 0);
+}
+
+TEST(RingAllocator_RandomizedNeverOverlaps)
+{
+	const std::uint64_t capacity = 64 * 1024;
+	RingAllocator ring(capacity);
+	std::vector<std::uint8_t> buffer((size_t)capacity, 0);
+
+	std::mt19937 random(42);
+	std::deque<Written> live;
+	std::uint64_t fenceValue = 1;
+	std::uint64_t completed = 0;
+	int allocated = 0;
+
+	for(int step = 0; step < 20000; ++step)
+	{
+		// A few allocations per frame, then the frame's fence is signaled.
+		if(random() % 4 == 0)
+			++fenceValue;
+
+		// The GPU lags a couple of frames behind.
+		if(completed + 2 < fenceValue && random() % 3 == 0)
+		{
+			completed = fenceValue - 2;
+			ring.Reclaim(completed);
+			while(!live.empty() && live.front().FenceValue <= completed)
+				live.pop_front();
+		}
+
+		const std::uint64_t size = 1 + random() % 4096;
+		const std::uint64_t alignment = 1ull << (random() % 9); // 1 to 256
+		const std::uint64_t offset = ring.Allocate(size, alignment, fenceValue);
+		if(offset == RingAllocator::InvalidOffset)
+			continue;
+
+		CHECK(offset % alignment == 0);
+		CHECK(offset + size <= capacity);
+
+		Written w = { offset, size, fenceValue, (std::uint8_t)(1 + allocated % 255) };
+		Fill(buffer, w);
+		live.push_back(w);
+		++allocated;
+
+		// Nothing still in flight was overwritten.
+		if(step % 16 == 0)
+		{
+			for(const Written& other : live)
+				CHECK(Intact(buffer, other));
+		}
+	}
+
+	CHECK(allocated > 10000);
+
+	ring.Reclaim(fenceValue);
+	CHECK(ring.GetUsedBytes() == 0);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+// Minimal test registry for the CPU-only code (no window, no device).
+//
+// TEST(Name) defines a test and BENCHMARK(Name) a benchmark; CHECK(condition)
+// records a failure and carries on.  TestMain.cpp runs every test, or every
+// benchmark with --bench, and fails when any CHECK did.
+struct TestCase
+{
+	const char* Name = nullptr;
+	void (*Function)() = nullptr;
+	bool IsBenchmark = false;
+};
+
+std::vector<TestCase>& GetTestCases();
+
+void ReportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, void (*function)(), bool isBenchmark)
+	{
+		GetTestCases().push_back(TestCase{ name, function, isBenchmark });
+	}
+};
+
+#define TEST_CASE_(name, isBenchmark)                                     \
+	static void name();                                                   \
+	static TestRegistrar name##Registrar(#name, name, isBenchmark);       \
+	static void name()
+
+#define TEST(name) TEST_CASE_(name, false)
+#define BENCHMARK(name) TEST_CASE_(name, true)
+
+#define CHECK(expression)                                                 \
+	do                                                                    \
+	{                                                                     \
+		if(!(expression))                                                 \
+			ReportFailure(__FILE__, __LINE__, #expression);               \
+	} while(0)
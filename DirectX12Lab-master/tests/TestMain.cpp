@@ -0,0 +1,56 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	int gFailures = 0;
+}
+
+std::vector<TestCase>& GetTestCases()
+{
+	// Function-local so registrars in other files can run first.
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+	std::printf("  FAILED %s(%d): %s\n", file, line, expression);
+	++gFailures;
+}
+
+// DirectX12LabTests [--bench] [name]: runs the tests (or the benchmarks) whose
+// name contains name.
+int main(int argc, char** argv)
+{
+	bool benchmarks = false;
+	const char* filter = nullptr;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(std::strcmp(argv[i], "--bench") == 0)
+			benchmarks = true;
+		else
+			filter = argv[i];
+	}
+
+	int run = 0;
+	for(const TestCase& testCase : GetTestCases())
+	{
+		if(testCase.IsBenchmark != benchmarks)
+			continue;
+		if(filter != nullptr && std::strstr(testCase.Name, filter) == nullptr)
+			continue;
+
+		const int failuresBefore = gFailures;
+		std::printf("%s\n", testCase.Name);
+		testCase.Function();
+		if(gFailures != failuresBefore)
+			std::printf("  %d check(s) failed\n", gFailures - failuresBefore);
+		++run;
+	}
+
+	std::printf("%d %s, %d failed check(s)\n", run, benchmarks ? "benchmark(s)" : "test(s)", gFailures);
+	return gFailures == 0 ? 0 : 1;
+}
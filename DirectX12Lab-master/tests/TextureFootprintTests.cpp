@@ -0,0 +1,260 @@
+#include "Test.h"
+#include "../src/resources/TextureFootprint.h"
+
+#include <cstdio>
+#include <vector>
+
+#ifdef _WIN32
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <wrl/client.h>
+#endif
+
+// Expected copy layouts, from subresource 0 at offset 0, worked out by hand from
+// the D3D12 rules: 256-byte row pitch, 512-byte placement, whole 4x4 blocks, one
+// subresource per plane, totals ending at the last row's data.  On Windows,
+// TextureFootprint_MatchesDevice also checks the calculator against a live
+// device's GetCopyableFootprints for these and a sweep of other resources, and
+// prints the device's values for each row below in this table's syntax, ready to
+// be pasted over the hand-derived ones.
+namespace
+{
+	struct ExpectedFootprint
+	{
+		const char* Name;
+		TextureFootprintDesc Desc;
+		uint32_t Subresource;
+		SubresourceFootprint Footprint;
+		uint32_t SubresourceCount; // of Desc, planes included
+		uint64_t TotalBytes;       // all of Desc's subresources
+	};
+
+	const ExpectedFootprint ExpectedFootprints[] =
+	{
+		{ "RGBA8 256x256 mip 0", { FootprintDimension_Texture2D, DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 9 },
+			0, { 0, DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 1024, 256, 1024 }, 9, 359940 },
+		{ "RGBA8 256x256 mip 2", { FootprintDimension_Texture2D, DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 9 },
+			2, { 327680, DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 256, 64, 256 }, 9, 359940 },
+		{ "RGBA8 256x256 mip 3", { FootprintDimension_Texture2D, DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 9 },
+			3, { 344064, DXGI_FORMAT_R8G8B8A8_UNORM, 32, 32, 1, 256, 32, 128 }, 9, 359940 },
+		{ "RGBA8 256x256 mip 8", { FootprintDimension_Texture2D, DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 9 },
+			8, { 359936, DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 256, 1, 4 }, 9, 359940 },
+		{ "RGBA8 100x100", { FootprintDimension_Texture2D, DXGI_FORMAT_R8G8B8A8_UNORM, 100, 100, 1, 1 },
+			0, { 0, DXGI_FORMAT_R8G8B8A8_UNORM, 100, 100, 1, 512, 100, 400 }, 1, 512 * 99 + 400 },
+		{ "BC1 4x4 mip 2", { FootprintDimension_Texture2D, DXGI_FORMAT_BC1_UNORM, 4, 4, 1, 3 },
+			2, { 1024, DXGI_FORMAT_BC1_UNORM, 4, 4, 1, 256, 1, 8 }, 3, 1032 },
+		{ "BC7 1024x512 x6, item 1 mip 0", { FootprintDimension_Texture2D, DXGI_FORMAT_BC7_UNORM, 1024, 512, 6, 0 },
+			11, { 701952, DXGI_FORMAT_BC7_UNORM, 1024, 512, 1, 4096, 128, 4096 }, 66, 701952 * 5 + 701440 + 16 },
+		{ "NV12 64x32 chroma", { FootprintDimension_Texture2D, DXGI_FORMAT_NV12, 64, 32, 1, 1 },
+			1, { 8192, DXGI_FORMAT_R8G8_UNORM, 32, 16, 1, 256, 16, 64 }, 2, 8192 + 256 * 15 + 64 },
+		{ "D32S8 64x64 stencil", { FootprintDimension_Texture2D, DXGI_FORMAT_D32_FLOAT_S8X24_UINT, 64, 64, 1, 1 },
+			1, { 16384, DXGI_FORMAT_R8_TYPELESS, 64, 64, 1, 256, 64, 64 }, 2, 16384 + 256 * 63 + 64 },
+		{ "RGBA16F 32x32x16 mip 1", { FootprintDimension_Texture3D, DXGI_FORMAT_R16G16B16A16_FLOAT, 32, 32, 16, 2 },
+			1, { 131072, DXGI_FORMAT_R16G16B16A16_FLOAT, 16, 16, 8, 256, 16, 128 }, 2, 131072 + 256 * (16 * 8 - 1) + 128 },
+		{ "Buffer 1000", { FootprintDimension_Buffer, DXGI_FORMAT_UNKNOWN, 1000, 1, 1, 1 },
+			0, { 0, DXGI_FORMAT_UNKNOWN, 1000, 1, 1, 1024, 1, 1000 }, 1, 1000 },
+		{ "YUY2 6x2", { FootprintDimension_Texture2D, DXGI_FORMAT_YUY2, 6, 2, 1, 1 },
+			0, { 0, DXGI_FORMAT_YUY2, 6, 2, 1, 256, 2, 12 }, 1, 256 + 12 },
+	};
+
+	bool operator==(const SubresourceFootprint& a, const SubresourceFootprint& b)
+	{
+		return a.Offset == b.Offset && a.Format == b.Format && a.Width == b.Width && a.Height == b.Height &&
+			a.Depth == b.Depth && a.RowPitch == b.RowPitch && a.NumRows == b.NumRows &&
+			a.RowSizeInBytes == b.RowSizeInBytes;
+	}
+
+	void PrintFootprint(const char* label, const SubresourceFootprint& f)
+	{
+		std::printf("    %s: offset %llu format %d %ux%ux%u pitch %u rows %u row size %llu\n", label,
+			(unsigned long long)f.Offset, (int)f.Format, f.Width, f.Height, f.Depth, f.RowPitch, f.NumRows,
+			(unsigned long long)f.RowSizeInBytes);
+	}
+}
+
+TEST(TextureFootprint_MatchesExpectedLayouts)
+{
+	for(const ExpectedFootprint& expected : ExpectedFootprints)
+	{
+		CHECK(TextureFootprint::GetSubresourceCount(expected.Desc) == expected.SubresourceCount);
+
+		std::vector<SubresourceFootprint> footprints(expected.SubresourceCount);
+		uint64_t totalBytes = 0;
+		CHECK(TextureFootprint::Compute(expected.Desc, 0, expected.SubresourceCount, 0, footprints.data(), &totalBytes));
+		CHECK(totalBytes == expected.TotalBytes);
+
+		const SubresourceFootprint& actual = footprints[expected.Subresource];
+		if(!(actual == expected.Footprint))
+		{
+			std::printf("  %s\n", expected.Name);
+			PrintFootprint("expected", expected.Footprint);
+			PrintFootprint("actual", actual);
+			CHECK(actual == expected.Footprint);
+		}
+
+		// One subresource at a time agrees with the whole range.
+		SubresourceFootprint single;
+		const uint64_t previousEnd = expected.Subresource > 0 ? TextureFootprint::GetEnd(footprints[expected.Subresource - 1]) : 0;
+		CHECK(TextureFootprint::Compute(expected.Desc, expected.Subresource, previousEnd, single));
+		CHECK(single == actual);
+	}
+}
+
+TEST(TextureFootprint_RejectsUnknownLayouts)
+{
+	TextureFootprintDesc desc;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.Width = 16;
+	desc.Height = 16;
+	CHECK(!TextureFootprint::IsSupported(desc.Format));
+
+	SubresourceFootprint footprint;
+	CHECK(!TextureFootprint::Compute(desc, 0, 0, footprint));
+
+	desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	CHECK(!TextureFootprint::Compute(desc, 1, 0, footprint)); // only one subresource
+}
+
+#ifdef _WIN32
+namespace
+{
+	D3D12_RESOURCE_DESC MakeResourceDesc(const TextureFootprintDesc& desc)
+	{
+		D3D12_RESOURCE_DESC resourceDesc = {};
+		resourceDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(desc.Dimension);
+		resourceDesc.Width = desc.Width;
+		resourceDesc.Height = desc.Height;
+		resourceDesc.DepthOrArraySize = static_cast<UINT16>(desc.DepthOrArraySize);
+		resourceDesc.MipLevels = static_cast<UINT16>(desc.MipLevels);
+		resourceDesc.Format = desc.Format;
+		resourceDesc.SampleDesc.Count = 1;
+		resourceDesc.Layout = desc.Dimension == FootprintDimension_Buffer ?
+			D3D12_TEXTURE_LAYOUT_ROW_MAJOR : D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		return resourceDesc;
+	}
+
+	// The default adapter, or WARP when there is none.
+	Microsoft::WRL::ComPtr<ID3D12Device> CreateDevice()
+	{
+		Microsoft::WRL::ComPtr<ID3D12Device> device;
+		if(SUCCEEDED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+			return device;
+
+		Microsoft::WRL::ComPtr<IDXGIFactory4> factory;
+		Microsoft::WRL::ComPtr<IDXGIAdapter> warpAdapter;
+		if(SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) &&
+			SUCCEEDED(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter))))
+		{
+			D3D12CreateDevice(warpAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device));
+		}
+		return device;
+	}
+
+	// expected's table row with the footprint and total the device reports.
+	void PrintDeviceRow(ID3D12Device* device, const ExpectedFootprint& expected)
+	{
+		const D3D12_RESOURCE_DESC resourceDesc = MakeResourceDesc(expected.Desc);
+		const uint32_t count = TextureFootprint::GetSubresourceCount(expected.Desc);
+
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(count);
+		std::vector<UINT> numRows(count);
+		std::vector<UINT64> rowSizes(count);
+		UINT64 total = 0;
+		device->GetCopyableFootprints(&resourceDesc, 0, count, 0,
+			layouts.data(), numRows.data(), rowSizes.data(), &total);
+
+		const TextureFootprintDesc& d = expected.Desc;
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& l = layouts[expected.Subresource];
+		std::printf("    { \"%s\", { (FootprintDimension)%d, (DXGI_FORMAT)%d, %llu, %u, %u, %u },\n", expected.Name, (int)d.Dimension, (int)d.Format,
+			(unsigned long long)d.Width, d.Height, d.DepthOrArraySize, d.MipLevels);
+		std::printf("        %u, { %llu, (DXGI_FORMAT)%d, %u, %u, %u, %u, %u, %llu }, %u, %llu },\n", expected.Subresource,
+			(unsigned long long)l.Offset, (int)l.Footprint.Format, l.Footprint.Width, l.Footprint.Height,
+			l.Footprint.Depth, l.Footprint.RowPitch, numRows[expected.Subresource],
+			(unsigned long long)rowSizes[expected.Subresource], count, (unsigned long long)total);
+	}
+
+	// Every subresource of desc, CPU against device.
+	void CheckAgainstDevice(ID3D12Device* device, const char* name, const TextureFootprintDesc& desc)
+	{
+		const D3D12_RESOURCE_DESC resourceDesc = MakeResourceDesc(desc);
+		const uint32_t count = TextureFootprint::GetSubresourceCount(desc);
+
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(count);
+		std::vector<UINT> numRows(count);
+		std::vector<UINT64> rowSizes(count);
+		UINT64 deviceTotal = 0;
+		device->GetCopyableFootprints(&resourceDesc, 0, count, 0,
+			layouts.data(), numRows.data(), rowSizes.data(), &deviceTotal);
+
+		std::vector<SubresourceFootprint> footprints(count);
+		uint64_t totalBytes = 0;
+		CHECK(TextureFootprint::Compute(desc, 0, count, 0, footprints.data(), &totalBytes));
+		CHECK(totalBytes == deviceTotal);
+
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			SubresourceFootprint fromDevice;
+			fromDevice.Offset = layouts[i].Offset;
+			fromDevice.Format = layouts[i].Footprint.Format;
+			fromDevice.Width = layouts[i].Footprint.Width;
+			fromDevice.Height = layouts[i].Footprint.Height;
+			fromDevice.Depth = layouts[i].Footprint.Depth;
+			fromDevice.RowPitch = layouts[i].Footprint.RowPitch;
+			fromDevice.NumRows = numRows[i];
+			fromDevice.RowSizeInBytes = rowSizes[i];
+
+			if(!(footprints[i] == fromDevice))
+			{
+				std::printf("  %s, subresource %u\n", name, i);
+				PrintFootprint("device", fromDevice);
+				PrintFootprint("cpu", footprints[i]);
+				CHECK(footprints[i] == fromDevice);
+				return;
+			}
+		}
+	}
+}
+
+TEST(TextureFootprint_MatchesDevice)
+{
+	Microsoft::WRL::ComPtr<ID3D12Device> device = CreateDevice();
+	CHECK(device != nullptr);
+	if(device == nullptr)
+		return;
+
+	std::printf("  device layouts for ExpectedFootprints:\n");
+	for(const ExpectedFootprint& expected : ExpectedFootprints)
+	{
+		PrintDeviceRow(device.Get(), expected);
+		CheckAgainstDevice(device.Get(), expected.Name, expected.Desc);
+	}
+
+	// A sweep of sizes, odd and even, over formats of every kind.
+	const DXGI_FORMAT formats[] =
+	{
+		DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT,
+		DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_B5G6R5_UNORM,
+		DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM,
+		DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_D24_UNORM_S8_UINT, DXGI_FORMAT_D32_FLOAT_S8X24_UINT,
+		DXGI_FORMAT_NV12, DXGI_FORMAT_P010, DXGI_FORMAT_YUY2,
+	};
+	const uint32_t sizes[][2] = { { 4, 4 }, { 64, 64 }, { 96, 40 }, { 1024, 8 }, { 200, 300 } };
+
+	for(DXGI_FORMAT format : formats)
+	{
+		for(const auto& size : sizes)
+		{
+			TextureFootprintDesc desc;
+			desc.Format = format;
+			desc.Width = size[0];
+			desc.Height = size[1];
+			desc.DepthOrArraySize = 3;
+			desc.MipLevels = 0;
+
+			char name[64];
+			std::snprintf(name, sizeof(name), "format %d %ux%u x3", (int)format, size[0], size[1]);
+			CheckAgainstDevice(device.Get(), name, desc);
+		}
+	}
+}
+#endif
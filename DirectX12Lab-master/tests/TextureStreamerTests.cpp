@@ -0,0 +1,357 @@
+#include "Test.h"
+#include "../src/resources/DdsWriter.h"
+#include "../src/resources/TextureStreamer.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+// RGBA8 256x256 with a full chain: mip 0 is 262144 bytes, mip 1 65536, and mips
+// 2-8 (64x64 and smaller) are the 21844-byte tail at the default TailSize of 64.
+namespace
+{
+	const std::uint64_t TailBytes = 16384 + 4096 + 1024 + 256 + 64 + 16 + 4;
+	const std::uint64_t Mip1Bytes = 65536 + TailBytes;
+	const std::uint64_t FullBytes = 262144 + Mip1Bytes;
+
+	// A parsed in-memory DDS; the image points into File, so it is never moved.
+	struct TestTexture
+	{
+		explicit TestTexture(size_t size = 256)
+		{
+			MipChain chain;
+			size_t mips = 1;
+			for(size_t s = size; s > 1; s /= 2)
+				++mips;
+			chain.Reset(DXGI_FORMAT_R8G8B8A8_UNORM, size, size, mips, 1);
+			DdsWriter::Write(chain, File);
+			Parsed = Image.Parse(File.data(), File.size()) == DdsImage::Result_Ok;
+		}
+
+		std::vector<std::uint8_t> File;
+		DdsImage Image;
+		bool Parsed = false;
+	};
+
+	// Tracks what it has been asked to keep resident and checks the streamer's
+	// side of the contract.  Loads and evictions can be made to stall or fail.
+	class FakeSink : public IMipUploadSink
+	{
+	public:
+		MipLoadResult LoadMips(StreamTextureId id, const DdsImage& image,
+			std::uint32_t firstMip, std::uint32_t previousFirstMip) override
+		{
+			const std::uint32_t mipCount = (std::uint32_t)image.GetMipCount();
+			const std::uint32_t resident = Resident.count(id) != 0 ? Resident[id] : mipCount;
+			if(previousFirstMip != resident || firstMip >= resident)
+				++ContractViolations;
+
+			Loads.push_back({ id, firstMip });
+			if(Busy)
+				return MipLoad_Busy;
+			if(firstMip < FailBelowMip)
+				return MipLoad_Failed;
+
+			Resident[id] = firstMip;
+			return MipLoad_Done;
+		}
+
+		bool EvictMips(StreamTextureId id, const DdsImage& image, std::uint32_t firstMip) override
+		{
+			(void)image;
+			if(Resident.count(id) == 0 || firstMip <= Resident[id])
+				++ContractViolations;
+			if(RefuseEvictions.count(id) != 0)
+			{
+				++RefusedEvictions;
+				return false;
+			}
+
+			Evictions.push_back({ id, firstMip });
+			Resident[id] = firstMip;
+			return true;
+		}
+
+		void Release(StreamTextureId id) override
+		{
+			Resident.erase(id);
+			++Releases;
+		}
+
+		struct Call
+		{
+			StreamTextureId Id;
+			std::uint32_t FirstMip;
+		};
+
+		std::map<StreamTextureId, std::uint32_t> Resident;
+		std::vector<Call> Loads;
+		std::vector<Call> Evictions;
+		std::set<StreamTextureId> RefuseEvictions;
+		bool Busy = false;
+		std::uint32_t FailBelowMip = 0;
+		int RefusedEvictions = 0;
+		int Releases = 0;
+		int ContractViolations = 0;
+	};
+
+	TextureStreamer::Config MakeConfig(std::uint64_t budget)
+	{
+		TextureStreamer::Config config;
+		config.BudgetBytes = budget;
+		return config;
+	}
+}
+
+TEST(TextureStreamer_LoadsTheTailOnRegister)
+{
+	TestTexture texture;
+	CHECK(texture.Parsed);
+
+	FakeSink sink;
+	{
+		TextureStreamer streamer(sink, MakeConfig(1 << 20));
+		const StreamTextureId id = streamer.Register(texture.Image);
+
+		CHECK(streamer.GetTailMip(id) == 2);
+		CHECK(streamer.GetResidentMip(id) == 2);
+		CHECK(sink.Loads.size() == 1 && sink.Loads[0].FirstMip == 2);
+		CHECK(streamer.GetResidentBytes(id) == TailBytes);
+		CHECK(streamer.GetStats().ResidentBytes == TailBytes);
+
+		// Nothing requested: nothing more is loaded.
+		streamer.Update(0);
+		CHECK(sink.Loads.size() == 1);
+
+		streamer.Unregister(id);
+		CHECK(sink.Releases == 1);
+		CHECK(streamer.GetStats().ResidentBytes == 0);
+	}
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_StreamsToTheRequestedMip)
+{
+	TestTexture texture;
+	FakeSink sink;
+	TextureStreamer streamer(sink, MakeConfig(1 << 20));
+	const StreamTextureId id = streamer.Register(texture.Image);
+
+	// 100 texels on screen: mip 1 (128 across) is enough.
+	streamer.RequestResolution(id, 100.0f);
+	streamer.Update(0);
+	CHECK(streamer.GetDesiredMip(id) == 1);
+	CHECK(streamer.GetResidentMip(id) == 1);
+	CHECK(streamer.GetStats().UploadedBytes == Mip1Bytes - TailBytes);
+
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(1);
+	CHECK(streamer.GetResidentMip(id) == 0);
+	CHECK(streamer.GetStats().ResidentBytes == FullBytes);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_StaysWithinBudget)
+{
+	TestTexture textures[4];
+	FakeSink sink;
+
+	// Room for the four tails, one full chain and one mip 1.
+	const std::uint64_t budget = 4 * TailBytes + (FullBytes - TailBytes) + (Mip1Bytes - TailBytes);
+	TextureStreamer streamer(sink, MakeConfig(budget));
+
+	StreamTextureId ids[4];
+	for(int i = 0; i < 4; ++i)
+		ids[i] = streamer.Register(textures[i].Image);
+
+	for(std::uint64_t frame = 0; frame < 20; ++frame)
+	{
+		for(int i = 0; i < 4; ++i)
+			streamer.RequestResolution(ids[i], 256.0f);
+		streamer.Update(frame);
+
+		CHECK(streamer.GetStats().ResidentBytes <= budget);
+
+		std::uint64_t sum = 0;
+		for(int i = 0; i < 4; ++i)
+			sum += streamer.GetResidentBytes(ids[i]);
+		CHECK(sum == streamer.GetStats().ResidentBytes);
+	}
+
+	CHECK(streamer.GetStats().BudgetStalls > 0);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_EvictsLeastRecentlyRequestedFirst)
+{
+	TestTexture a, b, c;
+	FakeSink sink;
+
+	// Two full chains and a tail fit; three full chains do not.
+	const std::uint64_t budget = 2 * FullBytes + TailBytes;
+	TextureStreamer streamer(sink, MakeConfig(budget));
+	const StreamTextureId idA = streamer.Register(a.Image);
+	const StreamTextureId idB = streamer.Register(b.Image);
+	const StreamTextureId idC = streamer.Register(c.Image);
+
+	streamer.RequestResolution(idA, 256.0f);
+	streamer.RequestResolution(idB, 256.0f);
+	streamer.Update(0);
+	CHECK(streamer.GetResidentMip(idA) == 0 && streamer.GetResidentMip(idB) == 0);
+
+	// A, then B, zoom out: their fine mips become surplus but still fit.
+	streamer.RequestResolution(idA, 32.0f);
+	streamer.RequestResolution(idB, 256.0f);
+	streamer.Update(1);
+	streamer.RequestResolution(idB, 32.0f);
+	streamer.Update(2);
+	CHECK(sink.Evictions.empty());
+	CHECK(streamer.GetResidentMip(idA) == 0 && streamer.GetResidentMip(idB) == 0);
+
+	// C needs room: A was requested longest ago and goes first; B keeps its mips.
+	streamer.RequestResolution(idC, 256.0f);
+	streamer.Update(3);
+	CHECK(streamer.GetResidentMip(idC) == 0);
+	CHECK(!sink.Evictions.empty() && sink.Evictions[0].Id == idA);
+	CHECK(streamer.GetResidentMip(idB) == 0);
+	CHECK(streamer.GetStats().ResidentBytes <= budget);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_RefusedEvictionTriesTheNextVictim)
+{
+	TestTexture a, b, c;
+	FakeSink sink;
+
+	const std::uint64_t budget = 2 * FullBytes + TailBytes;
+	TextureStreamer streamer(sink, MakeConfig(budget));
+	const StreamTextureId idA = streamer.Register(a.Image);
+	const StreamTextureId idB = streamer.Register(b.Image);
+	const StreamTextureId idC = streamer.Register(c.Image);
+
+	streamer.RequestResolution(idA, 256.0f);
+	streamer.RequestResolution(idB, 256.0f);
+	streamer.Update(0);
+	streamer.RequestResolution(idA, 32.0f);
+	streamer.Update(1);
+	streamer.RequestResolution(idB, 32.0f);
+	streamer.Update(2);
+
+	// A's mips are still in use on the GPU: B is evicted instead.
+	sink.RefuseEvictions.insert(idA);
+	streamer.RequestResolution(idC, 256.0f);
+	streamer.Update(3);
+	CHECK(sink.RefusedEvictions > 0);
+	CHECK(streamer.GetResidentMip(idA) == 0);
+	CHECK(!sink.Evictions.empty() && sink.Evictions[0].Id == idB);
+	CHECK(streamer.GetResidentMip(idC) == 0);
+	CHECK(streamer.GetStats().ResidentBytes <= budget);
+
+	// With every victim refusing, C's next load is skipped rather than overspending.
+	sink.RefuseEvictions.insert(idB);
+	sink.RefuseEvictions.insert(idC);
+	TestTexture d;
+	const StreamTextureId idD = streamer.Register(d.Image);
+	streamer.RequestResolution(idD, 256.0f);
+	const std::uint64_t stalls = streamer.GetStats().BudgetStalls;
+	streamer.Update(4);
+	CHECK(streamer.GetStats().ResidentBytes <= budget + TailBytes); // D's tail ignores the budget
+	CHECK(streamer.GetResidentMip(idD) == streamer.GetTailMip(idD));
+	CHECK(streamer.GetStats().BudgetStalls > stalls);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_MipBiasHysteresis)
+{
+	TestTexture texture;
+	FakeSink sink;
+
+	// The full chain does not fit, mip 1 does.
+	TextureStreamer streamer(sink, MakeConfig(Mip1Bytes + 4096));
+	const StreamTextureId id = streamer.Register(texture.Image);
+
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(0);
+	CHECK(streamer.GetStats().MipBias == 1);
+	CHECK(streamer.GetResidentMip(id) == 2);
+
+	// Biased by one the request fits.  The bias then holds steady: mip 0 would
+	// need about four times the memory, so it is not retried every other frame.
+	for(std::uint64_t frame = 1; frame < 10; ++frame)
+	{
+		streamer.RequestResolution(id, 256.0f);
+		streamer.Update(frame);
+		CHECK(streamer.GetStats().MipBias == 1);
+		CHECK(streamer.GetResidentMip(id) == 1);
+	}
+	const size_t loads = sink.Loads.size();
+
+	// Plenty of memory again: the bias relaxes and the full chain comes in.
+	streamer.SetBudget(16 * FullBytes);
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(10);
+	CHECK(streamer.GetStats().MipBias == 0);
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(11);
+	CHECK(streamer.GetResidentMip(id) == 0);
+	CHECK(sink.Loads.size() == loads + 1);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_BusySinkRetries)
+{
+	TestTexture texture;
+	FakeSink sink;
+	sink.Busy = true;
+
+	TextureStreamer streamer(sink, MakeConfig(1 << 20));
+	const StreamTextureId id = streamer.Register(texture.Image);
+
+	// Even the tail is postponed, not dropped.
+	CHECK(streamer.GetResidentMip(id) == 9);
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(0);
+	CHECK(streamer.GetResidentMip(id) == 9);
+	CHECK(streamer.GetStats().PendingTextures == 1);
+	CHECK(streamer.GetStats().LoadFailures == 0);
+
+	sink.Busy = false;
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(1);
+	CHECK(streamer.GetResidentMip(id) == 0);
+	CHECK(streamer.GetStats().PendingTextures == 0);
+	CHECK(sink.ContractViolations == 0);
+}
+
+TEST(TextureStreamer_FailedLoadCapsTheTexture)
+{
+	TestTexture texture;
+	FakeSink sink;
+	sink.FailBelowMip = 1; // mip 0 can never be loaded
+
+	TextureStreamer streamer(sink, MakeConfig(1 << 20));
+	const StreamTextureId id = streamer.Register(texture.Image);
+
+	streamer.RequestResolution(id, 256.0f);
+	streamer.Update(0);
+	CHECK(streamer.GetStats().LoadFailures == 1);
+	CHECK(streamer.GetResidentMip(id) == 2);
+	CHECK(streamer.GetStats().PendingTextures == 0);
+
+	// The next request settles for mip 1, and mip 0 is never asked for again.
+	for(std::uint64_t frame = 1; frame < 5; ++frame)
+	{
+		streamer.RequestResolution(id, 256.0f);
+		streamer.Update(frame);
+	}
+	CHECK(streamer.GetResidentMip(id) == 1);
+	CHECK(streamer.GetDesiredMip(id) == 1);
+	CHECK(streamer.GetStats().LoadFailures == 1);
+
+	int mip0Loads = 0;
+	for(const FakeSink::Call& call : sink.Loads)
+		mip0Loads += call.FirstMip == 0 ? 1 : 0;
+	CHECK(mip0Loads == 1);
+	CHECK(sink.ContractViolations == 0);
+}
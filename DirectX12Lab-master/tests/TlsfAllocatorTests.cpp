@@ -0,0 +1,196 @@
+#include "Test.h"
+#include "../src/graphics/TlsfAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	typedef TlsfAllocator<std::uint64_t> Allocator;
+
+	struct Live
+	{
+		Allocator::Allocation Allocation;
+		std::uint64_t Requested = 0;
+		std::uint64_t Alignment = 1;
+	};
+
+	// No two live allocations share a byte.
+	bool Disjoint(std::vector<Live> live)
+	{
+		std::sort(live.begin(), live.end(), [](const Live& a, const Live& b)
+			{ return a.Allocation.Offset < b.Allocation.Offset; });
+
+		for(size_t i = 1; i < live.size(); ++i)
+		{
+			const Allocator::Allocation& prev = live[i - 1].Allocation;
+			if(prev.Offset + prev.Size > live[i].Allocation.Offset)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(TlsfAllocator_FreesBackToOneBlock)
+{
+	Allocator allocator(1 << 20, 256);
+
+	Allocator::Allocation a = allocator.Allocate(1000);
+	Allocator::Allocation b = allocator.Allocate(5000, 4096);
+	Allocator::Allocation c = allocator.Allocate(256);
+	CHECK(a.IsValid() && b.IsValid() && c.IsValid());
+	CHECK(a.Size == 1024);
+	CHECK(b.Offset % 4096 == 0);
+	CHECK(allocator.GetAllocationCount() == 3);
+
+	// Free the middle one first so both merges (next and previous) are exercised.
+	allocator.Free(b);
+	allocator.Free(a);
+	allocator.Free(c);
+	CHECK(allocator.GetAllocationCount() == 0);
+	CHECK(allocator.GetUsedSize() == 0);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+	CHECK(allocator.GetFreeSize() == (1u << 20));
+}
+
+TEST(TlsfAllocator_RejectsWhatDoesNotFit)
+{
+	Allocator allocator(64 * 1024, 256);
+
+	CHECK(!allocator.Allocate(0).IsValid());
+	CHECK(!allocator.Allocate(64 * 1024 + 1).IsValid());
+
+	Allocator::Allocation all = allocator.Allocate(64 * 1024);
+	CHECK(all.IsValid() && all.Offset == 0);
+	CHECK(!allocator.Allocate(256).IsValid());
+
+	allocator.Free(all);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+}
+
+TEST(TlsfAllocator_RandomizedAllocFree)
+{
+	const std::uint64_t heapSize = 256ull << 20;
+	const std::uint64_t granularity = 256;
+	Allocator allocator(heapSize, granularity);
+
+	// Buffers, small and MSAA textures, the way GpuHeap uses it.
+	const std::uint64_t alignments[] = { 1, 256, 4096, 64 * 1024, 4 * 1024 * 1024 };
+
+	std::mt19937 random(1234);
+	std::vector<Live> live;
+	std::uint64_t used = 0;
+	int failedAllocations = 0;
+
+	for(int iteration = 0; iteration < 20000; ++iteration)
+	{
+		const bool allocate = live.empty() || (random() % 100) < (live.size() < 200 ? 60u : 40u);
+		if(allocate)
+		{
+			Live entry;
+			entry.Alignment = alignments[random() % 5];
+			// Mostly small, sometimes up to a few megabytes.
+			entry.Requested = (random() % 4) == 0 ? 1 + random() % (4 << 20) : 1 + random() % (64 * 1024);
+
+			entry.Allocation = allocator.Allocate(entry.Requested, entry.Alignment);
+			if(!entry.Allocation.IsValid())
+			{
+				++failedAllocations;
+				continue;
+			}
+
+			const Allocator::Allocation& a = entry.Allocation;
+			CHECK(a.Size >= entry.Requested);
+			CHECK(a.Size % granularity == 0);
+			CHECK(a.Offset % std::max(entry.Alignment, granularity) == 0);
+			CHECK(a.Offset + a.Size <= heapSize);
+
+			used += a.Size;
+			live.push_back(entry);
+		}
+		else
+		{
+			const size_t index = random() % live.size();
+			used -= live[index].Allocation.Size;
+			allocator.Free(live[index].Allocation);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		CHECK(allocator.GetUsedSize() == used);
+		CHECK(allocator.GetAllocationCount() == live.size());
+
+		if(iteration % 500 == 0)
+			CHECK(Disjoint(live));
+	}
+
+	CHECK(Disjoint(live));
+	CHECK(failedAllocations < 20000 / 10);
+
+	// Everything freed, in random order, coalesces back into the original block.
+	std::shuffle(live.begin(), live.end(), random);
+	for(const Live& entry : live)
+		allocator.Free(entry.Allocation);
+
+	CHECK(allocator.GetAllocationCount() == 0);
+	CHECK(allocator.GetUsedSize() == 0);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+
+	Allocator::Allocation whole = allocator.Allocate(heapSize);
+	CHECK(whole.IsValid() && whole.Offset == 0);
+}
+
+BENCHMARK(TlsfAllocator_AllocFree)
+{
+	typedef std::chrono::high_resolution_clock BenchClock;
+
+	const int slots = 1024;
+	const int rounds = 1000;
+	Allocator allocator(1ull << 30, 256);
+
+	// Random sizes and alignments, generated up front so only the allocator is timed.
+	std::mt19937 random(99);
+	std::vector<std::uint64_t> sizes(slots);
+	std::vector<std::uint64_t> alignments(slots);
+	for(int i = 0; i < slots; ++i)
+	{
+		sizes[i] = 256 + random() % (256 * 1024);
+		alignments[i] = (random() % 4) == 0 ? 64 * 1024 : 256;
+	}
+
+	std::vector<Allocator::Allocation> allocations(slots);
+	for(int i = 0; i < slots; ++i)
+		allocations[i] = allocator.Allocate(sizes[i], alignments[i]);
+
+	// Each round frees a scattered half of the slots, then allocates them again, so
+	// the free lists stay fragmented.
+	std::vector<int> order(slots / 2);
+	double freeSeconds = 0.0;
+	double allocSeconds = 0.0;
+	for(int round = 0; round < rounds; ++round)
+	{
+		for(int i = 0; i < slots / 2; ++i)
+			order[i] = (i * 389 + round * 7) % slots;
+
+		BenchClock::time_point start = BenchClock::now();
+		for(int slot : order)
+			allocator.Free(allocations[slot]);
+		freeSeconds += std::chrono::duration<double>(BenchClock::now() - start).count();
+
+		start = BenchClock::now();
+		for(int slot : order)
+			allocations[slot] = allocator.Allocate(sizes[slot], alignments[slot]);
+		allocSeconds += std::chrono::duration<double>(BenchClock::now() - start).count();
+	}
+
+	const double ops = (double)(slots / 2) * rounds;
+	std::printf("  alloc %8.1f ns/op\n", allocSeconds * 1e9 / ops);
+	std::printf("  free  %8.1f ns/op\n", freeSeconds * 1e9 / ops);
+
+	for(const Allocator::Allocation& allocation : allocations)
+		allocator.Free(allocation);
+	CHECK(allocator.GetFreeBlockCount() == 1);
+}